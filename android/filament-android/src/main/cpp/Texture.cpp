@@ -361,6 +361,14 @@ Java_com_google_android_filament_Texture_nGenerateMipmaps(JNIEnv*, jclass,
     texture->generateMipmaps(*engine);
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_google_android_filament_Texture_nSetMinMaxLevels(JNIEnv*, jclass,
+        jlong nativeTexture, jlong nativeEngine, jint minLevel, jint maxLevel) {
+    Texture *texture = (Texture *) nativeTexture;
+    Engine *engine = (Engine *) nativeEngine;
+    texture->setMinMaxLevels(*engine, (uint8_t) minLevel, (uint8_t) maxLevel);
+}
+
 extern "C"
 JNIEXPORT jboolean JNICALL
 Java_com_google_android_filament_Texture_nIsStreamValidForTexture(JNIEnv*, jclass,
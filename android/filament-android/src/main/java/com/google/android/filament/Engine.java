@@ -211,7 +211,9 @@ public class Engine {
             nSetBuilderConfig(mNativeBuilder, config.commandBufferSizeMB,
                     config.perRenderPassArenaSizeMB, config.driverHandleArenaSizeMB,
                     config.minCommandBufferSizeMB, config.perFrameCommandsSizeMB,
-                    config.jobSystemThreadCount, config.stereoscopicEyeCount);
+                    config.jobSystemThreadCount, config.stereoscopicEyeCount,
+                    config.resourceAllocatorCacheSizeMB, config.resourceAllocatorCacheMaxAge,
+                    config.componentLookupTableSizeKB);
             return this;
         }
 
@@ -356,6 +358,34 @@ public class Engine {
          * @see Engine#getMaxStereoscopicEyes
          */
         public long stereoscopicEyeCount = 2;
+
+        /**
+         * Size in MiB of the cache of transient textures.
+         *
+         * Textures used as intermediate render targets are kept in a cache after use, so they can
+         * be reused by later passes and frames. When the cache grows beyond this size, the least
+         * recently used textures are freed. 0 disables caching across frames.
+         *
+         * This value affects the application's memory usage.
+         */
+        public long resourceAllocatorCacheSizeMB = 64;
+
+        /**
+         * Number of frames a texture can stay unused in the cache of transient textures before
+         * it is freed. At most one such texture is freed per frame.
+         */
+        public long resourceAllocatorCacheMaxAge = 30;
+
+        /**
+         * Size in KiB of the table each of the transform, renderable and light managers uses to
+         * find the component of an entity from its index, instead of a hash map.
+         *
+         * The table is allocated by pages as entities get components. The default covers all
+         * possible entities, entities that don't fit use the hash map. 0 disables the table.
+         *
+         * This value affects the application's memory usage.
+         */
+        public long componentLookupTableSizeKB = 512;
     }
 
     private Engine(long nativeEngine, Config config) {
@@ -1227,7 +1257,8 @@ public class Engine {
     private static native void nSetBuilderConfig(long nativeBuilder, long commandBufferSizeMB,
             long perRenderPassArenaSizeMB, long driverHandleArenaSizeMB,
             long minCommandBufferSizeMB, long perFrameCommandsSizeMB, long jobSystemThreadCount,
-            long stereoscopicEyeCount);
+            long stereoscopicEyeCount, long resourceAllocatorCacheSizeMB,
+            long resourceAllocatorCacheMaxAge, long componentLookupTableSizeKB);
     private static native void nSetBuilderFeatureLevel(long nativeBuilder, int ordinal);
     private static native void nSetBuilderSharedContext(long nativeBuilder, long sharedContext);
     private static native long nBuilderBuild(long nativeBuilder);
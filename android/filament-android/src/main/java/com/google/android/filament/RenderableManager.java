@@ -407,6 +407,21 @@ public class RenderableManager {
             return this;
         }
 
+        /**
+         * Marks this renderable as a static shadow caster, false by default.
+         *
+         * Static shadow casters are rendered once into a cached shadow map of the spot and point
+         * lights they are visible from. The cache is updated when the light moves, when a
+         * static shadow caster it contains is moved, added or removed, and when the geometry or
+         * materials of such a caster change. Changing the content of its buffers directly is not
+         * detected, call setStaticShadowCaster() again after doing so.
+         */
+        @NonNull
+        public Builder staticShadowCaster(boolean enabled) {
+            nBuilderStaticShadowCaster(mNativeBuilder, enabled);
+            return this;
+        }
+
         /**
          * Allows bones to be swapped out and shared using SkinningBuffer.
          *
@@ -810,6 +825,15 @@ public class RenderableManager {
         nSetScreenSpaceContactShadows(mNativeObject, i, enabled);
     }
 
+    /**
+     * Changes whether or not the renderable is a static shadow caster.
+     *
+     * @see Builder#staticShadowCaster
+     */
+    public void setStaticShadowCaster(@EntityInstance int i, boolean enabled) {
+        nSetStaticShadowCaster(mNativeObject, i, enabled);
+    }
+
     /**
      * Checks if the renderable can cast shadows.
      *
@@ -975,6 +999,7 @@ public class RenderableManager {
     private static native void nBuilderCastShadows(long nativeBuilder, boolean enabled);
     private static native void nBuilderReceiveShadows(long nativeBuilder, boolean enabled);
     private static native void nBuilderScreenSpaceContactShadows(long nativeBuilder, boolean enabled);
+    private static native void nBuilderStaticShadowCaster(long nativeBuilder, boolean enabled);
     private static native void nBuilderSkinning(long nativeBuilder, int boneCount);
     private static native int nBuilderSkinningBones(long nativeBuilder, int boneCount, Buffer bones, int remaining);
     private static native void nBuilderSkinningBuffer(long nativeBuilder, long nativeSkinningBuffer, int boneCount, int offset);
@@ -1003,6 +1028,7 @@ public class RenderableManager {
     private static native void nSetCastShadows(long nativeRenderableManager, int i, boolean enabled);
     private static native void nSetReceiveShadows(long nativeRenderableManager, int i, boolean enabled);
     private static native void nSetScreenSpaceContactShadows(long nativeRenderableManager, int i, boolean enabled);
+    private static native void nSetStaticShadowCaster(long nativeRenderableManager, int i, boolean enabled);
     private static native boolean nIsShadowCaster(long nativeRenderableManager, int i);
     private static native boolean nIsShadowReceiver(long nativeRenderableManager, int i);
     private static native void nGetAxisAlignedBoundingBox(long nativeRenderableManager, int i, float[] center, float[] halfExtent);
@@ -1159,6 +1159,21 @@ public class Texture {
         nGenerateMipmaps(getNativeObject(), engine.getNativeObject());
     }
 
+    /**
+     * Restricts the range of levels that can be sampled, for instance while the finest levels
+     * of a texture are being streamed in. By default all levels can be sampled.
+     *
+     * @param engine    {@link Engine} this texture is associated to. Must be the
+     *                  instance passed to {@link Builder#build Builder.build()}.
+     * @param minLevel  finest level that can be sampled
+     * @param maxLevel  coarsest level that can be sampled, must be greater than or equal to
+     *                  <code>minLevel</code> and less than {@link #getLevels}
+     */
+    public void setMinMaxLevels(@NonNull Engine engine,
+            @IntRange(from = 0) int minLevel, @IntRange(from = 0) int maxLevel) {
+        nSetMinMaxLevels(getNativeObject(), engine.getNativeObject(), minLevel, maxLevel);
+    }
+
     /**
      * Creates a reflection map from an environment map.
      *
@@ -1300,6 +1315,9 @@ public class Texture {
 
     private static native void nGenerateMipmaps(long nativeTexture, long nativeEngine);
 
+    private static native void nSetMinMaxLevels(long nativeTexture, long nativeEngine,
+            int minLevel, int maxLevel);
+
     private static native boolean nIsStreamValidForTexture(long nativeTexture, long nativeStream);
 
     private static native int nGeneratePrefilterMipmap(long nativeIndirectLight, long nativeEngine,
@@ -1191,6 +1191,22 @@ static_assert(sizeof(StencilState) == 12u,
 
 using FrameScheduledCallback = void(*)(PresentCallable callable, void* user);
 
+/**
+ * Statistics of the backend's handle allocator. Handles are allocated from three pools of
+ * increasing size, which grow when exhausted. When a pool can't grow, handles are allocated on
+ * the heap through a slower path.
+ */
+struct HandleAllocatorStatistics {
+    static constexpr size_t POOL_COUNT = 3;
+    uint32_t handleSize[POOL_COUNT] = {};       //!< size of the handles of each pool in bytes
+    uint32_t liveHandleCount[POOL_COUNT] = {};  //!< number of handles allocated from each pool
+    uint32_t capacity[POOL_COUNT] = {};         //!< number of handles each pool can hold
+    uint32_t growCount[POOL_COUNT] = {};        //!< number of times each pool grew
+    size_t poolsSize = 0;                       //!< memory used by all the pools in bytes
+    uint32_t slowPathHandleCount = 0;           //!< number of handles allocated on the heap
+    uint64_t slowPathAllocationCount = 0;       //!< total number of heap allocations
+};
+
 enum class Workaround : uint16_t {
     // The EASU pass must split because shader compiler flattens early-exit branch
     SPLIT_EASU,
@@ -45,6 +45,8 @@ class CommandBufferQueue {
     mutable utils::Mutex mLock;
     mutable utils::Condition mCondition;
     mutable std::vector<Slice> mCommandBuffersToExecute;
+    // the slices returned by waitForCommands(), kept so that their storage is reused
+    mutable std::vector<Slice> mCommandBuffersExecuting;
     size_t mFreeSpace = 0;
     size_t mHighWatermark = 0;
     uint32_t mExitRequested = 0;
@@ -60,8 +62,9 @@ public:
 
     size_t getHighWatermark() const noexcept { return mHighWatermark; }
 
-    // wait for commands to be available and returns an array containing these commands
-    std::vector<Slice> waitForCommands() const;
+    // wait for commands to be available and returns an array containing these commands, which
+    // stays valid until the next call
+    std::vector<Slice> const& waitForCommands() const;
 
     // return the memory used by this command buffer to the circular buffer
     // WARNING: releaseBuffer() must be called in sequence of the Slices returned by
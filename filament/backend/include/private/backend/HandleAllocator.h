@@ -17,12 +17,18 @@
 #ifndef TNT_FILAMENT_BACKEND_PRIVATE_HANDLEALLOCATOR_H
 #define TNT_FILAMENT_BACKEND_PRIVATE_HANDLEALLOCATOR_H
 
+#include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
 #include <utils/Allocator.h>
 #include <utils/Log.h>
+#include <utils/Mutex.h>
 #include <utils/compiler.h>
+
 #include <tsl/robin_map.h>
+
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #if !defined(NDEBUG) && UTILS_HAS_RTTI
@@ -39,6 +45,9 @@ namespace filament::backend {
 
 /*
  * A utility class to efficiently allocate and manage Handle<>
+ *
+ * Handles are allocated from three pools of fixed size objects. The pools start in a single
+ * arena, and grow by chunks when exhausted, converting a handle to a pointer is always O(1).
  */
 template <size_t P0, size_t P1, size_t P2>
 class HandleAllocator {
@@ -208,92 +217,91 @@ public:
     }
 
 
+    /*
+     * Returns the number of live handles and the capacity of each pool, and how often
+     * allocations had to go through the slow heap path. This is thread-safe.
+     */
+    HandleAllocatorStatistics getStatistics() const noexcept;
+
 private:
 
-    // template <int P0, int P1, int P2>
-    class Allocator {
-        friend class HandleAllocator;
-        utils::PoolAllocator<P0, 16>   mPool0;
-        utils::PoolAllocator<P1, 16>   mPool1;
-        utils::PoolAllocator<P2, 16>   mPool2;
-        UTILS_UNUSED_IN_RELEASE const utils::AreaPolicy::HeapArea& mArea;
-    public:
-        static constexpr size_t MIN_ALIGNMENT_SHIFT = 4;
-        explicit Allocator(const utils::AreaPolicy::HeapArea& area);
-
-        // this is in fact always called with a constexpr size argument
-        [[nodiscard]] inline void* alloc(size_t size, size_t alignment, size_t extra) noexcept {
-            void* p = nullptr;
-                 if (size <= mPool0.getSize()) p = mPool0.alloc(size, 16, extra);
-            else if (size <= mPool1.getSize()) p = mPool1.alloc(size, 16, extra);
-            else if (size <= mPool2.getSize()) p = mPool2.alloc(size, 16, extra);
-            return p;
-        }
+    static constexpr size_t POOL_COUNT = HandleAllocatorStatistics::POOL_COUNT;
+    static constexpr size_t MIN_ALIGNMENT_SHIFT = 4;
+    static constexpr size_t MAX_CHUNK_COUNT = 4096;
 
-        // this is in fact always called with a constexpr size argument
-        inline void free(void* p, size_t size) noexcept {
-            assert_invariant(p >= mArea.begin() && (char*)p + size <= (char*)mArea.end());
-            if (size <= mPool0.getSize()) { mPool0.free(p); return; }
-            if (size <= mPool1.getSize()) { mPool1.free(p); return; }
-            if (size <= mPool2.getSize()) { mPool2.free(p); return; }
-        }
+    // Free handles are linked through their own storage, which also remembers their id, so that
+    // the pools can span several chunks of memory.
+    struct Node {
+        Node* next;
+        HandleBase::HandleId id;
     };
 
-// FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
-//        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
-//        we don't understand well (b/308029108).
-#ifndef NDEBUG
-    using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex,
-            utils::TrackingPolicy::DebugAndHighWatermark>;
-#else
-    using HandleArena = utils::Arena<Allocator,
-            utils::LockingPolicy::Mutex>;
-#endif
+    struct Pool {
+        Node* head = nullptr;       // list of free handles
+        size_t chunkSize = 0;       // size of the chunks the pool grows by
+        uint32_t liveCount = 0;
+        uint32_t capacity = 0;
+        uint32_t growCount = 0;
+    };
+
+    static constexpr size_t poolStride(size_t size) noexcept {
+        return (size + (1u << MIN_ALIGNMENT_SHIFT) - 1) & ~((1u << MIN_ALIGNMENT_SHIFT) - 1);
+    }
 
     // allocateHandle()/deallocateHandle() selects the pool to use at compile-time based on the
     // allocation size this is always inlined, because all these do is to call
-    // allocateHandleInPool()/deallocateHandleFromPool() with the right pool size.
+    // allocateHandleInPool()/deallocateHandleFromPool() with the right pool.
     template<size_t SIZE>
     HandleBase::HandleId allocateHandle() noexcept {
-        if constexpr (SIZE <= P0) { return allocateHandleInPool<P0>(); }
-        if constexpr (SIZE <= P1) { return allocateHandleInPool<P1>(); }
+        if constexpr (SIZE <= P0) { return allocateHandleInPool<0, P0>(); }
+        if constexpr (SIZE <= P1) { return allocateHandleInPool<1, P1>(); }
         static_assert(SIZE <= P2);
-        return allocateHandleInPool<P2>();
+        return allocateHandleInPool<2, P2>();
     }
 
     template<size_t SIZE>
     void deallocateHandle(HandleBase::HandleId id) noexcept {
         if constexpr (SIZE <= P0) {
-            deallocateHandleFromPool<P0>(id);
+            deallocateHandleFromPool<0, P0>(id);
         } else if constexpr (SIZE <= P1) {
-            deallocateHandleFromPool<P1>(id);
+            deallocateHandleFromPool<1, P1>(id);
         } else {
             static_assert(SIZE <= P2);
-            deallocateHandleFromPool<P2>(id);
+            deallocateHandleFromPool<2, P2>(id);
         }
     }
 
     // allocateHandleInPool()/deallocateHandleFromPool() is NOT inlined, which will cause three
-    // versions to be generated, one for each pool. Because the arena is synchronized,
-    // the code generated is not trivial (even if it's not insane either).
-    template<size_t SIZE>
+    // versions to be generated, one for each pool.
+    template<size_t INDEX, size_t SIZE>
     UTILS_NOINLINE
     HandleBase::HandleId allocateHandleInPool() noexcept {
-        void* p = mHandleArena.alloc(SIZE);
-        if (UTILS_LIKELY(p)) {
-            return pointerToHandle(p);
-        } else {
-            return allocateHandleSlow(SIZE);
+        std::unique_lock lock(mLock);
+        Pool& pool = mPools[INDEX];
+        if (UTILS_UNLIKELY(!pool.head)) {
+            // the pool is exhausted, add a chunk to it
+            if (UTILS_UNLIKELY(!growPool(pool, poolStride(SIZE)))) {
+                lock.unlock();
+                return allocateHandleSlow(SIZE);
+            }
         }
+        Node* const node = pool.head;
+        pool.head = node->next;
+        pool.liveCount++;
+        return node->id;
     }
 
-    template<size_t SIZE>
+    template<size_t INDEX, size_t SIZE>
     UTILS_NOINLINE
     void deallocateHandleFromPool(HandleBase::HandleId id) noexcept {
         if (UTILS_LIKELY(isPoolHandle(id))) {
-            void* p = handleToPointer(id);
-            mHandleArena.free(p, SIZE);
+            Node* const node = static_cast<Node*>(handleToPointer(id));
+            std::lock_guard const lock(mLock);
+            Pool& pool = mPools[INDEX];
+            node->next = pool.head;
+            node->id = id;
+            pool.head = node;
+            pool.liveCount--;
         } else {
             deallocateHandleSlow(id, SIZE);
         }
@@ -305,16 +313,23 @@ private:
         return (id & HEAP_HANDLE_FLAG) == 0u;
     }
 
+    // adds a chunk to the pool, returns false if the pool can't grow anymore
+    bool growPool(Pool& pool, size_t stride) noexcept;
+
+    // adds the handles of a chunk to the pool's free list
+    void addChunk(Pool& pool, char* begin, size_t size, size_t stride) noexcept;
+
     HandleBase::HandleId allocateHandleSlow(size_t size) noexcept;
     void deallocateHandleSlow(HandleBase::HandleId id, size_t size) noexcept;
 
-    // We inline this because it's just 4 instructions in the fast case
+    // We inline this because it's just a few instructions in the fast case. A handle id is the
+    // index of its chunk followed by its offset within the chunk.
     inline void* handleToPointer(HandleBase::HandleId id) const noexcept {
         // note: the null handle will end-up returning nullptr b/c it'll be handled as
         // a non-pool handle.
         if (UTILS_LIKELY(isPoolHandle(id))) {
-            char* const base = (char*)mHandleArena.getArea().begin();
-            size_t offset = id << Allocator::MIN_ALIGNMENT_SHIFT;
+            char* const base = mChunks[id >> mChunkShift];
+            size_t const offset = size_t(id & mChunkMask) << MIN_ALIGNMENT_SHIFT;
             return static_cast<void*>(base + offset);
         }
         return handleToPointerSlow(id);
@@ -322,21 +337,28 @@ private:
 
     void* handleToPointerSlow(HandleBase::HandleId id) const noexcept;
 
-    // We inline this because it's just 3 instructions
-    inline HandleBase::HandleId pointerToHandle(void* p) const noexcept {
-        char* const base = (char*)mHandleArena.getArea().begin();
-        size_t offset = (char*)p - base;
-        auto id = HandleBase::HandleId(offset >> Allocator::MIN_ALIGNMENT_SHIFT);
-        assert_invariant((id & HEAP_HANDLE_FLAG) == 0);
-        return id;
-    }
-
-    HandleArena mHandleArena;
-
-    // Below is only used when running out of space in the HandleArena
+    const char* const mName;
+    utils::AreaPolicy::HeapArea mHandleArea;
+
+    // Chunks are never freed or moved, so that handleToPointer() doesn't need a lock: a chunk is
+    // always added before any of its handles is returned. The first POOL_COUNT chunks are the
+    // initial area, split between the pools.
+    std::unique_ptr<char*[]> mChunks;
+    uint32_t mChunkCount = 0;
+    uint32_t mMaxChunkCount = 0;
+    uint32_t mChunkShift = 0;
+    uint32_t mChunkMask = 0;
+
+    // FIXME: We should be using a Spinlock here, at least on platforms where mutexes are not
+    //        efficient (i.e. non-Linux). However, we've seen some hangs on that spinlock, which
+    //        we don't understand well (b/308029108).
     mutable utils::Mutex mLock;
+    Pool mPools[POOL_COUNT];
+
+    // Below is only used when the pools can't grow anymore
     tsl::robin_map<HandleBase::HandleId, void*> mOverflowMap;
     HandleBase::HandleId mId = 0;
+    uint64_t mSlowPathCount = 0;
 #if HANDLE_TYPE_SAFETY
     mutable std::unordered_map<const void*, const char*> mHandleTypeId;
 #endif
@@ -24,6 +24,8 @@
 #include "private/backend/BackendUtils.h"
 #include "private/backend/CommandStream.h"
 
+#include <utility>
+
 using namespace utils;
 
 namespace filament::backend {
@@ -108,9 +110,13 @@ void CommandBufferQueue::flush() noexcept {
     }
 }
 
-std::vector<CommandBufferQueue::Slice> CommandBufferQueue::waitForCommands() const {
+std::vector<CommandBufferQueue::Slice> const& CommandBufferQueue::waitForCommands() const {
+    // the previous slices have been executed, swap their storage with the pending ones so
+    // that neither vector allocates in steady state.
+    mCommandBuffersExecuting.clear();
     if (!UTILS_HAS_THREADING) {
-        return std::move(mCommandBuffersToExecute);
+        std::swap(mCommandBuffersExecuting, mCommandBuffersToExecute);
+        return mCommandBuffersExecuting;
     }
     std::unique_lock<utils::Mutex> lock(mLock);
     while (mCommandBuffersToExecute.empty() && !mExitRequested) {
@@ -120,7 +126,8 @@ std::vector<CommandBufferQueue::Slice> CommandBufferQueue::waitForCommands() con
     ASSERT_PRECONDITION( mExitRequested == 0 || mExitRequested == EXIT_REQUESTED,
             "mExitRequested is corrupted (value = 0x%08x)!", mExitRequested);
 
-    return std::move(mCommandBuffersToExecute);
+    std::swap(mCommandBuffersExecuting, mCommandBuffersToExecute);
+    return mCommandBuffersExecuting;
 }
 
 void CommandBufferQueue::releaseBuffer(CommandBufferQueue::Slice const& buffer) {
@@ -16,8 +16,12 @@
 
 #include "private/backend/HandleAllocator.h"
 
+#include <utils/Log.h>
 #include <utils/Panic.h>
 
+#include <algorithm>
+#include <mutex>
+
 #include <stdlib.h>
 
 namespace filament::backend {
@@ -25,24 +29,32 @@ namespace filament::backend {
 using namespace utils;
 
 template <size_t P0, size_t P1, size_t P2>
-UTILS_NOINLINE
-HandleAllocator<P0, P1, P2>::Allocator::Allocator(AreaPolicy::HeapArea const& area)
-        : mArea(area) {
+HandleAllocator<P0, P1, P2>::HandleAllocator(const char* name, size_t size) noexcept
+    : mName(name), mHandleArea(size) {
     // TODO: we probably need a better way to set the size of these pools
-    const size_t unit = area.size() / 32;
-    const size_t offsetPool1 =      unit;
-    const size_t offsetPool2 = 16 * unit;
-    char* const p = (char*)area.begin();
-    mPool0 = PoolAllocator< P0, 16>(p, p + offsetPool1);
-    mPool1 = PoolAllocator< P1, 16>(p + offsetPool1, p + offsetPool2);
-    mPool2 = PoolAllocator< P2, 16>(p + offsetPool2, area.end());
-}
-
-// ------------------------------------------------------------------------------------------------
+    size_t const unit = (size / 32) & ~((size_t(1) << MIN_ALIGNMENT_SHIFT) - 1);
+    char* const p = (char*)mHandleArea.begin();
+    char* const begins[POOL_COUNT + 1] = { p, p + unit, p + 16 * unit, (char*)mHandleArea.end() };
+    size_t const strides[POOL_COUNT] = { poolStride(P0), poolStride(P1), poolStride(P2) };
+
+    // the pools grow by chunks of the size of their initial part of the area, a chunk must be
+    // addressable by the low bits of the handle id.
+    size_t largestChunk = 1u << MIN_ALIGNMENT_SHIFT;
+    for (size_t i = 0; i < POOL_COUNT; i++) {
+        mPools[i].chunkSize = std::max(size_t(begins[i + 1] - begins[i]), strides[i]);
+        largestChunk = std::max(largestChunk, mPools[i].chunkSize);
+    }
+    while ((size_t(1) << (mChunkShift + MIN_ALIGNMENT_SHIFT)) < largestChunk) {
+        mChunkShift++;
+    }
+    assert_invariant(mChunkShift < 31);
+    mChunkMask = (1u << mChunkShift) - 1u;
+    mMaxChunkCount = std::min(MAX_CHUNK_COUNT, size_t(HEAP_HANDLE_FLAG >> mChunkShift));
+    mChunks = std::make_unique<char*[]>(mMaxChunkCount);
 
-template <size_t P0, size_t P1, size_t P2>
-HandleAllocator<P0, P1, P2>::HandleAllocator(const char* name, size_t size) noexcept
-    : mHandleArena(name, size) {
+    for (size_t i = 0; i < POOL_COUNT; i++) {
+        addChunk(mPools[i], begins[i], size_t(begins[i + 1] - begins[i]), strides[i]);
+    }
 }
 
 template <size_t P0, size_t P1, size_t P2>
@@ -55,6 +67,72 @@ HandleAllocator<P0, P1, P2>::~HandleAllocator() {
             ::free(entry.second);
         }
     }
+    // the first chunks belong to the area
+    for (size_t i = POOL_COUNT; i < mChunkCount; i++) {
+        ::free(mChunks[i]);
+    }
+}
+
+template <size_t P0, size_t P1, size_t P2>
+void HandleAllocator<P0, P1, P2>::addChunk(Pool& pool,
+        char* begin, size_t size, size_t stride) noexcept {
+    assert_invariant(mChunkCount < mMaxChunkCount);
+    assert_invariant(!(uintptr_t(begin) & ((1u << MIN_ALIGNMENT_SHIFT) - 1)));
+    uint32_t const chunk = mChunkCount++;
+    mChunks[chunk] = begin;
+
+    // link the handles in address order, in front of the free list
+    size_t const count = size / stride;
+    Node* next = pool.head;
+    for (size_t i = count; i > 0; i--) {
+        Node* const node = reinterpret_cast<Node*>(begin + (i - 1) * stride);
+        node->next = next;
+        node->id = HandleBase::HandleId(
+                (chunk << mChunkShift) | (((i - 1) * stride) >> MIN_ALIGNMENT_SHIFT));
+        next = node;
+    }
+    pool.head = next;
+    pool.capacity += uint32_t(count);
+}
+
+template <size_t P0, size_t P1, size_t P2>
+UTILS_NOINLINE
+bool HandleAllocator<P0, P1, P2>::growPool(Pool& pool, size_t stride) noexcept {
+    if (UTILS_UNLIKELY(mChunkCount == mMaxChunkCount)) {
+        return false;
+    }
+    // malloc() returns memory aligned to at least 16 bytes
+    char* const p = (char*)::malloc(pool.chunkSize);
+    if (UTILS_UNLIKELY(!p)) {
+        return false;
+    }
+    if (UTILS_UNLIKELY(!pool.growCount)) {
+        slog.w << "HandleAllocator \"" << mName << "\": pool of " << stride
+               << " bytes handles is full, growing it. Consider increasing the handle arena "
+                  "size (e.g. FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB)." << io::endl;
+    }
+    pool.growCount++;
+    addChunk(pool, p, pool.chunkSize, stride);
+    return true;
+}
+
+template <size_t P0, size_t P1, size_t P2>
+HandleAllocatorStatistics HandleAllocator<P0, P1, P2>::getStatistics() const noexcept {
+    HandleAllocatorStatistics stats;
+    size_t const sizes[POOL_COUNT] = { P0, P1, P2 };
+    std::lock_guard const lock(mLock);
+    stats.poolsSize = mHandleArea.size();
+    for (size_t i = 0; i < POOL_COUNT; i++) {
+        Pool const& pool = mPools[i];
+        stats.handleSize[i] = uint32_t(sizes[i]);
+        stats.liveHandleCount[i] = pool.liveCount;
+        stats.capacity[i] = pool.capacity;
+        stats.growCount[i] = pool.growCount;
+        stats.poolsSize += pool.growCount * pool.chunkSize;
+    }
+    stats.slowPathHandleCount = uint32_t(mOverflowMap.size());
+    stats.slowPathAllocationCount = mSlowPathCount;
+    return stats;
 }
 
 template <size_t P0, size_t P1, size_t P2>
@@ -75,11 +153,12 @@ HandleBase::HandleId HandleAllocator<P0, P1, P2>::allocateHandleSlow(size_t size
     std::unique_lock lock(mLock);
     HandleBase::HandleId id = (++mId) | HEAP_HANDLE_FLAG;
     mOverflowMap.emplace(id, p);
+    mSlowPathCount++;
     lock.unlock();
 
     if (UTILS_UNLIKELY(id == (HEAP_HANDLE_FLAG|1u))) { // meaning id was zero
-        PANIC_LOG("HandleAllocator arena is full, using slower system heap. Please increase "
-                  "the appropriate constant (e.g. FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB).");
+        PANIC_LOG("HandleAllocator pools can't grow anymore, using slower system heap. Please "
+                  "increase the appropriate constant (e.g. FILAMENT_OPENGL_HANDLE_ARENA_SIZE_IN_MB).");
     }
     return id;
 }
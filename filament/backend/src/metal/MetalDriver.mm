@@ -763,6 +763,10 @@ FeatureLevel MetalDriver::getFeatureLevel() {
     return FeatureLevel::FEATURE_LEVEL_2;
 }
 
+HandleAllocatorStatistics MetalDriver::getHandleAllocatorStatistics() {
+    return mHandleAllocator.getStatistics();
+}
+
 math::float2 MetalDriver::getClipSpaceParams() {
     // virtual and physical z-coordinate of clip-space is in [-w, 0]
     // Note: this is actually never used (see: main.vs), but it's a backend API so we implement it
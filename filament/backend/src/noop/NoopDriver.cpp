@@ -194,6 +194,11 @@ FeatureLevel NoopDriver::getFeatureLevel() {
     return FeatureLevel::FEATURE_LEVEL_1;
 }
 
+HandleAllocatorStatistics NoopDriver::getHandleAllocatorStatistics() {
+    // the noop driver doesn't allocate handles
+    return {};
+}
+
 math::float2 NoopDriver::getClipSpaceParams() {
     return math::float2{ 1.0f, 0.0f };
 }
@@ -1938,6 +1938,10 @@ FeatureLevel OpenGLDriver::getFeatureLevel() {
     return mContext.getFeatureLevel();
 }
 
+HandleAllocatorStatistics OpenGLDriver::getHandleAllocatorStatistics() {
+    return mHandleAllocator.getStatistics();
+}
+
 math::float2 OpenGLDriver::getClipSpaceParams() {
     return mContext.ext.EXT_clip_control ?
            // z-coordinate of virtual and physical clip-space is in [-w, 0]
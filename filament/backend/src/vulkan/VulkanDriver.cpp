@@ -840,6 +840,10 @@ FeatureLevel VulkanDriver::getFeatureLevel() {
     return FeatureLevel::FEATURE_LEVEL_3;
 }
 
+HandleAllocatorStatistics VulkanDriver::getHandleAllocatorStatistics() {
+    return mResourceAllocator.getStatistics();
+}
+
 math::float2 VulkanDriver::getClipSpaceParams() {
     // virtual and physical z-coordinate of clip-space is in [-w, 0]
     // Note: this is actually never used (see: main.vs), but it's a backend API, so we implement it
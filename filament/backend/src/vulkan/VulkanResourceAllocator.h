@@ -105,6 +105,10 @@ public:
         mHandleAllocatorImpl.deallocate(handle, obj);
     }
 
+    HandleAllocatorStatistics getStatistics() const noexcept {
+        return mHandleAllocatorImpl.getStatistics();
+    }
+
 private:
     HandleAllocatorVK mHandleAllocatorImpl;
 
@@ -76,7 +76,7 @@ void BackendTest::initializeDriver() {
 
 void BackendTest::executeCommands() {
     commandBufferQueue.flush();
-    auto buffers = commandBufferQueue.waitForCommands();
+    auto const& buffers = commandBufferQueue.waitForCommands();
     for (auto& item : buffers) {
         if (UTILS_LIKELY(item.begin)) {
             getDriverApi().execute(item.begin);
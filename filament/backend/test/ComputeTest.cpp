@@ -78,7 +78,7 @@ void ComputeTest::TearDown() {
 
 void ComputeTest::executeCommands() {
     commandBufferQueue.flush();
-    auto buffers = commandBufferQueue.waitForCommands();
+    auto const& buffers = commandBufferQueue.waitForCommands();
     for (auto& item : buffers) {
         if (UTILS_LIKELY(item.begin)) {
             getDriverApi().execute(item.begin);
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "private/backend/HandleAllocator.h"
+
+#include <set>
+#include <vector>
+
+#include <stdint.h>
+
+// HandleAllocatorGL is only instantiated when the OpenGL backend is built
+#if defined(FILAMENT_SUPPORTS_OPENGL)
+
+using namespace filament::backend;
+
+namespace {
+
+struct HwSmall {
+    HandleBase::HandleId id;
+};
+
+struct HwLarge {
+    HandleBase::HandleId id;
+    uint8_t payload[160];
+};
+
+// a 4 KiB arena holds 8 small handles and 9 large ones, the rest grows in chunks
+constexpr size_t ARENA_SIZE = 4096;
+
+constexpr uint32_t HEAP_HANDLE_FLAG = 0x80000000u;
+
+template<typename T>
+std::vector<Handle<T>> allocate(HandleAllocatorGL& allocator, size_t count) {
+    std::vector<Handle<T>> handles;
+    for (size_t i = 0; i < count; i++) {
+        Handle<T> h = allocator.allocateAndConstruct<T>();
+        allocator.handle_cast<T*>(h)->id = h.getId();
+        handles.push_back(h);
+    }
+    return handles;
+}
+
+// checks that every handle still decodes to its own object
+template<typename T>
+void expectValid(HandleAllocatorGL& allocator, std::vector<Handle<T>> const& handles) {
+    std::set<T const*> pointers;
+    for (Handle<T> const& h : handles) {
+        T const* const p = allocator.handle_cast<T const*>(h);
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(uintptr_t(p) % 16, 0u);
+        EXPECT_EQ(p->id, h.getId());
+        pointers.insert(p);
+    }
+    EXPECT_EQ(pointers.size(), handles.size());
+}
+
+template<typename T>
+void deallocate(HandleAllocatorGL& allocator, std::vector<Handle<T>>& handles) {
+    for (Handle<T>& h : handles) {
+        allocator.deallocate(h);
+    }
+    handles.clear();
+}
+
+} // anonymous namespace
+
+TEST(HandleAllocatorTest, GrowsByChunks) {
+    HandleAllocatorGL allocator("test", ARENA_SIZE);
+    HandleAllocatorStatistics const initial = allocator.getStatistics();
+    EXPECT_EQ(initial.liveHandleCount[0], 0u);
+    EXPECT_EQ(initial.growCount[0], 0u);
+    EXPECT_EQ(initial.poolsSize, ARENA_SIZE);
+
+    // many times the initial capacity, so that handles span several chunks, mixed with handles
+    // from another pool
+    size_t const count = initial.capacity[0] * 10;
+    auto small = allocate<HwSmall>(allocator, count);
+    auto large = allocate<HwLarge>(allocator, initial.capacity[2] * 3);
+
+    HandleAllocatorStatistics const grown = allocator.getStatistics();
+    EXPECT_EQ(grown.liveHandleCount[0], count);
+    EXPECT_GE(grown.capacity[0], count);
+    EXPECT_GE(grown.growCount[0], 9u);
+    EXPECT_GE(grown.growCount[2], 2u);
+    EXPECT_GT(grown.poolsSize, ARENA_SIZE);
+    EXPECT_EQ(grown.slowPathAllocationCount, 0u);
+
+    // chunks never move, so the handles allocated before the pool grew are still valid
+    for (auto const& h : small) {
+        EXPECT_EQ(h.getId() & HEAP_HANDLE_FLAG, 0u);
+    }
+    expectValid(allocator, small);
+    expectValid(allocator, large);
+
+    // freed handles are recycled across all the chunks, without growing the pool again
+    std::set<HandleBase::HandleId> ids;
+    for (auto const& h : small) {
+        ids.insert(h.getId());
+    }
+    deallocate(allocator, small);
+    EXPECT_EQ(allocator.getStatistics().liveHandleCount[0], 0u);
+
+    small = allocate<HwSmall>(allocator, count);
+    for (auto const& h : small) {
+        EXPECT_EQ(ids.count(h.getId()), 1u);
+    }
+    expectValid(allocator, small);
+    HandleAllocatorStatistics const reused = allocator.getStatistics();
+    EXPECT_EQ(reused.growCount[0], grown.growCount[0]);
+    EXPECT_EQ(reused.capacity[0], grown.capacity[0]);
+
+    deallocate(allocator, small);
+    deallocate(allocator, large);
+    HandleAllocatorStatistics const released = allocator.getStatistics();
+    EXPECT_EQ(released.liveHandleCount[0], 0u);
+    EXPECT_EQ(released.liveHandleCount[2], 0u);
+}
+
+TEST(HandleAllocatorTest, SlowPathWhenChunksAreExhausted) {
+    HandleAllocatorGL allocator("test", ARENA_SIZE);
+
+    // fill the chunk table, the next allocations go to the heap
+    std::vector<Handle<HwSmall>> small;
+    while (allocator.getStatistics().slowPathAllocationCount == 0) {
+        auto more = allocate<HwSmall>(allocator, 1);
+        small.push_back(more.front());
+    }
+
+    HandleAllocatorStatistics const stats = allocator.getStatistics();
+    EXPECT_EQ(stats.slowPathHandleCount, 1u);
+
+    // heap handles are tagged, and still decode to their object
+    auto heap = allocate<HwSmall>(allocator, 4);
+    heap.insert(heap.begin(), small.back());
+    small.pop_back();
+    for (auto const& h : heap) {
+        EXPECT_NE(h.getId() & HEAP_HANDLE_FLAG, 0u);
+    }
+    for (auto const& h : small) {
+        EXPECT_EQ(h.getId() & HEAP_HANDLE_FLAG, 0u);
+    }
+    expectValid(allocator, heap);
+    expectValid(allocator, small);
+    EXPECT_EQ(allocator.getStatistics().slowPathHandleCount, 5u);
+
+    // freeing a pool handle makes it available again, before the heap is used
+    deallocate(allocator, heap);
+    EXPECT_EQ(allocator.getStatistics().slowPathHandleCount, 0u);
+    Handle<HwSmall> h = small.back();
+    allocator.deallocate(h);
+    small.pop_back();
+    auto recycled = allocate<HwSmall>(allocator, 1);
+    EXPECT_EQ(recycled.front().getId() & HEAP_HANDLE_FLAG, 0u);
+    EXPECT_EQ(allocator.getStatistics().slowPathAllocationCount, 5u);
+
+    deallocate(allocator, recycled);
+    deallocate(allocator, small);
+    EXPECT_EQ(allocator.getStatistics().liveHandleCount[0], 0u);
+}
+
+#endif // FILAMENT_SUPPORTS_OPENGL
@@ -173,6 +173,7 @@ public:
     using Backend = backend::Backend;
     using DriverConfig = backend::Platform::DriverConfig;
     using FeatureLevel = backend::FeatureLevel;
+    using HandleAllocatorStatistics = backend::HandleAllocatorStatistics;
 
     /**
      * Config is used to define the memory footprint used by the engine, such as the
@@ -234,8 +235,8 @@ public:
         /**
          * Size in MiB of the backend's handle arena.
          *
-         * Backends will fallback to slower heap-based allocations when running out of space and
-         * log this condition.
+         * When the arena runs out of space, its pools grow by chunks, and this condition is
+         * logged. See Engine::getHandleAllocatorStatistics().
          *
          * If 0, then the default value for the given platform is used
          *
@@ -300,6 +301,49 @@ public:
          * @see Engine::getMaxStereoscopicEyes
          */
         uint8_t stereoscopicEyeCount = 2;
+
+        /**
+         * Size in MiB of the cache of transient textures.
+         *
+         * Textures used as intermediate render targets are kept in a cache after use, so they can
+         * be reused by later passes and frames. When the cache grows beyond this size, the least
+         * recently used textures are freed. 0 disables caching across frames.
+         *
+         * This value affects the application's memory usage.
+         *
+         * @see Engine::trimResourceCache
+         */
+        uint32_t resourceAllocatorCacheSizeMB = 64;
+
+        /**
+         * Number of frames a texture can stay unused in the cache of transient textures before
+         * it is freed. At most one such texture is freed per frame.
+         */
+        uint32_t resourceAllocatorCacheMaxAge = 30;
+
+        /**
+         * Size in KiB of the table each of the transform, renderable and light managers uses to
+         * find the component of an entity from its index, instead of a hash map.
+         *
+         * The table is allocated by pages as entities get components. The default covers all
+         * possible entities, entities that don't fit use the hash map. 0 disables the table.
+         *
+         * This value affects the application's memory usage.
+         */
+        uint32_t componentLookupTableSizeKB = 512;
+    };
+
+    /**
+     * Statistics of the cache of transient textures.
+     *
+     * @see Engine::getResourceCacheStatistics
+     */
+    struct ResourceCacheStatistics {
+        uint64_t hitCount = 0;          //!< number of transient textures reused from the cache
+        uint64_t missCount = 0;         //!< number of transient textures that had to be created
+        uint64_t evictionCount = 0;     //!< number of textures freed from the cache
+        size_t cacheSize = 0;           //!< current size of the cache in bytes
+        size_t cacheEntryCount = 0;     //!< current number of textures in the cache
     };
 
 
@@ -586,6 +630,33 @@ public:
      */
     static size_t getMaxStereoscopicEyes() noexcept;
 
+    /**
+     * Frees cached transient textures (e.g. intermediate render targets), least recently used
+     * first, until the cache uses at most the given amount of memory. This is typically used in
+     * response to memory-pressure events. Textures in use by the current frame are not affected.
+     *
+     * @param size maximum size in bytes of the cache, 0 frees all cached textures
+     * @see Config::resourceAllocatorCacheSizeMB
+     */
+    void trimResourceCache(size_t size = 0) noexcept;
+
+    /**
+     * Returns statistics about the cache of transient textures, which can be used to tune
+     * Config::resourceAllocatorCacheSizeMB.
+     *
+     * @return a ResourceCacheStatistics structure
+     */
+    ResourceCacheStatistics getResourceCacheStatistics() const noexcept;
+
+    /**
+     * Returns statistics about the backend's handle allocator: the number of live handles and
+     * the capacity of each of its pools, and how many handles had to be allocated through the
+     * slower heap path. This can be used to tune Config::driverHandleArenaSizeMB.
+     *
+     * @return a HandleAllocatorStatistics structure, all zeros with the NOOP backend
+     */
+    HandleAllocatorStatistics getHandleAllocatorStatistics() const noexcept;
+
     /**
      * @return EntityManager used by filament
      */
@@ -150,6 +150,12 @@ public:
          */
         static constexpr uint8_t DEFAULT_CHANNEL = 2u;
 
+        /**
+         * Maximum number of levels of detail of a renderable
+         * @see Builder::levelOfDetail()
+         */
+        static constexpr uint8_t MAX_LEVEL_COUNT = 8u;
+
         /**
          * Creates a builder for renderable components.
          *
@@ -205,6 +211,34 @@ public:
          */
         Builder& material(size_t index, MaterialInstance const* materialInstance) noexcept;
 
+        /**
+         * Declares a level of detail (LOD) of the renderable.
+         *
+         * The primitives given to the Builder are split into consecutive ranges, one per level,
+         * from the most detailed (level 0) to the coarsest. Level 0 always starts at primitive 0,
+         * each other level starts at \p firstPrimitive and ends where the next level starts, or
+         * at the last primitive. Only the primitives of a single level are drawn each frame.
+         *
+         * The level is selected by each View from the renderable's projected size, that is the
+         * diameter of its bounding sphere divided by the height of the viewport: a level is used
+         * when this size is smaller than its \p screenSize. Some hysteresis is applied to avoid
+         * switching back and forth between two levels, and View::setLodBias() can be used to
+         * favor finer or coarser levels. Shadows use the level selected for the View's camera.
+         *
+         * By default, renderables have a single level.
+         *
+         * @param level the level to declare, between 1 and MAX_LEVEL_COUNT - 1. Levels must be
+         *              declared in increasing order, without gaps.
+         * @param firstPrimitive index of the first primitive of this level, must be greater than
+         *              the first primitive of the previous level and less than the count passed to
+         *              the Builder constructor
+         * @param screenSize projected size below which this level is used, must be smaller than
+         *              the \p screenSize of the previous level
+         *
+         * @see View::setLodBias()
+         */
+        Builder& levelOfDetail(uint8_t level, size_t firstPrimitive, float screenSize) noexcept;
+
         /**
          * The axis-aligned bounding box of the renderable.
          *
@@ -317,6 +351,26 @@ public:
          */
         Builder& screenSpaceContactShadows(bool enable) noexcept;
 
+        /**
+         * Marks this renderable as a static shadow caster, false by default.
+         *
+         * Static shadow casters are rendered once into a cached shadow map of the spot and point
+         * lights they are visible from, and that cache is reused in the following frames.
+         * Only the other shadow casters are then rendered each frame.
+         *
+         * The cache of a light is updated when the light or its shadow map moves, when a static
+         * shadow caster it contains is moved, added or removed, and when the geometry, material
+         * instances, bones or morph weights of such a caster are changed through this API or its
+         * material instances are modified. Changing the content of its vertex, index, morph
+         * target or skinning buffers directly is not detected, call setStaticShadowCaster()
+         * again after doing so. Renderables that deform every frame should not be static
+         * shadow casters, their cache would be updated every frame.
+         *
+         * Static shadow caching is not used with the directional light, whose shadow maps
+         * follow the camera, nor with ShadowType::VSM.
+         */
+        Builder& staticShadowCaster(bool enable) noexcept;
+
         /**
          * Allows bones to be swapped out and shared using SkinningBuffer.
          *
@@ -455,8 +509,9 @@ public:
          *    count.
          * 2. The vertex count of each morph target must equal the geometry's vertex count.
          *
-         * @param level the level of detail (lod), only 0 can be specified
-         * @param primitiveIndex zero-based index of the primitive, must be less than the count passed to Builder constructor
+         * @param level the level of detail (lod), see levelOfDetail(), which must be called first
+         *              when \p level is not 0
+         * @param primitiveIndex zero-based index of the primitive within \p level
          * @param morphTargetBuffer specifies the morph target buffer
          * @param offset specifies where in the morph target buffer to start reading (expressed as a number of vertices)
          * @param count number of vertices in the morph target buffer to read, must equal the geometry's count (for triangles, this should be a multiple of 3)
@@ -670,6 +725,13 @@ public:
      */
     void setScreenSpaceContactShadows(Instance instance, bool enable) noexcept;
 
+    /**
+     * Changes whether or not the renderable is a static shadow caster.
+     *
+     * \see Builder::staticShadowCaster()
+     */
+    void setStaticShadowCaster(Instance instance, bool enable) noexcept;
+
     /**
      * Checks if the renderable can cast shadows.
      *
@@ -684,6 +746,13 @@ public:
      */
     bool isShadowReceiver(Instance instance) const noexcept;
 
+    /**
+     * Checks if the renderable is a static shadow caster.
+     *
+     * \see Builder::staticShadowCaster().
+     */
+    bool isStaticShadowCaster(Instance instance) const noexcept;
+
     /**
      * Updates the bone transforms in the range [offset, offset + boneCount).
      * The bones must be pre-allocated using Builder::skinning().
@@ -721,6 +790,10 @@ public:
 
     /**
      * Associates a MorphTargetBuffer to the given primitive.
+     *
+     * \p primitiveIndex is the index of the primitive within the level of detail \p level.
+     *
+     * \see Builder::levelOfDetail()
      */
     void setMorphTargetBufferAt(Instance instance, uint8_t level, size_t primitiveIndex,
             MorphTargetBuffer* morphTargetBuffer, size_t offset, size_t count);
@@ -759,10 +832,50 @@ public:
     uint8_t getLayerMask(Instance instance) const noexcept;
 
     /**
-     * Gets the immutable number of primitives in the given renderable.
+     * Gets the coarse-level draw ordering.
+     *
+     * \see Builder::priority()
+     * \see RenderableManager::setPriority()
+     */
+    uint8_t getPriority(Instance instance) const noexcept;
+
+    /**
+     * Gets the channel the renderable is associated to.
+     *
+     * \see Builder::channel()
+     * \see RenderableManager::setChannel()
+     */
+    uint8_t getChannel(Instance instance) const noexcept;
+
+    /**
+     * Checks if frustum culling is enabled for the renderable.
+     *
+     * \see Builder::culling()
+     * \see RenderableManager::setCulling()
+     */
+    bool isCullingEnabled(Instance instance) const noexcept;
+
+    /**
+     * Checks if the renderable can use screen-space contact shadows.
+     *
+     * \see Builder::screenSpaceContactShadows()
+     * \see RenderableManager::setScreenSpaceContactShadows()
+     */
+    bool isScreenSpaceContactShadowsEnabled(Instance instance) const noexcept;
+
+    /**
+     * Gets the immutable number of primitives in the given renderable, across all its levels of
+     * detail. Unless stated otherwise, primitive indices are the ones passed to the Builder.
      */
     size_t getPrimitiveCount(Instance instance) const noexcept;
 
+    /**
+     * Gets the immutable number of levels of detail of the given renderable.
+     *
+     * \see Builder::levelOfDetail()
+     */
+    size_t getLevelCount(Instance instance) const noexcept;
+
     /**
      * Changes the material instance binding for the given primitive.
      *
@@ -460,6 +460,20 @@ public:
      */
     void generateMipmaps(Engine& engine) const noexcept;
 
+    /**
+     * Restricts the range of levels that can be sampled, for instance while the finest levels
+     * of a texture are being streamed in. By default all levels can be sampled.
+     *
+     * @param engine        Engine this texture is associated to.
+     * @param minLevel      Finest level that can be sampled.
+     * @param maxLevel      Coarsest level that can be sampled.
+     *
+     * @attention \p engine must be the instance passed to Builder::build()
+     * @attention \p minLevel must be less than or equal to \p maxLevel, which must be less
+     *            than getLevels().
+     */
+    void setMinMaxLevels(Engine& engine, uint8_t minLevel, uint8_t maxLevel) const;
+
     /**
      * Creates a reflection map from an environment map.
      *
@@ -254,6 +254,27 @@ public:
      */
     uint8_t getVisibleLayers() const noexcept;
 
+    /**
+     * Sets the bias applied to the selection of the renderables' levels of detail.
+     *
+     * The projected size of renderables is divided by 2^bias before selecting their level of
+     * detail, so that positive values select coarser levels sooner, and negative values select
+     * finer levels for longer. This can be used, for instance, to trade detail for performance
+     * or to match a lower rendering resolution. The default is 0.
+     *
+     * @param bias the level of detail bias
+     *
+     * @see RenderableManager::Builder::levelOfDetail()
+     */
+    void setLodBias(float bias) noexcept;
+
+    /**
+     * @return the level of detail bias
+     *
+     * @see View::setLodBias()
+     */
+    float getLodBias() const noexcept;
+
     /**
      * Enables or disables shadow mapping. Enabled by default.
      *
@@ -339,6 +339,18 @@ size_t Engine::getMaxStereoscopicEyes() noexcept {
     return FEngine::getMaxStereoscopicEyes();
 }
 
+void Engine::trimResourceCache(size_t size) noexcept {
+    downcast(this)->trimResourceCache(size);
+}
+
+Engine::ResourceCacheStatistics Engine::getResourceCacheStatistics() const noexcept {
+    return downcast(this)->getResourceCacheStatistics();
+}
+
+Engine::HandleAllocatorStatistics Engine::getHandleAllocatorStatistics() const noexcept {
+    return downcast(this)->getHandleAllocatorStatistics();
+}
+
 #if defined(__EMSCRIPTEN__)
 void Engine::resetBackendState() noexcept {
     downcast(this)->resetBackendState();
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FrameAllocator.h"
+
+#include <utils/memalign.h>
+#include <utils/Panic.h>
+
+#include <algorithm>
+
+#include <stdlib.h>
+
+using namespace utils;
+
+namespace filament {
+
+FrameAllocator::FrameAllocator(JobSystem& js, size_t areaSize) noexcept
+        : mJobSystem(js),
+          mAreas(new Area[js.getMaxThreadCount()]),
+          mAreaCount(js.getMaxThreadCount()) {
+    for (size_t i = 0; i < mAreaCount; i++) {
+        Area& area = mAreas[i];
+        area.begin = static_cast<char*>(utils::aligned_alloc(areaSize, CACHELINE_SIZE));
+        area.current = area.begin;
+        area.end = area.begin + areaSize;
+    }
+    mStatistics.capacity = areaSize * mAreaCount;
+    mStatistics.heapAllocationCount = uint32_t(mAreaCount);
+}
+
+FrameAllocator::~FrameAllocator() noexcept {
+    reset();
+    for (size_t i = 0; i < mAreaCount; i++) {
+        aligned_free(mAreas[i].begin);
+    }
+}
+
+void* FrameAllocator::allocSlow(Area& area, size_t size, size_t alignment) noexcept {
+    // The area is exhausted, the allocation goes to the heap until the next reset(). The
+    // block starts with the link to the previous overflow block.
+    size_t const blockSize = sizeof(void*) + alignment + size;
+    void** const block = static_cast<void**>(::malloc(blockSize));
+    ASSERT_POSTCONDITION(block, "FrameAllocator: out of memory (%zu bytes)", blockSize);
+    block[0] = area.heapBlocks;
+    area.heapBlocks = block;
+    area.heapSize += size + alignment;
+    area.heapCount++;
+    return pointermath::align(reinterpret_cast<char*>(block + 1), alignment);
+}
+
+void FrameAllocator::reset() noexcept {
+    size_t frameSize = 0;
+    size_t capacity = 0;
+    uint32_t frameHeapAllocationCount = 0;
+    for (size_t i = 0; i < mAreaCount; i++) {
+        Area& area = mAreas[i];
+        size_t const used = size_t(area.current - area.begin) + area.heapSize;
+        frameSize += used;
+        frameHeapAllocationCount += area.heapCount;
+
+        for (void* block = area.heapBlocks; block;) {
+            void* const next = *static_cast<void**>(block);
+            ::free(block);
+            block = next;
+        }
+
+        // grow this area so that its thread doesn't overflow the next frames, the other areas
+        // are sized from their own thread's usage.
+        size_t size = size_t(area.end - area.begin);
+        if (UTILS_UNLIKELY(area.heapSize)) {
+            while (size < used) {
+                size *= 2;
+            }
+            aligned_free(area.begin);
+            area.begin = static_cast<char*>(utils::aligned_alloc(size, CACHELINE_SIZE));
+            area.end = area.begin + size;
+            mStatistics.heapAllocationCount++;
+        }
+        capacity += size;
+
+        area.current = area.begin;
+        area.heapBlocks = nullptr;
+        area.heapSize = 0;
+        area.heapCount = 0;
+    }
+
+    mStatistics.capacity = capacity;
+    mStatistics.highWatermark = std::max(mStatistics.highWatermark, frameSize);
+    mStatistics.heapAllocationCount += frameHeapAllocationCount;
+    mStatistics.frameHeapAllocationCount = frameHeapAllocationCount;
+}
+
+} // namespace filament
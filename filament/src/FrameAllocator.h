@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_FRAMEALLOCATOR_H
+#define TNT_FILAMENT_FRAMEALLOCATOR_H
+
+#include <utils/Allocator.h>
+#include <utils/architecture.h>
+#include <utils/JobSystem.h>
+#include <utils/compiler.h>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+/*
+ * A linear allocator for memory that only lives until the end of the current frame.
+ *
+ * Each thread of the JobSystem allocates from its own area, without synchronization, so that
+ * jobs can allocate temporary memory. All the memory is reclaimed at once by reset(), which
+ * must be called when no job is using it, typically at the end of the frame.
+ *
+ * When an area is exhausted, allocations fall back to the heap and that area grows to fit its
+ * thread's usage at the next reset(). Each area ends up sized for the largest usage of its own
+ * thread, so that steady-state frames don't allocate from the heap. Destructors are never called.
+ */
+class FrameAllocator {
+public:
+    static constexpr size_t DEFAULT_AREA_SIZE = 64 * 1024;
+
+    struct Statistics {
+        size_t capacity;                    // size of all areas, in bytes
+        size_t highWatermark;               // largest frame usage, in bytes
+        uint32_t heapAllocationCount;       // heap allocations since creation
+        uint32_t frameHeapAllocationCount;  // heap allocations during the last frame
+    };
+
+    explicit FrameAllocator(utils::JobSystem& js, size_t areaSize = DEFAULT_AREA_SIZE) noexcept;
+    ~FrameAllocator() noexcept;
+
+    FrameAllocator(FrameAllocator const& rhs) = delete;
+    FrameAllocator& operator=(FrameAllocator const& rhs) = delete;
+
+    // The calling thread must belong to the JobSystem, see JobSystem::adopt().
+    void* alloc(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept {
+        Area& area = mAreas[mJobSystem.getThreadIndex()];
+        char* const p = utils::pointermath::align(area.current, alignment);
+        if (UTILS_LIKELY(p + size <= area.end)) {
+            area.current = p + size;
+            return p;
+        }
+        return allocSlow(area, size, alignment);
+    }
+
+    template<typename T>
+    T* alloc(size_t count, size_t alignment = alignof(T)) noexcept {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return static_cast<T*>(alloc(count * sizeof(T), alignment));
+    }
+
+    template<typename T, typename ... ARGS>
+    T* make(ARGS&& ... args) noexcept {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return new(alloc(sizeof(T), alignof(T))) T(std::forward<ARGS>(args)...);
+    }
+
+    // Frees all allocations made since the last call. Not thread-safe.
+    void reset() noexcept;
+
+    Statistics getStatistics() const noexcept { return mStatistics; }
+
+private:
+    struct alignas(utils::CACHELINE_SIZE) Area {
+        char* begin = nullptr;
+        char* current = nullptr;
+        char* end = nullptr;
+        void* heapBlocks = nullptr;     // singly linked list of overflow allocations
+        size_t heapSize = 0;            // bytes allocated from the heap this frame
+        uint32_t heapCount = 0;         // heap allocations this frame
+    };
+
+    UTILS_NOINLINE
+    void* allocSlow(Area& area, size_t size, size_t alignment) noexcept;
+
+    utils::JobSystem& mJobSystem;
+    std::unique_ptr<Area[]> mAreas;
+    size_t const mAreaCount;
+    Statistics mStatistics{};
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_FRAMEALLOCATOR_H
@@ -73,6 +73,14 @@ constexpr static float halton(unsigned int i, unsigned int b) noexcept {
     return r;
 }
 
+// blends the output of a pass into its destination, with premultiplied alpha
+static void enableTranslucentBlending(PipelineState& pipeline) noexcept {
+    pipeline.rasterState.blendFunctionSrcRGB = BlendFunction::ONE;
+    pipeline.rasterState.blendFunctionSrcAlpha = BlendFunction::ONE;
+    pipeline.rasterState.blendFunctionDstRGB = BlendFunction::ONE_MINUS_SRC_ALPHA;
+    pipeline.rasterState.blendFunctionDstAlpha = BlendFunction::ONE_MINUS_SRC_ALPHA;
+}
+
 // ------------------------------------------------------------------------------------------------
 
 PostProcessManager::PostProcessMaterial::PostProcessMaterial() noexcept {
@@ -2321,8 +2329,13 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::colorGrading(FrameGraph& fg,
         FColorGrading const* colorGrading,
         ColorGradingConfig const& colorGradingConfig,
         BloomOptions const& bloomOptions,
-        VignetteOptions const& vignetteOptions) noexcept
+        VignetteOptions const& vignetteOptions,
+        CompositingConfig const& compositingConfig) noexcept
 {
+    uint32_t const outWidth = compositingConfig.width ? compositingConfig.width : vp.width;
+    uint32_t const outHeight = compositingConfig.height ? compositingConfig.height : vp.height;
+    bool const upscaling = outWidth != vp.width || outHeight != vp.height;
+
     FrameGraphId<FrameGraphTexture> bloomDirt;
     FrameGraphId<FrameGraphTexture> starburst;
 
@@ -2360,8 +2373,8 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::colorGrading(FrameGraph& fg,
             [&](FrameGraph::Builder& builder, auto& data) {
                 data.input = builder.sample(input);
                 data.output = builder.createTexture("colorGrading output", {
-                        .width = vp.width,
-                        .height = vp.height,
+                        .width = outWidth,
+                        .height = outHeight,
                         .format = colorGradingConfig.ldrFormat
                 });
                 data.output = builder.declareRenderPass(data.output);
@@ -2407,7 +2420,16 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::colorGrading(FrameGraph& fg,
                 mi->setParameter("lutSize", float2{
                         0.5f / lutDimension, (lutDimension - 1.0f) / lutDimension,
                 });
-                mi->setParameter("colorBuffer", colorTexture, { /* shader uses texelFetch */ });
+                if (upscaling) {
+                    // the final upscaling is merged into this pass, filter the color buffer
+                    mi->setParameter("colorBuffer", colorTexture, {
+                            .filterMag = SamplerMagFilter::LINEAR,
+                            .filterMin = SamplerMinFilter::LINEAR
+                    });
+                } else {
+                    // 1:1 mapping, the shader samples the color buffer at texel centers
+                    mi->setParameter("colorBuffer", colorTexture, {});
+                }
                 mi->setParameter("bloomBuffer", bloomTexture, {
                         .filterMag = SamplerMagFilter::LINEAR,
                         .filterMin = SamplerMinFilter::LINEAR /* always read base level in shader */
@@ -2461,7 +2483,13 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::colorGrading(FrameGraph& fg,
                 const uint8_t variant = uint8_t(colorGradingConfig.translucent ?
                             PostProcessVariant::TRANSLUCENT : PostProcessVariant::OPAQUE);
 
-                commitAndRender(out, material, variant, driver);
+                mi->commit(driver);
+                mi->use(driver);
+                PipelineState pipeline(material.getPipelineState(mEngine, variant));
+                if (compositingConfig.blend) {
+                    enableTranslucentBlending(pipeline);
+                }
+                render(out, pipeline, driver);
             }
     );
 
@@ -2470,13 +2498,19 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::colorGrading(FrameGraph& fg,
 
 FrameGraphId<FrameGraphTexture> PostProcessManager::fxaa(FrameGraph& fg,
         FrameGraphId<FrameGraphTexture> input, filament::Viewport const& vp,
-        TextureFormat outFormat, bool translucent) noexcept {
+        TextureFormat outFormat, bool translucent,
+        CompositingConfig const& compositingConfig) noexcept {
 
     struct PostProcessFXAA {
         FrameGraphId<FrameGraphTexture> input;
         FrameGraphId<FrameGraphTexture> output;
     };
 
+    // FXAA's texelSize is the footprint of an output fragment, so it can blend into the
+    // destination but can't upscale.
+    assert_invariant(!compositingConfig.width ||
+            (compositingConfig.width == vp.width && compositingConfig.height == vp.height));
+
     auto& ppFXAA = fg.addPass<PostProcessFXAA>("fxaa",
             [&](FrameGraph::Builder& builder, auto& data) {
                 data.input = builder.sample(input);
@@ -2509,7 +2543,13 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::fxaa(FrameGraph& fg,
                 const uint8_t variant = uint8_t(translucent ?
                     PostProcessVariant::TRANSLUCENT : PostProcessVariant::OPAQUE);
 
-                commitAndRender(out, material, variant, driver);
+                mi->commit(driver);
+                mi->use(driver);
+                PipelineState pipeline(material.getPipelineState(mEngine, variant));
+                if (compositingConfig.blend) {
+                    enableTranslucentBlending(pipeline);
+                }
+                render(out, pipeline, driver);
             });
 
     return ppFXAA->output;
@@ -2814,14 +2854,6 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::upscale(FrameGraph& fg, bool
                             float2{ inputDesc.width, inputDesc.height });
                 };
 
-                // helper to enable blending
-                auto enableTranslucentBlending = [](PipelineState& pipeline) {
-                    pipeline.rasterState.blendFunctionSrcRGB = BlendFunction::ONE;
-                    pipeline.rasterState.blendFunctionSrcAlpha = BlendFunction::ONE;
-                    pipeline.rasterState.blendFunctionDstRGB = BlendFunction::ONE_MINUS_SRC_ALPHA;
-                    pipeline.rasterState.blendFunctionDstAlpha = BlendFunction::ONE_MINUS_SRC_ALPHA;
-                };
-
                 auto color = resources.getTexture(data.input);
                 auto const& inputDesc = resources.getDescriptor(data.input);
                 auto const& outputDesc = resources.getDescriptor(data.output);
@@ -3001,10 +3033,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::blit(FrameGraph& fg, bool tr
 
                 PipelineState pipeline(material.getPipelineState(mEngine));
                 if (translucent) {
-                    pipeline.rasterState.blendFunctionSrcRGB = BlendFunction::ONE;
-                    pipeline.rasterState.blendFunctionSrcAlpha = BlendFunction::ONE;
-                    pipeline.rasterState.blendFunctionDstRGB = BlendFunction::ONE_MINUS_SRC_ALPHA;
-                    pipeline.rasterState.blendFunctionDstAlpha = BlendFunction::ONE_MINUS_SRC_ALPHA;
+                    enableTranslucentBlending(pipeline);
                 }
                 render(out, pipeline, driver);
             });
@@ -75,6 +75,14 @@ public:
         backend::TextureFormat ldrFormat{};
     };
 
+    // Final compositing (bilinear upscaling and/or blending into the destination) performed by
+    // the last full-screen pass of the chain, instead of a separate upscale or blit pass.
+    struct CompositingConfig {
+        uint32_t width{};       // output size, 0 to use the size of the input viewport
+        uint32_t height{};
+        bool blend{};           // blend the output into the destination (premultiplied alpha)
+    };
+
     struct StructurePassConfig {
         float scale = 0.5f;
         bool picking{};
@@ -188,7 +196,8 @@ public:
             const FColorGrading* colorGrading,
             ColorGradingConfig const& colorGradingConfig,
             BloomOptions const& bloomOptions,
-            VignetteOptions const& vignetteOptions) noexcept;
+            VignetteOptions const& vignetteOptions,
+            CompositingConfig const& compositingConfig) noexcept;
 
     void colorGradingPrepareSubpass(backend::DriverApi& driver, const FColorGrading* colorGrading,
             ColorGradingConfig const& colorGradingConfig,
@@ -208,7 +217,8 @@ public:
     // Anti-aliasing
     FrameGraphId<FrameGraphTexture> fxaa(FrameGraph& fg,
             FrameGraphId<FrameGraphTexture> input, filament::Viewport const& vp,
-            backend::TextureFormat outFormat, bool translucent) noexcept;
+            backend::TextureFormat outFormat, bool translucent,
+            CompositingConfig const& compositingConfig) noexcept;
 
     // Temporal Anti-aliasing
     void prepareTaa(FrameGraph& fg,
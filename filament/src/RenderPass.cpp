@@ -30,6 +30,8 @@
 
 #include <utility>
 
+#include <string.h>
+
 using namespace utils;
 using namespace filament::math;
 
@@ -257,11 +259,10 @@ void RenderPass::instanceify(FEngine& engine) noexcept {
 
             // allocate our staging buffer only if needed
             if (UTILS_UNLIKELY(!stagingBuffer)) {
-                // TODO: use stream inline buffer for small sizes
-                // TODO: use a pool for larger heap buffers
-                // buffer large enough for all instances data
+                // buffer large enough for all instances data, it only lives until the upload
+                // below, so it comes from the per-frame allocator.
                 stagingBufferSize = sizeof(PerRenderableData) * (last - curr);
-                stagingBuffer = (PerRenderableData*)::malloc(stagingBufferSize);
+                stagingBuffer = engine.getFrameAllocator().alloc<PerRenderableData>(last - curr);
                 uboData = mRenderableSoa->data<FScene::UBO>();
             }
 
@@ -300,13 +301,26 @@ void RenderPass::instanceify(FEngine& engine) noexcept {
                 sizeof(PerRenderableData) * instancedPrimitiveOffset + sizeof(PerRenderableUib),
                 BufferObjectBinding::UNIFORM, backend::BufferUsage::STATIC);
 
-        // copy our instanced ubo data
-        driver.updateBufferObjectUnsynchronized(mInstancedUboHandle, {
-                stagingBuffer, sizeof(PerRenderableData) * instancedPrimitiveOffset,
-                +[](void* buffer, size_t, void*) {
-                    ::free(buffer);
-                }
-        }, 0);
+        // copy our instanced ubo data, directly into the command stream if it's small enough,
+        // or into a pooled buffer otherwise (like FScene::updateUBOs()), so that steady-state
+        // frames don't need a heap allocation.
+        static constexpr size_t MAX_STREAM_ALLOCATION_SIZE = 16 * 1024;
+        size_t const size = sizeof(PerRenderableData) * instancedPrimitiveOffset;
+        if (size <= MAX_STREAM_ALLOCATION_SIZE) {
+            void* const buffer = driver.allocate(size, alignof(PerRenderableData));
+            memcpy(buffer, stagingBuffer, size);
+            driver.updateBufferObjectUnsynchronized(mInstancedUboHandle, { buffer, size }, 0);
+        } else {
+            auto& pool = engine.getInstancedUboPool();
+            void* const buffer = pool.get(uint32_t(size));
+            memcpy(buffer, stagingBuffer, size);
+            driver.updateBufferObjectUnsynchronized(mInstancedUboHandle, {
+                    buffer, size,
+                    +[](void* buffer, size_t, void* user) {
+                        static_cast<BufferPoolAllocator<3>*>(user)->put(buffer);
+                    }, &pool
+            }, 0);
+        }
 
         stagingBuffer = nullptr;
 
@@ -88,6 +88,10 @@ void RenderableManager::setScreenSpaceContactShadows(Instance instance, bool ena
     downcast(this)->setScreenSpaceContactShadows(instance, enable);
 }
 
+void RenderableManager::setStaticShadowCaster(Instance instance, bool enable) noexcept {
+    downcast(this)->setStaticShadowCaster(instance, enable);
+}
+
 bool RenderableManager::isShadowCaster(Instance instance) const noexcept {
     return downcast(this)->isShadowCaster(instance);
 }
@@ -96,6 +100,26 @@ bool RenderableManager::isShadowReceiver(Instance instance) const noexcept {
     return downcast(this)->isShadowReceiver(instance);
 }
 
+bool RenderableManager::isStaticShadowCaster(Instance instance) const noexcept {
+    return downcast(this)->isStaticShadowCaster(instance);
+}
+
+bool RenderableManager::isScreenSpaceContactShadowsEnabled(Instance instance) const noexcept {
+    return downcast(this)->isScreenSpaceContactShadowsEnabled(instance);
+}
+
+bool RenderableManager::isCullingEnabled(Instance instance) const noexcept {
+    return downcast(this)->isCullingEnabled(instance);
+}
+
+uint8_t RenderableManager::getPriority(Instance instance) const noexcept {
+    return downcast(this)->getPriority(instance);
+}
+
+uint8_t RenderableManager::getChannel(Instance instance) const noexcept {
+    return downcast(this)->getChannel(instance);
+}
+
 const Box& RenderableManager::getAxisAlignedBoundingBox(Instance instance) const noexcept {
     return downcast(this)->getAxisAlignedBoundingBox(instance);
 }
@@ -105,36 +129,40 @@ uint8_t RenderableManager::getLayerMask(Instance instance) const noexcept {
 }
 
 size_t RenderableManager::getPrimitiveCount(Instance instance) const noexcept {
-    return downcast(this)->getPrimitiveCount(instance, 0);
+    return downcast(this)->getPrimitiveCount(instance);
+}
+
+size_t RenderableManager::getLevelCount(Instance instance) const noexcept {
+    return downcast(this)->getLevelCount(instance);
 }
 
 void RenderableManager::setMaterialInstanceAt(Instance instance,
         size_t primitiveIndex, MaterialInstance const* materialInstance) {
-    downcast(this)->setMaterialInstanceAt(instance, 0, primitiveIndex, downcast(materialInstance));
+    downcast(this)->setMaterialInstanceAt(instance, primitiveIndex, downcast(materialInstance));
 }
 
 MaterialInstance* RenderableManager::getMaterialInstanceAt(
         Instance instance, size_t primitiveIndex) const noexcept {
-    return downcast(this)->getMaterialInstanceAt(instance, 0, primitiveIndex);
+    return downcast(this)->getMaterialInstanceAt(instance, primitiveIndex);
 }
 
 void RenderableManager::setBlendOrderAt(Instance instance, size_t primitiveIndex, uint16_t order) noexcept {
-    downcast(this)->setBlendOrderAt(instance, 0, primitiveIndex, order);
+    downcast(this)->setBlendOrderAt(instance, primitiveIndex, order);
 }
 
 void RenderableManager::setGlobalBlendOrderEnabledAt(RenderableManager::Instance instance,
         size_t primitiveIndex, bool enabled) noexcept {
-    downcast(this)->setGlobalBlendOrderEnabledAt(instance, 0, primitiveIndex, enabled);
+    downcast(this)->setGlobalBlendOrderEnabledAt(instance, primitiveIndex, enabled);
 }
 
 AttributeBitset RenderableManager::getEnabledAttributesAt(Instance instance, size_t primitiveIndex) const noexcept {
-    return downcast(this)->getEnabledAttributesAt(instance, 0, primitiveIndex);
+    return downcast(this)->getEnabledAttributesAt(instance, primitiveIndex);
 }
 
 void RenderableManager::setGeometryAt(Instance instance, size_t primitiveIndex,
         PrimitiveType type, VertexBuffer* vertices, IndexBuffer* indices,
         size_t offset, size_t count) noexcept {
-    downcast(this)->setGeometryAt(instance, 0, primitiveIndex,
+    downcast(this)->setGeometryAt(instance, primitiveIndex,
             type, downcast(vertices), downcast(indices), offset, count);
 }
 
@@ -20,10 +20,10 @@
 
 #include "details/Texture.h"
 
-#include <utils/FixedCapacityVector.h>
 #include <utils/Log.h>
 #include <utils/debug.h>
 
+#include <algorithm>
 #include <iterator>
 
 using namespace utils;
@@ -94,21 +94,60 @@ size_t ResourceAllocator::TextureKey::getSize() const noexcept {
     return size;
 }
 
-ResourceAllocator::ResourceAllocator(DriverApi& driverApi) noexcept
-        : mBackend(driverApi) {
+void ResourceAllocator::LruList::push_back(CacheEntry* entry) noexcept {
+    entry->prev = mTail;
+    entry->next = nullptr;
+    if (mTail) {
+        mTail->next = entry;
+    } else {
+        mHead = entry;
+    }
+    mTail = entry;
+    mSize++;
+}
+
+void ResourceAllocator::LruList::remove(CacheEntry* entry) noexcept {
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        mHead = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        mTail = entry->prev;
+    }
+    entry->prev = nullptr;
+    entry->next = nullptr;
+    mSize--;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+ResourceAllocator::ResourceAllocator(DriverApi& driverApi,
+        size_t cacheCapacity, size_t cacheMaxAge) noexcept
+        : mBackend(driverApi),
+          mCacheCapacity(cacheCapacity),
+          mCacheMaxAge(cacheMaxAge) {
 }
 
 ResourceAllocator::~ResourceAllocator() noexcept {
-    assert_invariant(!mTextureCache.size());
+    assert_invariant(mTextureCache.empty());
     assert_invariant(!mInUseTextures.size());
+    while (mFreeEntries) {
+        CacheEntry* const entry = mFreeEntries;
+        mFreeEntries = entry->next;
+        delete entry;
+    }
 }
 
 void ResourceAllocator::terminate() noexcept {
     assert_invariant(!mInUseTextures.size());
-    auto& textureCache = mTextureCache;
-    for (auto it = textureCache.begin(); it != textureCache.end();) {
-        mBackend.destroyTexture(it->second.handle);
-        it = textureCache.erase(it);
+    while (!mTextureCache.empty()) {
+        CacheEntry* const entry = mTextureCache.front();
+        mBackend.destroyTexture(entry->payload.handle);
+        removeFromCache(entry);
+        releaseEntry(entry);
     }
 }
 
@@ -140,14 +179,16 @@ backend::TextureHandle ResourceAllocator::createTexture(const char* name,
     // do we have a suitable texture in the cache?
     TextureHandle handle;
     if constexpr (mEnabled) {
-        auto& textureCache = mTextureCache;
-        const TextureKey key{ name, target, levels, format, samples, width, height, depth, usage, swizzle };
-        auto it = textureCache.find(key);
-        if (UTILS_LIKELY(it != textureCache.end())) {
+        TextureKey key{ name, target, levels, format, samples, width, height, depth, usage, swizzle };
+        CacheEntry* const entry = findCompatible(key);
+        if (UTILS_LIKELY(entry)) {
             // we do, move the entry to the in-use list, and remove from the cache
-            handle = it->second.handle;
-            mCacheSize -= it->second.size;
-            textureCache.erase(it);
+            // (keep track of the actual usage, so it goes back in the cache unchanged)
+            key.usage = entry->key.usage;
+            handle = entry->payload.handle;
+            removeFromCache(entry);
+            releaseEntry(entry);
+            mHitCount++;
         } else {
             // we don't, allocate a new texture and populate the in-use list
             if (swizzle == defaultSwizzle) {
@@ -158,6 +199,7 @@ backend::TextureHandle ResourceAllocator::createTexture(const char* name,
                         target, levels, format, samples, width, height, depth, usage,
                         swizzle[0], swizzle[1], swizzle[2], swizzle[3]);
             }
+            mMissCount++;
         }
         mInUseTextures.emplace(handle, key);
     } else {
@@ -179,12 +221,11 @@ void ResourceAllocator::destroyTexture(TextureHandle h) noexcept {
         auto it = mInUseTextures.find(h);
         assert_invariant(it != mInUseTextures.end());
 
-        // move it to the cache
-        const TextureKey key = it->second;
-        uint32_t size = key.getSize();
-
-        mTextureCache.emplace(key, TextureCachePayload{ h, mAge, size });
-        mCacheSize += size;
+        // move it to the cache, as the most recently used entry
+        CacheEntry* const entry = allocateEntry();
+        entry->key = it->second;
+        entry->payload = TextureCachePayload{ h, mAge, uint32_t(entry->key.getSize()) };
+        addToCache(entry);
 
         // remove it from the in-use list
         mInUseTextures.erase(it);
@@ -201,75 +242,143 @@ void ResourceAllocator::gc() noexcept {
 
     // Purging strategy:
     //  - remove entries that are older than a certain age
-    //      - remove only one entry per gc(),
-    //      - unless we're at capacity
-    // - remove LRU entries until we're below capacity
+    //      - remove only one entry per gc(), trying to avoid a burst of work
+    //  - remove LRU entries until we're below capacity
+    //
+    // Entries are added to the back of the cache as they're released, so the front is
+    // always the oldest entry; both steps are O(1) per purged entry.
 
     auto& textureCache = mTextureCache;
-    for (auto it = textureCache.begin(); it != textureCache.end();) {
-        const size_t ageDiff = age - it->second.age;
-        if (ageDiff >= CACHE_MAX_AGE) {
-            it = purge(it);
-            if (mCacheSize < CACHE_CAPACITY) {
-                // if we're not at capacity, only purge a single entry per gc, trying to
-                // avoid a burst of work.
-                break;
-            }
-        } else {
-            ++it;
+    if (!textureCache.empty()) {
+        CacheEntry* const oldest = textureCache.front();
+        if (age - oldest->payload.age >= mCacheMaxAge) {
+            purge(oldest);
         }
     }
 
-    if (UTILS_UNLIKELY(mCacheSize >= CACHE_CAPACITY)) {
-        // make a copy of our CacheContainer to a vector
-        using Vector = FixedCapacityVector<std::pair<TextureKey, TextureCachePayload>>;
-        auto cache = Vector::with_capacity(textureCache.size());
-        std::copy(textureCache.begin(), textureCache.end(), std::back_insert_iterator<Vector>(cache));
-
-        // sort by least recently used
-        std::sort(cache.begin(), cache.end(), [](auto const& lhs, auto const& rhs) {
-            return lhs.second.age < rhs.second.age;
-        });
-
-        // now remove entries until we're at capacity
-        auto curr = cache.begin();
-        while (mCacheSize >= CACHE_CAPACITY) {
-            // by construction this entry must exist
-            purge(textureCache.find(curr->first));
-            ++curr;
-        }
+    trim(mCacheCapacity);
 
-        // Since we're sorted already, reset the oldestAge of the whole system
-        size_t oldestAge = cache.front().second.age;
-        for (auto& it : textureCache) {
-            it.second.age -= oldestAge;
-        }
-        mAge -= oldestAge;
-    }
     //if (mAge % 60 == 0) dump();
 }
 
+void ResourceAllocator::trim(size_t size) noexcept {
+    auto& textureCache = mTextureCache;
+    while (mCacheSize > size && !textureCache.empty()) {
+        purge(textureCache.front());
+    }
+}
+
+ResourceAllocator::Statistics ResourceAllocator::getStatistics() const noexcept {
+    return {
+            .hitCount = mHitCount,
+            .missCount = mMissCount,
+            .evictionCount = mEvictionCount,
+            .cacheSize = mCacheSize,
+            .cacheEntryCount = mTextureCache.size()
+    };
+}
+
 UTILS_NOINLINE
 void ResourceAllocator::dump(bool brief) const noexcept {
     slog.d << "# entries=" << mTextureCache.size() << ", sz=" << mCacheSize / float(1u << 20u)
-           << " MiB" << io::endl;
+           << " MiB" << ", hits=" << mHitCount << ", misses=" << mMissCount
+           << ", evictions=" << mEvictionCount << io::endl;
     if (!brief) {
-        for (auto const& it : mTextureCache) {
-            auto w = it.first.width;
-            auto h = it.first.height;
-            auto f = FTexture::getFormatSize(it.first.format);
-            slog.d << it.first.name << ": w=" << w << ", h=" << h << ", f=" << f << ", sz="
-                   << it.second.size / float(1u << 20u) << io::endl;
+        for (CacheEntry const* p = mTextureCache.front(); p; p = p->next) {
+            auto w = p->key.width;
+            auto h = p->key.height;
+            auto f = FTexture::getFormatSize(p->key.format);
+            slog.d << p->key.name << ": w=" << w << ", h=" << h << ", f=" << f << ", sz="
+                   << p->payload.size / float(1u << 20u) << io::endl;
+        }
+    }
+}
+
+ResourceAllocator::CacheEntry* ResourceAllocator::allocateEntry() noexcept {
+    // entries are recycled, so that steady-state frames don't allocate
+    CacheEntry* entry = mFreeEntries;
+    if (UTILS_LIKELY(entry)) {
+        mFreeEntries = entry->next;
+        entry->next = nullptr;
+    } else {
+        entry = new CacheEntry();
+    }
+    return entry;
+}
+
+void ResourceAllocator::releaseEntry(CacheEntry* entry) noexcept {
+    entry->prev = nullptr;
+    entry->next = mFreeEntries;
+    mFreeEntries = entry;
+}
+
+ResourceAllocator::CacheEntry* ResourceAllocator::findCompatible(
+        TextureKey const& key) const noexcept {
+    auto const pos = mTextureCacheIndex.find(key);
+    if (pos == mTextureCacheIndex.end()) {
+        return nullptr;
+    }
+    // Siblings only differ by their usage. We prefer an exact match, but a texture that supports
+    // more usages than requested is just as good, since its lifetime doesn't overlap with ours.
+    CacheEntry* compatible = nullptr;
+    for (CacheEntry* p = pos->second; p; p = p->nextSibling) {
+        if (p->key.usage == key.usage) {
+            return p;
+        }
+        if (!compatible && p->key.isCompatibleWith(key)) {
+            compatible = p;
+        }
+    }
+    return compatible;
+}
+
+void ResourceAllocator::addToCache(CacheEntry* entry) noexcept {
+    mTextureCache.push_back(entry);
+    mCacheSize += entry->payload.size;
+
+    // the most recently used sibling is at the head of the list
+    auto pos = mTextureCacheIndex.find(entry->key);
+    if (pos == mTextureCacheIndex.end()) {
+        entry->prevSibling = nullptr;
+        entry->nextSibling = nullptr;
+        mTextureCacheIndex.insert({ entry->key, entry });
+    } else {
+        CacheEntry* const head = pos->second;
+        head->prevSibling = entry;
+        entry->prevSibling = nullptr;
+        entry->nextSibling = head;
+        pos.value() = entry;
+    }
+}
+
+void ResourceAllocator::removeFromCache(CacheEntry* entry) noexcept {
+    mTextureCache.remove(entry);
+    mCacheSize -= entry->payload.size;
+
+    if (entry->nextSibling) {
+        entry->nextSibling->prevSibling = entry->prevSibling;
+    }
+    if (entry->prevSibling) {
+        entry->prevSibling->nextSibling = entry->nextSibling;
+    } else {
+        auto pos = mTextureCacheIndex.find(entry->key);
+        assert_invariant(pos != mTextureCacheIndex.end() && pos->second == entry);
+        if (entry->nextSibling) {
+            pos.value() = entry->nextSibling;
+        } else {
+            mTextureCacheIndex.erase(pos);
         }
     }
+    entry->prevSibling = nullptr;
+    entry->nextSibling = nullptr;
 }
 
-ResourceAllocator::CacheContainer::iterator ResourceAllocator::purge(
-        ResourceAllocator::CacheContainer::iterator const& pos) {
-    //slog.d << "purging " << pos->second.handle.getId() << ", age=" << pos->second.age << io::endl;
-    mBackend.destroyTexture(pos->second.handle);
-    mCacheSize -= pos->second.size;
-    return mTextureCache.erase(pos);
+void ResourceAllocator::purge(CacheEntry* entry) noexcept {
+    //slog.d << "purging " << entry->payload.handle.getId() << ", age=" << entry->payload.age << io::endl;
+    mBackend.destroyTexture(entry->payload.handle);
+    mEvictionCount++;
+    removeFromCache(entry);
+    releaseEntry(entry);
 }
 
 } // namespace filament
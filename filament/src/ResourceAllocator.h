@@ -25,6 +25,8 @@
 
 #include <utils/Hash.h>
 
+#include <tsl/robin_map.h>
+
 #include <array>
 #include <vector>
 
@@ -62,7 +64,16 @@ protected:
 
 class ResourceAllocator final : public ResourceAllocatorInterface {
 public:
-    explicit ResourceAllocator(backend::DriverApi& driverApi) noexcept;
+    struct Statistics {
+        uint64_t hitCount = 0;          // textures served from the cache
+        uint64_t missCount = 0;         // textures that had to be created
+        uint64_t evictionCount = 0;     // textures freed from the cache
+        size_t cacheSize = 0;           // size of the cache in bytes
+        size_t cacheEntryCount = 0;     // number of textures in the cache
+    };
+
+    ResourceAllocator(backend::DriverApi& driverApi,
+            size_t cacheCapacity, size_t cacheMaxAge) noexcept;
     ~ResourceAllocator() noexcept override;
 
     void terminate() noexcept;
@@ -88,11 +99,12 @@ public:
 
     void gc() noexcept;
 
-private:
-    // TODO: these should be settings of the engine
-    static constexpr size_t CACHE_CAPACITY = 64u << 20u;   // 64 MiB
-    static constexpr size_t CACHE_MAX_AGE  = 30u;
+    // frees the least recently used textures until the cache is at most `size` bytes
+    void trim(size_t size) noexcept;
+
+    Statistics getStatistics() const noexcept;
 
+private:
     struct TextureKey {
         const char* name; // doesn't participate in the hash
         backend::SamplerType target;
@@ -107,7 +119,8 @@ private:
 
         size_t getSize() const noexcept;
 
-        bool operator==(const TextureKey& other) const noexcept {
+        // whether the keys describe the same texture, regardless of its usage
+        bool isSameTextureAs(const TextureKey& other) const noexcept {
             return target == other.target &&
                    levels == other.levels &&
                    format == other.format &&
@@ -115,10 +128,20 @@ private:
                    width == other.width &&
                    height == other.height &&
                    depth == other.depth &&
-                   usage == other.usage &&
                    swizzle == other.swizzle;
         }
 
+        bool operator==(const TextureKey& other) const noexcept {
+            return isSameTextureAs(other) && usage == other.usage;
+        }
+
+        // whether a texture created with this key can be used in place of one created
+        // with the given key, i.e.: the keys only differ by additional usage bits.
+        bool isCompatibleWith(const TextureKey& other) const noexcept {
+            return isSameTextureAs(other) && (usage & other.usage) == other.usage;
+        }
+
+        // usage doesn't participate in the hash, so that compatible keys hash the same
         friend size_t hash_value(TextureKey const& k) {
             size_t seed = 0;
             utils::hash::combine_fast(seed, k.target);
@@ -128,7 +151,6 @@ private:
             utils::hash::combine_fast(seed, k.width);
             utils::hash::combine_fast(seed, k.height);
             utils::hash::combine_fast(seed, k.depth);
-            utils::hash::combine_fast(seed, k.usage);
             utils::hash::combine_fast(seed, k.swizzle[0]);
             utils::hash::combine_fast(seed, k.swizzle[1]);
             utils::hash::combine_fast(seed, k.swizzle[2]);
@@ -143,6 +165,30 @@ private:
         uint32_t size = 0;
     };
 
+    // An entry of the texture cache, linked in least recently used order. Entries of the same
+    // texture (which may only differ by their usage) are also linked together, from the index.
+    struct CacheEntry {
+        TextureKey key;
+        TextureCachePayload payload;
+        CacheEntry* prev = nullptr;
+        CacheEntry* next = nullptr;
+        CacheEntry* prevSibling = nullptr;
+        CacheEntry* nextSibling = nullptr;
+    };
+
+    // Intrusive doubly-linked list of CacheEntry, the least recently used entry is at the front.
+    class LruList {
+        CacheEntry* mHead = nullptr;
+        CacheEntry* mTail = nullptr;
+        size_t mSize = 0;
+    public:
+        size_t size() const noexcept { return mSize; }
+        bool empty() const noexcept { return !mHead; }
+        CacheEntry* front() const noexcept { return mHead; }
+        void push_back(CacheEntry* entry) noexcept;
+        void remove(CacheEntry* entry) noexcept;
+    };
+
     template<typename T>
     struct Hasher {
         std::size_t operator()(T const& s) const noexcept {
@@ -157,6 +203,17 @@ private:
         }
     };
 
+    struct TextureKeyEqual {
+        bool operator()(TextureKey const& lhs, TextureKey const& rhs) const noexcept {
+            return lhs.isSameTextureAs(rhs);
+        }
+    };
+
+    // Index of the texture cache, maps a texture (regardless of its usage) to the most recently
+    // used entry of its list of siblings.
+    using TextureCacheIndex =
+            tsl::robin_map<TextureKey, CacheEntry*, Hasher<TextureKey>, TextureKeyEqual>;
+
     inline void dump(bool brief = false) const noexcept;
 
     template<typename Key, typename Value, typename Hasher = Hasher<Key>>
@@ -187,16 +244,27 @@ private:
         void emplace(ARGS&&... args);
     };
 
-    using CacheContainer = AssociativeContainer<TextureKey, TextureCachePayload>;
     using InUseContainer = AssociativeContainer<backend::TextureHandle, TextureKey>;
 
-    CacheContainer::iterator purge(CacheContainer::iterator const& pos);
+    CacheEntry* allocateEntry() noexcept;
+    void releaseEntry(CacheEntry* entry) noexcept;
+    CacheEntry* findCompatible(TextureKey const& key) const noexcept;
+    void addToCache(CacheEntry* entry) noexcept;
+    void removeFromCache(CacheEntry* entry) noexcept;
+    void purge(CacheEntry* entry) noexcept;
 
     backend::DriverApi& mBackend;
-    CacheContainer mTextureCache;
+    size_t const mCacheCapacity;
+    size_t const mCacheMaxAge;
+    LruList mTextureCache;
+    TextureCacheIndex mTextureCacheIndex;
+    CacheEntry* mFreeEntries = nullptr; // singly-linked list of unused entries, using next
     InUseContainer mInUseTextures;
     size_t mAge = 0;
-    uint32_t mCacheSize = 0;
+    size_t mCacheSize = 0;
+    uint64_t mHitCount = 0;
+    uint64_t mMissCount = 0;
+    uint64_t mEvictionCount = 0;
     static constexpr bool mEnabled = true;
 };
 
@@ -45,6 +45,7 @@ class RenderPass;
 // VISIBLE_RENDERABLE                            X
 // VISIBLE_DIR_SHADOW_RENDERABLE               X
 // VISIBLE_DYN_SHADOW_RENDERABLE             X
+// VISIBLE_STATIC_SHADOW_RENDERABLE        X
 
 // A "shadow renderable" is a renderable rendered to the shadow map during a shadow pass:
 // PCF shadows: only shadow casters
@@ -53,10 +54,12 @@ class RenderPass;
 static constexpr size_t VISIBLE_RENDERABLE_BIT              = 0u;
 static constexpr size_t VISIBLE_DIR_SHADOW_RENDERABLE_BIT   = 1u;
 static constexpr size_t VISIBLE_DYN_SHADOW_RENDERABLE_BIT   = 2u;
+static constexpr size_t VISIBLE_STATIC_SHADOW_RENDERABLE_BIT = 3u;
 
 static constexpr Culler::result_type VISIBLE_RENDERABLE = 1u << VISIBLE_RENDERABLE_BIT;
 static constexpr Culler::result_type VISIBLE_DIR_SHADOW_RENDERABLE = 1u << VISIBLE_DIR_SHADOW_RENDERABLE_BIT;
 static constexpr Culler::result_type VISIBLE_DYN_SHADOW_RENDERABLE = 1u << VISIBLE_DYN_SHADOW_RENDERABLE_BIT;
+static constexpr Culler::result_type VISIBLE_STATIC_SHADOW_RENDERABLE = 1u << VISIBLE_STATIC_SHADOW_RENDERABLE_BIT;
 
 class ShadowMap {
 public:
@@ -17,6 +17,7 @@
 #include "ShadowMapManager.h"
 
 #include "RenderPass.h"
+#include "RenderPrimitive.h"
 #include "ShadowMap.h"
 
 #include "details/Texture.h"
@@ -24,8 +25,12 @@
 
 #include <fg/FrameGraph.h>
 
+#include <utils/Allocator.h>
 #include <utils/debug.h>
-#include <utils/FixedCapacityVector.h>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
 
 namespace filament {
 
@@ -48,6 +53,8 @@ ShadowMapManager::ShadowMapManager(FEngine& engine)
             &engine.debug.shadowmap.visualize_cascades);
     debugRegistry.registerProperty("d.shadowmap.tightly_bound_scene",
             &engine.debug.shadowmap.tightly_bound_scene);
+    debugRegistry.registerProperty("d.shadowmap.static_cache",
+            &engine.debug.shadowmap.static_cache);
 }
 
 ShadowMapManager::~ShadowMapManager() {
@@ -61,6 +68,9 @@ ShadowMapManager::~ShadowMapManager() {
 void ShadowMapManager::terminate(FEngine& engine) {
     DriverApi& driver = engine.getDriverApi();
     driver.destroyBufferObject(mShadowUbh);
+    if (mStaticShadowTexture) {
+        driver.destroyTexture(mStaticShadowTexture);
+    }
     UTILS_NOUNROLL
     for (auto& entry : mShadowMapCache) {
         std::launder(reinterpret_cast<ShadowMap*>(&entry))->terminate(engine);
@@ -142,6 +152,20 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
     const TextureAtlasRequirements textureRequirements = mTextureAtlasRequirements;
     assert_invariant(textureRequirements.layers <= CONFIG_MAX_SHADOW_LAYERS);
 
+    // Static shadow casters of spot and point lights are cached, which requires depth shadow maps
+    // and blitting into the atlas.
+    auto const spotShadowCastersRange = view.getVisibleSpotShadowCasters();
+    bool staticShadowCaching = false;
+    if (engine.debug.shadowmap.static_cache && !view.hasVSM() &&
+            !engine.getDriverApi().isWorkaroundNeeded(Workaround::DISABLE_BLIT_INTO_TEXTURE_ARRAY)) {
+        auto const* visibility = scene->getRenderableData().data<FScene::VISIBILITY_STATE>();
+        staticShadowCaching = std::any_of(
+                visibility + spotShadowCastersRange.first,
+                visibility + spotShadowCastersRange.last,
+                [](FRenderableManager::Visibility v) { return v.staticShadowCaster; });
+    }
+    updateStaticShadowCache(engine.getDriverApi(), staticShadowCaching, textureRequirements);
+
     // -------------------------------------------------------------------------------------------
     // Prepare Shadow Pass
     // -------------------------------------------------------------------------------------------
@@ -152,18 +176,26 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
             ShadowMap* shadowMap;
             utils::Range<uint32_t> range;
             FScene::VisibleMaskType visibilityMask;
+            // static shadow casters, rendered only when the cached shadow map is out of date
+            bool cached = false;
+            mutable bool hasStaticCasters = false;
+            mutable bool updateStaticCache = false;
+            mutable RenderPass::Executor staticExecutor;
         };
         // the actual shadow map atlas (currently a 2D texture array)
         FrameGraphId<FrameGraphTexture> shadows;
-        // a RenderPass per shadow map
-        utils::FixedCapacityVector<ShadowPass> passList;
+        // a RenderPass per shadow map, allocated from the per-render-pass arena
+        using ShadowPassList = std::vector<ShadowPass,
+                utils::STLAllocator<ShadowPass, LinearAllocatorArena>>;
+        std::optional<ShadowPassList> passList;
     };
 
     VsmShadowOptions const& vsmShadowOptions = view.getVsmShadowOptions();
 
     auto& prepareShadowPass = fg.addPass<PrepareShadowPassData>("Prepare Shadow Pass",
             [&](FrameGraph::Builder& builder, auto& data) {
-                data.passList.reserve(CONFIG_MAX_SHADOWMAPS);
+                data.passList.emplace(engine.getPerRenderPassAllocator());
+                data.passList->reserve(CONFIG_MAX_SHADOWMAPS);
                 data.shadows = builder.createTexture("Shadowmap", {
                         .width = textureRequirements.size, .height = textureRequirements.size,
                         .depth = textureRequirements.layers,
@@ -173,7 +205,7 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 });
 
                 // these loops create a list of the shadow maps that might need to be rendered
-                auto& passList = data.passList;
+                auto& passList = *data.passList;
 
                 // Directional, cascaded shadow maps
                 auto const directionalShadowCastersRange = view.getVisibleDirectionalShadowCasters();
@@ -189,13 +221,12 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                 }
 
                 // Point lights and Spotlight shadow maps
-                auto const spotShadowCastersRange = view.getVisibleSpotShadowCasters();
                 if (!spotShadowCastersRange.empty()) {
                     for (auto& shadowMap : getSpotShadowMaps()) {
                         assert_invariant(!shadowMap.isDirectionalShadow());
                         passList.push_back({
                                 {}, &shadowMap, spotShadowCastersRange,
-                                VISIBLE_DYN_SHADOW_RENDERABLE });
+                                VISIBLE_DYN_SHADOW_RENDERABLE, staticShadowCaching });
                     }
                 }
 
@@ -210,13 +241,12 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                     FrameGraphResources const&, auto const& data, DriverApi& driver) {
 
                 // Note: we could almost parallel_for the loop below, the problem currently is
-                // that updatePrimitivesLod() updates temporary global state.
-                // prepareSpotShadowMap() also update the visibility of renderable. These two
-                // pieces of state are needed only until shadowMap.render() returns.
+                // that prepareSpotShadowMap() updates the visibility of renderables. This state is
+                // needed only until shadowMap.render() returns.
                 // Conceptually, we could store this out-of-band.
 
                 // Generate a RenderPass for each shadow map
-                for (auto const& entry : data.passList) {
+                for (auto const& entry : *data.passList) {
                     ShadowMap& shadowMap = *entry.shadowMap;
 
                     // for spot shadow map, we need to do the culling
@@ -235,6 +265,28 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                             break;
                     }
 
+                    if (entry.cached && shadowMap.hasVisibleShadows()) {
+                        // static shadow casters are rendered separately, and only if the
+                        // cached static shadow map is out of date
+                        FScene::RenderableSoa& renderableData = scene->getRenderableData();
+                        splitStaticShadowCasters(
+                                renderableData.data<FScene::VISIBILITY_STATE>() + entry.range.first,
+                                renderableData.data<FScene::VISIBLE_MASK>() + entry.range.first,
+                                entry.range.size());
+                        StaticShadowCacheKey& key = mStaticShadowCacheScratch;
+                        computeStaticShadowCacheKey(key, shadowMap,
+                                engine.getRenderableManager(), renderableData, entry.range);
+                        StaticShadowCacheKey& cachedKey =
+                                mStaticShadowCacheKeys[shadowMap.getLayer()];
+                        entry.hasStaticCasters = !key.casters.empty();
+                        if (!(key == cachedKey)) {
+                            // swapping keeps the storage of both keys for the next frames
+                            std::swap(key, cachedKey);
+                            entry.updateStaticCache = entry.hasStaticCasters;
+                            mStaticShadowCacheUpdateCount += entry.hasStaticCasters;
+                        }
+                    }
+
                     if (shadowMap.hasVisibleShadows()) {
                         // Note: this loop can generate a lot of commands that come out of the
                         //       "per frame command arena". The allocation persists until the
@@ -257,9 +309,9 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                                 vsmShadowOptions.highPrecision);
                         shadowMap.commit(transaction, driver);
 
-                        // updatePrimitivesLod must be run before RenderPass::appendCommands.
-                        view.updatePrimitivesLod(engine,
-                                cameraInfo, scene->getRenderableData(), entry.range);
+                        // Levels of detail were selected by FView::prepare() from the
+                        // viewer's camera, for the shadow casters too, so that shadows match
+                        // the geometry that is drawn.
 
                         // generate and sort the commands for rendering the shadow map
                         RenderPass pass(passTemplate);
@@ -272,6 +324,17 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
 
                         entry.executor = pass.getExecutor();
 
+                        if (entry.updateStaticCache) {
+                            RenderPass staticPass(passTemplate);
+                            staticPass.setCamera(cameraInfo);
+                            staticPass.setVisibilityMask(VISIBLE_STATIC_SHADOW_RENDERABLE);
+                            staticPass.setGeometry(scene->getRenderableData(),
+                                    entry.range, scene->getRenderableUBO());
+                            staticPass.appendCommands(engine, RenderPass::SHADOW);
+                            staticPass.sortCommands(engine);
+                            entry.staticExecutor = staticPass.getExecutor();
+                        }
+
                         if (!view.hasVSM()) {
                             auto const* options = shadowMap.getShadowOptions();
                             const PolygonOffset polygonOffset = { // handle reversed Z
@@ -279,6 +342,7 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                                     .constant = -options->polygonOffsetConstant
                             };
                             entry.executor.overridePolygonOffset(&polygonOffset);
+                            entry.staticExecutor.overridePolygonOffset(&polygonOffset);
                         }
                     }
                 }
@@ -300,7 +364,18 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
         uint32_t rt{};
     };
 
-    auto const& passList = prepareShadowPass.getData().passList;
+    FrameGraphId<FrameGraphTexture> staticShadows;
+    if (staticShadowCaching) {
+        staticShadows = fg.import("Static Shadowmap", {
+                .width = textureRequirements.size, .height = textureRequirements.size,
+                .depth = textureRequirements.layers,
+                .type = SamplerType::SAMPLER_2D_ARRAY,
+                .format = textureRequirements.format
+        }, FrameGraphTexture::Usage::DEPTH_ATTACHMENT | FrameGraphTexture::Usage::BLIT_SRC,
+                FrameGraphTexture{ .handle = mStaticShadowTexture });
+    }
+
+    auto const& passList = *prepareShadowPass.getData().passList;
     for (auto const& entry: passList) {
         if (!entry.shadowMap->hasVisibleShadows()) {
             continue;
@@ -310,14 +385,86 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
         const auto* options = entry.shadowMap->getShadowOptions();
         const auto msaaSamples = textureRequirements.msaaSamples;
 
+        // With static shadow caching, the static shadow casters are rendered into the cache only
+        // when needed, the cached layer is copied into the atlas, and the shadow pass below
+        // renders the remaining shadow casters on top of it.
+        // Whether a shadow map has static casters is only known once its casters are culled,
+        // when the passes execute, so maps without any skip the static pass and the copy, and
+        // their shadow pass clears the layer instead.
+        FrameGraphId<FrameGraphTexture> cachedLayer;
+        if (entry.cached) {
+            struct StaticShadowPassData {
+                FrameGraphId<FrameGraphTexture> output;
+            };
+
+            auto& staticShadowPass = fg.addPass<StaticShadowPassData>("Static Shadow Pass",
+                    [&](FrameGraph::Builder& builder, auto& data) {
+                        data.output = builder.createSubresource(staticShadows,
+                                "Static Shadowmap Layer", { .layer = layer });
+                        data.output = builder.write(data.output,
+                                FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
+                        builder.declareRenderPass("Static Shadow RT", {
+                                .attachments = { .depth = data.output },
+                                .clearFlags = TargetBufferFlags::DEPTH });
+                    },
+                    [&engine, &entry](FrameGraphResources const& resources,
+                            auto const&, DriverApi& driver) {
+                        // see the Shadow Pass below about capturing entry by reference
+                        if (!entry.updateStaticCache) {
+                            // the cached static shadow map is up-to-date
+                            return;
+                        }
+                        auto rt = resources.getRenderPassInfo();
+                        engine.flush();
+                        driver.beginRenderPass(rt.target, rt.params);
+                        entry.shadowMap->bind(driver);
+                        entry.staticExecutor.overrideScissor(entry.shadowMap->getScissor());
+                        entry.staticExecutor.execute(engine, "Static Shadow Pass");
+                        driver.endRenderPass();
+                    });
+
+            struct CopyStaticShadowPassData {
+                FrameGraphId<FrameGraphTexture> input;
+                FrameGraphId<FrameGraphTexture> output;
+            };
+
+            auto& copyStaticShadowPass = fg.addPass<CopyStaticShadowPassData>(
+                    "Copy Static Shadows",
+                    [&](FrameGraph::Builder& builder, auto& data) {
+                        data.input = builder.read(staticShadowPass->output,
+                                FrameGraphTexture::Usage::BLIT_SRC);
+                        data.output = builder.createSubresource(prepareShadowPass->shadows,
+                                "Shadowmap Layer", { .layer = layer });
+                        data.output = builder.write(data.output,
+                                FrameGraphTexture::Usage::BLIT_DST);
+                    },
+                    [layer, &entry](FrameGraphResources const& resources,
+                            auto const& data, DriverApi& driver) {
+                        if (!entry.hasStaticCasters) {
+                            return;
+                        }
+                        auto const& src = resources.getTexture(data.input);
+                        auto const& dst = resources.getTexture(data.output);
+                        auto const& desc = resources.getDescriptor(data.output);
+                        // the whole layer is copied, the layout of both textures is the same
+                        driver.blit(
+                                dst, 0, layer, { 0, 0 },
+                                src, 0, layer, { 0, 0 },
+                                { desc.width, desc.height });
+                    });
+
+            cachedLayer = copyStaticShadowPass->output;
+        }
+
         auto& shadowPass = fg.addPass<ShadowPassData>("Shadow Pass",
                 [&](FrameGraph::Builder& builder, auto& data) {
                     const bool blur = view.hasVSM() && options->vsm.blurWidth > 0.0f;
 
                     FrameGraphRenderPass::Descriptor renderTargetDesc{};
 
-                    data.output = builder.createSubresource(prepareShadowPass->shadows,
-                            "Shadowmap Layer", { .layer = layer });
+                    data.output = cachedLayer ? cachedLayer :
+                            builder.createSubresource(prepareShadowPass->shadows,
+                                    "Shadowmap Layer", { .layer = layer });
 
                     if (view.hasVSM()) {
                         // Each shadow pass has its own sample count, but textures are created with
@@ -371,7 +518,9 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                         data.output = builder.write(data.output,
                                 FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
                         renderTargetDesc.attachments.depth = data.output;
-                        renderTargetDesc.clearFlags = TargetBufferFlags::DEPTH;
+                        // when the static shadow map was copied into the layer, we keep it
+                        renderTargetDesc.clearFlags =
+                                cachedLayer ? TargetBufferFlags::NONE : TargetBufferFlags::DEPTH;
                     }
 
                     // finally, create the shadowmap render target -- one per layer.
@@ -392,6 +541,10 @@ FrameGraphId<FrameGraphTexture> ShadowMapManager::render(FEngine& engine, FrameG
                     // initialized, as this happens in an `execute` block.
 
                     auto rt = resources.getRenderPassInfo(data.rt);
+                    if (entry.cached && !entry.hasStaticCasters) {
+                        // nothing was copied from the static shadow cache
+                        rt.params.flags.clear |= TargetBufferFlags::DEPTH;
+                    }
 
                     engine.flush();
                     driver.beginRenderPass(rt.target, rt.params);
@@ -675,6 +828,105 @@ void ShadowMapManager::updateSpotVisibilityMasks(
     }
 }
 
+void ShadowMapManager::splitStaticShadowCasters(
+        FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
+        Culler::result_type* UTILS_RESTRICT visibleMask, size_t count) {
+    // see updateSpotVisibilityMasks() above, this is vectorized the same way.
+    count = (count + 0xFu) & ~0xFu; // capacity guaranteed to be multiple of 16
+    for (size_t i = 0; i < count; ++i) {
+        const Culler::result_type mask = visibleMask[i];
+        const bool visible = mask & VISIBLE_DYN_SHADOW_RENDERABLE;
+        const bool isStatic = visibility[i].staticShadowCaster;
+
+        using Type = Culler::result_type;
+
+        visibleMask[i] &= ~Type(VISIBLE_DYN_SHADOW_RENDERABLE | VISIBLE_STATIC_SHADOW_RENDERABLE);
+        visibleMask[i] |= Type((visible && !isStatic) << VISIBLE_DYN_SHADOW_RENDERABLE_BIT);
+        visibleMask[i] |= Type((visible && isStatic) << VISIBLE_STATIC_SHADOW_RENDERABLE_BIT);
+    }
+}
+
+bool ShadowMapManager::StaticShadowCacheKey::operator==(
+        StaticShadowCacheKey const& rhs) const noexcept {
+    auto const isSameCaster = [](StaticShadowCaster const& a, StaticShadowCaster const& b) {
+        return a.instance == b.instance &&
+               a.generation == b.generation &&
+               a.materialGeneration == b.materialGeneration &&
+               a.transform == b.transform &&
+               a.level == b.level;
+    };
+    return valid && rhs.valid &&
+           projection == rhs.projection &&
+           model == rhs.model &&
+           viewport.left == rhs.viewport.left &&
+           viewport.bottom == rhs.viewport.bottom &&
+           viewport.width == rhs.viewport.width &&
+           viewport.height == rhs.viewport.height &&
+           polygonOffset == rhs.polygonOffset &&
+           std::equal(casters.begin(), casters.end(),
+                   rhs.casters.begin(), rhs.casters.end(), isSameCaster);
+}
+
+void ShadowMapManager::computeStaticShadowCacheKey(StaticShadowCacheKey& key,
+        ShadowMap const& shadowMap, FRenderableManager const& rcm,
+        FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range) noexcept {
+    // the shadow map's camera and viewport, which only depend on the light
+    FCamera const& camera = shadowMap.getCamera();
+    auto const* const options = shadowMap.getShadowOptions();
+    key.projection = mat4f{ camera.getProjectionMatrix() };
+    key.model = mat4f{ camera.getModelMatrix() };
+    key.viewport = shadowMap.getViewport();
+    key.polygonOffset = { options->polygonOffsetSlope, options->polygonOffsetConstant };
+    key.valid = true;
+
+    // and the static shadow casters it contains
+    auto const* const instances = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* const transforms = renderableData.data<FScene::WORLD_TRANSFORM>();
+    auto const* const primitives = renderableData.data<FScene::PRIMITIVES>();
+    auto const* const levels = renderableData.data<FScene::LOD_LEVEL>();
+    auto const* const visibleMasks = renderableData.data<FScene::VISIBLE_MASK>();
+    key.casters.clear();
+    for (uint32_t i = range.first; i < range.last; i++) {
+        if (visibleMasks[i] & VISIBLE_STATIC_SHADOW_RENDERABLE) {
+            uint64_t materialGeneration = 0;
+            for (FRenderPrimitive const& primitive : primitives[i]) {
+                materialGeneration += primitive.getMaterialInstance()->getGeneration();
+            }
+            key.casters.push_back({
+                    .instance = instances[i].asValue(),
+                    .generation = rcm.getGeneration(instances[i]),
+                    .materialGeneration = materialGeneration,
+                    .transform = transforms[i],
+                    .level = levels[i] });
+        }
+    }
+}
+
+void ShadowMapManager::updateStaticShadowCache(DriverApi& driver, bool enabled,
+        TextureAtlasRequirements const& textureRequirements) noexcept {
+    TextureAtlasRequirements const& current = mStaticShadowTextureRequirements;
+    bool const needsNewTexture = enabled && (!mStaticShadowTexture ||
+            current.size != textureRequirements.size ||
+            current.layers != textureRequirements.layers ||
+            current.format != textureRequirements.format);
+
+    if (mStaticShadowTexture && (!enabled || needsNewTexture)) {
+        driver.destroyTexture(mStaticShadowTexture);
+        mStaticShadowTexture.clear();
+        for (auto& key : mStaticShadowCacheKeys) {
+            key.valid = false;
+        }
+    }
+
+    if (needsNewTexture) {
+        mStaticShadowTexture = driver.createTexture(SamplerType::SAMPLER_2D_ARRAY, 1,
+                textureRequirements.format, 1,
+                textureRequirements.size, textureRequirements.size, textureRequirements.layers,
+                TextureUsage::DEPTH_ATTACHMENT | TextureUsage::BLIT_SRC);
+        mStaticShadowTextureRequirements = textureRequirements;
+    }
+}
+
 void ShadowMapManager::prepareSpotShadowMap(ShadowMap& shadowMap,
         FEngine& engine, FView& view, CameraInfo const& mainCameraInfo,
         FScene::RenderableSoa& renderableData, utils::Range<uint32_t> range,
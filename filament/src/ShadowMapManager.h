@@ -33,10 +33,12 @@
 
 #include <utils/Slice.h>
 
+#include <math/mat4.h>
 #include <math/vec3.h>
 
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace filament {
 
@@ -98,6 +100,11 @@ public:
 
     bool hasSpotShadows() const { return !mSpotShadowMapCount; }
 
+    // number of times a cached static shadow map was rendered, for testing
+    size_t getStaticShadowCacheUpdateCount() const noexcept {
+        return mStaticShadowCacheUpdateCount;
+    }
+
     // for debugging only
     FCamera const* getDirectionalLightCamera() const noexcept {
         return &getShadowMap(0).getDebugCamera();
@@ -131,6 +138,37 @@ private:
             FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
             Culler::result_type* UTILS_RESTRICT visibleMask, size_t count);
 
+    // moves the static shadow casters from VISIBLE_DYN_SHADOW_RENDERABLE to
+    // VISIBLE_STATIC_SHADOW_RENDERABLE
+    static void splitStaticShadowCasters(
+            FRenderableManager::Visibility const* UTILS_RESTRICT visibility,
+            Culler::result_type* UTILS_RESTRICT visibleMask, size_t count);
+
+    // A static shadow caster of a cached static shadow map
+    struct StaticShadowCaster {
+        uint32_t instance;              // renderable instance
+        uint32_t generation;            // see FRenderableManager::getGeneration()
+        uint64_t materialGeneration;    // sum of the generations of its material instances
+        math::mat4f transform;          // world transform
+        uint8_t level;                  // selected level of detail
+    };
+
+    // Everything the content of a cached static shadow map depends on. The cache is reused only
+    // if all of it is unchanged.
+    struct StaticShadowCacheKey {
+        math::mat4f projection;
+        math::mat4f model;
+        backend::Viewport viewport{};
+        math::float2 polygonOffset;
+        std::vector<StaticShadowCaster> casters;
+        bool valid = false;
+        bool operator==(StaticShadowCacheKey const& rhs) const noexcept;
+    };
+
+    static void computeStaticShadowCacheKey(StaticShadowCacheKey& key,
+            ShadowMap const& shadowMap, FRenderableManager const& rcm,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> range) noexcept;
+
     class CascadeSplits {
     public:
         constexpr static size_t SPLIT_COUNT = CONFIG_MAX_SHADOW_CASCADES + 1;
@@ -171,6 +209,19 @@ private:
         backend::TextureFormat format = backend::TextureFormat::DEPTH16;
     } mTextureAtlasRequirements;
 
+    // (re)creates or destroys the static shadow cache texture as needed
+    void updateStaticShadowCache(backend::DriverApi& driver, bool enabled,
+            TextureAtlasRequirements const& textureRequirements) noexcept;
+
+    // Static shadow casters of spot and point lights are rendered into this texture, which has
+    // the same layout as the shadow map atlas, and copied into the atlas each frame.
+    backend::Handle<backend::HwTexture> mStaticShadowTexture;
+    TextureAtlasRequirements mStaticShadowTextureRequirements;
+    // per layer, what the cached static shadow map was rendered from
+    std::array<StaticShadowCacheKey, CONFIG_MAX_SHADOW_LAYERS> mStaticShadowCacheKeys;
+    StaticShadowCacheKey mStaticShadowCacheScratch;
+    size_t mStaticShadowCacheUpdateCount = 0;
+
     SoftShadowOptions mSoftShadowOptions;
 
     mutable TypedUniformBuffer<ShadowUib> mShadowUb;
@@ -263,6 +263,14 @@ uint8_t View::getVisibleLayers() const noexcept {
   return downcast(this)->getVisibleLayers();
 }
 
+void View::setLodBias(float bias) noexcept {
+    downcast(this)->setLodBias(bias);
+}
+
+float View::getLodBias() const noexcept {
+    return downcast(this)->getLodBias();
+}
+
 bool View::isShadowingEnabled() const noexcept {
     return downcast(this)->isShadowingEnabled();
 }
@@ -153,8 +153,10 @@ LightManager::Builder::Result LightManager::Builder::build(Engine& engine, Entit
 
 // ------------------------------------------------------------------------------------------------
 
-FLightManager::FLightManager(FEngine& engine) noexcept : mEngine(engine) {
+FLightManager::FLightManager(FEngine& engine, size_t lookupTableSize) noexcept
+        : mEngine(engine) {
     // DON'T use engine here in the ctor, because it's not fully constructed yet.
+    mManager.enableDirectLookup(lookupTableSize);
 }
 
 FLightManager::~FLightManager() {
@@ -37,7 +37,7 @@ class FLightManager : public LightManager {
 public:
     using Instance = LightManager::Instance;
 
-    explicit FLightManager(FEngine& engine) noexcept;
+    FLightManager(FEngine& engine, size_t lookupTableSize) noexcept;
     ~FLightManager();
 
     void init(FEngine& engine) noexcept;
@@ -34,7 +34,11 @@
 #include <utils/Log.h>
 #include <utils/Panic.h>
 #include <utils/debug.h>
+
+#include <algorithm>
+#include <array>
 #include <unordered_map>
+#include <utility>
 
 using namespace filament::math;
 using namespace utils;
@@ -46,6 +50,9 @@ using namespace backend;
 struct RenderableManager::BuilderDetails {
     using Entry = RenderableManager::Builder::Entry;
     std::vector<Entry> mEntries;
+    // first primitive and screen size of each level of detail, level 0 is implicit
+    std::array<std::pair<size_t, float>, RenderableManager::Builder::MAX_LEVEL_COUNT> mLevels{};
+    uint8_t mLevelCount = 1;
     Box mAABB;
     uint8_t mLayerMask = 0x1;
     uint8_t mPriority = 0x4;
@@ -56,6 +63,7 @@ struct RenderableManager::BuilderDetails {
     bool mCastShadows : 1;
     bool mReceiveShadows : 1;
     bool mScreenSpaceContactShadows : 1;
+    bool mStaticShadowCaster : 1;
     bool mSkinningBufferMode : 1;
     bool mFogEnabled : 1;
     size_t mSkinningBoneCount = 0;
@@ -75,6 +83,7 @@ struct RenderableManager::BuilderDetails {
     explicit BuilderDetails(size_t count)
             : mEntries(count), mCulling(true), mCastShadows(false),
               mReceiveShadows(true), mScreenSpaceContactShadows(false),
+              mStaticShadowCaster(false),
               mSkinningBufferMode(false),  mFogEnabled(true), mBonePairs() {
     }
     // this is only needed for the explicit instantiation below
@@ -131,6 +140,16 @@ RenderableManager::Builder& RenderableManager::Builder::material(size_t index,
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::levelOfDetail(uint8_t level,
+        size_t firstPrimitive, float screenSize) noexcept {
+    // levels are validated in build()
+    if (level > 0 && level < MAX_LEVEL_COUNT) {
+        mImpl->mLevels[level] = { firstPrimitive, screenSize };
+        mImpl->mLevelCount = std::max(mImpl->mLevelCount, uint8_t(level + 1));
+    }
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::boundingBox(const Box& axisAlignedBoundingBox) noexcept {
     mImpl->mAABB = axisAlignedBoundingBox;
     return *this;
@@ -180,6 +199,11 @@ RenderableManager::Builder& RenderableManager::Builder::screenSpaceContactShadow
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::staticShadowCaster(bool enable) noexcept {
+    mImpl->mStaticShadowCaster = enable;
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::skinning(size_t boneCount) noexcept {
     mImpl->mSkinningBoneCount = boneCount;
     return *this;
@@ -242,9 +266,15 @@ RenderableManager::Builder& RenderableManager::Builder::morphing(size_t targetCo
     return *this;
 }
 
-RenderableManager::Builder& RenderableManager::Builder::morphing(uint8_t, size_t primitiveIndex,
-        MorphTargetBuffer* morphTargetBuffer, size_t offset, size_t count) noexcept {
+RenderableManager::Builder& RenderableManager::Builder::morphing(uint8_t level,
+        size_t primitiveIndex, MorphTargetBuffer* morphTargetBuffer,
+        size_t offset, size_t count) noexcept {
     std::vector<Entry>& entries = mImpl->mEntries;
+    if (level < mImpl->mLevelCount) {
+        primitiveIndex += mImpl->mLevels[level].first;
+    } else {
+        primitiveIndex = entries.size();
+    }
     if (primitiveIndex < entries.size()) {
         auto& morphing = entries[primitiveIndex].morphing;
         morphing.buffer = morphTargetBuffer;
@@ -408,6 +438,18 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
         mImpl->processBoneIndicesAndWights(engine, entity);
     }
 
+    for (size_t l = 1; l < mImpl->mLevelCount; l++) {
+        auto const& previous = mImpl->mLevels[l - 1];
+        auto const& level = mImpl->mLevels[l];
+        ASSERT_PRECONDITION(level.first > previous.first && level.first < mImpl->mEntries.size(),
+                "[entity=%u, level %u] first primitive (%u) must be greater than the previous "
+                "level's (%u) and less than the primitive count (%u)",
+                entity.getId(), l, level.first, previous.first, mImpl->mEntries.size());
+        ASSERT_PRECONDITION(level.second > 0.0f && (l == 1 || level.second < previous.second),
+                "[entity=%u, level %u] screen size (%f) must be positive and less than the "
+                "previous level's", entity.getId(), l, level.second);
+    }
+
     for (size_t i = 0, c = mImpl->mEntries.size(); i < c; i++) {
         auto& entry = mImpl->mEntries[i];
 
@@ -481,8 +523,10 @@ RenderableManager::Builder& RenderableManager::Builder::instances(
 
 // ------------------------------------------------------------------------------------------------
 
-FRenderableManager::FRenderableManager(FEngine& engine) noexcept : mEngine(engine) {
+FRenderableManager::FRenderableManager(FEngine& engine, size_t lookupTableSize) noexcept
+        : mEngine(engine) {
     // DON'T use engine here in the ctor, because it's not fully constructed yet.
+    mManager.enableDirectLookup(lookupTableSize);
 }
 
 FRenderableManager::~FRenderableManager() {
@@ -522,6 +566,7 @@ void FRenderableManager::create(
         setCastShadows(ci, builder->mCastShadows);
         setReceiveShadows(ci, builder->mReceiveShadows);
         setScreenSpaceContactShadows(ci, builder->mScreenSpaceContactShadows);
+        setStaticShadowCaster(ci, builder->mStaticShadowCaster);
         setCulling(ci, builder->mCulling);
         setSkinning(ci, false);
         setMorphing(ci, builder->mMorphTargetCount);
@@ -616,6 +661,22 @@ void FRenderableManager::create(
 
         mManager[ci].morphTargets = { morphTargets, size_type(entryCount) };
 
+        // Each level of detail refers to a range of the primitives and morph targets above.
+        if (UTILS_UNLIKELY(builder->mLevelCount > 1)) {
+            size_t const levelCount = builder->mLevelCount;
+            Level* const levels = new Level[levelCount];
+            for (size_t l = 0; l < levelCount; l++) {
+                size_t const first = builder->mLevels[l].first;
+                size_t const last = l + 1 < levelCount ? builder->mLevels[l + 1].first : entryCount;
+                levels[l] = {
+                        { rp + first, size_type(last - first) },
+                        { morphTargets + first, size_type(last - first) },
+                        builder->mLevels[l].second };
+            }
+            manager[ci].lods = LevelOfDetail{ levels, uint8_t(levelCount) };
+            mLevelOfDetailCount++;
+        }
+
         // Always create skinning and morphing resources if one of them is enabled because
         // the shader always handles both. See Variant::SKINNING_OR_MORPHING.
         if (UTILS_UNLIKELY(boneCount > 0 || targetCount > 0)) {
@@ -657,6 +718,8 @@ void FRenderableManager::create(
                 setMorphWeights(ci, initWeights, 1, 0);
             }
         }
+
+        invalidate(ci);
     }
     engine.flushIfNeeded();
 }
@@ -704,6 +767,12 @@ void FRenderableManager::destroyComponent(Instance ci) noexcept {
     destroyComponentPrimitives(mHwRenderPrimitiveFactory, driver, manager[ci].primitives);
     destroyComponentMorphTargets(engine, manager[ci].morphTargets);
 
+    LevelOfDetail const& lods = manager[ci].lods;
+    if (lods.levels) {
+        delete[] lods.levels;
+        mLevelOfDetailCount--;
+    }
+
     // destroy the bones structures if any
     Bones const& bones = manager[ci].bones;
     if (bones.handle && !bones.skinningBufferMode) {
@@ -740,10 +809,10 @@ void FRenderableManager::destroyComponentMorphTargets(FEngine&,
     delete[] morphTargets.data();
 }
 
-void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
+void FRenderableManager::setMaterialInstanceAt(Instance instance,
         size_t primitiveIndex, FMaterialInstance const* mi) {
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             assert_invariant(mi);
             FMaterial const* material = mi->getMaterial();
@@ -754,6 +823,7 @@ void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
                     material->getName().c_str_safe(), (uint8_t)material->getFeatureLevel());
 
             primitives[primitiveIndex].setMaterialInstance(mi);
+            invalidate(instance);
             AttributeBitset const required = material->getRequiredAttributes();
             AttributeBitset const declared = primitives[primitiveIndex].getEnabledAttributes();
             if (UTILS_UNLIKELY((declared & required) != required)) {
@@ -766,9 +836,9 @@ void FRenderableManager::setMaterialInstanceAt(Instance instance, uint8_t level,
 }
 
 MaterialInstance* FRenderableManager::getMaterialInstanceAt(
-        Instance instance, uint8_t level, size_t primitiveIndex) const noexcept {
+        Instance instance, size_t primitiveIndex) const noexcept {
     if (instance) {
-        const Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        const Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             // We store the material instance as const because we don't want to change it internally
             // but when the user queries it, we want to allow them to call setParameter()
@@ -778,20 +848,20 @@ MaterialInstance* FRenderableManager::getMaterialInstanceAt(
     return nullptr;
 }
 
-void FRenderableManager::setBlendOrderAt(Instance instance, uint8_t level,
+void FRenderableManager::setBlendOrderAt(Instance instance,
         size_t primitiveIndex, uint16_t order) noexcept {
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].setBlendOrder(order);
         }
     }
 }
 
-void FRenderableManager::setGlobalBlendOrderEnabledAt(Instance instance, uint8_t level,
+void FRenderableManager::setGlobalBlendOrderEnabledAt(Instance instance,
         size_t primitiveIndex, bool enabled) noexcept {
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].setGlobalBlendOrderEnabled(enabled);
         }
@@ -799,9 +869,9 @@ void FRenderableManager::setGlobalBlendOrderEnabledAt(Instance instance, uint8_t
 }
 
 AttributeBitset FRenderableManager::getEnabledAttributesAt(
-        Instance instance, uint8_t level, size_t primitiveIndex) const noexcept {
+        Instance instance, size_t primitiveIndex) const noexcept {
     if (instance) {
-        Slice<FRenderPrimitive> const& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive> const& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             return primitives[primitiveIndex].getEnabledAttributes();
         }
@@ -809,14 +879,15 @@ AttributeBitset FRenderableManager::getEnabledAttributesAt(
     return AttributeBitset{};
 }
 
-void FRenderableManager::setGeometryAt(Instance instance, uint8_t level, size_t primitiveIndex,
+void FRenderableManager::setGeometryAt(Instance instance, size_t primitiveIndex,
         PrimitiveType type, FVertexBuffer* vertices, FIndexBuffer* indices,
         size_t offset, size_t count) noexcept {
     if (instance) {
-        Slice<FRenderPrimitive>& primitives = getRenderPrimitives(instance, level);
+        Slice<FRenderPrimitive>& primitives = mManager[instance].primitives;
         if (primitiveIndex < primitives.size()) {
             primitives[primitiveIndex].set(mHwRenderPrimitiveFactory, mEngine.getDriverApi(),
                     type, vertices, indices, offset, 0, vertices->getVertexCount() - 1, count);
+            invalidate(instance);
         }
     }
 }
@@ -833,6 +904,7 @@ void FRenderableManager::setBones(Instance ci,
         if (bones.handle) {
             boneCount = std::min(boneCount, bones.count - offset);
             FSkinningBuffer::setBones(mEngine, bones.handle, transforms, boneCount, offset);
+            invalidate(ci);
         }
     }
 }
@@ -849,6 +921,7 @@ void FRenderableManager::setBones(Instance ci,
         if (bones.handle) {
             boneCount = std::min(boneCount, bones.count - offset);
             FSkinningBuffer::setBones(mEngine, bones.handle, transforms, boneCount, offset);
+            invalidate(ci);
         }
     }
 }
@@ -883,6 +956,7 @@ void FRenderableManager::setSkinningBuffer(FRenderableManager::Instance ci,
     bones.handle = skinningBuffer->getHwHandle();
     bones.count = uint16_t(count);
     bones.offset = uint16_t(offset);
+    invalidate(ci);
 }
 
 static void updateMorphWeights(FEngine& engine, backend::Handle<backend::HwBufferObject> handle,
@@ -905,6 +979,7 @@ void FRenderableManager::setMorphWeights(Instance instance, float const* weights
         MorphWeights const& morphWeights = mManager[instance].morphWeights;
         if (morphWeights.handle) {
             updateMorphWeights(mEngine, morphWeights.handle, weights, count, offset);
+            invalidate(instance);
         }
     }
 }
@@ -913,7 +988,7 @@ void FRenderableManager::setMorphTargetBufferAt(Instance instance, uint8_t level
         size_t primitiveIndex, FMorphTargetBuffer* morphTargetBuffer, size_t offset, size_t count) {
     assert_invariant(offset == 0 && "Offset not yet supported.");
     assert_invariant(count == morphTargetBuffer->getVertexCount() && "Count not yet supported.");
-    if (instance) {
+    if (instance && level < getLevelCount(instance)) {
         assert_invariant(morphTargetBuffer);
 
         MorphWeights const& morphWeights = mManager[instance].morphWeights;
@@ -921,18 +996,19 @@ void FRenderableManager::setMorphTargetBufferAt(Instance instance, uint8_t level
                 "Only %d morph targets can be set (count=%d)",
                 morphWeights.count, morphTargetBuffer->getCount());
 
-        Slice<MorphTargets>& morphTargets = getMorphTargets(instance, level);
+        Slice<MorphTargets> morphTargets = getMorphTargets(instance, level);
         if (primitiveIndex < morphTargets.size()) {
             morphTargets[primitiveIndex] = { morphTargetBuffer, (uint32_t)offset,
                                              (uint32_t)count };
+            invalidate(instance);
         }
     }
 }
 
 MorphTargetBuffer* FRenderableManager::getMorphTargetBufferAt(Instance instance, uint8_t level,
         size_t primitiveIndex) const noexcept {
-    if (instance) {
-        const Slice<MorphTargets>& morphTargets = getMorphTargets(instance, level);
+    if (instance && level < getLevelCount(instance)) {
+        Slice<MorphTargets> const morphTargets = getMorphTargets(instance, level);
         if (primitiveIndex < morphTargets.size()) {
             return morphTargets[primitiveIndex].buffer;
         }
@@ -968,8 +1044,9 @@ bool FRenderableManager::getLightChannel(Instance ci, unsigned int channel) cons
     return false;
 }
 
-size_t FRenderableManager::getPrimitiveCount(Instance instance, uint8_t level) const noexcept {
-    return getRenderPrimitives(instance, level).size();
+size_t FRenderableManager::getPrimitiveCount(Instance instance) const noexcept {
+    Slice<FRenderPrimitive> const& primitives = mManager[instance].primitives;
+    return primitives.size();
 }
 
 } // namespace filament
@@ -38,6 +38,8 @@
 #include <utils/Slice.h>
 #include <utils/Range.h>
 
+#include <algorithm>
+
 namespace filament {
 
 class FBufferObject;
@@ -65,6 +67,7 @@ public:
         bool screenSpaceContactShadows  : 1;
         bool reversedWindingOrder       : 1;
         bool fog                        : 1;
+        bool staticShadowCaster         : 1;
     };
 
     static_assert(sizeof(Visibility) == sizeof(uint16_t), "Visibility should be 16 bits");
@@ -75,7 +78,17 @@ public:
         uint32_t count = 0;
     };
 
-    explicit FRenderableManager(FEngine& engine) noexcept;
+    // A range of the renderable's primitives, see Builder::levelOfDetail()
+    struct Level {
+        utils::Slice<FRenderPrimitive> primitives;
+        utils::Slice<MorphTargets> morphTargets;
+        float screenSize;       // projected size below which this level is used
+    };
+
+    // Relative margin around the level screen sizes, within which the level doesn't change.
+    static constexpr float LOD_HYSTERESIS = 0.1f;
+
+    FRenderableManager(FEngine& engine, size_t lookupTableSize) noexcept;
     ~FRenderableManager();
 
     // free-up all resources
@@ -130,6 +143,7 @@ public:
     inline void setLayerMask(Instance instance, uint8_t layerMask) noexcept;
     inline void setReceiveShadows(Instance instance, bool enable) noexcept;
     inline void setScreenSpaceContactShadows(Instance instance, bool enable) noexcept;
+    inline void setStaticShadowCaster(Instance instance, bool enable) noexcept;
     inline void setCulling(Instance instance, bool enable) noexcept;
     inline void setFogEnabled(Instance instance, bool enable) noexcept;
     inline bool getFogEnabled(Instance instance) const noexcept;
@@ -154,14 +168,16 @@ public:
 
     inline bool isShadowCaster(Instance instance) const noexcept;
     inline bool isShadowReceiver(Instance instance) const noexcept;
+    inline bool isStaticShadowCaster(Instance instance) const noexcept;
     inline bool isCullingEnabled(Instance instance) const noexcept;
-
+    inline bool isScreenSpaceContactShadowsEnabled(Instance instance) const noexcept;
 
     inline Box const& getAABB(Instance instance) const noexcept;
     inline Box const& getAxisAlignedBoundingBox(Instance instance) const noexcept { return getAABB(instance); }
     inline Visibility getVisibility(Instance instance) const noexcept;
     inline uint8_t getLayerMask(Instance instance) const noexcept;
     inline uint8_t getPriority(Instance instance) const noexcept;
+    inline uint8_t getChannel(Instance instance) const noexcept;
     inline uint8_t getChannels(Instance instance) const noexcept;
 
     struct SkinningBindingInfo {
@@ -192,23 +208,40 @@ public:
     static_assert(sizeof(InstancesInfo) == 16);
     inline InstancesInfo getInstancesInfo(Instance instance) const noexcept;
 
-    inline size_t getLevelCount(Instance) const noexcept { return 1u; }
-    size_t getPrimitiveCount(Instance instance, uint8_t level) const noexcept;
-    void setMaterialInstanceAt(Instance instance, uint8_t level,
+    // Per-primitive APIs below use the primitive indices given to the Builder, i.e. across
+    // all levels of detail.
+    size_t getPrimitiveCount(Instance instance) const noexcept;
+    void setMaterialInstanceAt(Instance instance,
             size_t primitiveIndex, FMaterialInstance const* materialInstance);
-    MaterialInstance* getMaterialInstanceAt(Instance instance, uint8_t level, size_t primitiveIndex) const noexcept;
-    void setGeometryAt(Instance instance, uint8_t level, size_t primitiveIndex,
+    MaterialInstance* getMaterialInstanceAt(Instance instance, size_t primitiveIndex) const noexcept;
+    void setGeometryAt(Instance instance, size_t primitiveIndex,
             PrimitiveType type, FVertexBuffer* vertices, FIndexBuffer* indices,
             size_t offset, size_t count) noexcept;
-    void setBlendOrderAt(Instance instance, uint8_t level, size_t primitiveIndex, uint16_t blendOrder) noexcept;
-    void setGlobalBlendOrderEnabledAt(Instance instance, uint8_t level, size_t primitiveIndex, bool enabled) noexcept;
-    AttributeBitset getEnabledAttributesAt(Instance instance, uint8_t level, size_t primitiveIndex) const noexcept;
+    void setBlendOrderAt(Instance instance, size_t primitiveIndex, uint16_t blendOrder) noexcept;
+    void setGlobalBlendOrderEnabledAt(Instance instance, size_t primitiveIndex, bool enabled) noexcept;
+    AttributeBitset getEnabledAttributesAt(Instance instance, size_t primitiveIndex) const noexcept;
+
+    // Levels of detail. The primitives and morph targets of a level are sub-slices of the
+    // renderable's.
+    inline size_t getLevelCount(Instance instance) const noexcept;
     inline utils::Slice<FRenderPrimitive> const& getRenderPrimitives(Instance instance, uint8_t level) const noexcept;
-    inline utils::Slice<FRenderPrimitive>& getRenderPrimitives(Instance instance, uint8_t level) noexcept;
     inline utils::Slice<MorphTargets> const& getMorphTargets(Instance instance, uint8_t level) const noexcept;
-    inline utils::Slice<MorphTargets>& getMorphTargets(Instance instance, uint8_t level) noexcept;
+
+    // Returns the level to use for the given projected size, given the level selected
+    // previously, which provides the hysteresis.
+    inline uint8_t selectLevel(Instance instance, float screenSize,
+            uint8_t previous) const noexcept;
+
+    // Incremented whenever the geometry, materials, skinning or morphing of the renderable are
+    // changed through the RenderableManager, used to invalidate cached static shadow maps.
+    inline uint32_t getGeneration(Instance instance) const noexcept;
+
+    // Whether any renderable has more than one level of detail.
+    bool hasLevelsOfDetail() const noexcept { return mLevelOfDetailCount > 0; }
 
 private:
+    inline void invalidate(Instance instance) noexcept;
+
     void destroyComponent(Instance ci) noexcept;
     static void destroyComponentPrimitives(
             HwRenderPrimitiveFactory& factory, backend::DriverApi& driver,
@@ -232,6 +265,11 @@ private:
     };
     static_assert(sizeof(MorphWeights) == 8);
 
+    struct LevelOfDetail {
+        Level const* levels = nullptr;  // nullptr when the renderable has a single level
+        uint8_t count = 1;
+    };
+
     enum {
         AABB,                   // user data
         LAYERS,                 // user data
@@ -241,7 +279,9 @@ private:
         VISIBILITY,             // user data
         PRIMITIVES,             // user data
         BONES,                  // filament data, UBO storing a pointer to the bones information
-        MORPH_TARGETS
+        MORPH_TARGETS,
+        LODS,                   // user data
+        GENERATION              // filament data, incremented when the renderable's shape changes
     };
 
     using Base = utils::SingleInstanceComponentManager<
@@ -253,7 +293,9 @@ private:
             Visibility,                      // VISIBILITY
             utils::Slice<FRenderPrimitive>,  // PRIMITIVES
             Bones,                           // BONES
-            utils::Slice<MorphTargets>       // MORPH_TARGETS
+            utils::Slice<MorphTargets>,      // MORPH_TARGETS
+            LevelOfDetail,                   // LODS
+            uint32_t                         // GENERATION
     >;
 
     struct Sim : public Base {
@@ -277,6 +319,8 @@ private:
                 Field<PRIMITIVES>           primitives;
                 Field<BONES>                bones;
                 Field<MORPH_TARGETS>        morphTargets;
+                Field<LODS>                 lods;
+                Field<GENERATION>           generation;
             };
         };
 
@@ -291,6 +335,8 @@ private:
     Sim mManager;
     FEngine& mEngine;
     HwRenderPrimitiveFactory mHwRenderPrimitiveFactory;
+    size_t mLevelOfDetailCount = 0;     // number of renderables with more than one level
+    uint32_t mGeneration = 0;           // last generation given to a renderable
 };
 
 FILAMENT_DOWNCAST(RenderableManager)
@@ -350,6 +396,14 @@ void FRenderableManager::setScreenSpaceContactShadows(Instance instance, bool en
     }
 }
 
+void FRenderableManager::setStaticShadowCaster(Instance instance, bool enable) noexcept {
+    if (instance) {
+        Visibility& visibility = mManager[instance].visibility;
+        visibility.staticShadowCaster = enable;
+        invalidate(instance);
+    }
+}
+
 void FRenderableManager::setCulling(Instance instance, bool enable) noexcept {
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
@@ -372,6 +426,7 @@ void FRenderableManager::setSkinning(Instance instance, bool enable) noexcept {
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.skinning = enable;
+        invalidate(instance);
     }
 }
 
@@ -379,6 +434,7 @@ void FRenderableManager::setMorphing(Instance instance, bool enable) noexcept {
     if (instance) {
         Visibility& visibility = mManager[instance].visibility;
         visibility.morphing = enable;
+        invalidate(instance);
     }
 }
 
@@ -386,6 +442,7 @@ void FRenderableManager::setPrimitives(Instance instance,
         utils::Slice<FRenderPrimitive> const& primitives) noexcept {
     if (instance) {
         mManager[instance].primitives = primitives;
+        invalidate(instance);
     }
 }
 
@@ -402,10 +459,18 @@ bool FRenderableManager::isShadowReceiver(Instance instance) const noexcept {
     return getVisibility(instance).receiveShadows;
 }
 
+bool FRenderableManager::isStaticShadowCaster(Instance instance) const noexcept {
+    return getVisibility(instance).staticShadowCaster;
+}
+
 bool FRenderableManager::isCullingEnabled(Instance instance) const noexcept {
     return getVisibility(instance).culling;
 }
 
+bool FRenderableManager::isScreenSpaceContactShadowsEnabled(Instance instance) const noexcept {
+    return getVisibility(instance).screenSpaceContactShadows;
+}
+
 uint8_t FRenderableManager::getLayerMask(Instance instance) const noexcept {
     return mManager[instance].layers;
 }
@@ -414,6 +479,10 @@ uint8_t FRenderableManager::getPriority(Instance instance) const noexcept {
     return getVisibility(instance).priority;
 }
 
+uint8_t FRenderableManager::getChannel(Instance instance) const noexcept {
+    return getVisibility(instance).channel;
+}
+
 uint8_t FRenderableManager::getChannels(Instance instance) const noexcept {
     return mManager[instance].channels;
 }
@@ -445,24 +514,58 @@ FRenderableManager::getInstancesInfo(Instance instance) const noexcept {
     return mManager[instance].instances;
 }
 
-utils::Slice<FRenderPrimitive> const& FRenderableManager::getRenderPrimitives(
-        Instance instance, uint8_t level) const noexcept {
-    return mManager[instance].primitives;
+size_t FRenderableManager::getLevelCount(Instance instance) const noexcept {
+    LevelOfDetail const& lods = mManager[instance].lods;
+    return lods.count;
 }
 
-utils::Slice<FRenderPrimitive>& FRenderableManager::getRenderPrimitives(
-        Instance instance, uint8_t level) noexcept {
-    return mManager[instance].primitives;
+utils::Slice<FRenderPrimitive> const& FRenderableManager::getRenderPrimitives(
+        Instance instance, uint8_t level) const noexcept {
+    LevelOfDetail const& lods = mManager[instance].lods;
+    if (UTILS_LIKELY(!lods.levels)) {
+        return mManager[instance].primitives;
+    }
+    assert_invariant(level < lods.count);
+    return lods.levels[level].primitives;
 }
 
 utils::Slice<FRenderableManager::MorphTargets> const& FRenderableManager::getMorphTargets(
         Instance instance, uint8_t level) const noexcept {
-    return mManager[instance].morphTargets;
+    LevelOfDetail const& lods = mManager[instance].lods;
+    if (UTILS_LIKELY(!lods.levels)) {
+        return mManager[instance].morphTargets;
+    }
+    assert_invariant(level < lods.count);
+    return lods.levels[level].morphTargets;
 }
 
-utils::Slice<FRenderableManager::MorphTargets>& FRenderableManager::getMorphTargets(
-        Instance instance, uint8_t level) noexcept {
-    return mManager[instance].morphTargets;
+uint32_t FRenderableManager::getGeneration(Instance instance) const noexcept {
+    return mManager[instance].generation;
+}
+
+void FRenderableManager::invalidate(Instance instance) noexcept {
+    // generations are unique across renderables, so that a recycled instance never matches
+    mManager[instance].generation = ++mGeneration;
+}
+
+uint8_t FRenderableManager::selectLevel(Instance instance, float screenSize,
+        uint8_t previous) const noexcept {
+    LevelOfDetail const& lods = mManager[instance].lods;
+    if (UTILS_LIKELY(!lods.levels)) {
+        return 0;
+    }
+    // move to a coarser level only once well below its screen size, and back to a finer level
+    // only once well above it.
+    Level const* const levels = lods.levels;
+    uint8_t level = std::min(previous, uint8_t(lods.count - 1));
+    while (level + 1 < lods.count &&
+           screenSize < levels[level + 1].screenSize * (1.0f - LOD_HYSTERESIS)) {
+        level++;
+    }
+    while (level > 0 && screenSize > levels[level].screenSize * (1.0f + LOD_HYSTERESIS)) {
+        level--;
+    }
+    return level;
 }
 
 } // namespace filament
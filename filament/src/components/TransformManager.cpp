@@ -27,7 +27,9 @@ using namespace filament::math;
 
 namespace filament {
 
-FTransformManager::FTransformManager() noexcept = default;
+FTransformManager::FTransformManager(size_t lookupTableSize) noexcept {
+    mManager.enableDirectLookup(lookupTableSize);
+}
 
 FTransformManager::~FTransformManager() noexcept = default;
 
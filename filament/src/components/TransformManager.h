@@ -34,7 +34,7 @@ class UTILS_PRIVATE FTransformManager : public TransformManager {
 public:
     using Instance = TransformManager::Instance;
 
-    FTransformManager() noexcept;
+    explicit FTransformManager(size_t lookupTableSize) noexcept;
     ~FTransformManager() noexcept;
 
     // free-up all resources
@@ -43,6 +43,7 @@
 #include <backend/DriverEnums.h>
 
 #include <utils/compiler.h>
+#include <utils/CpuTopology.h>
 #include <utils/debug.h>
 #include <utils/Log.h>
 #include <utils/Panic.h>
@@ -191,9 +192,9 @@ FEngine::FEngine(Engine::Builder const& builder) :
         mSharedGLContext(builder->mSharedContext),
         mPostProcessManager(*this),
         mEntityManager(EntityManager::get()),
-        mRenderableManager(*this),
-        mTransformManager(),
-        mLightManager(*this),
+        mRenderableManager(*this, builder->mConfig.componentLookupTableSizeKB * KiB),
+        mTransformManager(builder->mConfig.componentLookupTableSizeKB * KiB),
+        mLightManager(*this, builder->mConfig.componentLookupTableSizeKB * KiB),
         mCameraManager(*this),
         mCommandBufferQueue(
                 builder->mConfig.minCommandBufferSizeMB * MiB,
@@ -203,6 +204,7 @@ FEngine::FEngine(Engine::Builder const& builder) :
                 builder->mConfig.perRenderPassArenaSizeMB * MiB),
         mHeapAllocator("FEngine::mHeapAllocator", AreaPolicy::NullArea{}),
         mJobSystem(getJobSystemThreadPoolSize(builder->mConfig)),
+        mFrameAllocator(mJobSystem),
         mEngineEpoch(std::chrono::steady_clock::now()),
         mDriverBarrier(1),
         mMainThreadId(ThreadUtils::getThreadId()),
@@ -221,8 +223,13 @@ uint32_t FEngine::getJobSystemThreadPoolSize(Engine::Config const& config) noexc
         return config.jobSystemThreadCount;
     }
 
-    // 1 thread for the user, 1 thread for the backend
-    int threadCount = (int)std::thread::hardware_concurrency() - 2;
+    // Only use the CPUs of the NUMA node we're running on, jobs share a lot of data with the
+    // main and backend threads. 1 thread for the user, 1 thread for the backend.
+    CpuTopology const topology = CpuTopology::query();
+    uint32_t const node = topology.getNode(CpuTopology::getCurrentCpu());
+    size_t const cpuCount = node != CpuTopology::INVALID ?
+            topology.getNodeCpuCount(node) : std::thread::hardware_concurrency();
+    int threadCount = int(cpuCount) - 2;
     // make sure we have at least 1 thread though
     threadCount = std::max(1, threadCount);
     return threadCount;
@@ -252,7 +259,9 @@ void FEngine::init() {
     slog.i << "FEngine feature level: " << int(mActiveFeatureLevel) << io::endl;
 
 
-    mResourceAllocator = new ResourceAllocator(driverApi);
+    mResourceAllocator = new ResourceAllocator(driverApi,
+            size_t(mConfig.resourceAllocatorCacheSizeMB) * MiB,
+            mConfig.resourceAllocatorCacheMaxAge);
 
     mFullScreenTriangleVb = downcast(VertexBuffer::Builder()
             .vertexCount(3)
@@ -562,6 +571,23 @@ void FEngine::flush() {
     flushCommandBuffer(mCommandBufferQueue);
 }
 
+void FEngine::trimResourceCache(size_t size) noexcept {
+    ASSERT_PRECONDITION(ThreadUtils::isThisThread(mMainThreadId),
+            "Engine::trimResourceCache() must be called from the Engine's thread");
+    mResourceAllocator->trim(size);
+}
+
+Engine::ResourceCacheStatistics FEngine::getResourceCacheStatistics() const noexcept {
+    auto const stats = mResourceAllocator->getStatistics();
+    return {
+            .hitCount = stats.hitCount,
+            .missCount = stats.missCount,
+            .evictionCount = stats.evictionCount,
+            .cacheSize = stats.cacheSize,
+            .cacheEntryCount = stats.cacheEntryCount
+    };
+}
+
 void FEngine::flushAndWait() {
 
 #if defined(__ANDROID__)
@@ -1156,7 +1182,7 @@ void* FEngine::streamAlloc(size_t size, size_t alignment) noexcept {
 
 bool FEngine::execute() {
     // wait until we get command buffers to be executed (or thread exit requested)
-    auto buffers = mCommandBufferQueue.waitForCommands();
+    auto const& buffers = mCommandBufferQueue.waitForCommands();
     if (UTILS_UNLIKELY(buffers.empty())) {
         return false;
     }
@@ -1286,6 +1312,9 @@ Engine::Config Engine::BuilderDetails::validateConfig(const Config* const pConfi
     config.stereoscopicEyeCount =
             std::clamp(config.stereoscopicEyeCount, uint8_t(1), CONFIG_MAX_STEREOSCOPIC_EYES);
 
+    // a transient texture must survive at least until the next frame to be reused
+    config.resourceAllocatorCacheMaxAge = std::max(config.resourceAllocatorCacheMaxAge, 1u);
+
     return config;
 }
 
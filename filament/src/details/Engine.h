@@ -20,7 +20,9 @@
 #include "downcast.h"
 
 #include "Allocators.h"
+#include "BufferPoolAllocator.h"
 #include "DFG.h"
+#include "FrameAllocator.h"
 #include "PostProcessManager.h"
 #include "ResourceList.h"
 
@@ -144,6 +146,14 @@ public:
     // we'll simply have to use separate Areas (for instance).
     LinearAllocatorArena& getPerRenderPassAllocator() noexcept { return mPerRenderPassAllocator; }
 
+    // Frame-scoped allocator that can be used from any JobSystem thread, its memory is
+    // reclaimed at the end of each frame (see FRenderer::endFrame()).
+    FrameAllocator& getFrameAllocator() noexcept { return mFrameAllocator; }
+
+    // Buffers for instanced UBO uploads too large for the command stream, they're returned to
+    // the pool by the driver callbacks, which are all called before the Engine is destroyed.
+    BufferPoolAllocator<3>& getInstancedUboPool() noexcept { return mInstancedUboPool; }
+
     // Material IDs...
     uint32_t getMaterialId() const noexcept { return mMaterialId++; }
 
@@ -188,6 +198,14 @@ public:
         return CONFIG_MAX_STEREOSCOPIC_EYES;
     }
 
+    void trimResourceCache(size_t size) noexcept;
+
+    ResourceCacheStatistics getResourceCacheStatistics() const noexcept;
+
+    HandleAllocatorStatistics getHandleAllocatorStatistics() const noexcept {
+        return getDriver().getHandleAllocatorStatistics();
+    }
+
     PostProcessManager const& getPostProcessManager() const noexcept {
         return mPostProcessManager;
     }
@@ -408,6 +426,7 @@ public:
     backend::Handle<backend::HwTexture> getOneTextureArray() const { return mDummyOneTextureArray; }
     backend::Handle<backend::HwTexture> getZeroTextureArray() const { return mDummyZeroTextureArray; }
 
+    static constexpr const size_t KiB = 1024u;
     static constexpr const size_t MiB = 1024u * 1024u;
     size_t getMinCommandBufferSize() const noexcept { return mConfig.minCommandBufferSizeMB * MiB; }
     size_t getCommandBufferSize() const noexcept { return mConfig.commandBufferSizeMB * MiB; }
@@ -514,6 +533,9 @@ private:
     utils::JobSystem mJobSystem;
     static uint32_t getJobSystemThreadPoolSize(Engine::Config const& config) noexcept;
 
+    FrameAllocator mFrameAllocator;
+    BufferPoolAllocator<3> mInstancedUboPool;
+
     std::default_random_engine mRandomEngine;
 
     Epoch mEngineEpoch;
@@ -552,6 +574,7 @@ public:
             bool focus_shadowcasters = true;
             bool visualize_cascades = false;
             bool tightly_bound_scene = true;
+            bool static_cache = true;
             float dzn = -1.0f;
             float dzf =  1.0f;
         } shadowmap;
@@ -568,7 +591,15 @@ public:
             // capture to file. At the moment, only supported by the Metal backend.
             bool doFrameCapture = false;
             bool disable_buffer_padding = false;
+            // When set to true, the final upscaling and blending are done by the last
+            // post-processing pass instead of a dedicated one.
+            bool merge_post_process = true;
         } renderer;
+        struct {
+            // When set to true, the FrameGraph reorders independent passes to minimize the
+            // peak transient memory.
+            bool reorder_passes = false;
+        } framegraph;
         struct {
             bool debug_froxel_visualization = false;
         } lighting;
@@ -162,6 +162,7 @@ void FMaterialInstance::terminate(FEngine& engine) {
 }
 
 void FMaterialInstance::commitSlow(DriverApi& driver) const {
+    mGeneration++;
     // update uniforms if needed
     if (mUniforms.isDirty()) {
         driver.updateBufferObject(mUbHandle, mUniforms.toBufferDescriptor(driver), 0);
@@ -258,6 +259,7 @@ void FMaterialInstance::setTransparencyMode(TransparencyMode mode) noexcept {
 
 void FMaterialInstance::setDepthCulling(bool enable) noexcept {
     mDepthFunc = enable ? RasterState::DepthFunc::GE : RasterState::DepthFunc::A;
+    mGeneration++;
 }
 
 bool FMaterialInstance::isDepthCullingEnabled() const noexcept {
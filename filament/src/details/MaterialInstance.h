@@ -89,6 +89,10 @@ public:
 
     backend::CullingMode getCullingMode() const noexcept { return mCulling; }
 
+    // Incremented when the parameters or the culling and depth state of this instance change,
+    // used to invalidate cached static shadow maps.
+    uint32_t getGeneration() const noexcept { return mGeneration; }
+
     bool isColorWriteEnabled() const noexcept { return mColorWrite; }
 
     bool isDepthWriteEnabled() const noexcept { return mDepthWrite; }
@@ -103,6 +107,7 @@ public:
 
     void setDepthFunc(backend::RasterState::DepthFunc depthFunc) noexcept {
         mDepthFunc = depthFunc;
+        mGeneration++;
     }
 
     void setPolygonOffset(float scale, float constant) noexcept {
@@ -130,11 +135,17 @@ public:
 
     void setTransparencyMode(TransparencyMode mode) noexcept;
 
-    void setCullingMode(CullingMode culling) noexcept { mCulling = culling; }
+    void setCullingMode(CullingMode culling) noexcept {
+        mCulling = culling;
+        mGeneration++;
+    }
 
     void setColorWrite(bool enable) noexcept { mColorWrite = enable; }
 
-    void setDepthWrite(bool enable) noexcept { mDepthWrite = enable; }
+    void setDepthWrite(bool enable) noexcept {
+        mDepthWrite = enable;
+        mGeneration++;
+    }
 
     void setStencilWrite(bool enable) noexcept { mStencilState.stencilWrite = enable; }
 
@@ -261,6 +272,9 @@ private:
 
     uint64_t mMaterialSortingKey = 0;
 
+    // parameters are counted when they're committed, which is why this is mutable
+    mutable uint32_t mGeneration = 0;
+
     // Scissor rectangle is specified as: Left Bottom Width Height.
     backend::Viewport mScissorRect = { 0, 0,
             (uint32_t)std::numeric_limits<int32_t>::max(),
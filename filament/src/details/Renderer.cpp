@@ -70,6 +70,10 @@ FRenderer::FRenderer(FEngine& engine) :
             &engine.debug.renderer.doFrameCapture);
     debugRegistry.registerProperty("d.renderer.disable_buffer_padding",
             &engine.debug.renderer.disable_buffer_padding);
+    debugRegistry.registerProperty("d.renderer.merge_post_process",
+            &engine.debug.renderer.merge_post_process);
+    debugRegistry.registerProperty("d.framegraph.reorder_passes",
+            &engine.debug.framegraph.reorder_passes);
 
     DriverApi& driver = engine.getDriverApi();
 
@@ -319,6 +323,9 @@ void FRenderer::endFrame() {
 
     // make sure we're done with the gcs
     js.waitAndRelease(job);
+
+    // all jobs of this frame are done, reclaim the per-frame memory
+    engine.getFrameAllocator().reset();
 }
 
 void FRenderer::readPixels(uint32_t xoffset, uint32_t yoffset, uint32_t width, uint32_t height,
@@ -409,6 +416,9 @@ void FRenderer::renderStandaloneView(FView const* view) {
         renderInternal(view);
 
         driver.endFrame(mFrameId);
+
+        // standalone views are rendered outside of beginFrame() / endFrame()
+        engine.getFrameAllocator().reset();
     }
 }
 
@@ -649,6 +659,7 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
      */
 
     FrameGraph fg(engine.getResourceAllocator());
+    fg.setPassReorderingEnabled(engine.debug.framegraph.reorder_passes);
     auto& blackboard = fg.getBlackboard();
 
     /*
@@ -742,11 +753,7 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
      * Depth + Color passes
      */
 
-    // updatePrimitivesLod must be run before appendCommands and once for each set
-    // of RenderPass::setCamera / RenderPass::setGeometry calls.
-    view.updatePrimitivesLod(engine, cameraInfo,
-            scene.getRenderableData(), view.getVisibleRenderables());
-
+    // levels of detail were selected by FView::prepare()
     pass.setCamera(cameraInfo);
     pass.setGeometry(scene.getRenderableData(), view.getVisibleRenderables(), scene.getRenderableUBO());
 
@@ -1040,12 +1047,32 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
             flare = flare_;
         }
 
+        // The last full-screen pass of the chain (FXAA or color grading) can do the final
+        // compositing itself, i.e. the bilinear upscaling and/or the blending into the
+        // destination, which saves a render target round-trip and a draw. FXAA only blends:
+        // it filters the texels of its input, so it must run at the input resolution.
+        PostProcessManager::CompositingConfig compositingConfig{};
+        if (engine.debug.renderer.merge_post_process &&
+                (hasFXAA || (hasColorGrading && !colorGradingConfig.asSubpass))) {
+            if (scaled && dsrOptions.quality == QualityLevel::LOW && !hasFXAA) {
+                auto const& viewport = DEBUG_DYNAMIC_SCALING ? xvp : vp;
+                compositingConfig = { viewport.width, viewport.height, needsAlphaChannel };
+            } else if (!scaled && blendModeTranslucent) {
+                compositingConfig = { vp.width, vp.height, true };
+            }
+        }
+        const bool mergedCompositing = compositingConfig.width != 0;
+        if (mergedCompositing) {
+            mightNeedFinalBlit = false;
+        }
+
         if (hasColorGrading) {
             if (!colorGradingConfig.asSubpass) {
                 input = ppm.colorGrading(fg, input, xvp,
                         bloom, flare,
                         colorGrading, colorGradingConfig,
-                        bloomOptions, vignetteOptions);
+                        bloomOptions, vignetteOptions,
+                        hasFXAA ? PostProcessManager::CompositingConfig{} : compositingConfig);
                 // the padded buffer is resolved now
                 xvp.left = xvp.bottom = 0;
                 svp = xvp;
@@ -1054,12 +1081,12 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
 
         if (hasFXAA) {
             input = ppm.fxaa(fg, input, xvp, colorGradingConfig.ldrFormat,
-                    !hasColorGrading || needsAlphaChannel);
+                    !hasColorGrading || needsAlphaChannel, compositingConfig);
             // the padded buffer is resolved now
             xvp.left = xvp.bottom = 0;
             svp = xvp;
         }
-        if (scaled) {
+        if (scaled && !mergedCompositing) {
             mightNeedFinalBlit = false;
             auto viewport = DEBUG_DYNAMIC_SCALING ? xvp : vp;
             input = ppm.upscale(fg, needsAlphaChannel, dsrOptions, input, xvp, {
@@ -1119,7 +1146,11 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
 
     fg.present(fgViewRenderTarget);
 
-    fg.compile();
+    fg.compile(mFrameGraphCache);
+
+    SYSTRACE_CONTEXT();
+    SYSTRACE_VALUE32("fgPeakTransientKiB", fg.getTransientMemoryInfo().peak >> 10u);
+    SYSTRACE_VALUE32("fgTotalTransientKiB", fg.getTransientMemoryInfo().total >> 10u);
 
     //fg.export_graphviz(slog.d, view.getName());
 
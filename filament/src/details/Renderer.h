@@ -31,6 +31,7 @@
 
 #include <fg/FrameGraphId.h>
 #include <fg/FrameGraphTexture.h>
+#include <fg/FrameGraphTopologyCache.h>
 
 #include <filament/Renderer.h>
 #include <filament/Viewport.h>
@@ -190,6 +191,9 @@ private:
 
     // per-frame arena for this Renderer
     LinearAllocatorArena& mPerRenderPassArena;
+
+    // compiled FrameGraph structures, reused across frames
+    FrameGraphTopologyCache mFrameGraphCache;
 };
 
 FILAMENT_DOWNCAST(Renderer)
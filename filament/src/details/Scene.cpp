@@ -33,6 +33,7 @@
 #include <utils/Range.h>
 #include <utils/Systrace.h>
 
+#include <math/batch.h>
 #include <math/quat.h>
 
 #include <algorithm>
@@ -182,9 +183,6 @@ void FScene::prepare(utils::JobSystem& js,
                     worldTransform * tcm.getWorldTransformAccurate(ti) };
             const bool reversedWindingOrder = det(shaderWorldTransform.upperLeft()) < 0;
 
-            // compute the world AABB so we can perform culling
-            const Box worldAABB = rigidTransform(rcm.getAABB(ri), shaderWorldTransform);
-
             auto visibility = rcm.getVisibility(ri);
             visibility.reversedWindingOrder = reversedWindingOrder;
             if (shadowReceiversAreCasters && visibility.receiveShadows) {
@@ -206,16 +204,34 @@ void FScene::prepare(utils::JobSystem& js,
             sceneData.elementAt<SKINNING_BUFFER>(index)     = rcm.getSkinningBufferInfo(ri);
             sceneData.elementAt<MORPHING_BUFFER>(index)     = rcm.getMorphingBufferInfo(ri);
             sceneData.elementAt<INSTANCES>(index)           = rcm.getInstancesInfo(ri);
-            sceneData.elementAt<WORLD_AABB_CENTER>(index)   = worldAABB.center;
             sceneData.elementAt<VISIBLE_MASK>(index)        = 0;
             sceneData.elementAt<CHANNELS>(index)            = rcm.getChannels(ri);
             sceneData.elementAt<LAYERS>(index)              = rcm.getLayerMask(ri);
-            sceneData.elementAt<WORLD_AABB_EXTENT>(index)   = worldAABB.halfExtent;
             //sceneData.elementAt<PRIMITIVES>(index)          = {}; // already initialized, Slice<>
             sceneData.elementAt<SUMMED_PRIMITIVE_COUNT>(index) = 0;
             //sceneData.elementAt<UBO>(index)                 = {}; // not needed here
             sceneData.elementAt<USER_DATA>(index)           = scale;
         }
+
+        // compute the world AABBs so we can perform culling, a block at a time
+        constexpr size_t BLOCK_SIZE = 64;
+        float3 centers[BLOCK_SIZE];
+        float3 halfExtents[BLOCK_SIZE];
+        size_t const start = std::distance(first, p);
+        for (size_t i = 0; i < c; i += BLOCK_SIZE) {
+            size_t const n = std::min(BLOCK_SIZE, size_t(c - i));
+            for (size_t j = 0; j < n; j++) {
+                Box const& aabb = rcm.getAABB(p[i + j].first);
+                centers[j] = aabb.center;
+                halfExtents[j] = aabb.halfExtent;
+            }
+            size_t const index = start + i;
+            math::batch::transformBoxes(
+                    &sceneData.elementAt<WORLD_AABB_CENTER>(index),
+                    &sceneData.elementAt<WORLD_AABB_EXTENT>(index),
+                    &sceneData.elementAt<WORLD_TRANSFORM>(index),
+                    centers, halfExtents, n);
+        }
     };
 
     auto lightWork = [first = lightInstances.data(), &lcm, &tcm, &worldTransform,
@@ -248,7 +264,7 @@ void FScene::prepare(utils::JobSystem& js,
 
     auto* renderableJob = jobs::parallel_for(js, rootJob,
             renderableInstances.data(), renderableInstances.size(),
-            std::cref(renderableWork), jobs::CountSplitter<128, 5>());
+            std::cref(renderableWork), jobs::ChunkSplitter<128>());
 
     auto* lightJob = jobs::parallel_for(js, rootJob,
             lightInstances.data(), lightInstances.size(),
@@ -423,25 +439,29 @@ void FScene::updateUBOs(
         buffer[i] = uboData[i];
     }
 
-    // We capture state shared between Scene and the update buffer callback, because the Scene could
-    // be destroyed before the callback executes.
-    std::weak_ptr<SharedState>* const weakShared = new std::weak_ptr<SharedState>(mSharedState);
-
     // update the UBO
     driver.resetBufferObject(renderableUbh);
-    driver.updateBufferObjectUnsynchronized(renderableUbh, {
-            buffer, count * sizeof(PerRenderableData),
-            +[](void* p, size_t s, void* user) {
-                std::weak_ptr<SharedState>* const weakShared =
-                        static_cast<std::weak_ptr<SharedState>*>(user);
-                if (s >= MAX_STREAM_ALLOCATION_COUNT * sizeof(PerRenderableData)) {
+    if (count < MAX_STREAM_ALLOCATION_COUNT) {
+        // the command stream owns the buffer, no callback needed
+        driver.updateBufferObjectUnsynchronized(renderableUbh, {
+                buffer, count * sizeof(PerRenderableData) }, 0);
+    } else {
+        // We capture state shared between Scene and the update buffer callback, because the
+        // Scene could be destroyed before the callback executes.
+        std::weak_ptr<SharedState>* const weakShared =
+                new std::weak_ptr<SharedState>(mSharedState);
+        driver.updateBufferObjectUnsynchronized(renderableUbh, {
+                buffer, count * sizeof(PerRenderableData),
+                +[](void* p, size_t, void* user) {
+                    std::weak_ptr<SharedState>* const weakShared =
+                            static_cast<std::weak_ptr<SharedState>*>(user);
                     if (auto state = weakShared->lock()) {
                         state->mBufferPoolAllocator.put(p);
                     }
-                }
-                delete weakShared;
-            }, weakShared
-    }, 0);
+                    delete weakShared;
+                }, weakShared
+        }, 0);
+    }
 
     // update skybox
     if (mSkybox) {
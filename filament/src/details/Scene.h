@@ -105,6 +105,7 @@ public:
 
         // These are temporaries and should be stored out of line
         PRIMITIVES,             //   8 | level-of-detail'ed primitives
+        LOD_LEVEL,              //   1 | level of detail selected by the view
         SUMMED_PRIMITIVE_COUNT, //   4 | summed visible primitive counts
         UBO,                    // 128 |
 
@@ -125,6 +126,7 @@ public:
             uint8_t,                                    // LAYERS
             math::float3,                               // WORLD_AABB_EXTENT
             utils::Slice<FRenderPrimitive>,             // PRIMITIVES
+            uint8_t,                                    // LOD_LEVEL
             uint32_t,                                   // SUMMED_PRIMITIVE_COUNT
             PerRenderableData,                          // UBO
             // FIXME: We need a better way to handle this
@@ -420,6 +420,13 @@ void FTexture::generateMipmaps(FEngine& engine) const noexcept {
     engine.getDriverApi().generateMipmaps(mHandle);
 }
 
+void FTexture::setMinMaxLevels(FEngine& engine, uint8_t minLevel, uint8_t maxLevel) const {
+    ASSERT_PRECONDITION(minLevel <= maxLevel && maxLevel < mLevelCount,
+            "invalid level range [%u, %u] for a texture with %u levels",
+            unsigned(minLevel), unsigned(maxLevel), unsigned(mLevelCount));
+    engine.getDriverApi().setMinMaxLevels(mHandle, minLevel, maxLevel);
+}
+
 bool FTexture::isTextureFormatSupported(FEngine& engine, InternalFormat format) noexcept {
     return engine.getDriverApi().isTextureFormatSupported(format);
 }
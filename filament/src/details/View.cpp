@@ -43,6 +43,8 @@
 #include <math/scalar.h>
 #include <math/fast.h>
 
+#include <cmath>
+#include <limits>
 #include <memory>
 
 using namespace utils;
@@ -479,10 +481,12 @@ void FView::prepare(FEngine& engine, DriverApi& driver, ArenaScope& arena,
         // create and start the prepareVisibleLights job
         // note: this job updates LightData (non const)
         prepareVisibleLightsJob = js.runAndRetain(js.createJob(nullptr,
-                [&engine, &arena, &viewMatrix = cameraInfo.view, &cullingFrustum,
+                [&engine, &viewMatrix = cameraInfo.view, &cullingFrustum,
                  &lightData = scene->getLightData()]
                         (JobSystem&, JobSystem::Job*) {
-                    FView::prepareVisibleLights(engine.getLightManager(), arena,
+                    // this runs concurrently with the main thread, so it can't use its arena
+                    FView::prepareVisibleLights(engine.getLightManager(),
+                            engine.getFrameAllocator(),
                             viewMatrix, cullingFrustum, lightData);
                 }));
     }
@@ -536,14 +540,15 @@ void FView::prepare(FEngine& engine, DriverApi& driver, ArenaScope& arena,
                 //       strictly necessary
                 mPerViewUniforms.prepareDynamicLights(mFroxelizer);
             }
-            // We need to pass viewMatrix by value here because it extends the scope of this
-            // function.
-            std::function<void(JobSystem&, JobSystem::Job*)> froxelizerWork =
-                    [&froxelizer = mFroxelizer, &engine, viewMatrix = cameraInfo.view, &lightData]
+            // viewMatrix must outlive this function, we copy it into per-frame memory, which
+            // also keeps the lambda small enough to be stored in the job itself.
+            mat4f const* const viewMatrix =
+                    engine.getFrameAllocator().make<mat4f>(cameraInfo.view);
+            froxelizeLightsJob = js.runAndRetain(js.createJob(nullptr,
+                    [&froxelizer = mFroxelizer, &engine, viewMatrix, &lightData]
                             (JobSystem&, JobSystem::Job*) {
-                        froxelizer.froxelizeLights(engine, viewMatrix, lightData);
-                    };
-            froxelizeLightsJob = js.runAndRetain(js.createJob(nullptr, std::move(froxelizerWork)));
+                        froxelizer.froxelizeLights(engine, *viewMatrix, lightData);
+                    }));
         }
 
         setFroxelizerSync(froxelizeLightsJob);
@@ -616,6 +621,10 @@ void FView::prepare(FEngine& engine, DriverApi& driver, ArenaScope& arena,
 
         SYSTRACE_NAME_END();
 
+        // select the levels of detail of all the renderables drawn by any pass, including the
+        // shadow casters, this must happen before RenderPass::appendCommands.
+        updatePrimitivesLod(engine, cameraInfo, renderableData, merged);
+
         // TODO: when any spotlight is used, `merged` ends-up being the whole list. However,
         //       some of the items will end-up not being visible by any light. Can we do better?
         //       e.g. could we deffer some of the prepareVisibleRenderables() to later?
@@ -839,7 +848,7 @@ void FView::cullRenderables(JobSystem&,
     functor(0, renderableData.size());
 }
 
-void FView::prepareVisibleLights(FLightManager const& lcm, ArenaScope& rootArena,
+void FView::prepareVisibleLights(FLightManager const& lcm, FrameAllocator& allocator,
         mat4f const& viewMatrix, Frustum const& frustum,
         FScene::LightSoa& lightData) noexcept {
     SYSTRACE_CALL();
@@ -907,14 +916,13 @@ void FView::prepareVisibleLights(FLightManager const& lcm, ArenaScope& rootArena
      * - This helps our limited numbers of spot-shadow as well.
      */
 
-    ArenaScope arena(rootArena.getAllocator());
     size_t const size = visibleLightCount;
     // number of point/spotlights
     size_t const positionalLightCount = size - FScene::DIRECTIONAL_LIGHTS_COUNT;
     if (positionalLightCount) {
         // always allocate at least 4 entries, because the vectorized loops below rely on that
         float* const UTILS_RESTRICT distances =
-                arena.allocate<float>((size + 3u) & ~3u, CACHELINE_SIZE);
+                allocator.alloc<float>((size + 3u) & ~3u, CACHELINE_SIZE);
 
         // pre-compute the lights' distance to the camera, for sorting below
         // - we don't skip the directional light, because we don't care, it's ignored during sorting
@@ -950,14 +958,56 @@ inline void FView::computeLightCameraDistances(
     }
 }
 
-void FView::updatePrimitivesLod(FEngine& engine, const CameraInfo&,
+void FView::updatePrimitivesLod(FEngine& engine, const CameraInfo& camera,
         FScene::RenderableSoa& renderableData, Range visible) noexcept {
     FRenderableManager const& rcm = engine.getRenderableManager();
-    for (uint32_t const index : visible) {
-        uint8_t const level = 0; // TODO: pick the proper level of detail
-        auto ri = renderableData.elementAt<FScene::RENDERABLE_INSTANCE>(index);
-        renderableData.elementAt<FScene::PRIMITIVES>(index) = rcm.getRenderPrimitives(ri, level);
+    auto const* const UTILS_RESTRICT soaInstance = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto* const UTILS_RESTRICT soaPrimitives = renderableData.data<FScene::PRIMITIVES>();
+    auto* const UTILS_RESTRICT soaLevel = renderableData.data<FScene::LOD_LEVEL>();
+
+    if (UTILS_LIKELY(!rcm.hasLevelsOfDetail())) {
+        for (uint32_t const index : visible) {
+            soaPrimitives[index] = rcm.getRenderPrimitives(soaInstance[index], 0);
+            soaLevel[index] = 0;
+        }
+        return;
     }
+
+    SYSTRACE_CALL();
+
+    // The projected size of a renderable is the diameter of its bounding sphere divided by the
+    // height of the viewport, that is radius * p[1][1] / w, where w is the clip-space w of its
+    // center, i.e. its distance to the camera plane, or 1 for orthographic projections.
+    mat4f const& p = camera.projection;
+    float4 const wFromWorld = transpose(camera.view) * float4{ p[0][3], p[1][3], p[2][3], p[3][3] };
+    float const scale = p[1][1] * std::exp2(-mLodBias);
+
+    // instances are unique within the range, so jobs never write the same entry
+    mLodLevels.resize(rcm.getComponentCount() + 1);
+    uint8_t* const UTILS_RESTRICT previousLevels = mLodLevels.data();
+
+    auto work = [&rcm, &renderableData, soaInstance, soaPrimitives, soaLevel, previousLevels,
+            wFromWorld, scale](uint32_t startIndex, uint32_t count) {
+        auto const* const UTILS_RESTRICT soaCenter = renderableData.data<FScene::WORLD_AABB_CENTER>();
+        auto const* const UTILS_RESTRICT soaExtent = renderableData.data<FScene::WORLD_AABB_EXTENT>();
+        auto* const UTILS_RESTRICT soaMorphing = renderableData.data<FScene::MORPHING_BUFFER>();
+        for (uint32_t i = startIndex, e = startIndex + count; i < e; i++) {
+            auto const ri = soaInstance[i];
+            float const w = dot(wFromWorld.xyz, soaCenter[i]) + wFromWorld.w;
+            float const screenSize = w > 0.0f ? scale * length(soaExtent[i]) / w
+                                              : std::numeric_limits<float>::infinity();
+            uint8_t const level = rcm.selectLevel(ri, screenSize, previousLevels[ri.asValue()]);
+            previousLevels[ri.asValue()] = level;
+            soaLevel[i] = level;
+            soaPrimitives[i] = rcm.getRenderPrimitives(ri, level);
+            soaMorphing[i].targets = rcm.getMorphTargets(ri, level).data();
+        }
+    };
+
+    JobSystem& js = engine.getJobSystem();
+    auto* job = jobs::parallel_for(js, nullptr, visible.first, uint32_t(visible.size()),
+            std::cref(work), jobs::CountSplitter<256>());
+    js.runAndWait(job);
 }
 
 FrameGraphId<FrameGraphTexture> FView::renderShadowMaps(FEngine& engine, FrameGraph& fg,
@@ -24,6 +24,7 @@
 #include "downcast.h"
 
 #include "Allocators.h"
+#include "FrameAllocator.h"
 #include "FrameHistory.h"
 #include "FrameInfo.h"
 #include "Froxelizer.h"
@@ -53,6 +54,8 @@
 #include <math/scalar.h>
 #include <math/mat4.h>
 
+#include <vector>
+
 namespace utils {
 class JobSystem;
 } // namespace utils;
@@ -124,6 +127,9 @@ public:
         return mVisibleLayers;
     }
 
+    void setLodBias(float bias) noexcept { mLodBias = bias; }
+    float getLodBias() const noexcept { return mLodBias; }
+
     void setName(const char* name) noexcept {
         mName = utils::CString(name);
     }
@@ -162,6 +168,8 @@ public:
     bool hasDirectionalLight() const noexcept { return mHasDirectionalLight; }
     bool hasDynamicLighting() const noexcept { return mHasDynamicLighting; }
     bool hasShadowing() const noexcept { return mHasShadowing; }
+
+    ShadowMapManager const& getShadowMapManager() const noexcept { return mShadowMapManager; }
     bool needsShadowMap() const noexcept { return mNeedsShadowMap; }
     bool hasFog() const noexcept { return mFogOptions.enabled && mFogOptions.density > 0.0f; }
     bool hasVSM() const noexcept { return mShadowType == ShadowType::VSM; }
@@ -176,6 +184,10 @@ public:
             CameraInfo const& cameraInfo, math::float4 const& userTime,
             RenderPass const& pass) noexcept;
 
+    // Selects the level of detail of the renderables in the given range, stores it in
+    // LOD_LEVEL and sets their primitives accordingly. This is done once per frame, from the
+    // view's camera, for all the passes including the shadow passes, so that shadows match the
+    // geometry that is drawn.
     void updatePrimitivesLod(
             FEngine& engine, const CameraInfo& camera,
             FScene::RenderableSoa& renderableData, Range visible) noexcept;
@@ -458,7 +470,7 @@ private:
     void prepareVisibleRenderables(utils::JobSystem& js,
             Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept;
 
-    static void prepareVisibleLights(FLightManager const& lcm, ArenaScope& rootArena,
+    static void prepareVisibleLights(FLightManager const& lcm, FrameAllocator& allocator,
             math::mat4f const& viewMatrix, Frustum const& frustum,
             FScene::LightSoa& lightData) noexcept;
 
@@ -502,6 +514,12 @@ private:
     FRenderTarget* mRenderTarget = nullptr;
 
     uint8_t mVisibleLayers = 0x1;
+    float mLodBias = 0.0f;
+    // Level of detail selected for each renderable during the previous frame, indexed by
+    // renderable instance, it provides the hysteresis. It is per view since each view selects
+    // its own levels. Instances are recycled, so a renderable can inherit the level of a
+    // destroyed one, which only affects the hysteresis for one frame.
+    std::vector<uint8_t> mLodLevels;
     AntiAliasing mAntiAliasing = AntiAliasing::FXAA;
     Dithering mDithering = Dithering::TEMPORAL;
     bool mShadowingEnabled = true;
@@ -18,6 +18,7 @@
 
 #include <utils/Systrace.h>
 
+#include <algorithm>
 #include <iterator>
 
 namespace filament {
@@ -134,6 +135,20 @@ void DependencyGraph::cull() noexcept {
     }
 }
 
+void DependencyGraph::getRefCounts(std::vector<uint32_t>& refCounts) const noexcept {
+    refCounts.resize(mNodes.size());
+    std::transform(mNodes.begin(), mNodes.end(), refCounts.begin(),
+            [](Node const* pNode) { return pNode->mRefCount; });
+}
+
+void DependencyGraph::setRefCounts(std::vector<uint32_t> const& refCounts) noexcept {
+    assert_invariant(refCounts.size() == mNodes.size());
+    auto& nodes = mNodes;
+    for (size_t i = 0, c = nodes.size(); i < c; i++) {
+        nodes[i]->mRefCount = refCounts[i];
+    }
+}
+
 void DependencyGraph::clear() noexcept {
     mEdges.clear();
     mNodes.clear();
@@ -24,9 +24,16 @@
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
 
+#include <utils/Hash.h>
 #include <utils/Panic.h>
 #include <utils/Systrace.h>
 
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace filament {
 
 inline FrameGraph::Builder::Builder(FrameGraph& fg, PassNode* passNode) noexcept
@@ -98,12 +105,36 @@ void FrameGraph::reset() noexcept {
     mResourceNodes.clear();
     mResources.clear();
     mResourceSlots.clear();
+    mTransientMemoryInfo = {};
 }
 
 FrameGraph& FrameGraph::compile() noexcept {
+    SYSTRACE_CALL();
+    cullAndSchedule();
+    finalizeCompile();
+    return *this;
+}
 
+FrameGraph& FrameGraph::compile(FrameGraphTopologyCache& cache) noexcept {
     SYSTRACE_CALL();
 
+    // the signature is computed into storage owned by the cache, so that it doesn't allocate
+    std::vector<uint32_t>& signature = cache.mSignature;
+    computeSignature(signature);
+    uint32_t const hash = utils::hash::murmur3(signature.data(), signature.size(), 0);
+
+    FrameGraphTopologyCache::Entry const* const entry = cache.find(hash, signature);
+    if (entry) {
+        restoreTopology(*entry);
+    } else {
+        cullAndSchedule();
+        saveTopology(cache.insert(hash, signature));
+    }
+    finalizeCompile();
+    return *this;
+}
+
+void FrameGraph::cullAndSchedule() noexcept {
     DependencyGraph& dependencyGraph = mGraph;
 
     // first we cull unreachable nodes
@@ -119,6 +150,10 @@ FrameGraph& FrameGraph::compile() noexcept {
         return !pPassNode->isCulled();
     });
 
+    if (mPassReorderingEnabled) {
+        reorderPassesForMemory();
+    }
+
     auto first = mPassNodes.begin();
     const auto activePassNodesEnd = mActivePassNodesEnd;
     while (first != activePassNodesEnd) {
@@ -143,8 +178,14 @@ FrameGraph& FrameGraph::compile() noexcept {
             auto pNode = static_cast<ResourceNode*>(dependencyGraph.getNode(edge->to));
             passNode->registerResource(pNode->resourceHandle);
         }
+    }
+}
 
-        passNode->resolve();
+void FrameGraph::finalizeCompile() noexcept {
+    DependencyGraph& dependencyGraph = mGraph;
+
+    for (auto it = mPassNodes.begin(); it != mActivePassNodesEnd; ++it) {
+        (*it)->resolve();
     }
 
     // add resource to de-virtualize or destroy to the corresponding list for each active pass
@@ -174,7 +215,339 @@ FrameGraph& FrameGraph::compile() noexcept {
         pNode->resolveResourceUsage(dependencyGraph);
     }
 
-    return *this;
+    computeTransientMemoryInfo();
+}
+
+void FrameGraph::computeSignature(std::vector<uint32_t>& signature) const noexcept {
+    SYSTRACE_CALL();
+
+    // This captures everything cullAndSchedule() depends on: the graph itself, which nodes
+    // are targets, which resource each ResourceNode refers to and the pass declaration order.
+    DependencyGraph const& dependencyGraph = mGraph;
+    auto const& nodes = dependencyGraph.getNodes();
+    auto const& edges = dependencyGraph.getEdges();
+
+    signature.clear();
+    signature.reserve(4 + nodes.size() + 2 * edges.size() + mPassNodes.size() +
+            3 * mResourceNodes.size() + 2 * mResources.size());
+
+    signature.push_back(mPassReorderingEnabled);
+    signature.push_back(uint32_t(nodes.size()));
+    for (auto const* pNode : nodes) {
+        signature.push_back(pNode->isTarget());
+    }
+    signature.push_back(uint32_t(edges.size()));
+    for (auto const* pEdge : edges) {
+        signature.push_back(pEdge->from);
+        signature.push_back(pEdge->to);
+    }
+    signature.push_back(uint32_t(mPassNodes.size()));
+    for (auto const* pPassNode : mPassNodes) {
+        signature.push_back(pPassNode->getId());
+    }
+    for (auto* pNode : mResourceNodes) {
+        FrameGraphHandle const parent = pNode->getParentHandle();
+        signature.push_back(pNode->getId());
+        signature.push_back(getResourceSlot(pNode->resourceHandle).rid);
+        signature.push_back(parent ?
+                uint32_t(getResourceSlot(parent).rid) : FrameGraphTopologyCache::NONE);
+    }
+    if (mPassReorderingEnabled) {
+        // the pass order depends on the size of the resources
+        for (auto const* pResource : mResources) {
+            uint64_t const size = pResource->getTransientSize();
+            signature.push_back(uint32_t(size));
+            signature.push_back(uint32_t(size >> 32u));
+        }
+    }
+}
+
+void FrameGraph::saveTopology(FrameGraphTopologyCache::Entry& entry) const noexcept {
+    using Cache = FrameGraphTopologyCache;
+
+    mGraph.getRefCounts(entry.refCounts);
+
+    entry.activePasses.clear();
+    entry.declaredHandles.clear();
+    entry.declaredHandlesOffset.clear();
+    for (auto it = mPassNodes.begin(); it != mActivePassNodesEnd; ++it) {
+        PassNode const* const passNode = *it;
+        entry.activePasses.push_back(passNode->getId());
+        entry.declaredHandlesOffset.push_back(uint32_t(entry.declaredHandles.size()));
+        entry.declaredHandles.insert(entry.declaredHandles.end(),
+                passNode->mDeclaredHandles.begin(), passNode->mDeclaredHandles.end());
+    }
+    entry.declaredHandlesOffset.push_back(uint32_t(entry.declaredHandles.size()));
+
+    entry.resources.resize(mResources.size());
+    for (size_t i = 0, c = mResources.size(); i < c; i++) {
+        VirtualResource const* const resource = mResources[i];
+        entry.resources[i] = {
+                resource->refcount,
+                resource->first ? resource->first->getId() : Cache::NONE,
+                resource->last ? resource->last->getId() : Cache::NONE };
+    }
+}
+
+void FrameGraph::restoreTopology(FrameGraphTopologyCache::Entry const& entry) noexcept {
+    using Cache = FrameGraphTopologyCache;
+
+    SYSTRACE_CALL();
+
+    DependencyGraph& dependencyGraph = mGraph;
+
+    // this is equivalent to culling
+    dependencyGraph.setRefCounts(entry.refCounts);
+
+    // active passes in their execution order, followed by the culled ones
+    mActivePassNodesEnd = std::stable_partition(
+            mPassNodes.begin(), mPassNodes.end(), [](auto const& pPassNode) {
+        return !pPassNode->isCulled();
+    });
+    assert_invariant(size_t(mActivePassNodesEnd - mPassNodes.begin()) ==
+            entry.activePasses.size());
+
+    auto const first = mPassNodes.begin();
+    for (size_t i = 0, c = entry.activePasses.size(); i < c; i++) {
+        auto* const passNode = static_cast<PassNode*>(
+                dependencyGraph.getNode(entry.activePasses[i]));
+        assert_invariant(!passNode->isCulled());
+        first[ptrdiff_t(i)] = passNode;
+        passNode->mDeclaredHandles.insert(
+                entry.declaredHandles.begin() + entry.declaredHandlesOffset[i],
+                entry.declaredHandles.begin() + entry.declaredHandlesOffset[i + 1]);
+    }
+
+    auto getPassNode = [&dependencyGraph](uint32_t id) -> PassNode* {
+        return id == Cache::NONE ? nullptr : static_cast<PassNode*>(dependencyGraph.getNode(id));
+    };
+
+    for (size_t i = 0, c = mResources.size(); i < c; i++) {
+        VirtualResource* const resource = mResources[i];
+        resource->refcount = entry.resources[i].refcount;
+        resource->first = getPassNode(entry.resources[i].first);
+        resource->last = getPassNode(entry.resources[i].last);
+    }
+}
+
+UTILS_NOINLINE
+void FrameGraph::reorderPassesForMemory() noexcept {
+
+    SYSTRACE_CALL();
+
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    DependencyGraph& dependencyGraph = mGraph;
+    auto const first = mPassNodes.begin();
+    uint32_t const count = uint32_t(mActivePassNodesEnd - first);
+    if (count < 3) {
+        // there is nothing to gain
+        return;
+    }
+
+    /*
+     * Gather the resources accessed by each active pass. We only track top-level resources,
+     * because subresources share the memory -- and the lifetime -- of their parent.
+     */
+
+    tsl::robin_map<VirtualResource*, uint32_t> resourceIndices;
+    std::vector<size_t> resourceSizes;
+    std::vector<uint32_t> passResources;
+    std::vector<uint32_t> passResourcesOffset(count + 1, 0);
+
+    auto addResource = [&](uint32_t passIndex, FrameGraphHandle handle) {
+        VirtualResource* const resource = getResource(handle)->getResource();
+        auto const pos = resourceIndices.insert({ resource, uint32_t(resourceSizes.size()) });
+        if (pos.second) {
+            resourceSizes.push_back(resource->getTransientSize());
+        }
+        uint32_t const index = pos.first->second;
+        auto const begin = passResources.begin() + passResourcesOffset[passIndex];
+        if (std::find(begin, passResources.end(), index) == passResources.end()) {
+            passResources.push_back(index);
+        }
+    };
+
+    for (uint32_t i = 0; i < count; i++) {
+        PassNode const* const passNode = first[i];
+        passResourcesOffset[i] = uint32_t(passResources.size());
+        for (auto const& edge : dependencyGraph.getIncomingEdges(passNode)) {
+            auto pNode = static_cast<ResourceNode const*>(dependencyGraph.getNode(edge->from));
+            addResource(i, pNode->resourceHandle);
+        }
+        for (auto const& edge : dependencyGraph.getOutgoingEdges(passNode)) {
+            auto pNode = static_cast<ResourceNode const*>(dependencyGraph.getNode(edge->to));
+            addResource(i, pNode->resourceHandle);
+        }
+    }
+    passResourcesOffset[count] = uint32_t(passResources.size());
+
+    auto resourcesOf = [&](uint32_t passIndex) {
+        return std::make_pair(
+                passResources.data() + passResourcesOffset[passIndex],
+                passResources.data() + passResourcesOffset[passIndex + 1]);
+    };
+
+    /*
+     * Build the ordering constraints. A pass must execute after the previous pass (in
+     * declaration order) that accesses any of its resources. Passes that don't declare any
+     * resource can have side effects we don't know about, so they act as barriers.
+     */
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges; // (before, after)
+    std::vector<uint32_t> lastUser(resourceSizes.size(), NONE);
+    uint32_t lastBarrier = NONE;
+    for (uint32_t i = 0; i < count; i++) {
+        auto const [begin, end] = resourcesOf(i);
+        if (begin == end) {
+            for (uint32_t j = (lastBarrier == NONE) ? 0 : lastBarrier; j < i; j++) {
+                edges.emplace_back(j, i);
+            }
+            lastBarrier = i;
+            continue;
+        }
+        if (lastBarrier != NONE) {
+            edges.emplace_back(lastBarrier, i);
+        }
+        for (auto p = begin; p != end; ++p) {
+            if (lastUser[*p] != NONE) {
+                edges.emplace_back(lastUser[*p], i);
+            }
+            lastUser[*p] = i;
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<uint32_t> successorsOffset(count + 1, 0);
+    std::vector<uint32_t> predecessorCount(count, 0);
+    for (auto const& edge : edges) {
+        successorsOffset[edge.first + 1]++;
+        predecessorCount[edge.second]++;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        successorsOffset[i + 1] += successorsOffset[i];
+    }
+
+    // peak memory needed to execute the passes in the given order
+    auto computePeak = [&](std::vector<uint32_t> const& order) {
+        std::vector<uint32_t> users(resourceSizes.size(), 0);
+        for (uint32_t r : passResources) {
+            users[r]++;
+        }
+        std::vector<bool> allocated(resourceSizes.size(), false);
+        size_t current = 0;
+        size_t peak = 0;
+        for (uint32_t i : order) {
+            auto const [begin, end] = resourcesOf(i);
+            for (auto p = begin; p != end; ++p) {
+                if (!allocated[*p]) {
+                    allocated[*p] = true;
+                    current += resourceSizes[*p];
+                }
+            }
+            peak = std::max(peak, current);
+            for (auto p = begin; p != end; ++p) {
+                if (--users[*p] == 0) {
+                    current -= resourceSizes[*p];
+                }
+            }
+        }
+        return peak;
+    };
+
+    /*
+     * Greedy list scheduling: among the passes that are ready to execute, pick the one that
+     * increases the amount of live memory the least. Ties are broken by declaration order,
+     * which yields the declaration order when there is nothing to gain.
+     */
+
+    std::vector<uint32_t> remainingUsers(resourceSizes.size(), 0);
+    for (uint32_t r : passResources) {
+        remainingUsers[r]++;
+    }
+    std::vector<bool> allocated(resourceSizes.size(), false);
+    std::vector<uint32_t> ready;
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!predecessorCount[i]) {
+            ready.push_back(i);
+        }
+    }
+
+    while (!ready.empty()) {
+        auto best = ready.end();
+        int64_t bestDelta = std::numeric_limits<int64_t>::max();
+        for (auto it = ready.begin(); it != ready.end(); ++it) {
+            int64_t delta = 0;
+            auto const [begin, end] = resourcesOf(*it);
+            for (auto p = begin; p != end; ++p) {
+                if (!allocated[*p]) {
+                    delta += int64_t(resourceSizes[*p]);
+                }
+                if (remainingUsers[*p] == 1) {
+                    delta -= int64_t(resourceSizes[*p]);
+                }
+            }
+            if (best == ready.end() || delta < bestDelta ||
+                    (delta == bestDelta && *it < *best)) {
+                bestDelta = delta;
+                best = it;
+            }
+        }
+
+        uint32_t const i = *best;
+        ready.erase(best);
+        order.push_back(i);
+
+        auto const [begin, end] = resourcesOf(i);
+        for (auto p = begin; p != end; ++p) {
+            allocated[*p] = true;
+            remainingUsers[*p]--;
+        }
+        for (uint32_t e = successorsOffset[i]; e < successorsOffset[i + 1]; e++) {
+            uint32_t const successor = edges[e].second;
+            if (--predecessorCount[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+
+    // by construction the constraints are acyclic, so all passes must have been scheduled
+    assert_invariant(order.size() == count);
+
+    std::vector<uint32_t> declaredOrder(count);
+    for (uint32_t i = 0; i < count; i++) {
+        declaredOrder[i] = i;
+    }
+
+    // the greedy heuristic is not optimal, make sure we never do worse than the declared order
+    if (computePeak(order) >= computePeak(declaredOrder)) {
+        return;
+    }
+
+    std::vector<PassNode*> passNodes(first, mActivePassNodesEnd);
+    for (uint32_t i = 0; i < count; i++) {
+        first[i] = passNodes[order[i]];
+    }
+}
+
+void FrameGraph::computeTransientMemoryInfo() noexcept {
+    size_t current = 0;
+    TransientMemoryInfo info;
+    for (auto it = mPassNodes.begin(); it != mActivePassNodesEnd; ++it) {
+        PassNode const* const passNode = *it;
+        for (VirtualResource const* resource : passNode->devirtualize) {
+            size_t const size = resource->getTransientSize();
+            current += size;
+            info.total += size;
+        }
+        info.peak = std::max(info.peak, current);
+        for (VirtualResource const* resource : passNode->destroy) {
+            current -= resource->getTransientSize();
+        }
+    }
+    mTransientMemoryInfo = info;
 }
 
 void FrameGraph::execute(backend::DriverApi& driver) noexcept {
@@ -24,6 +24,7 @@
 #include "fg/FrameGraphPass.h"
 #include "fg/FrameGraphRenderPass.h"
 #include "fg/FrameGraphTexture.h"
+#include "fg/FrameGraphTopologyCache.h"
 
 #include "fg/details/DependencyGraph.h"
 #include "fg/details/Resource.h"
@@ -35,6 +36,7 @@
 #include <backend/Handle.h>
 
 #include <functional>
+#include <vector>
 
 namespace filament {
 
@@ -232,6 +234,12 @@ public:
     /** Empty struct to use for passes with no data */
     struct Empty { };
 
+    /** Transient memory statistics of a FrameGraph, valid after compile() */
+    struct TransientMemoryInfo {
+        size_t peak = 0;    // maximum number of bytes alive at any time during execute()
+        size_t total = 0;   // sum of the sizes of all transient resources
+    };
+
     /**
      * Add a pass to the frame graph. Typically:
      *
@@ -285,6 +293,33 @@ public:
      */
     FrameGraph& compile() noexcept;
 
+    /**
+     * Same as compile(), but reuses the results of a previous compilation of a FrameGraph
+     * with the same structure (i.e. same passes, resources and dependencies) when available
+     * in the cache, and records them otherwise.
+     *
+     * @param cache a FrameGraphTopologyCache that outlives this FrameGraph
+     * @return a reference to the FrameGraph, for chaining calls.
+     */
+    FrameGraph& compile(FrameGraphTopologyCache& cache) noexcept;
+
+    /**
+     * Allows compile() to reorder passes that don't depend on each other, such that the
+     * peak transient memory is minimized. Passes accessing the same resource, as well as passes
+     * that don't declare any resource, keep their declaration order. Disabled by default.
+     *
+     * @param enabled true to enable pass reordering
+     */
+    void setPassReorderingEnabled(bool enabled) noexcept { mPassReorderingEnabled = enabled; }
+
+    /**
+     * Returns the peak and total transient memory needed to execute this FrameGraph.
+     * Only valid after compile().
+     */
+    TransientMemoryInfo const& getTransientMemoryInfo() const noexcept {
+        return mTransientMemoryInfo;
+    }
+
     /**
      * Execute all referenced passes
      *
@@ -512,6 +547,13 @@ private:
     }
 
     void destroyInternal() noexcept;
+    void cullAndSchedule() noexcept;
+    void finalizeCompile() noexcept;
+    void reorderPassesForMemory() noexcept;
+    void computeSignature(std::vector<uint32_t>& signature) const noexcept;
+    void saveTopology(FrameGraphTopologyCache::Entry& entry) const noexcept;
+    void restoreTopology(FrameGraphTopologyCache::Entry const& entry) noexcept;
+    void computeTransientMemoryInfo() noexcept;
 
     Blackboard mBlackboard;
     ResourceAllocatorInterface& mResourceAllocator;
@@ -523,6 +565,8 @@ private:
     Vector<ResourceNode*> mResourceNodes;
     Vector<PassNode*> mPassNodes;
     Vector<PassNode*>::iterator mActivePassNodesEnd;
+    TransientMemoryInfo mTransientMemoryInfo;
+    bool mPassReorderingEnabled = false;
 };
 
 template<typename Data, typename Setup, typename Execute>
@@ -18,6 +18,8 @@
 
 #include "ResourceAllocator.h"
 
+#include "details/Texture.h"
+
 #include <algorithm>
 
 namespace filament {
@@ -51,4 +53,18 @@ FrameGraphTexture::Descriptor FrameGraphTexture::generateSubResourceDescriptor(
     return descriptor;
 }
 
+size_t FrameGraphTexture::getSize(Descriptor const& descriptor) noexcept {
+    size_t const pixelCount = size_t(descriptor.width) * descriptor.height * descriptor.depth;
+    size_t size = pixelCount * FTexture::getFormatSize(descriptor.format);
+    if (descriptor.samples > 1) {
+        // if we have MSAA, we assume N times the storage
+        size *= descriptor.samples;
+    }
+    if (descriptor.levels > 1) {
+        // if we have mip-maps we assume the full pyramid
+        size += size / 3;
+    }
+    return size;
+}
+
 } // namespace filament
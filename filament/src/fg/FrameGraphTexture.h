@@ -36,6 +36,7 @@ namespace filament {
  * And declares and define:
  *      void create(ResourceAllocatorInterface&, const char* name, Descriptor const&, Usage) noexcept;
  *      void destroy(ResourceAllocatorInterface&) noexcept;
+ *      static size_t getSize(Descriptor const&) noexcept;
  */
 struct FrameGraphTexture {
     backend::Handle<backend::HwTexture> handle;
@@ -95,6 +96,13 @@ struct FrameGraphTexture {
      */
     static Descriptor generateSubResourceDescriptor(Descriptor descriptor,
             SubResourceDescriptor const& srd) noexcept;
+
+    /**
+     * Estimates the amount of memory needed by the concrete resource
+     * @param descriptor Descriptor to the resource
+     * @return           size in bytes
+     */
+    static size_t getSize(Descriptor const& descriptor) noexcept;
 };
 
 } // namespace filament
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_FG_FRAMEGRAPHTOPOLOGYCACHE_H
+#define TNT_FILAMENT_FG_FRAMEGRAPHTOPOLOGYCACHE_H
+
+#include <tsl/robin_map.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+
+class FrameGraph;
+
+/**
+ * Keeps the results of FrameGraph::compile() that only depend on the structure of the graph
+ * (culling, pass order, first/last users of resources), so they can be reused by a later
+ * FrameGraph with the same structure. A FrameGraphTopologyCache outlives the FrameGraphs using
+ * it, typically it lives as long as the Renderer.
+ */
+class FrameGraphTopologyCache {
+public:
+    // how many different graph structures we keep around (e.g. one per View)
+    static constexpr size_t CAPACITY = 4;
+
+    FrameGraphTopologyCache() noexcept = default;
+    FrameGraphTopologyCache(FrameGraphTopologyCache const&) = delete;
+    FrameGraphTopologyCache& operator=(FrameGraphTopologyCache const&) = delete;
+
+    void clear() noexcept {
+        mEntries.clear();
+        mIndex.clear();
+    }
+
+    size_t getHitCount() const noexcept { return mHitCount; }
+    size_t getMissCount() const noexcept { return mMissCount; }
+
+private:
+    friend class FrameGraph;
+
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct ResourceInfo {
+        uint32_t refcount = 0;
+        uint32_t first = NONE;      // NodeID of the first pass using the resource
+        uint32_t last = NONE;       // NodeID of the last pass using the resource
+    };
+
+    struct Entry {
+        uint32_t hash = 0;
+        uint64_t lastUsed = 0;
+        std::vector<uint32_t> signature;            // the whole structure, to detect collisions
+        std::vector<uint32_t> refCounts;            // per node, as computed by culling
+        std::vector<uint32_t> activePasses;         // NodeID of active passes, in execution order
+        std::vector<ResourceInfo> resources;        // per VirtualResource
+        std::vector<uint32_t> declaredHandles;      // per active pass, flattened
+        std::vector<uint32_t> declaredHandlesOffset;
+    };
+
+    Entry* find(uint32_t hash, std::vector<uint32_t> const& signature) noexcept {
+        auto const pos = mIndex.find(hash);
+        if (pos == mIndex.end() || mEntries[pos->second].signature != signature) {
+            mMissCount++;
+            return nullptr;
+        }
+        Entry& entry = mEntries[pos->second];
+        mHitCount++;
+        entry.lastUsed = ++mAge;
+        return &entry;
+    }
+
+    Entry& insert(uint32_t hash, std::vector<uint32_t> const& signature) noexcept {
+        size_t index;
+        if (mEntries.size() < CAPACITY) {
+            index = mEntries.size();
+            mEntries.emplace_back();
+        } else {
+            // evict the least recently used entry
+            index = size_t(std::min_element(mEntries.begin(), mEntries.end(),
+                    [](Entry const& lhs, Entry const& rhs) {
+                        return lhs.lastUsed < rhs.lastUsed;
+                    }) - mEntries.begin());
+            auto const pos = mIndex.find(mEntries[index].hash);
+            if (pos != mIndex.end() && pos->second == index) {
+                mIndex.erase(pos);
+            }
+            mEntries[index] = {};
+        }
+        // on a hash collision, the new entry replaces the old one in the index
+        mIndex[hash] = uint32_t(index);
+        Entry& entry = mEntries[index];
+        entry.hash = hash;
+        entry.lastUsed = ++mAge;
+        entry.signature = signature;
+        return entry;
+    }
+
+    std::vector<Entry> mEntries;
+    tsl::robin_map<uint32_t, uint32_t> mIndex;      // hash -> index in mEntries
+    std::vector<uint32_t> mSignature;               // scratch storage, reused every frame
+    uint64_t mAge = 0;
+    size_t mHitCount = 0;
+    size_t mMissCount = 0;
+};
+
+} // namespace filament
+
+#endif // TNT_FILAMENT_FG_FRAMEGRAPHTOPOLOGYCACHE_H
@@ -163,6 +163,20 @@ public:
     //! cull unreferenced nodes. Links ARE NOT removed, only reference counts are updated.
     void cull() noexcept;
 
+    /**
+     * Returns the reference counts of all nodes, indexed by NodeID.
+     * Valid only after cull() is called.
+     * @param refCounts vector receiving the reference counts
+     */
+    void getRefCounts(std::vector<uint32_t>& refCounts) const noexcept;
+
+    /**
+     * Restores reference counts returned by getRefCounts() on a graph with the same structure.
+     * This is equivalent to calling cull().
+     * @param refCounts reference counts indexed by NodeID
+     */
+    void setRefCounts(std::vector<uint32_t> const& refCounts) noexcept;
+
     /**
      * Return whether an edge is valid, that is if both ends are connected to nodes
      * that are not culled. Valid only after cull() is called.
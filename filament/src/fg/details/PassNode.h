@@ -41,6 +41,7 @@ class ResourceNode;
 
 class PassNode : public DependencyGraph::Node {
 protected:
+    friend class FrameGraph;
     friend class FrameGraphResources;
     FrameGraph& mFrameGraph;
     std::unordered_set<FrameGraphHandle::Index> mDeclaredHandles;
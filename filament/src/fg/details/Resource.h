@@ -94,6 +94,9 @@ public:
 
     virtual utils::CString usageString() const noexcept = 0;
 
+    /* Memory needed by the concrete resource, zero if it's not owned by the FrameGraph */
+    virtual size_t getTransientSize() const noexcept = 0;
+
     virtual bool isImported() const noexcept { return false; }
 
     // this is to workaround our lack of RTTI -- otherwise we could use dynamic_cast
@@ -248,6 +251,11 @@ protected:
     utils::CString usageString() const noexcept override {
         return utils::to_string(usage);
     }
+
+    size_t getTransientSize() const noexcept override {
+        // subresources share the memory of their parent
+        return isSubResource() ? 0 : RESOURCE::getSize(descriptor);
+    }
 };
 
 /*
@@ -275,6 +283,11 @@ protected:
         // imported resources never destroy the concrete resource
     }
 
+    size_t getTransientSize() const noexcept override {
+        // imported resources are not allocated by the FrameGraph
+        return 0;
+    }
+
     bool isImported() const noexcept override { return true; }
 
     UTILS_NOINLINE
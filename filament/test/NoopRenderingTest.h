@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_TEST_NOOPRENDERINGTEST_H
+#define TNT_FILAMENT_TEST_NOOPRENDERINGTEST_H
+
+#include <gtest/gtest.h>
+
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/SwapChain.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include <utils/Entity.h>
+#include <utils/EntityManager.h>
+
+#include <math/vec3.h>
+
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+// Renders a scene with the NOOP backend. Tests add their own renderables and lights to mScene,
+// they can use the triangle in mVertexBuffer and mIndexBuffer for their geometry.
+class NoopRenderingTest : public testing::Test {
+protected:
+    filament::Engine* mEngine = nullptr;
+    filament::SwapChain* mSwapChain = nullptr;
+    filament::Renderer* mRenderer = nullptr;
+    filament::Scene* mScene = nullptr;
+    filament::View* mView = nullptr;
+    filament::Camera* mCamera = nullptr;
+    filament::VertexBuffer* mVertexBuffer = nullptr;
+    filament::IndexBuffer* mIndexBuffer = nullptr;
+
+    void SetUp() override {
+        using namespace filament;
+        mEngine = Engine::create(Engine::Backend::NOOP);
+        mSwapChain = mEngine->createSwapChain(64, 64);
+        mRenderer = mEngine->createRenderer();
+        mScene = mEngine->createScene();
+        mView = createView(&mCamera);
+
+        static const math::float3 vertices[3] = {{ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }};
+        static const uint16_t indices[3] = { 0, 1, 2 };
+        mVertexBuffer = VertexBuffer::Builder()
+                .vertexCount(3)
+                .bufferCount(1)
+                .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::FLOAT3)
+                .build(*mEngine);
+        mVertexBuffer->setBufferAt(*mEngine, 0, { vertices, sizeof(vertices) });
+        mIndexBuffer = IndexBuffer::Builder()
+                .indexCount(3)
+                .bufferType(IndexBuffer::IndexType::USHORT)
+                .build(*mEngine);
+        mIndexBuffer->setBuffer(*mEngine, { indices, sizeof(indices) });
+    }
+
+    void TearDown() override {
+        mEngine->destroy(mVertexBuffer);
+        mEngine->destroy(mIndexBuffer);
+        for (auto [view, cameraEntity] : mViews) {
+            mEngine->destroy(view);
+            mEngine->destroyCameraComponent(cameraEntity);
+            mEngine->getEntityManager().destroy(cameraEntity);
+        }
+        mEngine->destroy(mScene);
+        mEngine->destroy(mRenderer);
+        mEngine->destroy(mSwapChain);
+        filament::Engine::destroy(&mEngine);
+    }
+
+    // Creates a 64x64 view of the scene, without post-processing, looking at the origin. The view
+    // and its camera are destroyed with the fixture.
+    filament::View* createView(filament::Camera** camera) {
+        utils::Entity const cameraEntity = mEngine->getEntityManager().create();
+        *camera = mEngine->createCamera(cameraEntity);
+        (*camera)->setProjection(45.0, 1.0, 0.1, 100.0);
+        (*camera)->lookAt({ 0, 0, 5 }, { 0, 0, 0 });
+        filament::View* view = mEngine->createView();
+        view->setViewport({ 0, 0, 64, 64 });
+        view->setScene(mScene);
+        view->setCamera(*camera);
+        view->setPostProcessingEnabled(false);
+        mViews.emplace_back(view, cameraEntity);
+        return view;
+    }
+
+    // Renders a frame of the view and waits until the backend is done with it.
+    void renderFrame(filament::View* view) {
+        if (mRenderer->beginFrame(mSwapChain)) {
+            mRenderer->render(view);
+            mRenderer->endFrame();
+        }
+        mEngine->flushAndWait();
+    }
+
+    void renderFrame() {
+        renderFrame(mView);
+    }
+
+private:
+    std::vector<std::pair<filament::View*, utils::Entity>> mViews;
+};
+
+#endif // TNT_FILAMENT_TEST_NOOPRENDERINGTEST_H
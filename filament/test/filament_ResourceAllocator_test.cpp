@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ResourceAllocator.h"
+
+#include <backend/Platform.h>
+
+#include <private/backend/CommandStream.h>
+#include <private/backend/PlatformFactory.h>
+
+using namespace filament;
+using namespace backend;
+
+class ResourceAllocatorTest : public testing::Test {
+protected:
+    static constexpr size_t MAX_AGE = 3;
+
+    // RGBA8 textures without mip-maps, so their size is width * width * 4
+    static constexpr size_t SIZE_16 = 16 * 16 * 4;
+    static constexpr size_t SIZE_32 = 32 * 32 * 4;
+    static constexpr size_t SIZE_64 = 64 * 64 * 4;
+
+    TextureHandle create(uint32_t width,
+            TextureUsage usage = TextureUsage::COLOR_ATTACHMENT) noexcept {
+        using TS = TextureSwizzle;
+        return allocator.createTexture("test", SamplerType::SAMPLER_2D, 1, TextureFormat::RGBA8,
+                1, width, width, 1, { TS::CHANNEL_0, TS::CHANNEL_1, TS::CHANNEL_2, TS::CHANNEL_3 },
+                usage);
+    }
+
+    void TearDown() override {
+        allocator.terminate();
+    }
+
+    Backend backend = Backend::NOOP;
+    CircularBuffer buffer = CircularBuffer{ 8192 };
+    Platform* platform = PlatformFactory::create(&backend);
+    CommandStream driverApi = CommandStream{ *platform->createDriver(nullptr, {}), buffer };
+    ResourceAllocator allocator{ driverApi, SIZE_16 + SIZE_32 + SIZE_64, MAX_AGE };
+};
+
+TEST_F(ResourceAllocatorTest, ReuseCompatibleUsage) {
+    TextureUsage const sampleable = TextureUsage::COLOR_ATTACHMENT | TextureUsage::SAMPLEABLE;
+
+    TextureHandle const a = create(16, sampleable);
+    TextureHandle const b = create(16);
+    allocator.destroyTexture(a);
+    allocator.destroyTexture(b);
+
+    // an exact match is preferred over a texture with additional usages
+    TextureHandle const c = create(16);
+    EXPECT_EQ(c.getId(), b.getId());
+
+    // otherwise, a texture with additional usages is reused
+    TextureHandle const d = create(16);
+    EXPECT_EQ(d.getId(), a.getId());
+
+    // and it goes back to the cache with its actual usage
+    allocator.destroyTexture(d);
+    TextureHandle const e = create(16, sampleable);
+    EXPECT_EQ(e.getId(), a.getId());
+
+    // a texture with fewer usages can't be reused
+    allocator.destroyTexture(c);
+    TextureHandle const f = create(16, sampleable);
+    EXPECT_NE(f.getId(), b.getId());
+
+    allocator.destroyTexture(e);
+    allocator.destroyTexture(f);
+
+    auto const stats = allocator.getStatistics();
+    EXPECT_EQ(stats.hitCount, 3);
+    EXPECT_EQ(stats.missCount, 3);
+    EXPECT_EQ(stats.cacheEntryCount, 3);
+    EXPECT_EQ(stats.cacheSize, 3 * SIZE_16);
+}
+
+TEST_F(ResourceAllocatorTest, EvictionOrder) {
+    TextureHandle const a = create(16);
+    TextureHandle const b = create(32);
+    TextureHandle const c = create(64);
+    allocator.destroyTexture(a);
+    allocator.destroyTexture(b);
+    allocator.destroyTexture(c);
+    EXPECT_EQ(allocator.getStatistics().cacheSize, SIZE_16 + SIZE_32 + SIZE_64);
+
+    // the least recently used texture is evicted first
+    allocator.trim(SIZE_32 + SIZE_64);
+    EXPECT_EQ(allocator.getStatistics().evictionCount, 1);
+    EXPECT_EQ(allocator.getStatistics().cacheEntryCount, 2);
+
+    // reusing a texture makes it the most recently used
+    TextureHandle const d = create(32);
+    EXPECT_EQ(d.getId(), b.getId());
+    allocator.destroyTexture(d);
+
+    allocator.trim(SIZE_32);
+    EXPECT_EQ(allocator.getStatistics().evictionCount, 2);
+    EXPECT_EQ(allocator.getStatistics().cacheSize, SIZE_32);
+
+    TextureHandle const e = create(32);
+    EXPECT_EQ(e.getId(), b.getId());
+    TextureHandle const f = create(64);
+    EXPECT_NE(f.getId(), c.getId());
+    allocator.destroyTexture(e);
+    allocator.destroyTexture(f);
+
+    allocator.trim(0);
+    EXPECT_EQ(allocator.getStatistics().cacheEntryCount, 0);
+    EXPECT_EQ(allocator.getStatistics().cacheSize, 0);
+}
+
+TEST_F(ResourceAllocatorTest, SizeLimit) {
+    TextureHandle const a = create(16);
+    TextureHandle const b = create(32);
+    TextureHandle const c = create(64);
+    TextureHandle const d = create(16);
+    allocator.destroyTexture(a);
+    allocator.destroyTexture(b);
+    allocator.destroyTexture(c);
+    allocator.destroyTexture(d);
+
+    // gc() evicts the least recently used textures until the cache fits its capacity
+    allocator.gc();
+    auto const stats = allocator.getStatistics();
+    EXPECT_EQ(stats.evictionCount, 1);
+    EXPECT_EQ(stats.cacheEntryCount, 3);
+    EXPECT_EQ(stats.cacheSize, SIZE_32 + SIZE_64 + SIZE_16);
+
+    TextureHandle const e = create(16);
+    EXPECT_EQ(e.getId(), d.getId());
+    allocator.destroyTexture(e);
+}
+
+TEST_F(ResourceAllocatorTest, AgeLimit) {
+    TextureHandle const a = create(16);
+    TextureHandle const b = create(32);
+    allocator.destroyTexture(a);
+    allocator.destroyTexture(b);
+
+    for (size_t i = 0; i < MAX_AGE; i++) {
+        allocator.gc();
+    }
+    EXPECT_EQ(allocator.getStatistics().evictionCount, 0);
+
+    // textures older than the max age are evicted, one per gc()
+    allocator.gc();
+    EXPECT_EQ(allocator.getStatistics().evictionCount, 1);
+    EXPECT_EQ(allocator.getStatistics().cacheSize, SIZE_32);
+    allocator.gc();
+    EXPECT_EQ(allocator.getStatistics().evictionCount, 2);
+    EXPECT_EQ(allocator.getStatistics().cacheEntryCount, 0);
+
+    // a reused texture is younger when it goes back to the cache
+    TextureHandle const c = create(16);
+    allocator.destroyTexture(c);
+    for (size_t i = 0; i < MAX_AGE - 1; i++) {
+        allocator.gc();
+    }
+    TextureHandle const d = create(16);
+    EXPECT_EQ(d.getId(), c.getId());
+    allocator.destroyTexture(d);
+    for (size_t i = 0; i < MAX_AGE - 1; i++) {
+        allocator.gc();
+    }
+    EXPECT_EQ(allocator.getStatistics().cacheEntryCount, 1);
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This test replaces the global operator new to count heap allocations, it is built in its own
+// executable so that the replacement doesn't affect the other tests.
+
+#include "NoopRenderingTest.h"
+
+#include "FrameAllocator.h"
+#include "details/Engine.h"
+
+#include <filament/LightManager.h>
+#include <filament/RenderableManager.h>
+
+#include <utils/memalign.h>
+
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
+
+using namespace filament;
+using namespace utils;
+
+// Counts the global heap allocations while enabled
+static std::atomic<bool> gCountHeapAllocations{ false };
+static std::atomic<size_t> gHeapAllocationCount{ 0 };
+
+static void countHeapAllocation() noexcept {
+    if (gCountHeapAllocations.load(std::memory_order_relaxed)) {
+        gHeapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* operator new(size_t size) {
+    countHeapAllocation();
+    void* const p = malloc(size ? size : 1);
+    if (!p) {
+        abort();
+    }
+    return p;
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    countHeapAllocation();
+    void* const p = utils::aligned_alloc(size ? size : 1, size_t(alignment));
+    if (!p) {
+        abort();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    utils::aligned_free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    utils::aligned_free(p);
+}
+
+TEST_F(NoopRenderingTest, FrameAllocatorSteadyState) {
+    mEngine->setAutomaticInstancingEnabled(true);
+
+    // identical renderables, so that they're instanced, and point lights so that lights are
+    // culled and froxelized in jobs.
+    constexpr size_t RENDERABLE_COUNT = 128;
+    constexpr size_t LIGHT_COUNT = 16;
+    Entity entities[RENDERABLE_COUNT + LIGHT_COUNT];
+    mEngine->getEntityManager().create(RENDERABLE_COUNT + LIGHT_COUNT, entities);
+    for (size_t i = 0; i < RENDERABLE_COUNT; i++) {
+        RenderableManager::Builder(1)
+                .boundingBox({{ 0, 0, 0 }, { 1, 1, 0.1f }})
+                .geometry(0, RenderableManager::PrimitiveType::TRIANGLES,
+                        mVertexBuffer, mIndexBuffer)
+                .build(*mEngine, entities[i]);
+    }
+    for (size_t i = 0; i < LIGHT_COUNT; i++) {
+        LightManager::Builder(LightManager::Type::POINT)
+                .position({ float(i) * 0.5f - 4.0f, 0, 1 })
+                .falloff(4.0f)
+                .build(*mEngine, entities[RENDERABLE_COUNT + i]);
+    }
+
+    // returns the number of global heap allocations of 16 steady-state frames
+    FrameAllocator const& allocator = downcast(mEngine)->getFrameAllocator();
+    auto measure = [&]() -> size_t {
+        // the first frames size the per-thread areas and the buffer pools
+        for (size_t i = 0; i < 8; i++) {
+            renderFrame();
+        }
+        FrameAllocator::Statistics const warm = allocator.getStatistics();
+        EXPECT_GT(warm.highWatermark, 0);
+        gHeapAllocationCount.store(0, std::memory_order_relaxed);
+        gCountHeapAllocations.store(true, std::memory_order_relaxed);
+        for (size_t i = 0; i < 16; i++) {
+            renderFrame();
+            EXPECT_EQ(allocator.getStatistics().frameHeapAllocationCount, 0);
+        }
+        gCountHeapAllocations.store(false, std::memory_order_relaxed);
+        EXPECT_EQ(allocator.getStatistics().heapAllocationCount, warm.heapAllocationCount);
+        EXPECT_EQ(allocator.getStatistics().capacity, warm.capacity);
+        return gHeapAllocationCount.load(std::memory_order_relaxed);
+    };
+
+    // A few renderables and lights...
+    mScene->addEntities(entities, 4);
+    mScene->addEntities(entities + RENDERABLE_COUNT, 4);
+    size_t const smallSceneAllocationCount = measure();
+
+    // ...then many more. The instanced data no longer fits in the command stream (> 16 KiB),
+    // more lights are culled and froxelized, yet the frames don't use the heap any more than
+    // before: none of the per-renderable or per-light work allocates. What remains is a fixed
+    // number of allocations per frame: the frame graph's containers, which are rebuilt each
+    // frame, and the fence of flushAndWait().
+    mScene->addEntities(entities + 4, RENDERABLE_COUNT - 4);
+    mScene->addEntities(entities + RENDERABLE_COUNT + 4, LIGHT_COUNT - 4);
+    size_t const largeSceneAllocationCount = measure();
+    EXPECT_EQ(largeSceneAllocationCount, smallSceneAllocationCount);
+
+    for (Entity e : entities) {
+        mEngine->destroy(e);
+    }
+    mEngine->getEntityManager().destroy(RENDERABLE_COUNT + LIGHT_COUNT, entities);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -29,6 +29,9 @@
 
 #include "details/Texture.h"
 
+#include <string>
+#include <vector>
+
 using namespace filament;
 using namespace backend;
 
@@ -942,3 +945,176 @@ TEST_F(FrameGraphTest, WriteResourceReadAsAttachment) {
 
     fg.execute(driverApi);
 }
+
+TEST_F(FrameGraphTest, ReorderPassesForTransientMemory) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+    struct CombineData {
+        FrameGraphId<FrameGraphTexture> inputs[2];
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    // two independent chains, each producing a large texture that is immediately reduced
+    // into a small one. Executed in declaration order, both large textures are alive at
+    // the same time.
+    auto setup = [](FrameGraph& fg, std::vector<std::string>* executed) {
+        FrameGraphId<FrameGraphTexture> small[2];
+        for (size_t i = 0; i < 2; i++) {
+            auto& large = fg.addPass<PassData>(i ? "Large B" : "Large A",
+                    [&](FrameGraph::Builder& builder, auto& data) {
+                        data.output = builder.create<FrameGraphTexture>("Large buffer",
+                                { .width = 1024, .height = 1024 });
+                        data.output = builder.write(data.output);
+                    },
+                    [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                        executed->push_back(i ? "Large B" : "Large A");
+                    });
+            small[i] = large->output;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            auto& reduce = fg.addPass<PassData>(i ? "Reduce B" : "Reduce A",
+                    [&](FrameGraph::Builder& builder, auto& data) {
+                        data.input = builder.sample(small[i]);
+                        data.output = builder.create<FrameGraphTexture>("Small buffer",
+                                { .width = 16, .height = 16 });
+                        data.output = builder.write(data.output);
+                    },
+                    [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                        executed->push_back(i ? "Reduce B" : "Reduce A");
+                    });
+            small[i] = reduce->output;
+        }
+        auto& combine = fg.addPass<CombineData>("Combine",
+                [&](FrameGraph::Builder& builder, auto& data) {
+                    data.inputs[0] = builder.sample(small[0]);
+                    data.inputs[1] = builder.sample(small[1]);
+                    data.output = builder.create<FrameGraphTexture>("Output buffer",
+                            { .width = 16, .height = 16 });
+                    data.output = builder.write(data.output);
+                },
+                [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                    executed->push_back("Combine");
+                });
+        fg.present(combine->output);
+    };
+
+    std::vector<std::string> declaredOrder;
+    setup(fg, &declaredOrder);
+    fg.compile();
+    fg.execute(driverApi);
+
+    std::vector<std::string> reorderedOrder;
+    FrameGraph reordered{ resourceAllocator };
+    reordered.setPassReorderingEnabled(true);
+    setup(reordered, &reorderedOrder);
+    EXPECT_TRUE(reordered.isAcyclic());
+    reordered.compile();
+    reordered.execute(driverApi);
+
+    constexpr size_t LARGE = 1024 * 1024 * 4;
+    constexpr size_t SMALL = 16 * 16 * 4;
+
+    EXPECT_EQ(declaredOrder, (std::vector<std::string>{
+            "Large A", "Large B", "Reduce A", "Reduce B", "Combine" }));
+    EXPECT_EQ(reorderedOrder, (std::vector<std::string>{
+            "Large A", "Reduce A", "Large B", "Reduce B", "Combine" }));
+
+    auto const& declaredInfo = fg.getTransientMemoryInfo();
+    auto const& reorderedInfo = reordered.getTransientMemoryInfo();
+    EXPECT_EQ(declaredInfo.total, 2 * LARGE + 3 * SMALL);
+    EXPECT_EQ(reorderedInfo.total, declaredInfo.total);
+    EXPECT_EQ(declaredInfo.peak, 2 * LARGE + SMALL);
+    EXPECT_EQ(reorderedInfo.peak, LARGE + 2 * SMALL);
+    EXPECT_LT(reorderedInfo.peak, declaredInfo.peak);
+}
+
+TEST_F(FrameGraphTest, TopologyCache) {
+    struct PassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> output;
+    };
+
+    auto setup = [](FrameGraph& fg, std::vector<std::string>* executed, bool withCulledPass) {
+        auto& depthPass = fg.addPass<PassData>("Depth pass",
+                [&](FrameGraph::Builder& builder, auto& data) {
+                    data.output = builder.create<FrameGraphTexture>("Depth buffer",
+                            { .width = 16, .height = 32, .format = TextureFormat::DEPTH32F });
+                    data.output = builder.write(data.output,
+                            FrameGraphTexture::Usage::DEPTH_ATTACHMENT);
+                },
+                [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                    EXPECT_TRUE(resources.get(data.output).handle);
+                    executed->push_back("Depth pass");
+                });
+        if (withCulledPass) {
+            fg.addPass<PassData>("Culled pass",
+                    [&](FrameGraph::Builder& builder, auto& data) {
+                        data.input = builder.sample(depthPass->output);
+                        data.output = builder.create<FrameGraphTexture>("Unused buffer");
+                        data.output = builder.write(data.output);
+                    },
+                    [=](FrameGraphResources const&, auto const&, backend::DriverApi&) {
+                        executed->push_back("Culled pass");
+                    });
+        }
+        auto& colorPass = fg.addPass<PassData>("Color pass",
+                [&](FrameGraph::Builder& builder, auto& data) {
+                    data.input = builder.sample(depthPass->output);
+                    data.output = builder.create<FrameGraphTexture>("Color buffer",
+                            { .width = 16, .height = 32 });
+                    data.output = builder.write(data.output);
+                },
+                [=](FrameGraphResources const& resources, auto const& data, backend::DriverApi&) {
+                    EXPECT_TRUE(resources.get(data.input).handle);
+                    EXPECT_TRUE(resources.get(data.output).handle);
+                    EXPECT_EQ(resources.getUsage(data.output),
+                            FrameGraphTexture::Usage::COLOR_ATTACHMENT);
+                    executed->push_back("Color pass");
+                });
+        fg.present(colorPass->output);
+    };
+
+    FrameGraphTopologyCache cache;
+
+    std::vector<std::string> first;
+    setup(fg, &first, true);
+    fg.compile(cache);
+    fg.execute(driverApi);
+    EXPECT_EQ(cache.getHitCount(), 0);
+    EXPECT_EQ(cache.getMissCount(), 1);
+
+    // same structure: the compilation results are reused
+    std::vector<std::string> second;
+    FrameGraph sameStructure{ resourceAllocator };
+    setup(sameStructure, &second, true);
+    sameStructure.compile(cache);
+    sameStructure.execute(driverApi);
+    EXPECT_EQ(cache.getHitCount(), 1);
+    EXPECT_EQ(cache.getMissCount(), 1);
+
+    EXPECT_EQ(first, (std::vector<std::string>{ "Depth pass", "Color pass" }));
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(sameStructure.getTransientMemoryInfo().peak, fg.getTransientMemoryInfo().peak);
+
+    // different structure: the graph is compiled from scratch
+    std::vector<std::string> third;
+    FrameGraph otherStructure{ resourceAllocator };
+    setup(otherStructure, &third, false);
+    otherStructure.compile(cache);
+    otherStructure.execute(driverApi);
+    EXPECT_EQ(cache.getHitCount(), 1);
+    EXPECT_EQ(cache.getMissCount(), 2);
+    EXPECT_EQ(third, first);
+
+    // both structures are found again
+    std::vector<std::string> fourth;
+    FrameGraph again{ resourceAllocator };
+    setup(again, &fourth, true);
+    again.compile(cache);
+    again.execute(driverApi);
+    EXPECT_EQ(cache.getHitCount(), 2);
+    EXPECT_EQ(cache.getMissCount(), 2);
+    EXPECT_EQ(fourth, first);
+}
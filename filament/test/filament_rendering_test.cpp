@@ -16,17 +16,23 @@
 
 #include <gtest/gtest.h>
 
+#include <filament/Camera.h>
+#include <filament/ColorGrading.h>
+#include <filament/DebugRegistry.h>
 #include <filament/Engine.h>
 #include <filament/Renderer.h>
 #include <filament/Skybox.h>
 #include <filament/Scene.h>
 #include <filament/View.h>
+#include <filament/ToneMapper.h>
 #include <filament/Viewport.h>
 
 #include <utils/EntityManager.h>
 
 #include <backend/PixelBufferDescriptor.h>
 
+#include <vector>
+
 using namespace filament;
 using namespace backend;
 
@@ -132,3 +138,52 @@ TEST_F(RenderingTest, ClearGreen) {
     });
     EXPECT_TRUE(callbackCalled);
 }
+
+TEST_F(RenderingTest, MergedUpscaling) {
+    // color grading is the last pass without FXAA, it does the LOW quality upscaling itself
+    LinearToneMapper toneMapper;
+    ColorGrading* colorGrading = ColorGrading::Builder()
+            .toneMapper(&toneMapper)
+            .build(*mEngine);
+
+    mSkybox->setColor({ 1.0f, 0.0f, 0.0f, 1.0f });
+    mCamera->setExposure(1.0f);
+    mView->setPostProcessingEnabled(true);
+    mView->setColorGrading(colorGrading);
+    mView->setDithering(View::Dithering::NONE);
+    mView->setAntiAliasing(View::AntiAliasing::NONE);
+    mView->setDynamicResolutionOptions({
+            .minScale = { 0.5f, 0.5f },
+            .maxScale = { 0.5f, 0.5f },
+            .enabled = true,
+            .quality = QualityLevel::LOW
+    });
+
+    auto capture = [](std::vector<uint8_t>& pixels) {
+        return [&pixels](uint8_t const* rgba, uint32_t width, uint32_t height) {
+            pixels.assign(rgba, rgba + width * height * 4);
+        };
+    };
+
+    std::vector<uint8_t> merged;
+    std::vector<uint8_t> separate;
+    mEngine->getDebugRegistry().setProperty("d.renderer.merge_post_process", true);
+    runTest(capture(merged));
+    mEngine->getDebugRegistry().setProperty("d.renderer.merge_post_process", false);
+    runTest(capture(separate));
+
+    ASSERT_EQ(merged.size(), 16 * 16 * 4);
+    ASSERT_EQ(separate.size(), 16 * 16 * 4);
+    for (size_t i = 0; i < merged.size(); i += 4) {
+        EXPECT_NEAR(merged[i + 0], 0xff, 1);
+        EXPECT_NEAR(merged[i + 1], 0, 1);
+        EXPECT_NEAR(merged[i + 2], 0, 1);
+        EXPECT_EQ(merged[i + 3], 0xff);
+        EXPECT_NEAR(merged[i + 0], separate[i + 0], 1);
+        EXPECT_NEAR(merged[i + 1], separate[i + 1], 1);
+        EXPECT_NEAR(merged[i + 2], separate[i + 2], 1);
+    }
+
+    mView->setColorGrading(nullptr);
+    mEngine->destroy(colorGrading);
+}
@@ -31,6 +31,13 @@
 #include <filament/Frustum.h>
 #include <filament/Material.h>
 #include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/LightManager.h>
+#include <filament/RenderableManager.h>
+#include <filament/Renderer.h>
+#include <filament/Scene.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
 
 #include <private/filament/BufferInterfaceBlock.h>
 #include <private/filament/UibStructs.h>
@@ -40,11 +47,15 @@
 #include "details/Material.h"
 #include "details/Camera.h"
 #include "Froxelizer.h"
+#include "RenderPrimitive.h"
 #include "details/Engine.h"
+#include "details/View.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
 #include "UniformBuffer.h"
 
+#include "NoopRenderingTest.h"
+
 using namespace filament;
 using namespace filament::math;
 using namespace utils;
@@ -180,7 +191,7 @@ TEST(FilamentTest, SkinningMath) {
 }
 
 TEST(FilamentTest, TransformManager) {
-    filament::FTransformManager tcm;
+    filament::FTransformManager tcm(Engine::Config{}.componentLookupTableSizeKB * FEngine::KiB);
     tcm.setAccurateTranslationsEnabled(true);
     EntityManager& em = EntityManager::get();
     std::array<Entity, 3> entities;
@@ -741,6 +752,170 @@ TEST(FilamentTest, FroxelData) {
     Engine::destroy((Engine **)&engine);
 }
 
+TEST_F(NoopRenderingTest, StaticShadowCacheInvalidation) {
+    mCamera->lookAt({ 0, 3, 6 }, { 0, 0, 0 });
+    MaterialInstance* mi = mEngine->getDefaultMaterial()->createInstance();
+
+    // a static shadow caster and a ground, below a spot light
+    Entity entities[3];
+    mEngine->getEntityManager().create(3, entities);
+    Entity const caster = entities[0];
+    Entity const ground = entities[1];
+    Entity const light = entities[2];
+    auto& tcm = mEngine->getTransformManager();
+    tcm.create(caster, {}, mat4f::translation(float3{ 0, 1, 0 }));
+    RenderableManager::Builder(1)
+            .boundingBox({{ 0, 0, 0 }, { 1, 1, 0.1f }})
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, mVertexBuffer, mIndexBuffer)
+            .material(0, mi)
+            .castShadows(true)
+            .staticShadowCaster(true)
+            .build(*mEngine, caster);
+    tcm.create(ground, {}, mat4f::scaling(float3{ 8 }) * mat4f::rotation(-F_PI_2, float3{ 1, 0, 0 }));
+    RenderableManager::Builder(1)
+            .boundingBox({{ 0, 0, 0 }, { 1, 1, 0.1f }})
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, mVertexBuffer, mIndexBuffer)
+            .receiveShadows(true)
+            .build(*mEngine, ground);
+    LightManager::Builder(LightManager::Type::SPOT)
+            .position({ 0, 4, 0 })
+            .direction({ 0, -1, 0 })
+            .spotLightCone(0.5f, 0.8f)
+            .falloff(10.0f)
+            .castShadows(true)
+            .build(*mEngine, light);
+    mScene->addEntities(entities, 3);
+
+    auto& rcm = mEngine->getRenderableManager();
+    ShadowMapManager const& shadowMapManager = downcast(mView)->getShadowMapManager();
+    auto updateCountAfterFrame = [&]() {
+        renderFrame();
+        return shadowMapManager.getStaticShadowCacheUpdateCount();
+    };
+
+    // the cache is rendered once, and reused while nothing changes
+    size_t const count = updateCountAfterFrame();
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(updateCountAfterFrame(), count);
+
+    // moving the static caster invalidates the cache
+    tcm.setTransform(tcm.getInstance(caster), mat4f::translation(float3{ 0.5f, 1, 0 }));
+    EXPECT_EQ(updateCountAfterFrame(), count + 1);
+    EXPECT_EQ(updateCountAfterFrame(), count + 1);
+
+    // so does changing its material instance's state
+    mi->setCullingMode(MaterialInstance::CullingMode::NONE);
+    EXPECT_EQ(updateCountAfterFrame(), count + 2);
+    mi->setDepthCulling(false);
+    EXPECT_EQ(updateCountAfterFrame(), count + 3);
+
+    // or its geometry
+    rcm.setGeometryAt(rcm.getInstance(caster), 0,
+            RenderableManager::PrimitiveType::TRIANGLES, mVertexBuffer, mIndexBuffer, 0, 3);
+    EXPECT_EQ(updateCountAfterFrame(), count + 4);
+
+    // but not changes to the other renderables
+    tcm.setTransform(tcm.getInstance(ground), mat4f::scaling(float3{ 4 }));
+    EXPECT_EQ(updateCountAfterFrame(), count + 4);
+
+    for (Entity e : entities) {
+        mEngine->destroy(e);
+    }
+    mEngine->getEntityManager().destroy(3, entities);
+    mEngine->destroy(mi);
+}
+
+TEST(FilamentTest, RenderableLevelOfDetail) {
+    using namespace filament;
+
+    Engine* engine = Engine::create(Engine::Backend::NOOP);
+    Entity entity = engine->getEntityManager().create();
+    RenderableManager::Builder(4)
+            .boundingBox({{ 0, 0, 0 }, { 1, 1, 1 }})
+            .levelOfDetail(1, 2, 0.5f)
+            .levelOfDetail(2, 3, 0.1f)
+            .build(*engine, entity);
+
+    FRenderableManager& rcm = downcast(engine)->getRenderableManager();
+    auto const ri = rcm.getInstance(entity);
+    EXPECT_TRUE(rcm.hasLevelsOfDetail());
+    EXPECT_EQ(rcm.getLevelCount(ri), 3);
+    EXPECT_EQ(rcm.getPrimitiveCount(ri), 4);
+    EXPECT_EQ(rcm.getRenderPrimitives(ri, 0).size(), 2);
+    EXPECT_EQ(rcm.getRenderPrimitives(ri, 1).size(), 1);
+    EXPECT_EQ(rcm.getRenderPrimitives(ri, 2).size(), 1);
+    EXPECT_EQ(rcm.getMorphTargets(ri, 2).size(), 1);
+
+    // levels only change once the screen size is out of the hysteresis band
+    EXPECT_EQ(rcm.selectLevel(ri, 1.0f, 0), 0);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.48f, 0), 0);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.4f, 0), 1);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.52f, 1), 1);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.6f, 1), 0);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.01f, 0), 2);
+    EXPECT_EQ(rcm.selectLevel(ri, 0.105f, 2), 2);
+    EXPECT_EQ(rcm.selectLevel(ri, 2.0f, 2), 0);
+    // an out of range previous level is clamped
+    EXPECT_EQ(rcm.selectLevel(ri, 0.105f, 7), 2);
+
+    engine->destroy(entity);
+    EXPECT_FALSE(rcm.hasLevelsOfDetail());
+    engine->getEntityManager().destroy(entity);
+
+    Engine::destroy(&engine);
+}
+
+TEST_F(NoopRenderingTest, LevelOfDetailIsPerView) {
+    // level 1 is used below a projected size of 0.5, with a hysteresis band of [0.45, 0.55]
+    Entity entity = mEngine->getEntityManager().create();
+    RenderableManager::Builder(2)
+            .boundingBox({{ 0, 0, 0 }, { 0.1f, 0.1f, 0.1f }})
+            .geometry(0, RenderableManager::PrimitiveType::TRIANGLES, mVertexBuffer, mIndexBuffer)
+            .geometry(1, RenderableManager::PrimitiveType::TRIANGLES, mVertexBuffer, mIndexBuffer)
+            .levelOfDetail(1, 1, 0.5f)
+            .build(*mEngine, entity);
+    mScene->addEntity(entity);
+
+    // With a 90 degrees vertical field of view, the projected size is the bounding sphere's
+    // radius over its distance to the camera.
+    float const radius = length(float3{ 0.1f });
+    Camera* cameras[2] = { mCamera };
+    View* const views[2] = { mView, createView(&cameras[1]) };
+    float const screenSizes[2] = { 0.48f, 0.4f };
+    for (size_t i = 0; i < 2; i++) {
+        cameras[i]->setProjection(90.0, 1.0, 0.01, 10.0, Camera::Fov::VERTICAL);
+        cameras[i]->lookAt({ 0, 0, radius / screenSizes[i] }, { 0, 0, 0 });
+    }
+
+    FRenderableManager const& rcm = downcast(mEngine)->getRenderableManager();
+    auto const ri = rcm.getInstance(entity);
+    auto getLevel = [&]() -> int {
+        FScene::RenderableSoa const& soa = downcast(mScene)->getRenderableData();
+        for (size_t i = 0; i < soa.size(); i++) {
+            if (soa.elementAt<FScene::RENDERABLE_INSTANCE>(i) == ri) {
+                return soa.elementAt<FScene::LOD_LEVEL>(i);
+            }
+        }
+        return -1;
+    };
+
+    // The first view is within the hysteresis band, it keeps the finest level even though the
+    // second view, rendered in between, selects the coarser one.
+    for (size_t frame = 0; frame < 4; frame++) {
+        if (mRenderer->beginFrame(mSwapChain)) {
+            mRenderer->render(views[0]);
+            EXPECT_EQ(getLevel(), 0);
+            mRenderer->render(views[1]);
+            EXPECT_EQ(getLevel(), 1);
+            mRenderer->endFrame();
+        }
+        mEngine->flushAndWait();
+    }
+
+    mEngine->destroy(entity);
+    mEngine->getEntityManager().destroy(entity);
+}
+
 TEST(FilamentTest, GoogleLineDirective) {
     {
         char s[512] = "#line 10 \"foobar\"";
@@ -31,12 +31,19 @@ proc Flags {} {
         } elseif {[expr $value & 0x2] == 0x0} {
             entry "UV" "FP_16"
         }
-        if {[expr $value & 0x3] == 0x3} {
+        if {[expr $value & 0x4] == 0x4} {
             entry "Compression" "meshopt"
-        } elseif {[expr $value & 0x3] == 0x0} {
+        } else {
             entry "Compression" "None"
         }
+        if {[expr $value & 0x8] == 0x8} {
+            entry "Levels of detail" ""
+        }
+        if {[expr $value & 0x10] == 0x10} {
+            entry "Quantization" ""
+        }
     }
+    return $value
 }
 
 proc Attribute {name} {
@@ -78,7 +85,7 @@ uint32 "Version"
 set partCount [uint32 "Parts count"]
 
 BoundingBox
-Flags
+set flags [Flags]
 Attribute "Position"
 Attribute "Tangent"
 Attribute "Color"
@@ -101,6 +108,21 @@ section "Indices" {
     }
 }
 
+if {[expr $flags & 0x10] == 0x10} {
+    section "Quantization" {
+        uint32 "Position bits"
+        uint32 "UV bits"
+        section -collapsed "UV min" {
+            float "U"
+            float "V"
+        }
+        section -collapsed "UV max" {
+            float "U"
+            float "V"
+        }
+    }
+}
+
 bytes $vertexSize "Vertex data"
 bytes $indexSize "Index data"
 
@@ -89,6 +89,10 @@ public:
      * file cannot be matched to a material in the registry, a default material is
      * used instead. The default material can be overridden by adding a material
      * named "DefaultMaterial" to the registry.
+     *
+     * The file is read sequentially: compressed vertices and indices are decoded
+     * as soon as they are read, into the memory given to the buffers, so the file
+     * is never entirely in memory. Returns an empty mesh if the file cannot be read.
      */
     static Mesh loadMeshFromFile(filament::Engine* engine,
             const utils::Path& path,
@@ -100,6 +104,11 @@ public:
      * file cannot be matched to a material in the registry, a default material is
      * used instead. The default material can be overridden by adding a material
      * named "DefaultMaterial" to the registry.
+     *
+     * The destructor is called once for the vertex data and once for the index
+     * data, with the address and size of each. Uncompressed data is uploaded from
+     * the buffer, so the callback is called once the GPU is done with it. Compressed
+     * or quantized data is released as soon as it is decoded.
      */
     static Mesh loadMeshFromBuffer(filament::Engine* engine,
             void const* data, Callback destructor, void* user,
@@ -113,6 +122,18 @@ public:
     static Mesh loadMeshFromBuffer(filament::Engine* engine,
             void const* data, Callback destructor, void* user,
             filament::MaterialInstance* defaultMaterial);
+
+    /**
+     * Decodes the vertices of a filamesh stored in an in-memory buffer, without
+     * creating any buffer. Compressed vertices are decompressed and quantized
+     * attributes are converted back, the decoded vertices are laid out as
+     * described by the header of the file, as they would be given to the
+     * VertexBuffer.
+     *
+     * The decoded vertices are copied to the given memory if it is large enough.
+     * Returns their size in bytes, or 0 if they cannot be decoded.
+     */
+    static size_t decodeVertices(void const* data, void* out, size_t size);
 };
 
 } // namespace filamesh
@@ -19,13 +19,17 @@
 
 #include <filament/Box.h>
 
+#include <math/vec2.h>
+
+#include <stdint.h>
+
 namespace filamesh {
 
 using Box = filament::Box;
 
 static const char MAGICID[] { 'F', 'I', 'L', 'A', 'M', 'E', 'S', 'H' };
 
-static const uint32_t VERSION = 1;
+static const uint32_t VERSION = 3;
 
 enum IndexType : uint32_t {
     UI32 = 0,
@@ -36,6 +40,8 @@ enum Flags : uint32_t {
     INTERLEAVED         = 1 << 0,
     TEXCOORD_SNORM16    = 1 << 1,
     COMPRESSION         = 1 << 2,
+    LEVELS_OF_DETAIL    = 1 << 3,
+    QUANTIZATION        = 1 << 4,
 };
 
 // Each of these fields specifies a number of bytes within the compressed data. This is ignored
@@ -70,6 +76,19 @@ struct Header {
     uint32_t indexSize;
 };
 
+// When the QUANTIZATION flag is set (version 3 and above), this structure follows the header.
+// Quantized positions are stored as a ushort4 whose XYZ hold positionBits-bit unsigned integers
+// mapping [0, 2^positionBits - 1] to the bounding box of the mesh, W being 0. Quantized UVs are
+// stored as a ushort2 mapping [0, 2^uvBits - 1] to [uvMin, uvMax]. An attribute whose number of
+// bits is 0 is not quantized. Quantized attributes have the size of the attributes they replace,
+// MeshReader converts them back to half floats (or to snorm16 UVs, see TEXCOORD_SNORM16).
+struct Quantization {
+    uint32_t positionBits;
+    uint32_t uvBits;
+    filament::math::float2 uvMin;
+    filament::math::float2 uvMax;
+};
+
 struct Part {
     uint32_t offset;
     uint32_t indexCount;
@@ -79,6 +98,15 @@ struct Part {
     Box aabb;
 };
 
+// When the LEVELS_OF_DETAIL flag is set, the parts are split into levelCount groups of equal size,
+// from the most detailed to the coarsest, each group being a simplified version of the previous
+// one. This structure follows the materials and is followed by levelCount floats, the screen size
+// below which each level is used (see RenderableManager::Builder::levelOfDetail(), the screen
+// size of level 0 is ignored).
+struct LevelsOfDetail {
+    uint32_t levelCount;
+};
+
 } // namespace filamesh
 
 #endif // TNT_FILAMENT_FILAMESHIO_FILAMESH_H
@@ -19,31 +19,43 @@
 
 #include <filament/Box.h>
 #include <filament/Engine.h>
-#include <filament/Fence.h>
 #include <filament/IndexBuffer.h>
 #include <filament/Material.h>
 #include <filament/MaterialInstance.h>
 #include <filament/RenderableManager.h>
 #include <filament/VertexBuffer.h>
 
+#include <math/half.h>
+#include <math/norm.h>
+#include <math/vec2.h>
+#include <math/vec4.h>
+
 #include <meshoptimizer.h>
 
 #include <utils/EntityManager.h>
 #include <utils/Log.h>
 #include <utils/Path.h>
 
-#include <string>
-#include <vector>
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
 #if !defined(WIN32)
 #    include <unistd.h>
 #else
 #    include <io.h>
 #endif
 
+#if !defined(O_BINARY)
+#    define O_BINARY 0
+#endif
+
 using namespace filament;
 using namespace filamesh;
 using namespace filament::math;
@@ -149,213 +161,405 @@ void MeshReader::MaterialRegistry::getRegisteredMaterialNames(
 //---------------------------End Material Registry------------------------------
 //------------------------------------------------------------------------------
 
+namespace {
+
+// A section of a filamesh file. It either points into the buffer given to loadMeshFromBuffer()
+// and is released with the user callback, or was allocated by the reader and is released with
+// free(). Sections not handed over to a buffer descriptor are released when destroyed.
+class Section {
+public:
+    Section() noexcept = default;
+
+    Section(void const* data, size_t size, MeshReader::Callback destructor, void* user) noexcept
+            : mData((uint8_t const*) data), mSize(size), mDestructor(destructor), mUser(user) {
+    }
+
+    Section(Section&& rhs) noexcept { swap(rhs); }
+
+    Section& operator=(Section&& rhs) noexcept {
+        Section(std::move(rhs)).swap(*this);
+        return *this;
+    }
+
+    ~Section() noexcept {
+        if (mDestructor) {
+            mDestructor((void*) mData, mSize, mUser);
+        }
+    }
+
+    static Section allocate(size_t size) noexcept {
+        return { malloc(size), size, [](void* buffer, size_t, void*) { free(buffer); }, nullptr };
+    }
+
+    uint8_t const* data() const noexcept { return mData; }
+    uint8_t* mutableData() const noexcept { return (uint8_t*) mData; }
+    size_t size() const noexcept { return mSize; }
+
+    // The descriptor owns the data, the section is empty afterwards.
+    backend::BufferDescriptor descriptor() noexcept {
+        backend::BufferDescriptor descriptor(mData, mSize, mDestructor, mUser);
+        mDestructor = nullptr;
+        return descriptor;
+    }
+
+private:
+    void swap(Section& rhs) noexcept {
+        std::swap(mData, rhs.mData);
+        std::swap(mSize, rhs.mSize);
+        std::swap(mDestructor, rhs.mDestructor);
+        std::swap(mUser, rhs.mUser);
+    }
+
+    uint8_t const* mData = nullptr;
+    size_t mSize = 0;
+    MeshReader::Callback mDestructor = nullptr;
+    void* mUser = nullptr;
+};
+
+// Reads a filamesh file from memory. The vertex and index data are not copied.
+class BufferInput {
+public:
+    BufferInput(void const* data, MeshReader::Callback destructor, void* user) noexcept
+            : mCursor((uint8_t const*) data), mDestructor(destructor), mUser(user) {
+    }
+
+    bool read(void* out, size_t size) noexcept {
+        memcpy(out, mCursor, size);
+        mCursor += size;
+        return true;
+    }
+
+    bool take(size_t size, Section* out) noexcept {
+        *out = Section(mCursor, size, mDestructor, mUser);
+        mCursor += size;
+        return true;
+    }
+
+private:
+    uint8_t const* mCursor;
+    MeshReader::Callback const mDestructor;
+    void* const mUser;
+};
+
+// Reads a filamesh file sequentially. Each section is read into its own allocation, which is
+// handed over to a buffer descriptor, or freed as soon as it is decoded.
+class FileInput {
+public:
+    explicit FileInput(int fd) noexcept : mFd(fd) {}
+
+    bool read(void* out, size_t size) noexcept {
+        uint8_t* p = (uint8_t*) out;
+        while (size > 0) {
+            auto const n = ::read(mFd, p, (unsigned int) std::min(size, size_t(1) << 30));
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            size -= size_t(n);
+        }
+        return true;
+    }
+
+    bool take(size_t size, Section* out) noexcept {
+        Section section = Section::allocate(size);
+        if (!section.data() || !read(section.mutableData(), size)) {
+            return false;
+        }
+        *out = std::move(section);
+        return true;
+    }
+
+private:
+    int const mFd;
+};
 
-static size_t fileSize(int fd) {
-    size_t filesize;
-    filesize = (size_t) lseek(fd, 0, SEEK_END);
-    lseek(fd, 0, SEEK_SET);
-    return filesize;
+// Converts quantized positions to half4 in place, see Quantization.
+void dequantizePositions(uint8_t* vertices, Header const& header, uint32_t bits) noexcept {
+    size_t const stride = header.stridePosition ? header.stridePosition : sizeof(half4);
+    float3 const min = header.aabb.getMin();
+    float3 const scale = header.aabb.halfExtent * 2.0f / float((1u << bits) - 1u);
+    uint8_t* p = vertices + header.offsetPosition;
+    for (size_t i = 0; i < header.vertexCount; i++, p += stride) {
+        ushort4 q;
+        memcpy(&q, p, sizeof(q));
+        half4 const position{ min + float3(q.xyz) * scale, 1.0f };
+        memcpy(p, &position, sizeof(position));
+    }
 }
 
-namespace filamesh {
+// Converts quantized UVs to half2 or snorm16 in place, see Quantization.
+void dequantizeUVs(uint8_t* vertices, size_t offset, size_t stride, size_t count,
+        Quantization const& quantization, bool snorm) noexcept {
+    stride = stride ? stride : sizeof(ushort2);
+    float2 const min = quantization.uvMin;
+    float2 const scale = (quantization.uvMax - min) / float((1u << quantization.uvBits) - 1u);
+    uint8_t* p = vertices + offset;
+    for (size_t i = 0; i < count; i++, p += stride) {
+        ushort2 q;
+        memcpy(&q, p, sizeof(q));
+        float2 const uv = min + float2(q) * scale;
+        if (snorm) {
+            short2 const value = packSnorm16(uv);
+            memcpy(p, &value, sizeof(value));
+        } else {
+            half2 const value{ uv };
+            memcpy(p, &value, sizeof(value));
+        }
+    }
+}
 
-MeshReader::Mesh MeshReader::loadMeshFromFile(filament::Engine* engine, const utils::Path& path,
-        MaterialRegistry& materials) {
+// Decodes compressed vertices and converts quantized attributes. The decoded vertices replace
+// the given section, they are laid out as described by the header.
+bool decodeVertices(Header const& header, Quantization const& quantization, Section& vertices) {
+    bool const compressed = header.flags & COMPRESSION;
+    if (!compressed && !quantization.positionBits && !quantization.uvBits) {
+        return true;
+    }
 
-    Mesh mesh;
+    constexpr uint32_t uintmax = std::numeric_limits<uint32_t>::max();
+    const bool hasUV1 = header.offsetUV1 != uintmax && header.strideUV1 != uintmax;
+    size_t const vertexCount = header.vertexCount;
+    size_t const vertexSize = sizeof(half4) + sizeof(short4) + sizeof(ubyte4) + sizeof(ushort2) +
+            (hasUV1 ? sizeof(ushort2) : 0);
+
+    Section decoded = Section::allocate(compressed ? vertexSize * vertexCount : vertices.size());
+    if (!decoded.data()) {
+        return false;
+    }
 
-    int fd = open(path.c_str(), O_RDONLY);
+    if (compressed) {
+        if (vertices.size() < sizeof(CompressionHeader)) {
+            return false;
+        }
+        const uint8_t* srcdata = vertices.data() + sizeof(CompressionHeader);
+        const size_t srcsize = vertices.size() - sizeof(CompressionHeader);
+        uint8_t* dstdata = decoded.mutableData();
+        int err = 0;
+        if (header.flags & INTERLEAVED) {
+            err |= meshopt_decodeVertexBuffer(dstdata, vertexCount, vertexSize, srcdata, srcsize);
+        } else {
+            CompressionHeader sizes;
+            memcpy(&sizes, vertices.data(), sizeof(CompressionHeader));
+            if (size_t(sizes.positions) + sizes.tangents + sizes.colors + sizes.uv0 + sizes.uv1 >
+                    srcsize) {
+                return false;
+            }
+            auto decode = meshopt_decodeVertexBuffer;
 
-    size_t size = fileSize(fd);
-    char* data = (char*) malloc(size);
-    read(fd, data, size);
+            err |= decode(dstdata, vertexCount, sizeof(half4), srcdata, sizes.positions);
+            srcdata += sizes.positions;
+            dstdata += sizeof(half4) * vertexCount;
 
-    if (data) {
-        char *p = data;
-        char *magic = p;
-        p += sizeof(MAGICID);
+            err |= decode(dstdata, vertexCount, sizeof(short4), srcdata, sizes.tangents);
+            srcdata += sizes.tangents;
+            dstdata += sizeof(short4) * vertexCount;
 
-        if (!strncmp(MAGICID, magic, 8)) {
-            mesh = loadMeshFromBuffer(engine, data, nullptr, nullptr, materials);
+            err |= decode(dstdata, vertexCount, sizeof(ubyte4), srcdata, sizes.colors);
+            srcdata += sizes.colors;
+            dstdata += sizeof(ubyte4) * vertexCount;
+
+            err |= decode(dstdata, vertexCount, sizeof(ushort2), srcdata, sizes.uv0);
+
+            if (sizes.uv1) {
+                srcdata += sizes.uv0;
+                dstdata += sizeof(ushort2) * vertexCount;
+                err |= decode(dstdata, vertexCount, sizeof(ushort2), srcdata, sizes.uv1);
+            }
         }
+        if (err) {
+            return false;
+        }
+    } else {
+        memcpy(decoded.mutableData(), vertices.data(), vertices.size());
+    }
 
-        Fence::waitAndDestroy(engine->createFence());
-        free(data);
+    uint8_t* const data = decoded.mutableData();
+    if (quantization.positionBits) {
+        dequantizePositions(data, header, quantization.positionBits);
+    }
+    if (quantization.uvBits) {
+        bool const snorm = header.flags & TEXCOORD_SNORM16;
+        dequantizeUVs(data, header.offsetUV0, header.strideUV0, vertexCount, quantization, snorm);
+        if (hasUV1) {
+            dequantizeUVs(data, header.offsetUV1, header.strideUV1, vertexCount, quantization,
+                    snorm);
+        }
     }
-    close(fd);
 
-    return mesh;
+    // This releases the source data, which does not get passed to the GPU.
+    vertices = std::move(decoded);
+    return true;
 }
 
-MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
-        void const* data, Callback destructor, void* user,
-        MaterialInstance* defaultMaterial) {
-    MaterialRegistry reg;
-    reg.registerMaterialInstance(utils::CString(DEFAULT_MATERIAL), defaultMaterial);
-    return loadMeshFromBuffer(engine, data, destructor, user, reg);
+// Decodes compressed indices, which replace the given section.
+bool decodeIndices(Header const& header, Section& indices) {
+    if (!(header.flags & COMPRESSION)) {
+        return true;
+    }
+    size_t const indexSize = header.indexType == UI16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    Section decoded = Section::allocate(indexSize * header.indexCount);
+    if (!decoded.data() || meshopt_decodeIndexBuffer(decoded.mutableData(), header.indexCount,
+            indexSize, indices.data(), indices.size())) {
+        return false;
+    }
+    indices = std::move(decoded);
+    return true;
 }
 
-MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
-        void const* data, Callback destructor, void* user,
-        MaterialRegistry& materials) {
-    const uint8_t* p = (const uint8_t*) data;
-    if (strncmp(MAGICID, (const char *) p, 8)) {
+// Reads the magic string, the header and the quantization parameters, which precede the vertices.
+template<typename Input>
+bool readHeader(Input& input, Header* header, Quantization* quantization) {
+    char magic[sizeof(MAGICID)];
+    if (!input.read(magic, sizeof(magic)) || strncmp(MAGICID, magic, sizeof(MAGICID))) {
         utils::slog.e << "Magic string not found." << utils::io::endl;
-        return {};
+        return false;
     }
-    p += 8;
 
-    Header* header = (Header*) p;
-    p += sizeof(Header);
+    if (!input.read(header, sizeof(Header))) {
+        utils::slog.e << "Unable to read the header." << utils::io::endl;
+        return false;
+    }
+    if (header->version > VERSION) {
+        utils::slog.e << "Unsupported filamesh version (" << header->version << ")."
+                << utils::io::endl;
+        return false;
+    }
 
-    uint8_t const* vertexData = p;
-    p += header->vertexSize;
+    *quantization = {};
+    if (header->flags & QUANTIZATION) {
+        if (!input.read(quantization, sizeof(Quantization)) ||
+                quantization->positionBits > 16 || quantization->uvBits > 16) {
+            utils::slog.e << "Invalid quantization." << utils::io::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
-    uint8_t const* indices = p;
-    p += header->indexSize;
+// Reads and decodes the vertices, which follow the header.
+template<typename Input>
+bool readVertices(Input& input, Header const& header, Quantization const& quantization,
+        Section* vertices) {
+    if (!input.take(header.vertexSize, vertices) ||
+            !decodeVertices(header, quantization, *vertices)) {
+        utils::slog.e << "Unable to decode vertex buffer." << utils::io::endl;
+        return false;
+    }
+    return true;
+}
 
-    Part* parts = (Part*) p;
-    p += header->parts * sizeof(Part);
+template<typename Input>
+MeshReader::Mesh loadMesh(Engine* engine, Input& input, MeshReader::MaterialRegistry& materials) {
+    Header header;
+    Quantization quantization;
+    if (!readHeader(input, &header, &quantization)) {
+        return {};
+    }
 
-    uint32_t materialCount = (uint32_t) *p;
-    p += sizeof(uint32_t);
+    // Vertices and indices are decoded as soon as they are read, so that a file is never
+    // entirely in memory.
+    Section vertices;
+    if (!readVertices(input, header, quantization, &vertices)) {
+        return {};
+    }
 
-    std::vector<std::string> partsMaterial(materialCount);
-    for (size_t i = 0; i < materialCount; i++) {
-        uint32_t nameLength = (uint32_t) *p;
-        p += sizeof(uint32_t);
-        partsMaterial[i] = (const char*) p;
-        p += nameLength + 1; // null terminated
+    Section indices;
+    if (!input.take(header.indexSize, &indices) || !decodeIndices(header, indices)) {
+        utils::slog.e << "Unable to decode index buffer." << utils::io::endl;
+        return {};
     }
 
-    Mesh mesh;
+    std::vector<Part> parts(header.parts);
+    uint32_t materialCount = 0;
+    bool valid = input.read(parts.data(), header.parts * sizeof(Part)) &&
+            input.read(&materialCount, sizeof(uint32_t));
+
+    std::vector<std::string> partsMaterial(valid ? materialCount : 0);
+    for (size_t i = 0; valid && i < materialCount; i++) {
+        uint32_t nameLength = 0;
+        valid = input.read(&nameLength, sizeof(uint32_t));
+        partsMaterial[i].resize(nameLength + 1); // null terminated
+        valid = valid && input.read(partsMaterial[i].data(), nameLength + 1);
+        partsMaterial[i].pop_back();
+    }
+    if (!valid) {
+        utils::slog.e << "Unable to read the parts and materials." << utils::io::endl;
+        return {};
+    }
+
+    // Parts are split evenly between the levels of detail, see LevelsOfDetail.
+    std::vector<float> screenSizes;
+    if (header.flags & LEVELS_OF_DETAIL) {
+        LevelsOfDetail lods{};
+        input.read(&lods, sizeof(LevelsOfDetail));
+        if (lods.levelCount > 1 && lods.levelCount <= RenderableManager::Builder::MAX_LEVEL_COUNT &&
+                header.parts % lods.levelCount == 0) {
+            screenSizes.resize(lods.levelCount);
+            if (!input.read(screenSizes.data(), lods.levelCount * sizeof(float))) {
+                screenSizes.clear();
+            }
+        } else if (lods.levelCount > 1) {
+            utils::slog.w << "Ignoring invalid levels of detail (" << lods.levelCount << ")"
+                    << utils::io::endl;
+        }
+    }
+
+    MeshReader::Mesh mesh;
 
     mesh.indexBuffer = IndexBuffer::Builder()
-            .indexCount(header->indexCount)
-            .bufferType(header->indexType == UI16 ? IndexBuffer::IndexType::USHORT
+            .indexCount(header.indexCount)
+            .bufferType(header.indexType == UI16 ? IndexBuffer::IndexType::USHORT
                     : IndexBuffer::IndexType::UINT)
             .build(*engine);
 
-    // If the index buffer is compressed, then decode the indices into a temporary buffer.
-    // The user callback can be called immediately afterwards because the source data does not get
-    // passed to the GPU.
-    const size_t indicesSize = header->indexSize;
-    if (header->flags & COMPRESSION) {
-        size_t indexSize = header->indexType == UI16 ? sizeof(uint16_t) : sizeof(uint32_t);
-        size_t indexCount = header->indexCount;
-        size_t uncompressedSize = indexSize * indexCount;
-        void* uncompressed = malloc(uncompressedSize);
-        int err = meshopt_decodeIndexBuffer(uncompressed, indexCount, indexSize, indices,
-                indicesSize);
-        if (err) {
-            utils::slog.e << "Unable to decode index buffer." << utils::io::endl;
-            return {};
-        }
-        if (destructor) {
-            destructor((void*) indices, indicesSize, user);
-        }
-        auto freecb = [](void* buffer, size_t size, void* user) { free(buffer); };
-        mesh.indexBuffer->setBuffer(*engine,
-                IndexBuffer::BufferDescriptor(uncompressed, uncompressedSize, freecb, nullptr));
-    } else {
-        mesh.indexBuffer->setBuffer(*engine,
-                IndexBuffer::BufferDescriptor(indices, indicesSize, destructor, user));
-    }
+    mesh.indexBuffer->setBuffer(*engine, indices.descriptor());
 
     VertexBuffer::Builder vbb;
-    vbb.vertexCount(header->vertexCount)
+    vbb.vertexCount(header.vertexCount)
             .bufferCount(1)
             .normalized(VertexAttribute::COLOR)
             .normalized(VertexAttribute::TANGENTS);
 
-    VertexBuffer::AttributeType uvtype = (header->flags & TEXCOORD_SNORM16) ?
+    VertexBuffer::AttributeType uvtype = (header.flags & TEXCOORD_SNORM16) ?
             VertexBuffer::AttributeType::SHORT2 : VertexBuffer::AttributeType::HALF2;
 
     vbb
             .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::HALF4,
-                        header->offsetPosition, uint8_t(header->stridePosition))
+                        header.offsetPosition, uint8_t(header.stridePosition))
             .attribute(VertexAttribute::TANGENTS, 0, VertexBuffer::AttributeType::SHORT4,
-                        header->offsetTangents, uint8_t(header->strideTangents))
+                        header.offsetTangents, uint8_t(header.strideTangents))
             .attribute(VertexAttribute::COLOR, 0, VertexBuffer::AttributeType::UBYTE4,
-                        header->offsetColor, uint8_t(header->strideColor))
+                        header.offsetColor, uint8_t(header.strideColor))
             .attribute(VertexAttribute::UV0, 0, uvtype,
-                        header->offsetUV0, uint8_t(header->strideUV0))
-            .normalized(VertexAttribute::UV0, header->flags & TEXCOORD_SNORM16);
+                        header.offsetUV0, uint8_t(header.strideUV0))
+            .normalized(VertexAttribute::UV0, header.flags & TEXCOORD_SNORM16);
 
     constexpr uint32_t uintmax = std::numeric_limits<uint32_t>::max();
-    const bool hasUV1 = header->offsetUV1 != uintmax && header->strideUV1 != uintmax;
+    const bool hasUV1 = header.offsetUV1 != uintmax && header.strideUV1 != uintmax;
 
     if (hasUV1) {
         vbb
             .attribute(VertexAttribute::UV1, 0, VertexBuffer::AttributeType::HALF2,
-                    header->offsetUV1, uint8_t(header->strideUV1))
+                    header.offsetUV1, uint8_t(header.strideUV1))
             .normalized(VertexAttribute::UV1);
     }
 
     mesh.vertexBuffer = vbb.build(*engine);
 
-    // If the vertex buffer is compressed, then decode the vertices into a temporary buffer.
-    // The user callback can be called immediately afterwards because the source data does not get
-    // passed to the GPU.
-    const size_t verticesSize = header->vertexSize;
-    if (header->flags & COMPRESSION) {
-        size_t vertexSize = sizeof(half4) + sizeof(short4) + sizeof(ubyte4) + sizeof(ushort2) +
-                (hasUV1 ? sizeof(ushort2) : 0);
-        size_t vertexCount = header->vertexCount;
-        size_t uncompressedSize = vertexSize * vertexCount;
-        void* uncompressed = malloc(uncompressedSize);
-        const uint8_t* srcdata = vertexData + sizeof(CompressionHeader);
-        int err = 0;
-        if (header->flags & INTERLEAVED) {
-            err |= meshopt_decodeVertexBuffer(uncompressed, vertexCount, vertexSize, srcdata,
-                    vertexSize);
-        } else {
-            const CompressionHeader* sizes = (CompressionHeader*) vertexData;
-            uint8_t* dstdata = (uint8_t*) uncompressed;
-            auto decode = meshopt_decodeVertexBuffer;
+    mesh.vertexBuffer->setBufferAt(*engine, 0, vertices.descriptor());
 
-            err |= decode(dstdata, vertexCount, sizeof(half4), srcdata, sizes->positions);
-            srcdata += sizes->positions;
-            dstdata += sizeof(half4) * vertexCount;
-
-            err |= decode(dstdata, vertexCount, sizeof(short4), srcdata, sizes->tangents);
-            srcdata += sizes->tangents;
-            dstdata += sizeof(short4) * vertexCount;
-
-            err |= decode(dstdata, vertexCount, sizeof(ubyte4), srcdata, sizes->colors);
-            srcdata += sizes->colors;
-            dstdata += sizeof(ubyte4) * vertexCount;
+    mesh.renderable = utils::EntityManager::get().create();
 
-            err |= decode(dstdata, vertexCount, sizeof(ushort2), srcdata, sizes->uv0);
+    RenderableManager::Builder builder(header.parts);
+    builder.boundingBox(header.aabb);
 
-            if (sizes->uv1) {
-                srcdata += sizes->uv0;
-                dstdata += sizeof(ushort2) * vertexCount;
-                err |= decode(dstdata, vertexCount, sizeof(ushort2), srcdata, sizes->uv1);
-            }
-        }
-        if (err) {
-            utils::slog.e << "Unable to decode vertex buffer." << utils::io::endl;
-            return {};
-        }
-        if (destructor) {
-            destructor((void*) vertexData, verticesSize, user);
-        }
-        auto freecb = [](void* buffer, size_t size, void* user) { free(buffer); };
-        mesh.vertexBuffer->setBufferAt(*engine, 0,
-                IndexBuffer::BufferDescriptor(uncompressed, uncompressedSize, freecb, nullptr));
-    } else {
-        mesh.vertexBuffer->setBufferAt(*engine, 0,
-                VertexBuffer::BufferDescriptor(vertexData, verticesSize, destructor, user));
+    const size_t partsPerLevel = screenSizes.empty() ? 0 : header.parts / screenSizes.size();
+    for (size_t level = 1; level < screenSizes.size(); level++) {
+        builder.levelOfDetail(uint8_t(level), level * partsPerLevel, screenSizes[level]);
     }
 
-    mesh.renderable = utils::EntityManager::get().create();
-
-    RenderableManager::Builder builder(header->parts);
-    builder.boundingBox(header->aabb);
-
     const auto defaultmi = materials.getMaterialInstance(utils::CString(DEFAULT_MATERIAL));
-    for (size_t i = 0; i < header->parts; i++) {
+    for (size_t i = 0; i < header.parts; i++) {
         builder.geometry(i, RenderableManager::PrimitiveType::TRIANGLES,
                 mesh.vertexBuffer, mesh.indexBuffer, parts[i].offset,
                 parts[i].minIndex, parts[i].maxIndex, parts[i].indexCount);
@@ -384,4 +588,51 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
     return mesh;
 }
 
+} // anonymous namespace
+
+namespace filamesh {
+
+MeshReader::Mesh MeshReader::loadMeshFromFile(filament::Engine* engine, const utils::Path& path,
+        MaterialRegistry& materials) {
+    int fd = open(path.c_str(), O_RDONLY | O_BINARY);
+    if (fd < 0) {
+        utils::slog.e << "Unable to open " << path.c_str() << utils::io::endl;
+        return {};
+    }
+    FileInput input(fd);
+    Mesh mesh = loadMesh(engine, input, materials);
+    close(fd);
+    return mesh;
+}
+
+MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
+        void const* data, Callback destructor, void* user,
+        MaterialInstance* defaultMaterial) {
+    MaterialRegistry reg;
+    reg.registerMaterialInstance(utils::CString(DEFAULT_MATERIAL), defaultMaterial);
+    return loadMeshFromBuffer(engine, data, destructor, user, reg);
+}
+
+MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
+        void const* data, Callback destructor, void* user,
+        MaterialRegistry& materials) {
+    BufferInput input(data, destructor, user);
+    return loadMesh(engine, input, materials);
+}
+
+size_t MeshReader::decodeVertices(void const* data, void* out, size_t size) {
+    BufferInput input(data, nullptr, nullptr);
+    Header header;
+    Quantization quantization;
+    Section vertices;
+    if (!readHeader(input, &header, &quantization) ||
+            !readVertices(input, header, quantization, &vertices)) {
+        return 0;
+    }
+    if (out && size >= vertices.size()) {
+        memcpy(out, vertices.data(), vertices.size());
+    }
+    return vertices.size();
+}
+
 } // namespace filamesh
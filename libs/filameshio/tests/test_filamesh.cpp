@@ -17,6 +17,7 @@
 #include <filament/Engine.h>
 #include <filament/Material.h>
 #include <filament/RenderableManager.h>
+#include <filament/VertexBuffer.h>
 
 #include <filameshio/filamesh.h>
 #include <filameshio/MeshReader.h>
@@ -27,8 +28,11 @@
 #include <math/quat.h>
 #include <math/vec3.h>
 
+#include <utils/Path.h>
+
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <sstream>
 
 using namespace filament;
@@ -216,6 +220,269 @@ TEST_F(FilameshTest, Interleaved) {
     engine->destroy(mi);
 }
 
+TEST_F(FilameshTest, QuantizedFromFile) {
+    // Serialize a single-triangle mesh with quantized positions and UVs, which are the size of
+    // the half floats they replace
+    const Header header {
+        .version = VERSION,
+        .parts = 1,
+        .aabb = unitBox,
+        .flags = QUANTIZATION,
+        .offsetTangents = sizeof(positions),
+        .offsetColor = sizeof(positions) + sizeof(tangents),
+        .offsetUV0 = sizeof(positions) + sizeof(tangents) + sizeof(colors),
+        .offsetUV1 = maxint,
+        .strideUV1 = maxint,
+        .vertexCount = vertexCount,
+        .vertexSize = sizeof(positions) + sizeof(tangents) + sizeof(colors) + sizeof(uv0),
+        .indexType = IndexType::UI16,
+        .indexCount = 3,
+        .indexSize = sizeof(uint16_t) * 3
+    };
+    const Quantization quantization {
+        .positionBits = 16,
+        .uvBits = 12,
+        .uvMin = float2(0, 0),
+        .uvMax = float2(1, 1)
+    };
+    const ushort4 quantizedPositions[] = {
+        { 0, 0, 0, 0 },
+        { 65535, 0, 32768, 0 },
+        { 0, 65535, 65535, 0 },
+    };
+    const ushort2 quantizedUV0[] = { { 0, 0 }, { 4095, 0 }, { 0, 4095 } };
+    const uint32_t nmats = 1;
+    const string matname = "DefaultMaterial";
+    const uint32_t matnamelength = matname.size();
+
+    utils::Path path = utils::Path::getTemporaryDirectory() + "quantized.filamesh";
+    {
+        ofstream stream(path.getPath(), ios::binary | ios::trunc);
+        write(stream, MAGICID, sizeof(MAGICID));
+        write(stream, &header, sizeof(header));
+        write(stream, &quantization, sizeof(quantization));
+        write(stream, quantizedPositions, sizeof(quantizedPositions));
+        write(stream, tangents, sizeof(tangents));
+        write(stream, colors, sizeof(colors));
+        write(stream, quantizedUV0, sizeof(quantizedUV0));
+        write(stream, indices, sizeof(indices));
+        write(stream, parts, sizeof(parts));
+        write(stream, &nmats, sizeof(nmats));
+        write(stream, &matnamelength, sizeof(matnamelength));
+        write(stream, matname.c_str(), matnamelength + 1);
+    }
+
+    // Deserialize the mesh as a smoke test.
+    MaterialInstance* mi = engine->getDefaultMaterial()->createInstance();
+    MeshReader::MaterialRegistry registry;
+    registry.registerMaterialInstance(utils::CString(matname.c_str()), mi);
+    auto mesh = MeshReader::loadMeshFromFile(engine, path, registry);
+    path.unlinkFile();
+    ASSERT_NE(mesh.vertexBuffer, nullptr);
+    EXPECT_EQ(mesh.vertexBuffer->getVertexCount(), vertexCount);
+    auto& rm = engine->getRenderableManager();
+    auto inst = rm.getInstance(mesh.renderable);
+    EXPECT_EQ(rm.getPrimitiveCount(inst), 1);
+
+    // Cleanup.
+    engine->destroy(mesh.renderable);
+    engine->destroy(mesh.vertexBuffer);
+    engine->destroy(mesh.indexBuffer);
+    engine->destroy(mi);
+}
+
+TEST(FilameshDecodeTest, QuantizedRoundTrip) {
+    // Quantize the attributes of a grid of vertices the way the filamesh tool does, then check
+    // that they are decoded within the quantization error, without an engine
+    constexpr size_t count = 64;
+    constexpr uint32_t positionBits = 12;
+    constexpr uint32_t uvBits = 10;
+    const Box aabb = { .center = float3(1, -2, 3), .halfExtent = float3(4, 5, 6) };
+    const float2 uvMin = float2(-0.5f, -0.25f);
+    const float2 uvMax = float2(0.75f, 1.0f);
+
+    vector<float3> sourcePositions(count);
+    vector<float2> sourceUVs(count);
+    vector<quatf> sourceTangents(count);
+    vector<ushort4> quantizedPositions(count);
+    vector<short4> packedTangents(count);
+    vector<ushort2> quantizedUVs(count);
+    vector<ubyte4> vertexColors(count, ubyte4(255));
+    for (size_t i = 0; i < count; i++) {
+        float3 const t = float3(i % 8, i / 8, (i * 5) % 7) / float3(7, 7, 6);
+        sourcePositions[i] = aabb.getMin() + t * aabb.halfExtent * 2.0f;
+        sourceUVs[i] = uvMin + t.xy * (uvMax - uvMin);
+        sourceTangents[i] = normalize(quatf::fromAxisAngle(normalize(t + 0.1f), float(i)));
+        float3 const q = round(t * float((1u << positionBits) - 1u));
+        float2 const uv = round(t.xy * float((1u << uvBits) - 1u));
+        quantizedPositions[i] = ushort4(q.x, q.y, q.z, 0);
+        quantizedUVs[i] = ushort2(uv);
+        packedTangents[i] = packSnorm16(sourceTangents[i].xyzw);
+    }
+
+    size_t const positionsSize = count * sizeof(ushort4);
+    size_t const tangentsSize = count * sizeof(short4);
+    size_t const colorsSize = count * sizeof(ubyte4);
+    size_t const uvsSize = count * sizeof(ushort2);
+    const Quantization quantization {
+        .positionBits = positionBits,
+        .uvBits = uvBits,
+        .uvMin = uvMin,
+        .uvMax = uvMax
+    };
+
+    float3 const positionError = aabb.halfExtent / float((1u << positionBits) - 1u);
+    float2 const uvError = (uvMax - uvMin) / float(2u * ((1u << uvBits) - 1u));
+    float const snormError = 0.5f / 32767.0f;
+
+    for (uint32_t flags : { uint32_t(QUANTIZATION), QUANTIZATION | TEXCOORD_SNORM16 }) {
+        const Header header {
+            .version = VERSION,
+            .parts = 1,
+            .aabb = aabb,
+            .flags = flags,
+            .offsetTangents = uint32_t(positionsSize),
+            .offsetColor = uint32_t(positionsSize + tangentsSize),
+            .offsetUV0 = uint32_t(positionsSize + tangentsSize + colorsSize),
+            .offsetUV1 = maxint,
+            .strideUV1 = maxint,
+            .vertexCount = count,
+            .vertexSize = uint32_t(positionsSize + tangentsSize + colorsSize + uvsSize),
+            .indexType = IndexType::UI16,
+        };
+
+        // Only the vertices are decoded, the rest of the file is not needed
+        stringstream stream(ios_base::out);
+        write(stream, MAGICID, sizeof(MAGICID));
+        write(stream, &header, sizeof(header));
+        write(stream, &quantization, sizeof(quantization));
+        write(stream, quantizedPositions.data(), positionsSize);
+        write(stream, packedTangents.data(), tangentsSize);
+        write(stream, vertexColors.data(), colorsSize);
+        write(stream, quantizedUVs.data(), uvsSize);
+        const string file = stream.str();
+
+        size_t const size = MeshReader::decodeVertices(file.data(), nullptr, 0);
+        ASSERT_EQ(size, header.vertexSize);
+        vector<uint8_t> decoded(size);
+        ASSERT_EQ(MeshReader::decodeVertices(file.data(), decoded.data(), size), size);
+
+        auto const* decodedPositions = (half4 const*) decoded.data();
+        auto const* decodedTangents = (short4 const*) (decoded.data() + header.offsetTangents);
+        auto const* decodedUVs = decoded.data() + header.offsetUV0;
+        for (size_t i = 0; i < count; i++) {
+            // Half floats add their own rounding error to the quantization error
+            float3 const position = float3(decodedPositions[i].xyz);
+            float3 const positionDiff = abs(position - sourcePositions[i]);
+            float3 const halfError = abs(sourcePositions[i]) / 1024.0f;
+            EXPECT_TRUE(all(lessThanEqual(positionDiff, positionError + halfError)))
+                    << "position " << i;
+            EXPECT_EQ(float(decodedPositions[i].w), 1.0f);
+
+            float4 const tangent = unpackSnorm16(decodedTangents[i]);
+            EXPECT_TRUE(all(lessThanEqual(abs(tangent - sourceTangents[i].xyzw),
+                    float4(snormError)))) << "tangent " << i;
+
+            float2 uv;
+            if (flags & TEXCOORD_SNORM16) {
+                short2 const value = ((short2 const*) decodedUVs)[i];
+                uv = float2(unpackSnorm16(value.x), unpackSnorm16(value.y));
+                EXPECT_TRUE(all(lessThanEqual(abs(uv - sourceUVs[i]), uvError + snormError)))
+                        << "uv " << i;
+            } else {
+                uv = float2(((half2 const*) decodedUVs)[i]);
+                EXPECT_TRUE(all(lessThanEqual(abs(uv - sourceUVs[i]),
+                        uvError + abs(sourceUVs[i]) / 1024.0f))) << "uv " << i;
+            }
+        }
+    }
+}
+
+TEST_F(FilameshTest, LevelsOfDetail) {
+    // Serialize the same triangle twice, as two levels of detail of a single part each
+    const Header header {
+        .version = VERSION,
+        .parts = 2,
+        .aabb = unitBox,
+        .flags = LEVELS_OF_DETAIL,
+        .offsetTangents = sizeof(positions),
+        .offsetColor = sizeof(positions) + sizeof(tangents),
+        .offsetUV0 = sizeof(positions) + sizeof(tangents) + sizeof(colors),
+        .offsetUV1 = maxint,
+        .strideUV1 = maxint,
+        .vertexCount = vertexCount,
+        .vertexSize = sizeof(positions) + sizeof(tangents) + sizeof(colors) + sizeof(uv0),
+        .indexType = IndexType::UI16,
+        .indexCount = 3,
+        .indexSize = sizeof(uint16_t) * 3
+    };
+    const uint32_t nmats = 1;
+    const string matname = "DefaultMaterial";
+    const uint32_t matnamelength = matname.size();
+    const float screenSizes[] = { 1.0f, 0.25f };
+
+    auto serialize = [&](uint32_t levelCount) {
+        const LevelsOfDetail lods { .levelCount = levelCount };
+        stringstream stream(ios_base::out);
+        write(stream, MAGICID, sizeof(MAGICID));
+        write(stream, &header, sizeof(header));
+        write(stream, positions, sizeof(positions));
+        write(stream, tangents, sizeof(tangents));
+        write(stream, colors, sizeof(colors));
+        write(stream, uv0, sizeof(uv0));
+        write(stream, indices, sizeof(indices));
+        write(stream, parts, sizeof(parts));
+        write(stream, parts, sizeof(parts));
+        write(stream, &nmats, sizeof(nmats));
+        write(stream, &matnamelength, sizeof(matnamelength));
+        write(stream, matname.c_str(), matnamelength + 1);
+        write(stream, &lods, sizeof(lods));
+        write(stream, screenSizes, sizeof(screenSizes));
+        return stream.str();
+    };
+
+    MaterialInstance* mi = engine->getDefaultMaterial()->createInstance();
+    auto& rm = engine->getRenderableManager();
+
+    // Each level gets one of the parts
+    auto mesh = MeshReader::loadMeshFromBuffer(engine, serialize(2).data(), nullptr, nullptr, mi);
+    auto inst = rm.getInstance(mesh.renderable);
+    EXPECT_EQ(rm.getPrimitiveCount(inst), 2);
+    EXPECT_EQ(rm.getLevelCount(inst), 2);
+    engine->destroy(mesh.renderable);
+    engine->destroy(mesh.vertexBuffer);
+    engine->destroy(mesh.indexBuffer);
+
+    // The parts can't be split evenly between 3 levels, all of them are drawn at level 0
+    mesh = MeshReader::loadMeshFromBuffer(engine, serialize(3).data(), nullptr, nullptr, mi);
+    inst = rm.getInstance(mesh.renderable);
+    EXPECT_EQ(rm.getPrimitiveCount(inst), 2);
+    EXPECT_EQ(rm.getLevelCount(inst), 1);
+    engine->destroy(mesh.renderable);
+    engine->destroy(mesh.vertexBuffer);
+    engine->destroy(mesh.indexBuffer);
+
+    engine->destroy(mi);
+}
+
+TEST_F(FilameshTest, UnsupportedVersion) {
+    const Header header {
+        .version = VERSION + 1,
+        .parts = 1,
+        .aabb = unitBox,
+    };
+    stringstream stream(ios_base::out);
+    write(stream, MAGICID, sizeof(MAGICID));
+    write(stream, &header, sizeof(header));
+
+    MaterialInstance* mi = engine->getDefaultMaterial()->createInstance();
+    auto mesh = MeshReader::loadMeshFromBuffer(engine, stream.str().data(), nullptr, nullptr, mi);
+    EXPECT_TRUE(mesh.renderable.isNull());
+    EXPECT_EQ(mesh.vertexBuffer, nullptr);
+    EXPECT_EQ(mesh.indexBuffer, nullptr);
+    engine->destroy(mi);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
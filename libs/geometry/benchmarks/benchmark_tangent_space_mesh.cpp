@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <geometry/TangentSpaceMesh.h>
+
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <utils/JobSystem.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace filament::geometry;
+using namespace filament::math;
+using namespace utils;
+
+namespace {
+
+using Algorithm = TangentSpaceMesh::Algorithm;
+
+// A wavy grid of size x size vertices, i.e. about 2 x size x size triangles.
+struct Grid {
+    explicit Grid(size_t size) {
+        positions.reserve(size * size);
+        normals.reserve(size * size);
+        uvs.reserve(size * size);
+        for (size_t y = 0; y < size; ++y) {
+            for (size_t x = 0; x < size; ++x) {
+                float const u = float(x) / float(size - 1);
+                float const v = float(y) / float(size - 1);
+                float const su = std::sin(u * 20.0f), cu = std::cos(u * 20.0f);
+                float const sv = std::sin(v * 20.0f), cv = std::cos(v * 20.0f);
+                positions.push_back(float3{ u, 0.1f * su * cv, v });
+                normals.push_back(normalize(float3{ -2.0f * cu * cv, 1.0f, 2.0f * su * sv }));
+                uvs.push_back(float2{ u, v });
+            }
+        }
+        triangles.reserve(2 * (size - 1) * (size - 1));
+        for (uint32_t y = 0; y + 1 < size; ++y) {
+            for (uint32_t x = 0; x + 1 < size; ++x) {
+                uint32_t const i = uint32_t(y * size + x);
+                uint32_t const s = uint32_t(size);
+                triangles.push_back(uint3{ i, i + s, i + 1 });
+                triangles.push_back(uint3{ i + 1, i + s, i + s + 1 });
+            }
+        }
+    }
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<uint3> triangles;
+};
+
+Grid const& getGrid() {
+    // 1024 x 1024 vertices, about 2M triangles
+    static Grid const grid(1024);
+    return grid;
+}
+
+} // anonymous namespace
+
+// Arguments: the algorithm, and whether a job system is used.
+static void BM_TangentSpaceMesh(benchmark::State& state) {
+    Algorithm const algorithm = Algorithm(state.range(0));
+    bool const parallel = state.range(1) != 0;
+    Grid const& grid = getGrid();
+
+    JobSystem js;
+    js.adopt();
+
+    for (auto _ : state) {
+        TangentSpaceMesh* mesh = TangentSpaceMesh::Builder()
+                .vertexCount(grid.positions.size())
+                .normals(grid.normals.data())
+                .positions(grid.positions.data())
+                .uvs(grid.uvs.data())
+                .triangleCount(grid.triangles.size())
+                .triangles(grid.triangles.data())
+                .algorithm(algorithm)
+                .jobSystem(parallel ? &js : nullptr)
+                .build();
+        benchmark::DoNotOptimize(mesh);
+        TangentSpaceMesh::destroy(mesh);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(grid.triangles.size()));
+    state.SetLabel(parallel ? "parallel" : "serial");
+
+    js.emancipate();
+}
+
+static void algorithms(benchmark::internal::Benchmark* b) {
+    for (Algorithm algorithm : { Algorithm::MIKKTSPACE, Algorithm::LENGYEL, Algorithm::FRISVAD,
+            Algorithm::FLAT_SHADING }) {
+        b->Args({ int(algorithm), 0 });
+        b->Args({ int(algorithm), 1 });
+    }
+}
+
+BENCHMARK(BM_TangentSpaceMesh)
+        ->ArgNames({ "algorithm", "parallel" })
+        ->Apply(algorithms)
+        ->Unit(benchmark::kMillisecond);
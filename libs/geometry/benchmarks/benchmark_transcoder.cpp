@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <geometry/Transcoder.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace filament::geometry;
+
+// Number of vertices converted by each iteration, about the size of a large glTF accessor.
+static constexpr size_t VERTEX_COUNT = 1024 * 1024;
+
+// Arguments: the component type, whether the values are normalized, the component count, and the
+// input stride in bytes. Tightly packed inputs take the SIMD paths, the others are converted
+// element by element.
+static void BM_Transcoder(benchmark::State& state) {
+    Transcoder::Config const config{
+        .componentType = ComponentType(state.range(0)),
+        .normalized = state.range(1) != 0,
+        .componentCount = uint32_t(state.range(2)),
+        .inputStrideBytes = uint32_t(state.range(3)),
+    };
+    Transcoder const transcode(config);
+
+    std::vector<uint8_t> source(VERTEX_COUNT * config.inputStrideBytes);
+    // The odd bytes keep the halves within [0.5, 2), denormals would dominate the timings.
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = uint8_t(i & 1 ? 0x38 + (i >> 1) % 8 : i * 31);
+    }
+    std::vector<float> target(VERTEX_COUNT * config.componentCount);
+
+    for (auto _ : state) {
+        transcode(target.data(), source.data(), VERTEX_COUNT);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(source.size()));
+}
+
+BENCHMARK(BM_Transcoder)
+        ->ArgNames({ "type", "normalized", "components", "stride" })
+        ->Args({ int(ComponentType::UBYTE), 1, 4, 4 })
+        ->Args({ int(ComponentType::UBYTE), 1, 4, 8 })
+        ->Args({ int(ComponentType::BYTE), 1, 4, 4 })
+        ->Args({ int(ComponentType::BYTE), 1, 4, 8 })
+        ->Args({ int(ComponentType::USHORT), 1, 2, 4 })
+        ->Args({ int(ComponentType::USHORT), 1, 2, 8 })
+        ->Args({ int(ComponentType::SHORT), 1, 3, 6 })
+        ->Args({ int(ComponentType::SHORT), 1, 3, 8 })
+        ->Args({ int(ComponentType::HALF), 0, 4, 8 })
+        ->Args({ int(ComponentType::HALF), 0, 4, 12 })
+        ->Args({ int(ComponentType::FLOAT), 0, 3, 12 })
+        ->Args({ int(ComponentType::FLOAT), 0, 3, 32 });
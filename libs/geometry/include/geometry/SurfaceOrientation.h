@@ -23,6 +23,10 @@
 
 #include <utils/compiler.h>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 
 /**
@@ -84,6 +88,14 @@ public:
         Builder& triangles(const filament::math::uint3*) noexcept;
         Builder& triangles(const filament::math::ushort3*) noexcept;
 
+        /**
+         * Optional job system used to split the computation of large meshes into chunks that
+         * run in parallel. build() still returns once the computation is complete, and must then
+         * be called from a thread of the job system, or from a thread that adopted it. The
+         * results are the same with and without a job system.
+         */
+        Builder& jobSystem(utils::JobSystem* jobSystem) noexcept;
+
         /**
          * Generates quats or returns null if the submitted data is an incomplete combination.
          */
@@ -21,6 +21,10 @@
 #include <math/vec3.h>
 #include <math/vec4.h>
 
+namespace utils {
+class JobSystem;
+} // namespace utils
+
 namespace filament {
 namespace geometry {
 
@@ -183,6 +187,20 @@ public:
 
         Builder& algorithm(Algorithm algorithm) noexcept;
 
+        /**
+         * Optional job system used to split the computation of large meshes into chunks that
+         * run in parallel. build() still returns once the computation is complete, and must then
+         * be called from a thread of the job system, or from a thread that adopted it. The
+         * results are the same with and without a job system.
+         *
+         * MIKKTSPACE only runs its frame packing in parallel: the library itself processes the
+         * whole mesh at once, since its smoothing groups may span any number of triangles.
+         *
+         * @param jobSystem The job system, or nullptr to compute on the calling thread (default)
+         * @return Builder
+         */
+        Builder& jobSystem(utils::JobSystem* jobSystem) noexcept;
+
         /**
          * Computes the tangent space mesh. The resulting mesh object is owned by the callee. The
          * callee must call TangentSpaceMesh::destroy on the object once they are finished with it.
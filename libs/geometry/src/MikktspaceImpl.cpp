@@ -19,7 +19,6 @@
 #include <math/mat3.h>
 #include <math/norm.h>
 
-
 #include <meshoptimizer.h>
 #include <mikktspace/mikktspace.h>
 
@@ -70,18 +69,10 @@ void MikktspaceImpl::getTexCoord(SMikkTSpaceContext const* context, float fvTexc
 
 void MikktspaceImpl::setTSpaceBasic(SMikkTSpaceContext const* context, float const fvTangent[],
         float const fSign, int const iFace, int const iVert) noexcept {
+    // The frames are packed later, possibly in parallel, MikkTSpace runs on a single thread.
     auto const wrapper = MikktspaceImpl::getThis(context);
-    uint32_t const vertInd = wrapper->getTriangle(iFace)[iVert];
-    float3 const pos = *pointerAdd(wrapper->mPositions, vertInd, wrapper->mPositionStride);
-    float3 const n = normalize(*pointerAdd(wrapper->mNormals, vertInd, wrapper->mNormalStride));
-    float2 const uv = *pointerAdd(wrapper->mUVs, vertInd, wrapper->mUVStride);
-    float3 const t{fvTangent[0], fvTangent[1], fvTangent[2]};
-    float3 const b = fSign * normalize(cross(n, t));
-
-    // TODO: packTangentFrame actually changes the orientation of b.
-    quatf const quat = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-
-    wrapper->mOutVertices.push_back({pos, uv, quat});
+    wrapper->mCornerTangents[iFace * 3 + iVert] = {
+            float3{fvTangent[0], fvTangent[1], fvTangent[2]}, fSign };
 }
 
 MikktspaceImpl::MikktspaceImpl(const TangentSpaceMeshInput* input) noexcept
@@ -95,7 +86,7 @@ MikktspaceImpl::MikktspaceImpl(const TangentSpaceMeshInput* input) noexcept
       mIsTriangle16(input->triangles16),
       mTriangles(
               input->triangles16 ? (uint8_t*) input->triangles16 : (uint8_t*) input->triangles32) {
-    mOutVertices.reserve(mFaceCount * 3);
+    mCornerTangents.resize(mFaceCount * 3);
 }
 
 MikktspaceImpl* MikktspaceImpl::getThis(SMikkTSpaceContext const* context) noexcept {
@@ -108,7 +99,7 @@ inline const uint3 MikktspaceImpl::getTriangle(int const triangleIndex) const no
                          : *(uint3*) (pointerAdd(mTriangles, triangleIndex, tstride));
 }
 
-void MikktspaceImpl::run(TangentSpaceMeshOutput* output) noexcept {
+void MikktspaceImpl::run(TangentSpaceMeshOutput* output, utils::JobSystem* js) noexcept {
     SMikkTSpaceInterface interface {
         .m_getNumFaces = MikktspaceImpl::getNumFaces,
         .m_getNumVerticesOfFace = MikktspaceImpl::getNumVerticesOfFace,
@@ -120,26 +111,50 @@ void MikktspaceImpl::run(TangentSpaceMeshOutput* output) noexcept {
     SMikkTSpaceContext context{.m_pInterface = &interface, .m_pUserData = this};
     genTangSpaceDefault(&context);
 
-    std::vector<unsigned int> remap(mOutVertices.size());
-    size_t vertexCount = meshopt_generateVertexRemap(remap.data(), NULL, mOutVertices.size(),
-            mOutVertices.data(), mOutVertices.size(), sizeof(IOVertex));
+    size_t const cornerCount = mCornerTangents.size();
+    std::vector<IOVertex> outVertices(cornerCount);
+    parallelFor(js, mFaceCount, [&](size_t start, size_t count) {
+        for (size_t face = start; face < start + count; ++face) {
+            uint3 const tri = getTriangle(int(face));
+            for (size_t vert = 0; vert < 3; ++vert) {
+                uint32_t const vertInd = tri[vert];
+                CornerTangent const& corner = mCornerTangents[face * 3 + vert];
+                float3 const pos = *pointerAdd(mPositions, vertInd, mPositionStride);
+                float3 const n = normalize(*pointerAdd(mNormals, vertInd, mNormalStride));
+                float2 const uv = *pointerAdd(mUVs, vertInd, mUVStride);
+                float3 const t = corner.tangent;
+                float3 const b = corner.sign * normalize(cross(n, t));
+
+                // TODO: packTangentFrame actually changes the orientation of b.
+                quatf const quat = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+
+                outVertices[face * 3 + vert] = {pos, uv, quat};
+            }
+        }
+    });
+
+    std::vector<unsigned int> remap(cornerCount);
+    size_t vertexCount = meshopt_generateVertexRemap(remap.data(), NULL, cornerCount,
+            outVertices.data(), cornerCount, sizeof(IOVertex));
 
     std::vector<IOVertex> newVertices(vertexCount);
-    meshopt_remapVertexBuffer((void*) newVertices.data(), mOutVertices.data(), mOutVertices.size(),
+    meshopt_remapVertexBuffer((void*) newVertices.data(), outVertices.data(), cornerCount,
             sizeof(IOVertex), remap.data());
 
     uint3* triangles32 = output->triangles32.allocate(mFaceCount);
-    meshopt_remapIndexBuffer((uint32_t*) triangles32, NULL, mOutVertices.size(), remap.data());
+    meshopt_remapIndexBuffer((uint32_t*) triangles32, NULL, cornerCount, remap.data());
 
     float3* outPositions = output->positions.allocate(vertexCount);
     float2* outUVs = output->uvs.allocate(vertexCount);
     quatf* outQuats = output->tangentSpace.allocate(vertexCount);
 
-    for (size_t i = 0; i < vertexCount; ++i) {
-        outPositions[i] = newVertices[i].position;
-        outUVs[i] = newVertices[i].uv;
-        outQuats[i] = newVertices[i].tangentSpace;
-    }
+    parallelFor(js, vertexCount, [&](size_t start, size_t count) {
+        for (size_t i = start; i < start + count; ++i) {
+            outPositions[i] = newVertices[i].position;
+            outUVs[i] = newVertices[i].uv;
+            outQuats[i] = newVertices[i].tangentSpace;
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = mFaceCount;
@@ -44,7 +44,8 @@ public:
     MikktspaceImpl(MikktspaceImpl const&) = delete;
     MikktspaceImpl& operator=(MikktspaceImpl const&) = delete;
 
-    void run(TangentSpaceMeshOutput* output) noexcept;
+    // The job system, which can be null, packs the tangent frames and remaps the vertices.
+    void run(TangentSpaceMeshOutput* output, utils::JobSystem* js) noexcept;
 
 private:
     static int getNumFaces(SMikkTSpaceContext const* context) noexcept;
@@ -58,6 +59,12 @@ private:
     static void setTSpaceBasic(SMikkTSpaceContext const* context, float const fvTangent[],
             float const fSign, int const iFace, int const iVert) noexcept;
 
+    // The tangent computed by MikkTSpace for a triangle corner.
+    struct CornerTangent {
+        float3 tangent;
+        float sign;
+    };
+
     static MikktspaceImpl* getThis(SMikkTSpaceContext const* context) noexcept;
 
     inline const uint3 getTriangle(int const triangleIndex) const noexcept;
@@ -72,7 +79,7 @@ private:
     uint8_t const* mTriangles;
     bool mIsTriangle16;
 
-    std::vector<IOVertex> mOutVertices;
+    std::vector<CornerTangent> mCornerTangents;   // indexed by face * 3 + vertex
 };
 
 }// namespace filament::geometry
@@ -16,6 +16,9 @@
 
 #include <geometry/SurfaceOrientation.h>
 
+#include "TangentSpaceMeshInternal.h"
+
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 #include <utils/debug.h>
 
@@ -44,6 +47,7 @@ struct OrientationBuilderImpl {
     size_t uvStride = 0;
     size_t positionStride = 0;
     size_t triangleCount = 0;
+    utils::JobSystem* jobSystem = nullptr;
     SurfaceOrientation* buildWithNormalsOnly();
     SurfaceOrientation* buildWithSuppliedTangents();
     SurfaceOrientation* buildWithUvs();
@@ -111,6 +115,11 @@ Builder& Builder::triangles(const ushort3* triangles) noexcept {
     return *this;
 }
 
+Builder& Builder::jobSystem(utils::JobSystem* jobSystem) noexcept {
+    mImpl->jobSystem = jobSystem;
+    return *this;
+}
+
 SurfaceOrientation* Builder::build() {
     if (!ASSERT_PRECONDITION_NON_FATAL(mImpl->vertexCount > 0, "Vertex count must be non-zero.")) {
         return nullptr;
@@ -173,16 +182,17 @@ static void frisvadTangentSpace(const float3& N, float3& T, float3& B) {
 SurfaceOrientation* OrientationBuilderImpl::buildWithNormalsOnly() {
     vector<quatf> quats(vertexCount);
 
-    const float3* normal = this->normals;
+    const float3* normals = this->normals;
     size_t nstride = this->normalStride ? this->normalStride : sizeof(float3);
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 n = *normal;
-        float3 b, t;
-        frisvadTangentSpace(n, t, b);
-        quats[qindex] = mat3f::packTangentFrame({t, b, n});
-        normal = (const float3*) (((const uint8_t*) normal) + nstride);
-    }
+    parallelFor(jobSystem, vertexCount, [&](size_t start, size_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 n = *pointerAdd(normals, qindex, nstride);
+            float3 b, t;
+            frisvadTangentSpace(n, t, b);
+            quats[qindex] = mat3f::packTangentFrame({t, b, n});
+        }
+    });
 
     return new SurfaceOrientation(new OrientationImpl( { std::move(quats) } ));
 }
@@ -190,29 +200,28 @@ SurfaceOrientation* OrientationBuilderImpl::buildWithNormalsOnly() {
 SurfaceOrientation* OrientationBuilderImpl::buildWithSuppliedTangents() {
     vector<quatf> quats(vertexCount);
 
-    const float3* normal = this->normals;
+    const float3* normals = this->normals;
     size_t nstride = this->normalStride ? this->normalStride : sizeof(float3);
 
-    const float3* tanvec = (const float3*) this->tangents;
-    const float* tandir = &this->tangents->w;
+    const float4* tangents = this->tangents;
     size_t tstride = this->tangentStride ? this->tangentStride : sizeof(float4);
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 n = *normal;
-        float3 t = *tanvec;
-        float3 b = *tandir > 0 ? cross(t, n) : cross(n, t);
-
-        // Some assets do not provide perfectly orthogonal tangents and normals, so we adjust the
-        // tangent to enforce orthonormality. We would rather honor the exact normal vector than
-        // the exact tangent vector since the latter is only used for bump mapping and anisotropic
-        // lighting.
-        t = *tandir > 0 ? cross(n, b) : cross(b, n);
-
-        quats[qindex] = mat3f::packTangentFrame({t, b, n});
-        normal = (const float3*) (((const uint8_t*) normal) + nstride);
-        tanvec = (const float3*) (((const uint8_t*) tanvec) + tstride);
-        tandir = (const float*) (((const uint8_t*) tandir) + tstride);
-    }
+    parallelFor(jobSystem, vertexCount, [&](size_t start, size_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 n = *pointerAdd(normals, qindex, nstride);
+            float4 const& tangent = *pointerAdd(tangents, qindex, tstride);
+            float3 t = tangent.xyz;
+            float3 b = tangent.w > 0 ? cross(t, n) : cross(n, t);
+
+            // Some assets do not provide perfectly orthogonal tangents and normals, so we adjust
+            // the tangent to enforce orthonormality. We would rather honor the exact normal vector
+            // than the exact tangent vector since the latter is only used for bump mapping and
+            // anisotropic lighting.
+            t = tangent.w > 0 ? cross(n, b) : cross(b, n);
+
+            quats[qindex] = mat3f::packTangentFrame({t, b, n});
+        }
+    });
 
     return new SurfaceOrientation(new OrientationImpl( { std::move(quats) } ));
 }
@@ -239,13 +248,8 @@ SurfaceOrientation* OrientationBuilderImpl::buildWithUvs() {
     if (!ASSERT_PRECONDITION_NON_FATAL(this->positionStride == 0, "Non-zero positions stride not yet supported.")) {
         return nullptr;
     }
-    vector<float3> tan1(vertexCount);
-    vector<float3> tan2(vertexCount);
-    memset(tan1.data(), 0, sizeof(float3) * vertexCount);
-    memset(tan2.data(), 0, sizeof(float3) * vertexCount);
-    for (size_t a = 0; a < triangleCount; ++a) {
-        uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+    // Computes the directions of the given triangle.
+    auto kernel = [this](uint3 const& tri, float3* sdir, float3* tdir) {
         const float3& v1 = positions[tri.x];
         const float3& v2 = positions[tri.y];
         const float3& v3 = positions[tri.z];
@@ -263,43 +267,96 @@ SurfaceOrientation* OrientationBuilderImpl::buildWithUvs() {
         float t1 = w2.y - w1.y;
         float t2 = w3.y - w1.y;
         float d = s1 * t2 - s2 * t1;
-        float3 sdir, tdir;
         // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
         // least avoid divide-by-zero and fall back to normals-only method.
         if (d == 0.0) {
             const float3& n1 = normals[tri.x];
-            sdir = randomPerp(n1);
-            tdir = cross(n1, sdir);
+            *sdir = randomPerp(n1);
+            *tdir = cross(n1, *sdir);
         } else {
-            sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
-            tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
+            *sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
+            *tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
             float r = 1.0f / d;
-            sdir *= r;
-            tdir *= r;
+            *sdir *= r;
+            *tdir *= r;
+        }
+    };
+
+    vector<float3> tan1(vertexCount, float3{0.0f});
+    vector<float3> tan2(vertexCount, float3{0.0f});
+    if (!jobSystem) {
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            float3 sdir, tdir;
+            kernel(tri, &sdir, &tdir);
+            tan1[tri.x] += sdir;
+            tan1[tri.y] += sdir;
+            tan1[tri.z] += sdir;
+            tan2[tri.x] += tdir;
+            tan2[tri.y] += tdir;
+            tan2[tri.z] += tdir;
+        }
+    } else {
+        // The directions of the triangles are computed in parallel, then each vertex sums the
+        // directions of its triangles in the same order as above, the results are identical.
+        vector<float3> sdirs(triangleCount);
+        vector<float3> tdirs(triangleCount);
+        parallelFor(jobSystem, triangleCount, [&](size_t start, size_t count) {
+            for (size_t a = start; a < start + count; ++a) {
+                uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+                kernel(tri, &sdirs[a], &tdirs[a]);
+            }
+        });
+
+        // Sort the triangle corners by vertex, keeping them in triangle order for each vertex.
+        vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            offsets[tri.x + 1]++;
+            offsets[tri.y + 1]++;
+            offsets[tri.z + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+        vector<uint32_t> vertexTriangles(triangleCount * 3);
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            vertexTriangles[cursors[tri.x]++] = uint32_t(a);
+            vertexTriangles[cursors[tri.y]++] = uint32_t(a);
+            vertexTriangles[cursors[tri.z]++] = uint32_t(a);
         }
-        tan1[tri.x] += sdir;
-        tan1[tri.y] += sdir;
-        tan1[tri.z] += sdir;
-        tan2[tri.x] += tdir;
-        tan2[tri.y] += tdir;
-        tan2[tri.z] += tdir;
+
+        parallelFor(jobSystem, vertexCount, [&](size_t start, size_t count) {
+            for (size_t v = start; v < start + count; ++v) {
+                for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    tan1[v] += sdirs[vertexTriangles[i]];
+                    tan2[v] += tdirs[vertexTriangles[i]];
+                }
+            }
+        });
     }
 
     vector<quatf> quats(vertexCount);
-    for (size_t a = 0; a < vertexCount; a++) {
-        const float3& n = normals[a];
-        const float3& t1 = tan1[a];
-        const float3& t2 = tan2[a];
+    parallelFor(jobSystem, vertexCount, [&](size_t start, size_t count) {
+        for (size_t a = start; a < start + count; a++) {
+            const float3& n = normals[a];
+            const float3& t1 = tan1[a];
+            const float3& t2 = tan2[a];
 
-        // Gram-Schmidt orthogonalize
-        float3 t = normalize(t1 - n * dot(n, t1));
+            // Gram-Schmidt orthogonalize
+            float3 t = normalize(t1 - n * dot(n, t1));
 
-        // Calculate handedness
-        float w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
+            // Calculate handedness
+            float w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
 
-        float3 b = w < 0 ? cross(t, n) : cross(n, t);
-        quats[a] = mat3f::packTangentFrame({t, b, n});
-    }
+            float3 b = w < 0 ? cross(t, n) : cross(n, t);
+            quats[a] = mat3f::packTangentFrame({t, b, n});
+        }
+    });
     return new SurfaceOrientation(new OrientationImpl( { std::move(quats) } ));
 }
 
@@ -351,17 +408,25 @@ void SurfaceOrientation::getQuats(quath* out, size_t quatCount, size_t stride) c
 }
 
 SurfaceOrientation* OrientationBuilderImpl::buildWithFlatNormals() {
+    // The normals of the triangles are computed in parallel, each vertex then gets the normal of
+    // the last triangle that uses it.
+    vector<float3> faceNormals(triangleCount);
+    parallelFor(jobSystem, triangleCount, [&](size_t start, size_t count) {
+        for (size_t a = start; a < start + count; ++a) {
+            const uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            const float3 v1 = positions[tri.x];
+            const float3 v2 = positions[tri.y];
+            const float3 v3 = positions[tri.z];
+            faceNormals[a] = normalize(cross(v2 - v1, v3 - v1));
+        }
+    });
     float3* normals = new float3[vertexCount];
     for (size_t a = 0; a < triangleCount; ++a) {
         const uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
-        const float3 v1 = positions[tri.x];
-        const float3 v2 = positions[tri.y];
-        const float3 v3 = positions[tri.z];
-        const float3 normal = normalize(cross(v2 - v1, v3 - v1));
-        normals[tri.x] = normal;
-        normals[tri.y] = normal;
-        normals[tri.z] = normal;
+        normals[tri.x] = faceNormals[a];
+        normals[tri.y] = faceNormals[a];
+        normals[tri.z] = faceNormals[a];
     }
     this->normals = normals;
     SurfaceOrientation* result = buildWithNormalsOnly();
@@ -175,12 +175,13 @@ void frisvadMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* o
     float3 const* UTILS_RESTRICT normals = input->normals;
     size_t nstride = input->normalStride ? input->normalStride : sizeof(float3);
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        auto const [b, t] = frisvadKernel(n);
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
+    parallelFor(input->jobSystem, vertexCount, [=](size_t start, size_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 const n = *pointerAdd(normals, qindex, nstride);
+            auto const [b, t] = frisvadKernel(n);
+            quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
 
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
@@ -198,21 +199,22 @@ void hughesMollerMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutp
     float3 const* UTILS_RESTRICT normals = input->normals;
     size_t nstride = input->normalStride ? input->normalStride : sizeof(float3);
 
-    for (size_t qindex = 0; qindex < vertexCount; ++qindex) {
-        float3 const n = *normals;
-        float3 b, t;
+    parallelFor(input->jobSystem, vertexCount, [=](size_t start, size_t count) {
+        for (size_t qindex = start; qindex < start + count; ++qindex) {
+            float3 const n = *pointerAdd(normals, qindex, nstride);
+            float3 b, t;
 
-        if (abs(n.x) > abs(n.z) + std::numeric_limits<float>::epsilon()) {
-            t = float3{-n.y, n.x, 0.0f};
-        } else {
-            t = float3{0.0f, -n.z, n.y};
-        }
-        t = normalize(t);
-        b = cross(n, t);
+            if (abs(n.x) > abs(n.z) + std::numeric_limits<float>::epsilon()) {
+                t = float3{-n.y, n.x, 0.0f};
+            } else {
+                t = float3{0.0f, -n.z, n.y};
+            }
+            t = normalize(t);
+            b = cross(n, t);
 
-        quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        normals = pointerAdd(normals, 1, nstride);
-    }
+            quats[qindex] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
     output->vertexCount = input->vertexCount;
     output->triangleCount = input->triangleCount;
     output->uvs.borrow(input->uvs);
@@ -244,37 +246,39 @@ void flatShadingMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutpu
     size_t const outTriangleCount = triangleCount;
     uint3* outTriangles = output->triangles32.allocate(outTriangleCount);
 
-    size_t vindex = 0;
-    for (size_t tindex = 0; tindex < triangleCount; ++tindex) {
-        uint3 tri = isTriangle16 ?
-                uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
-                *(uint3*)(pointerAdd(triangles, tindex, tstride));
+    // Each triangle gets its own 3 vertices, so the triangles can be processed in any order.
+    parallelFor(input->jobSystem, triangleCount, [=](size_t start, size_t count) {
+        for (size_t tindex = start; tindex < start + count; ++tindex) {
+            uint3 tri = isTriangle16 ?
+                    uint3(*(ushort3*)(pointerAdd(triangles, tindex, tstride))) :
+                    *(uint3*)(pointerAdd(triangles, tindex, tstride));
 
-        float3 const pa = *pointerAdd(positions, tri.x, pstride);
-        float3 const pb = *pointerAdd(positions, tri.y, pstride);
-        float3 const pc = *pointerAdd(positions, tri.z, pstride);
+            float3 const pa = *pointerAdd(positions, tri.x, pstride);
+            float3 const pb = *pointerAdd(positions, tri.y, pstride);
+            float3 const pc = *pointerAdd(positions, tri.z, pstride);
 
-        uint32_t i0 = vindex++, i1 = vindex++, i2 = vindex++;
-        outTriangles[tindex] = uint3{i0, i1, i2};
+            uint32_t const i0 = uint32_t(tindex * 3), i1 = i0 + 1, i2 = i0 + 2;
+            outTriangles[tindex] = uint3{i0, i1, i2};
 
-        outPositions[i0] = pa;
-        outPositions[i1] = pb;
-        outPositions[i2] = pc;
+            outPositions[i0] = pa;
+            outPositions[i1] = pb;
+            outPositions[i2] = pc;
 
-        float3 const n = normalize(cross(pc - pb, pa - pb));
-        const auto [t, b] = frisvadKernel(n);
+            float3 const n = normalize(cross(pc - pb, pa - pb));
+            const auto [t, b] = frisvadKernel(n);
 
-        quatf const tspace = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-        quats[i0] = tspace;
-        quats[i1] = tspace;
-        quats[i2] = tspace;
+            quatf const tspace = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+            quats[i0] = tspace;
+            quats[i1] = tspace;
+            quats[i2] = tspace;
 
-        if (outUvs) {
-            outUvs[i0] = *pointerAdd(uvs, tri.x, uvstride);
-            outUvs[i1] = *pointerAdd(uvs, tri.y, uvstride);
-            outUvs[i2] = *pointerAdd(uvs, tri.z, uvstride);
+            if (outUvs) {
+                outUvs[i0] = *pointerAdd(uvs, tri.x, uvstride);
+                outUvs[i1] = *pointerAdd(uvs, tri.y, uvstride);
+                outUvs[i2] = *pointerAdd(uvs, tri.z, uvstride);
+            }
         }
-    }
+    });
 
     output->vertexCount = outVertexCount;
     output->triangleCount = outTriangleCount;
@@ -282,7 +286,7 @@ void flatShadingMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutpu
 
 void mikktspaceMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* output) {
     MikktspaceImpl impl(input);
-    impl.run(output);
+    impl.run(output, input->jobSystem);
 }
 
 inline float3 randomPerp(float3 const& n) {
@@ -295,77 +299,133 @@ inline float3 randomPerp(float3 const& n) {
     return perp / sqrlen;
 }
 
+// Computes the tangent and bitangent directions of a triangle from its positions and UVs.
+inline void lengyelKernel(TangentSpaceMeshInput const* input, uint3 const tri,
+        float3* outSdir, float3* outTdir) noexcept {
+    size_t const positionStride = input->positionStride ? input->positionStride : sizeof(float3);
+    size_t const normalStride = input->normalStride ? input->normalStride : sizeof(float3);
+    size_t const uvStride = input->uvStride ? input->uvStride : sizeof(float2);
+    float3 const& v1 = *pointerAdd(input->positions, tri.x, positionStride);
+    float3 const& v2 = *pointerAdd(input->positions, tri.y, positionStride);
+    float3 const& v3 = *pointerAdd(input->positions, tri.z, positionStride);
+    float2 const& w1 = *pointerAdd(input->uvs, tri.x, uvStride);
+    float2 const& w2 = *pointerAdd(input->uvs, tri.y, uvStride);
+    float2 const& w3 = *pointerAdd(input->uvs, tri.z, uvStride);
+    float const x1 = v2.x - v1.x;
+    float const x2 = v3.x - v1.x;
+    float const y1 = v2.y - v1.y;
+    float const y2 = v3.y - v1.y;
+    float const z1 = v2.z - v1.z;
+    float const z2 = v3.z - v1.z;
+    float const s1 = w2.x - w1.x;
+    float const s2 = w3.x - w1.x;
+    float const t1 = w2.y - w1.y;
+    float const t2 = w3.y - w1.y;
+    float const d = s1 * t2 - s2 * t1;
+    float3 sdir, tdir;
+    // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
+    // least avoid divide-by-zero and fall back to normals-only method.
+    if (d == 0.0) {
+        float3 const& n1 = *pointerAdd(input->normals, tri.x, normalStride);
+        sdir = randomPerp(n1);
+        tdir = cross(n1, sdir);
+    } else {
+        sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
+        tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
+        float const r = 1.0f / d;
+        sdir *= r;
+        tdir *= r;
+    }
+    *outSdir = sdir;
+    *outTdir = tdir;
+}
+
 void lengyelMethod(TangentSpaceMeshInput const* input, TangentSpaceMeshOutput* output) {
     size_t const vertexCount = input->vertexCount;
     size_t const triangleCount = input->triangleCount;
-    size_t const positionStride = input->positionStride ? input->positionStride : sizeof(float3);
     size_t const normalStride = input->normalStride ? input->normalStride : sizeof(float3);
-    size_t const uvStride = input->uvStride ? input->uvStride : sizeof(float2);
     auto const* triangles16 = input->triangles16;
     auto const* triangles32 = input->triangles32;
     auto const* positions = input->positions;
     auto const* uvs = input->uvs;
     auto const* normals = input->normals;
+    utils::JobSystem* const js = input->jobSystem;
 
     std::vector<float3> tan1(vertexCount, float3{0.0f});
     std::vector<float3> tan2(vertexCount, float3{0.0f});
-    for (size_t a = 0; a < triangleCount; ++a) {
-        uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
-        float3 const& v1 = *pointerAdd(positions, tri.x, positionStride);
-        float3 const& v2 = *pointerAdd(positions, tri.y, positionStride);
-        float3 const& v3 = *pointerAdd(positions, tri.z, positionStride);
-        float2 const& w1 = *pointerAdd(uvs, tri.x, uvStride);
-        float2 const& w2 = *pointerAdd(uvs, tri.y, uvStride);
-        float2 const& w3 = *pointerAdd(uvs, tri.z, uvStride);
-        float const x1 = v2.x - v1.x;
-        float const x2 = v3.x - v1.x;
-        float const y1 = v2.y - v1.y;
-        float const y2 = v3.y - v1.y;
-        float const z1 = v2.z - v1.z;
-        float const z2 = v3.z - v1.z;
-        float const s1 = w2.x - w1.x;
-        float const s2 = w3.x - w1.x;
-        float const t1 = w2.y - w1.y;
-        float const t2 = w3.y - w1.y;
-        float const d = s1 * t2 - s2 * t1;
-        float3 sdir, tdir;
-        // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
-        // least avoid divide-by-zero and fall back to normals-only method.
-        if (d == 0.0) {
-            float3 const& n1 = *pointerAdd(normals, tri.x, normalStride);
-            sdir = randomPerp(n1);
-            tdir = cross(n1, sdir);
-        } else {
-            sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
-            tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
-            float const r = 1.0f / d;
-            sdir *= r;
-            tdir *= r;
+    if (!js) {
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            float3 sdir, tdir;
+            lengyelKernel(input, tri, &sdir, &tdir);
+            tan1[tri.x] += sdir;
+            tan1[tri.y] += sdir;
+            tan1[tri.z] += sdir;
+            tan2[tri.x] += tdir;
+            tan2[tri.y] += tdir;
+            tan2[tri.z] += tdir;
+        }
+    } else {
+        // The directions of the triangles are computed in parallel, then each vertex sums the
+        // directions of its triangles in the same order as above, the results are identical.
+        std::vector<float3> sdirs(triangleCount);
+        std::vector<float3> tdirs(triangleCount);
+        parallelFor(js, triangleCount, [&](size_t start, size_t count) {
+            for (size_t a = start; a < start + count; ++a) {
+                uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+                lengyelKernel(input, tri, &sdirs[a], &tdirs[a]);
+            }
+        });
+
+        // Sort the triangle corners by vertex, keeping them in triangle order for each vertex.
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            assert_invariant(tri.x < vertexCount && tri.y < vertexCount && tri.z < vertexCount);
+            offsets[tri.x + 1]++;
+            offsets[tri.y + 1]++;
+            offsets[tri.z + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+        std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+        for (size_t a = 0; a < triangleCount; ++a) {
+            uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
+            vertexTriangles[cursors[tri.x]++] = uint32_t(a);
+            vertexTriangles[cursors[tri.y]++] = uint32_t(a);
+            vertexTriangles[cursors[tri.z]++] = uint32_t(a);
         }
-        tan1[tri.x] += sdir;
-        tan1[tri.y] += sdir;
-        tan1[tri.z] += sdir;
-        tan2[tri.x] += tdir;
-        tan2[tri.y] += tdir;
-        tan2[tri.z] += tdir;
+
+        parallelFor(js, vertexCount, [&](size_t start, size_t count) {
+            for (size_t v = start; v < start + count; ++v) {
+                for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    tan1[v] += sdirs[vertexTriangles[i]];
+                    tan2[v] += tdirs[vertexTriangles[i]];
+                }
+            }
+        });
     }
 
     quatf* quats = output->tangentSpace.allocate(vertexCount);
-    for (size_t a = 0; a < vertexCount; a++) {
-        float3 const& n = *pointerAdd(normals, a, normalStride);
-        float3 const& t1 = tan1[a];
-        float3 const& t2 = tan2[a];
+    parallelFor(js, vertexCount, [&](size_t start, size_t count) {
+        for (size_t a = start; a < start + count; a++) {
+            float3 const& n = *pointerAdd(normals, a, normalStride);
+            float3 const& t1 = tan1[a];
+            float3 const& t2 = tan2[a];
 
-        // Gram-Schmidt orthogonalize
-        float3 const t = normalize(t1 - n * dot(n, t1));
+            // Gram-Schmidt orthogonalize
+            float3 const t = normalize(t1 - n * dot(n, t1));
 
-        // Calculate handedness
-        float const w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
+            // Calculate handedness
+            float const w = (dot(cross(n, t1), t2) < 0.0f) ? -1.0f : 1.0f;
 
-        float3 b = w < 0 ? cross(t, n) : cross(n, t);
-        quats[a] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
-    }
+            float3 b = w < 0 ? cross(t, n) : cross(n, t);
+            quats[a] = mat3f::packTangentFrame({t, b, n}, sizeof(int32_t));
+        }
+    });
 
     output->vertexCount = vertexCount;
     output->triangleCount = triangleCount;
@@ -436,6 +496,11 @@ Builder& Builder::algorithm(Algorithm algo) noexcept {
     return *this;
 }
 
+Builder& Builder::jobSystem(utils::JobSystem* jobSystem) noexcept {
+    mMesh->mInput->jobSystem = jobSystem;
+    return *this;
+}
+
 TangentSpaceMesh* Builder::build() {
     ASSERT_PRECONDITION(!mMesh->mInput->triangles32 || !mMesh->mInput->triangles16,
             "Cannot provide both uint32 triangles and uint16 triangles");
@@ -22,8 +22,10 @@
 #include <math/mat3.h>
 #include <math/norm.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Panic.h>
 
+#include <functional>
 #include <vector>
 
 namespace filament::geometry {
@@ -77,6 +79,8 @@ struct TangentSpaceMeshInput {
     size_t triangleCount = 0;
 
     Algorithm algorithm;
+
+    utils::JobSystem* jobSystem = nullptr;
 };
 
 struct TangentSpaceMeshOutput {
@@ -102,6 +106,22 @@ inline InputType* pointerAdd(InputType* ptr, size_t index, size_t stride) noexce
     return (InputType*) (((uint8_t*) ptr) + (index * stride));
 }
 
+// Number of vertices or triangles below which a range is not split further between jobs.
+constexpr size_t PARALLEL_CHUNK_SIZE = 4096;
+
+// Calls func(start, count) on consecutive ranges covering [0, count). The ranges are processed
+// by the given job system when there is one and the count is large enough, so func must only
+// write to the elements of its range.
+template<typename F>
+inline void parallelFor(utils::JobSystem* js, size_t count, F func) {
+    if (!js || count < PARALLEL_CHUNK_SIZE * 2) {
+        func(0, count);
+        return;
+    }
+    js->runAndWait(utils::jobs::parallel_for(*js, nullptr, 0, uint32_t(count), std::ref(func),
+            utils::jobs::CountSplitter<PARALLEL_CHUNK_SIZE>()));
+}
+
 }// namespace filament::geometry
 
 #endif//TNT_GEOMETRY_TANGENTSPACEMESHIMPL_H
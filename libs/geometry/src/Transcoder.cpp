@@ -18,11 +18,196 @@
 
 #include <math/half.h>
 
+#include <string.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   include <arm_neon.h>
+#   define GEOMETRY_TRANSCODER_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <immintrin.h>
+#   define GEOMETRY_TRANSCODER_SSE 1
+#endif
+
 using filament::math::half;
 
 namespace filament {
 namespace geometry {
 
+namespace {
+
+// The SIMD paths are selected at compile time: SSE2 and NEON are part of the x86-64 and arm64
+// baselines. Each widen() overload converts the 16 bytes at the given address to floats, exactly
+// like the scalar conversions.
+
+#if defined(GEOMETRY_TRANSCODER_NEON)
+
+using vfloat4 = float32x4_t;
+
+inline void store(float* p, vfloat4 v) noexcept { vst1q_f32(p, v); }
+inline vfloat4 splat(float f) noexcept { return vdupq_n_f32(f); }
+inline vfloat4 mul(vfloat4 a, vfloat4 b) noexcept { return vmulq_f32(a, b); }
+inline vfloat4 max(vfloat4 a, vfloat4 b) noexcept { return vmaxq_f32(a, b); }
+
+inline void widen(uint8_t const* src, vfloat4 (&out)[4]) noexcept {
+    uint8x16_t const v = vld1q_u8(src);
+    uint16x8_t const lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t const hi = vmovl_u8(vget_high_u8(v));
+    out[0] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo)));
+    out[1] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo)));
+    out[2] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi)));
+    out[3] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi)));
+}
+
+inline void widen(int8_t const* src, vfloat4 (&out)[4]) noexcept {
+    int8x16_t const v = vld1q_s8(src);
+    int16x8_t const lo = vmovl_s8(vget_low_s8(v));
+    int16x8_t const hi = vmovl_s8(vget_high_s8(v));
+    out[0] = vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo)));
+    out[1] = vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo)));
+    out[2] = vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi)));
+    out[3] = vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi)));
+}
+
+inline void widen(uint16_t const* src, vfloat4 (&out)[2]) noexcept {
+    uint16x8_t const v = vld1q_u16(src);
+    out[0] = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+    out[1] = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v)));
+}
+
+inline void widen(int16_t const* src, vfloat4 (&out)[2]) noexcept {
+    int16x8_t const v = vld1q_s16(src);
+    out[0] = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+    out[1] = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+
+inline void widen(half const* src, vfloat4 (&out)[2]) noexcept {
+    float16x8_t const v = vld1q_f16((__fp16 const*) src);
+    out[0] = vcvt_f32_f16(vget_low_f16(v));
+    out[1] = vcvt_high_f32_f16(v);
+}
+
+inline void copy3(float* target, float const* src) noexcept {
+    vst1q_f32(target, vld1q_f32(src));
+}
+
+#elif defined(GEOMETRY_TRANSCODER_SSE)
+
+using vfloat4 = __m128;
+
+inline void store(float* p, vfloat4 v) noexcept { _mm_storeu_ps(p, v); }
+inline vfloat4 splat(float f) noexcept { return _mm_set1_ps(f); }
+inline vfloat4 mul(vfloat4 a, vfloat4 b) noexcept { return _mm_mul_ps(a, b); }
+inline vfloat4 max(vfloat4 a, vfloat4 b) noexcept { return _mm_max_ps(a, b); }
+
+inline void widen(uint8_t const* src, vfloat4 (&out)[4]) noexcept {
+    __m128i const v = _mm_loadu_si128((__m128i const*) src);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const lo = _mm_unpacklo_epi8(v, zero);
+    __m128i const hi = _mm_unpackhi_epi8(v, zero);
+    out[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+    out[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+    out[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+    out[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+}
+
+inline void widen(int8_t const* src, vfloat4 (&out)[4]) noexcept {
+    // move each value to the top of a wider lane, then sign-extend with an arithmetic shift
+    __m128i const v = _mm_loadu_si128((__m128i const*) src);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const lo = _mm_unpacklo_epi8(zero, v);
+    __m128i const hi = _mm_unpackhi_epi8(zero, v);
+    out[0] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, lo), 24));
+    out[1] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, lo), 24));
+    out[2] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, hi), 24));
+    out[3] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, hi), 24));
+}
+
+inline void widen(uint16_t const* src, vfloat4 (&out)[2]) noexcept {
+    __m128i const v = _mm_loadu_si128((__m128i const*) src);
+    __m128i const zero = _mm_setzero_si128();
+    out[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+    out[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero));
+}
+
+inline void widen(int16_t const* src, vfloat4 (&out)[2]) noexcept {
+    __m128i const v = _mm_loadu_si128((__m128i const*) src);
+    __m128i const zero = _mm_setzero_si128();
+    out[0] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, v), 16));
+    out[1] = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, v), 16));
+}
+
+// Same algorithm as math::half's conversion to float: the exponent is rebiased by a multiply,
+// which also normalizes the denormals.
+inline vfloat4 halfToFloat(__m128i h) noexcept {
+    __m128i const bits = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+    __m128 const f = _mm_mul_ps(_mm_castsi128_ps(bits),
+            _mm_castsi128_ps(_mm_set1_epi32(0x77800000)));          // 2^112
+    __m128 const infnan = _mm_cmpge_ps(f, _mm_castsi128_ps(_mm_set1_epi32(0x47800000)));
+    __m128i const sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    __m128 const exponent = _mm_and_ps(infnan, _mm_castsi128_ps(_mm_set1_epi32(0x7F800000)));
+    return _mm_or_ps(_mm_or_ps(f, exponent), _mm_castsi128_ps(sign));
+}
+
+inline void widen(half const* src, vfloat4 (&out)[2]) noexcept {
+    __m128i const v = _mm_loadu_si128((__m128i const*) src);
+    __m128i const zero = _mm_setzero_si128();
+    out[0] = halfToFloat(_mm_unpacklo_epi16(v, zero));
+    out[1] = halfToFloat(_mm_unpackhi_epi16(v, zero));
+}
+
+inline void copy3(float* target, float const* src) noexcept {
+    _mm_storeu_ps(target, _mm_loadu_ps(src));
+}
+
+#endif
+
+// Converts values that are tightly packed, regardless of the number of components.
+template<typename SOURCE_TYPE, int NORMALIZATION_FACTOR, bool CLAMPED>
+void convertPacked(float* UTILS_RESTRICT target, void const* UTILS_RESTRICT source,
+        size_t count) noexcept {
+    constexpr float scale = 1.0f / float(NORMALIZATION_FACTOR);
+    SOURCE_TYPE const* src = (SOURCE_TYPE const*) source;
+    size_t i = 0;
+#if defined(GEOMETRY_TRANSCODER_NEON) || defined(GEOMETRY_TRANSCODER_SSE)
+    constexpr size_t WIDTH = 16 / sizeof(SOURCE_TYPE);
+    vfloat4 const vscale = splat(scale);
+    vfloat4 const minimum = splat(-1.0f);
+    for (; i + WIDTH <= count; i += WIDTH) {
+        vfloat4 v[WIDTH / 4];
+        widen(src + i, v);
+        for (size_t j = 0; j < WIDTH / 4; ++j) {
+            vfloat4 const value = mul(v[j], vscale);
+            store(target + i + j * 4, CLAMPED ? max(value, minimum) : value);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const float value = float(src[i]) * scale;
+        target[i] = CLAMPED && value < -1.0f ? -1.0f : value;
+    }
+}
+
+// Packs float3 values, the stride of which is at least the size of a float3.
+void convertFloat3(float* UTILS_RESTRICT target, uint8_t const* UTILS_RESTRICT source,
+        size_t count, size_t srcStride) noexcept {
+    size_t i = 0;
+#if defined(GEOMETRY_TRANSCODER_NEON) || defined(GEOMETRY_TRANSCODER_SSE)
+    // Each element but the last is copied with 4 floats, the 4th float overlaps the next element
+    // in both the source and the target, and is overwritten by the next copy.
+    for (; i + 1 < count; ++i) {
+        copy3(target + i * 3, (float const*) (source + i * srcStride));
+    }
+#endif
+    for (; i < count; ++i) {
+        float const* src = (float const*) (source + i * srcStride);
+        target[i * 3 + 0] = src[0];
+        target[i * 3 + 1] = src[1];
+        target[i * 3 + 2] = src[2];
+    }
+}
+
+} // anonymous namespace
+
 // The internal workhorse function of the Transcoder, which takes arbitrary input but always
 // produced packed floats. We expose a more readable interface than this to users, who often have
 // untyped blobs of interleaved data. Note that this variant takes an arbitrary number of
@@ -95,6 +280,14 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
     switch (mConfig.componentType) {
         case ComponentType::BYTE: {
             const uint32_t stride = mConfig.inputStrideBytes ? mConfig.inputStrideBytes : comp;
+            if (stride == comp * sizeof(int8_t)) {
+                if (mConfig.normalized) {
+                    convertPacked<int8_t, 127, true>(target, source, count * comp);
+                } else {
+                    convertPacked<int8_t, 1, false>(target, source, count * comp);
+                }
+                return required;
+            }
             if (mConfig.normalized) {
                 if (comp == 2) {
                     convertClamped<int8_t, 127, 2>(target, source, count, stride);
@@ -116,6 +309,14 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
         }
         case ComponentType::UBYTE: {
             const uint32_t stride = mConfig.inputStrideBytes ? mConfig.inputStrideBytes : comp;
+            if (stride == comp * sizeof(uint8_t)) {
+                if (mConfig.normalized) {
+                    convertPacked<uint8_t, 255, false>(target, source, count * comp);
+                } else {
+                    convertPacked<uint8_t, 1, false>(target, source, count * comp);
+                }
+                return required;
+            }
             if (mConfig.normalized) {
                 if (comp == 2) {
                     convert<uint8_t, 255, 2>(target, source, count, stride);
@@ -137,6 +338,14 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
         }
         case ComponentType::SHORT: {
             const uint32_t stride = mConfig.inputStrideBytes ? mConfig.inputStrideBytes : (2 * comp);
+            if (stride == comp * sizeof(int16_t)) {
+                if (mConfig.normalized) {
+                    convertPacked<int16_t, 32767, true>(target, source, count * comp);
+                } else {
+                    convertPacked<int16_t, 1, false>(target, source, count * comp);
+                }
+                return required;
+            }
             if (mConfig.normalized) {
                 if (comp == 2) {
                     convertClamped<int16_t, 32767, 2>(target, source, count, stride);
@@ -158,6 +367,14 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
         }
         case ComponentType::USHORT: {
             const uint32_t stride = mConfig.inputStrideBytes ? mConfig.inputStrideBytes : (2 * comp);
+            if (stride == comp * sizeof(uint16_t)) {
+                if (mConfig.normalized) {
+                    convertPacked<uint16_t, 65535, false>(target, source, count * comp);
+                } else {
+                    convertPacked<uint16_t, 1, false>(target, source, count * comp);
+                }
+                return required;
+            }
             if (mConfig.normalized) {
                 if (comp == 2) {
                     convert<uint16_t, 65535, 2>(target, source, count, stride);
@@ -179,6 +396,10 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
         }
         case ComponentType::HALF: {
             const uint32_t stride = mConfig.inputStrideBytes ? mConfig.inputStrideBytes : (2 * comp);
+            if (stride == comp * sizeof(half)) {
+                convertPacked<half, 1, false>(target, source, count * comp);
+                return required;
+            }
             uint8_t const* srcBytes = (uint8_t const*) source;
             for (size_t i = 0; i < count; ++i, target += comp, srcBytes += stride) {
                 half const* src = (half const*) srcBytes;
@@ -191,6 +412,14 @@ size_t Transcoder::operator()(float* UTILS_RESTRICT target, void const* UTILS_RE
         case ComponentType::FLOAT: {
             const uint32_t srcStride =
                     mConfig.inputStrideBytes ? mConfig.inputStrideBytes : (4 * comp);
+            if (srcStride == comp * sizeof(float)) {
+                memcpy(target, source, required);
+                return required;
+            }
+            if (comp == 3) {
+                convertFloat3(target, (uint8_t const*) source, count, srcStride);
+                return required;
+            }
             uint8_t const* srcBytes = (uint8_t const*) source;
             for (size_t i = 0; i < count; ++i, target += comp, srcBytes += srcStride) {
                 // This will never break alignment rules because the glTF spec stipulates that the
@@ -14,13 +14,18 @@
  * limitations under the License.
  */
 
+#include <geometry/SurfaceOrientation.h>
 #include <geometry/TangentSpaceMesh.h>
 
 #include <math/quat.h>
 #include <math/vec3.h>
 
+#include <utils/JobSystem.h>
+
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 class TangentSpaceMeshTest : public testing::Test {};
 
 using namespace filament::geometry;
@@ -114,6 +119,35 @@ bool isAlmostEqual2(const float2& a, const float2& b) noexcept {
     }
     return true;
 }
+
+// A wavy grid of size x size vertices.
+struct Grid {
+    explicit Grid(size_t size) {
+        for (size_t y = 0; y < size; ++y) {
+            for (size_t x = 0; x < size; ++x) {
+                float const u = float(x) / float(size - 1);
+                float const v = float(y) / float(size - 1);
+                float const su = std::sin(u * 20.0f), cu = std::cos(u * 20.0f);
+                float const sv = std::sin(v * 20.0f), cv = std::cos(v * 20.0f);
+                positions.push_back(float3{u, 0.1f * su * cv, v});
+                normals.push_back(normalize(float3{-2.0f * cu * cv, 1.0f, 2.0f * su * sv}));
+                uvs.push_back(float2{u, v});
+            }
+        }
+        for (uint32_t y = 0; y + 1 < size; ++y) {
+            for (uint32_t x = 0; x + 1 < size; ++x) {
+                uint32_t const i = uint32_t(y * size + x);
+                triangles.push_back(uint3{i, i + uint32_t(size), i + 1});
+                triangles.push_back(uint3{i + 1, i + uint32_t(size), i + uint32_t(size) + 1});
+            }
+        }
+    }
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<uint3> triangles;
+};
 } // anonymous namespace
 
 TEST_F(TangentSpaceMeshTest, BuilderDefaultAlgorithms) {
@@ -367,6 +401,114 @@ TEST_F(TangentSpaceMeshTest, Lengyel) {
     TangentSpaceMesh::destroy(mesh);
 }
 
+TEST_F(TangentSpaceMeshTest, JobSystem) {
+    utils::JobSystem js;
+    js.adopt();
+
+    // The grid is large enough to be split between jobs.
+    Grid const grid(128);
+    for (auto algorithm : { TangentSpaceMesh::Algorithm::MIKKTSPACE,
+            TangentSpaceMesh::Algorithm::LENGYEL, TangentSpaceMesh::Algorithm::FRISVAD,
+            TangentSpaceMesh::Algorithm::HUGHES_MOLLER,
+            TangentSpaceMesh::Algorithm::FLAT_SHADING }) {
+        auto build = [&](utils::JobSystem* jobSystem) {
+            return TangentSpaceMesh::Builder()
+                    .vertexCount(grid.positions.size())
+                    .normals(grid.normals.data())
+                    .positions(grid.positions.data())
+                    .uvs(grid.uvs.data())
+                    .triangleCount(grid.triangles.size())
+                    .triangles(grid.triangles.data())
+                    .algorithm(algorithm)
+                    .jobSystem(jobSystem)
+                    .build();
+        };
+        TangentSpaceMesh* serial = build(nullptr);
+        TangentSpaceMesh* parallel = build(&js);
+
+        size_t const vertexCount = serial->getVertexCount();
+        ASSERT_EQ(parallel->getVertexCount(), vertexCount);
+        ASSERT_EQ(parallel->getTriangleCount(), serial->getTriangleCount());
+
+        std::vector<quatf> serialQuats(vertexCount);
+        std::vector<quatf> parallelQuats(vertexCount);
+        serial->getQuats(serialQuats.data());
+        parallel->getQuats(parallelQuats.data());
+        float maxDifference = 0.0f;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            float4 const diff = abs(serialQuats[i].xyzw - parallelQuats[i].xyzw);
+            maxDifference = std::max(maxDifference, std::max(std::max(diff.x, diff.y),
+                    std::max(diff.z, diff.w)));
+        }
+        EXPECT_LT(maxDifference, 1e-5f);
+
+        TangentSpaceMesh::destroy(serial);
+        TangentSpaceMesh::destroy(parallel);
+    }
+
+    js.emancipate();
+}
+
+TEST_F(TangentSpaceMeshTest, SurfaceOrientationJobSystem) {
+    utils::JobSystem js;
+    js.adopt();
+
+    Grid const grid(128);
+    std::vector<float4> tangents;
+    for (size_t i = 0; i < grid.normals.size(); ++i) {
+        float3 const t = normalize(cross(grid.normals[i], float3{0, 0, 1}));
+        tangents.push_back(float4{t, i % 2 ? -1.0f : 1.0f});
+    }
+
+    // Covers each of the combinations of inputs accepted by the builder.
+    enum class Inputs { NORMALS, TANGENTS, UVS, FLAT };
+    for (auto inputs : { Inputs::NORMALS, Inputs::TANGENTS, Inputs::UVS, Inputs::FLAT }) {
+        auto build = [&](utils::JobSystem* jobSystem) {
+            SurfaceOrientation::Builder builder;
+            builder.vertexCount(grid.positions.size()).jobSystem(jobSystem);
+            if (inputs != Inputs::FLAT) {
+                builder.normals(grid.normals.data());
+            }
+            if (inputs == Inputs::TANGENTS) {
+                builder.tangents(tangents.data());
+            }
+            if (inputs == Inputs::UVS) {
+                builder.uvs(grid.uvs.data());
+            }
+            if (inputs == Inputs::UVS || inputs == Inputs::FLAT) {
+                builder.positions(grid.positions.data())
+                        .triangleCount(grid.triangles.size())
+                        .triangles(grid.triangles.data());
+            }
+            return builder.build();
+        };
+        SurfaceOrientation* serial = build(nullptr);
+        SurfaceOrientation* parallel = build(&js);
+        ASSERT_NE(serial, nullptr);
+        ASSERT_NE(parallel, nullptr);
+
+        size_t const vertexCount = serial->getVertexCount();
+        ASSERT_EQ(parallel->getVertexCount(), vertexCount);
+
+        std::vector<quatf> serialQuats(vertexCount);
+        std::vector<quatf> parallelQuats(vertexCount);
+        serial->getQuats(serialQuats.data(), vertexCount);
+        parallel->getQuats(parallelQuats.data(), vertexCount);
+        float maxDifference = 0.0f;
+        for (size_t i = 0; i < vertexCount; ++i) {
+            float4 const diff = abs(serialQuats[i].xyzw - parallelQuats[i].xyzw);
+            maxDifference = std::max(maxDifference, std::max(std::max(diff.x, diff.y),
+                    std::max(diff.z, diff.w)));
+        }
+        EXPECT_LT(maxDifference, 1e-5f);
+
+        delete serial;
+        delete parallel;
+    }
+
+    js.emancipate();
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
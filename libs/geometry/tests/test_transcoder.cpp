@@ -20,6 +20,10 @@
 
 #include <gtest/gtest.h>
 
+#include <string.h>
+
+#include <vector>
+
 using filament::math::half;
 using filament::geometry::Transcoder;
 using filament::geometry::ComponentType;
@@ -124,6 +128,82 @@ TEST_F(TranscoderTest, NonNormalized) {
     ASSERT_EQ(result[1], 1.0f);
 }
 
+// Checks the packed conversions, which have SIMD paths, against the per-element definition. The
+// counts are not multiples of the vector widths, so that the scalar tails are covered too.
+template<typename T>
+static void checkPacked(ComponentType type, bool normalized, float scale, bool clamped) {
+    std::vector<T> source(3 * 347);
+    for (size_t i = 0; i < source.size(); ++i) {
+        uint32_t const bits = uint32_t(i * 2654435761u) >> 7;
+        memcpy(&source[i], &bits, sizeof(T));
+    }
+    Transcoder transcode({
+        .componentType = type,
+        .normalized = normalized,
+        .componentCount = 3u,
+    });
+    std::vector<float> result(source.size());
+    ASSERT_EQ(transcode(result.data(), source.data(), 347), source.size() * sizeof(float));
+    for (size_t i = 0; i < source.size(); ++i) {
+        float const value = float(source[i]) * scale;
+        ASSERT_EQ(result[i], clamped && value < -1.0f ? -1.0f : value) << i;
+    }
+}
+
+TEST_F(TranscoderTest, Packed) {
+    checkPacked<uint8_t>(ComponentType::UBYTE, true, 1.0f / 255.0f, false);
+    checkPacked<uint8_t>(ComponentType::UBYTE, false, 1.0f, false);
+    checkPacked<int8_t>(ComponentType::BYTE, true, 1.0f / 127.0f, true);
+    checkPacked<int8_t>(ComponentType::BYTE, false, 1.0f, false);
+    checkPacked<uint16_t>(ComponentType::USHORT, true, 1.0f / 65535.0f, false);
+    checkPacked<uint16_t>(ComponentType::USHORT, false, 1.0f, false);
+    checkPacked<int16_t>(ComponentType::SHORT, true, 1.0f / 32767.0f, true);
+    checkPacked<int16_t>(ComponentType::SHORT, false, 1.0f, false);
+}
+
+TEST_F(TranscoderTest, PackedHalf) {
+    // every bit pattern, including denormals, infinities and NaNs
+    std::vector<uint16_t> source(65536 + 3);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = uint16_t(i);
+    }
+    Transcoder transcode({
+        .componentType = ComponentType::HALF,
+        .normalized = false,
+        .componentCount = 1u,
+    });
+    std::vector<float> result(source.size());
+    transcode(result.data(), source.data(), source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        float const expected = float(filament::math::makeHalf(source[i]));
+        ASSERT_EQ(memcmp(&result[i], &expected, sizeof(float)), 0) << i;
+    }
+}
+
+TEST_F(TranscoderTest, StridedFloat3) {
+    struct Vertex {
+        float position[3];
+        float uv[2];
+    };
+    std::vector<Vertex> source(37);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = {{ float(i), float(i) + 0.25f, float(i) + 0.5f }, { -1.0f, -2.0f }};
+    }
+    Transcoder transcode({
+        .componentType = ComponentType::FLOAT,
+        .normalized = false,
+        .componentCount = 3u,
+        .inputStrideBytes = sizeof(Vertex)
+    });
+    std::vector<float> result(source.size() * 3);
+    transcode(result.data(), source.data(), source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        ASSERT_EQ(result[i * 3 + 0], source[i].position[0]);
+        ASSERT_EQ(result[i * 3 + 1], source[i].position[1]);
+        ASSERT_EQ(result[i * 3 + 2], source[i].position[2]);
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
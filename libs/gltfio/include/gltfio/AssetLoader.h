@@ -38,6 +38,22 @@ namespace filament::gltfio {
 
 class NodeManager;
 
+/**
+ * \struct LevelOfDetail AssetLoader.h gltfio/AssetLoader.h
+ * \brief Describes a simplified level of detail generated by ResourceLoader.
+ *
+ * The triangles of each mesh are simplified until the given error is reached, and the result is
+ * used when the mesh's projected size falls below screenSize, see
+ * filament::RenderableManager::Builder::levelOfDetail().
+ */
+struct LevelOfDetail {
+    //! Maximum deviation from the original surface, relative to the extent of the mesh.
+    float error;
+
+    //! Fraction of the viewport height below which this level is used.
+    float screenSize;
+};
+
 /**
  * \struct AssetConfiguration AssetLoader.h gltfio/AssetLoader.h
  * \brief Construction parameters for AssetLoader.
@@ -62,6 +78,21 @@ struct AssetConfiguration {
 
     //! Optional default node name for anonymous nodes
     char* defaultNodeName = nullptr;
+
+    //! Optional levels of detail to generate for triangle meshes without morph targets, in
+    //! increasing error and decreasing screen size order. The array is copied by the loader, at
+    //! most filament::RenderableManager::Builder::MAX_LEVEL_COUNT - 1 levels are used.
+    const LevelOfDetail* levelsOfDetail = nullptr;
+
+    //! Number of entries in levelsOfDetail.
+    size_t levelOfDetailCount = 0;
+
+    //! If true, the geometry and renderable components of mesh nodes that are not skinned, morphed,
+    //! mapped to material variants or Draco compressed are not created with the asset. Their
+    //! entities, transforms, bounds and material instances are, and an AssetStreamer creates and
+    //! destroys their geometry depending on the camera distance. The source data of these assets
+    //! is kept until they are destroyed, FilamentAsset::releaseSourceData() has no effect.
+    bool streaming = false;
 };
 
 /**
@@ -156,6 +187,18 @@ public:
      */
     FilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
 
+    /**
+     * Memory-maps the given GLB or JSON-based glTF 2.0 file and returns an asset with one
+     * instance, or null on failure.
+     *
+     * Unlike createAsset(), the content of the file is not copied. The mapping is kept until the
+     * source data of the asset is released and the uploads from it have completed, and
+     * ResourceLoader uploads the buffers embedded in a GLB file straight from it when their
+     * layout permits. External resources are found with ResourceConfiguration::gltfPath, as
+     * usual.
+     */
+    FilamentAsset* createAssetFromFile(const char* path);
+
     /**
      * Consumes the contents of a glTF 2.0 file and produces a primary asset with one or more
      * instances. The primary asset has ownership over the instances.
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_ASSETSTREAMER_H
+#define GLTFIO_ASSETSTREAMER_H
+
+#include <utils/compiler.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+    class Engine;
+    class View;
+}
+
+namespace filament::gltfio {
+
+class AssetLoader;
+class FilamentAsset;
+
+/**
+ * \struct AssetStreamerConfig AssetStreamer.h gltfio/AssetStreamer.h
+ * \brief Construction parameters for AssetStreamer.
+ */
+struct AssetStreamerConfig {
+    //! Chunks whose bounding box is closer to the camera than this distance are loaded.
+    float loadDistance = 100.0f;
+
+    //! Chunks whose bounding box is farther from the camera than this distance are unloaded. This
+    //! should be larger than loadDistance, so that chunks are not reloaded as soon as unloaded.
+    float unloadDistance = 150.0f;
+
+    //! Maximum estimated size in bytes of the geometry of the loaded chunks. The closest chunks
+    //! are loaded first.
+    size_t budget = 256 * 1024 * 1024;
+
+    //! Maximum number of meshes whose geometry starts loading in each update.
+    uint32_t maxLoadsPerUpdate = 8;
+};
+
+/**
+ * \class AssetStreamer AssetStreamer.h gltfio/AssetStreamer.h
+ * \brief Creates and destroys the geometry of the nodes of large assets based on their distance
+ * to the camera.
+ *
+ * In assets loaded with AssetConfiguration::streaming, the mesh nodes that are not skinned,
+ * morphed, animated, mapped to material variants or Draco compressed are chunks: their entities,
+ * transforms, bounding boxes and material instances are created with the asset, and their
+ * textures by ResourceLoader, but their vertex buffers, index buffers and renderable components
+ * are not. AssetStreamer creates them when a chunk comes within the load distance and destroys
+ * them when it goes beyond the unload distance. The vertex data is converted, and the tangents
+ * and levels of detail are generated, by background jobs; only the Filament objects are created
+ * by update(). The state set on the renderable of a chunk, e.g. its layer mask, priority or
+ * material instances, is restored when the renderable is created again.
+ *
+ * Chunks are indexed by their world-space bounding boxes, so that each update only visits the
+ * chunks close to the camera and the loaded ones. Chunks must not be moved relative to the root
+ * of their instance, the index is built again when the root moves.
+ *
+ * The source data of streamed assets is kept, FilamentAsset::releaseSourceData() only releases
+ * the data that is not needed by the chunks. The source data of the meshes of chunks is given
+ * back to the system once uploaded when it is memory-mapped, i.e. with
+ * AssetLoader::createAssetFromFile() or when ResourceLoader maps external buffers, it is read
+ * from the files again when a chunk is loaded. If the buffers of an asset were given with
+ * ResourceLoader::addResourceData(), they stay in memory: the ResourceLoader must not be
+ * destroyed, and the resource data must not be evicted, while the asset is streamed.
+ *
+ * Chunks are not included in FilamentAsset::getRenderableEntities(), their entities are added
+ * to the scene with the other entities of the asset.
+ *
+ * Example usage:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * AssetConfiguration config { engine, materials };
+ * config.streaming = true;
+ * auto assetLoader = AssetLoader::create(config);
+ * auto streamer = AssetStreamer::create(engine, assetLoader);
+ * auto asset = assetLoader->createAsset(content.data(), content.size());
+ * resourceLoader->loadResources(asset);
+ * scene->addEntities(asset->getEntities(), asset->getEntityCount());
+ * streamer->addAsset(asset);
+ *
+ * do {
+ *     streamer->update(view);
+ *     renderer->render(view);
+ *     ...
+ * } while (!quit);
+ *
+ * streamer->removeAsset(asset);
+ * assetLoader->destroyAsset(asset);
+ * AssetStreamer::destroy(&streamer);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC AssetStreamer {
+public:
+    struct Statistics {
+        size_t chunkCount;          //!< number of chunks in the streamed assets
+        size_t loadedChunkCount;    //!< number of chunks that have a renderable component
+        size_t loadingCount;        //!< number of meshes whose geometry is being prepared
+        size_t residentBytes;       //!< estimated size of the geometry of the loaded meshes
+    };
+
+    /**
+     * Creates an asset streamer. The given loader must be the one that creates the streamed
+     * assets and must outlive the streamer. The calling thread must be the thread the engine was
+     * created on.
+     */
+    static AssetStreamer* create(Engine* engine, AssetLoader* loader,
+            AssetStreamerConfig const& config = {});
+
+    /**
+     * Destroys the given streamer and sets the pointer to null. The geometry of the assets that
+     * were not removed is destroyed.
+     */
+    static void destroy(AssetStreamer** streamer);
+
+    /**
+     * Starts streaming the chunks of the given asset, which must have been created with
+     * AssetConfiguration::streaming. This must be called after ResourceLoader::loadResources()
+     * or asyncBeginLoad(). The chunks of the instances created later are also streamed.
+     */
+    void addAsset(FilamentAsset* asset);
+
+    /**
+     * Destroys the geometry of the chunks of the given asset and stops streaming them. This must
+     * be called before the asset is destroyed.
+     */
+    void removeAsset(FilamentAsset* asset);
+
+    /**
+     * Creates the renderables of the chunks whose geometry is ready, and starts loading or
+     * unloading chunks depending on their distance to the camera of the given view. This is
+     * typically called once per frame, from the thread the engine was created on.
+     */
+    void update(View const* view);
+
+    Statistics getStatistics() const noexcept;
+
+    /*! \cond PRIVATE */
+protected:
+    AssetStreamer() noexcept = default;
+    ~AssetStreamer() = default;
+
+public:
+    AssetStreamer(AssetStreamer const&) = delete;
+    AssetStreamer(AssetStreamer&&) = delete;
+    AssetStreamer& operator=(AssetStreamer const&) = delete;
+    AssetStreamer& operator=(AssetStreamer&&) = delete;
+    /*! \endcond */
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_ASSETSTREAMER_H
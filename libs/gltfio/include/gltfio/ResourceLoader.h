@@ -49,6 +49,17 @@ struct ResourceConfiguration {
     //! If true, adjusts skinning weights to sum to 1. Well formed glTF files do not need this,
     //! but it is useful for robustness.
     bool normalizeSkinningWeights;
+
+    //! Optional path of a file that caches the processed geometry of the loaded asset: the vertex,
+    //! index and morph target data after Draco and meshopt decoding, conversions and skinning
+    //! weight normalization, and the generated tangents and levels of detail. If the file was
+    //! written for the same source data and options, loadResources() uploads the geometry
+    //! straight from it (memory-mapped) and skips that processing, otherwise the file is
+    //! rewritten. Textures are not cached. The string pointer is not retained.
+    //!
+    //! The positions of Draco meshes are not decoded when the cache is used, so
+    //! FilamentInstance::recomputeBoundingBoxes() cannot be used with them.
+    const char* cachePath = nullptr;
 };
 
 /**
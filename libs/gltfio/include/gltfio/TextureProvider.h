@@ -30,6 +30,8 @@ namespace filament {
 
 namespace filament::gltfio {
 
+class TextureStreamer;
+
 /**
  * TextureProvider is an interface that allows clients to implement their own texture decoding
  * facility for JPEG, PNG, or KTX2 content. It constructs Filament Texture objects synchronously,
@@ -179,6 +181,13 @@ TextureProvider* createStbProvider(filament::Engine* engine);
  */
 TextureProvider* createKtx2Provider(filament::Engine* engine);
 
+/**
+ * Same as above, but only the coarse tail of the mip chain of each texture is transcoded and
+ * uploaded, the finer levels are streamed by the given TextureStreamer. The streamer must outlive
+ * the textures created by this provider.
+ */
+TextureProvider* createKtx2Provider(filament::Engine* engine, TextureStreamer* streamer);
+
 } // namespace filament::gltfio
 
 template<> struct utils::EnableBitMaskOperators<filament::gltfio::TextureProvider::TextureFlags>
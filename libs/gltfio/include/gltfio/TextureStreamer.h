@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_TEXTURESTREAMER_H
+#define GLTFIO_TEXTURESTREAMER_H
+
+#include <utils/compiler.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+    class Engine;
+    class View;
+}
+
+namespace filament::gltfio {
+
+class FilamentAsset;
+
+/**
+ * \struct TextureStreamerConfig TextureStreamer.h gltfio/TextureStreamer.h
+ * \brief Construction parameters for TextureStreamer.
+ */
+struct TextureStreamerConfig {
+    //! Maximum total size in bytes of the mip levels uploaded for streamed textures, over the
+    //! lifetime of the streamer. The coarse tails of the textures are always uploaded and count
+    //! towards it. This limits the transcoding and upload work, it is not a memory budget: the
+    //! streamer doesn't manage residency and never evicts levels, see TextureStreamer.
+    size_t maxUploadedBytes = 64 * 1024 * 1024;
+
+    //! Mip levels whose width and height are at most this size form the tail of a texture, they
+    //! are loaded with the texture.
+    uint32_t tailSize = 128;
+};
+
+/**
+ * \class TextureStreamer TextureStreamer.h gltfio/TextureStreamer.h
+ * \brief Streams the finest mip levels of KTX2 textures based on their screen coverage.
+ *
+ * A KTX2 texture provider created with a TextureStreamer (see createKtx2Provider()) only
+ * transcodes and uploads the coarse tail of each texture's mip chain. The finer levels are
+ * transcoded and uploaded by update(), from the most magnified textures in the view frustum to
+ * the least, as long as the total size of the uploaded levels stays within
+ * TextureStreamerConfig::maxUploadedBytes.
+ * Textures that need fewer levels than they have uploaded are restricted to their coarser levels
+ * when sampled.
+ *
+ * This does not reduce GPU memory: Filament allocates the storage for all the levels of a
+ * texture when it is created, and uploaded levels are kept until the texture is destroyed. The
+ * streamer defers and bounds the transcoding and upload work, and limits the levels sampled.
+ *
+ * Example usage:
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * auto streamer = TextureStreamer::create(engine);
+ * auto ktx2 = createKtx2Provider(engine, streamer);
+ * resourceLoader->addTextureProvider("image/ktx2", ktx2);
+ * resourceLoader->loadResources(asset);
+ * streamer->addAsset(asset);
+ *
+ * do {
+ *     streamer->update(view);
+ *     resourceLoader->asyncUpdateLoad();
+ *     renderer->render(view);
+ *     ...
+ * } while (!quit);
+ *
+ * streamer->removeAsset(asset);
+ * assetLoader->destroyAsset(asset);
+ * delete ktx2;
+ * TextureStreamer::destroy(&streamer);
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class UTILS_PUBLIC TextureStreamer {
+public:
+    struct Statistics {
+        size_t textureCount;        //!< number of streamed textures
+        size_t uploadedBytes;       //!< estimated size of the levels that were uploaded
+        size_t streamingCount;      //!< number of textures whose levels are being transcoded
+    };
+
+    /**
+     * Creates a texture streamer. The calling thread must be the thread the engine was created on.
+     */
+    static TextureStreamer* create(Engine* engine, TextureStreamerConfig const& config = {});
+
+    /**
+     * Destroys the given streamer and sets the pointer to null. The assets using streamed
+     * textures must have been removed.
+     */
+    static void destroy(TextureStreamer** streamer);
+
+    /**
+     * Starts computing the screen coverage of the textures of the given asset.
+     *
+     * This must be called after the asset's textures are created by ResourceLoader (i.e. after
+     * loadResources() or asyncBeginLoad()), and before FilamentAsset::releaseSourceData().
+     */
+    void addAsset(FilamentAsset* asset);
+
+    /**
+     * Stops streaming the textures of the given asset. This must be called before the asset is
+     * destroyed.
+     */
+    void removeAsset(FilamentAsset* asset);
+
+    /**
+     * Estimates the screen coverage of the textures from the bounding boxes of the renderables
+     * using them that intersect the frustum of the given view's camera, uploads the levels that
+     * were transcoded, and starts transcoding the levels that are needed. This is typically
+     * called once per frame, from the thread the engine was created on.
+     */
+    void update(View const* view);
+
+    Statistics getStatistics() const noexcept;
+
+    /*! \cond PRIVATE */
+protected:
+    TextureStreamer() noexcept = default;
+    ~TextureStreamer() = default;
+
+public:
+    TextureStreamer(TextureStreamer const&) = delete;
+    TextureStreamer(TextureStreamer&&) = delete;
+    TextureStreamer& operator=(TextureStreamer const&) = delete;
+    TextureStreamer& operator=(TextureStreamer&&) = delete;
+    /*! \endcond */
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_TEXTURESTREAMER_H
@@ -52,6 +52,8 @@
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
+
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 
@@ -224,13 +226,23 @@ struct FAssetLoader : public AssetLoader {
             mTransformManager(config.engine->getTransformManager()),
             mMaterials(*config.materials),
             mEngine(*config.engine),
-            mDefaultNodeName(config.defaultNodeName) {}
+            mLevelsOfDetail(std::min(config.levelOfDetailCount,
+                    size_t(RenderableManager::Builder::MAX_LEVEL_COUNT - 1))),
+            mStreaming(config.streaming),
+            mDefaultNodeName(config.defaultNodeName) {
+        std::copy_n(config.levelsOfDetail, mLevelsOfDetail.size(), mLevelsOfDetail.data());
+    }
 
     FFilamentAsset* createAsset(const uint8_t* bytes, uint32_t nbytes);
+    FFilamentAsset* createAssetFromFile(const char* path);
     FFilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
             FilamentInstance** instances, size_t numInstances);
     FilamentInstance* createInstance(FFilamentAsset* fAsset);
 
+    // Creates the geometry of a chunk's mesh if needed, then its renderable, see AssetStreamer.
+    bool createChunkPrimitives(const Chunk& chunk, FFilamentAsset* fAsset);
+    void createChunkRenderable(const Chunk& chunk, FFilamentAsset* fAsset);
+
     static void destroy(FAssetLoader** loader) noexcept {
         delete *loader;
         *loader = nullptr;
@@ -259,10 +271,15 @@ struct FAssetLoader : public AssetLoader {
 private:
     void importSkins(FFilamentInstance* instance, const cgltf_data* srcAsset);
 
+    // Parses the given content, which must outlive the returned asset.
+    FFilamentAsset* parseAsset(const uint8_t* bytes, size_t byteCount, size_t numInstances);
+
     // Methods used during the first traveral (creation of VertexBuffer, IndexBuffer, etc)
     FFilamentAsset* createRootAsset(const cgltf_data* srcAsset);
     void recursePrimitives(const cgltf_node* rootNode, FFilamentAsset* fAsset);
     void createPrimitives(const cgltf_node* node, const char* name, FFilamentAsset* fAsset);
+    void addChunkBounds(const cgltf_node* node, FFilamentAsset* fAsset);
+    void addAnimatedNodes(const cgltf_node* node, FFilamentAsset* fAsset);
     bool createPrimitive(const cgltf_primitive& inPrim, const char* name, Primitive* outPrim,
             FFilamentAsset* fAsset);
 
@@ -272,6 +289,8 @@ private:
             FFilamentAsset* fAsset, FFilamentInstance* instance);
     void createRenderable(const cgltf_node* node, Entity entity, const char* name,
             FFilamentAsset* fAsset);
+    void buildRenderable(const cgltf_node* node, Entity entity, const char* name,
+            MaterialInstance* const* materials, FFilamentAsset* fAsset);
     void createLight(const cgltf_light* light, Entity entity, FFilamentAsset* fAsset);
     void createCamera(const cgltf_camera* camera, Entity entity, FFilamentAsset* fAsset);
     void addTextureBinding(MaterialInstance* materialInstance, const char* parameterName,
@@ -298,6 +317,8 @@ public:
     Engine& mEngine;
     FNodeManager mNodeManager;
     FTrsTransformManager mTrsTransformManager;
+    FixedCapacityVector<LevelOfDetail> mLevelsOfDetail;
+    const bool mStreaming;
 
     // Transient state used only for the asset currently being loaded:
     const char* mDefaultNodeName;
@@ -316,8 +337,38 @@ FFilamentAsset* FAssetLoader::createAsset(const uint8_t* bytes, uint32_t byteCou
     return createInstancedAsset(bytes, byteCount, &instances, 1);
 }
 
+FFilamentAsset* FAssetLoader::createAssetFromFile(const char* path) {
+    // The mapping is owned by the asset, cgltf and the buffer uploads point into it.
+    MappedFile file(path);
+    if (!file) {
+        slog.e << "Unable to map " << path << io::endl;
+        return nullptr;
+    }
+    FFilamentAsset* fAsset = parseAsset(file.data(), file.size(), 1);
+    if (fAsset) {
+        fAsset->mSourceAsset->mappedFiles.push_back(std::move(file));
+    }
+    return fAsset;
+}
+
 FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t byteCount,
         FilamentInstance** instances, size_t numInstances) {
+    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
+    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
+    // asset.
+    utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
+    std::copy_n(bytes, byteCount, glbdata.data());
+
+    FFilamentAsset* fAsset = parseAsset(glbdata.data(), byteCount, numInstances);
+    if (fAsset) {
+        glbdata.swap(fAsset->mSourceAsset->glbData);
+        std::copy_n(fAsset->mInstances.data(), numInstances, instances);
+    }
+    return fAsset;
+}
+
+FFilamentAsset* FAssetLoader::parseAsset(const uint8_t* bytes, size_t byteCount,
+        size_t numInstances) {
     // This method can be used to load JSON or GLB. By using a default options struct, we are asking
     // cgltf to examine the magic identifier to determine which type of file is being loaded.
     cgltf_options options {};
@@ -336,15 +387,9 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         options.file.release = [](const cgltf_memory_options*, const cgltf_file_options*, void*) {};
     }
 
-    // Clients can free up their source blob immediately, but cgltf has pointers into the data that
-    // need to stay valid. Therefore we create a copy of the source blob and stash it inside the
-    // asset.
-    utils::FixedCapacityVector<uint8_t> glbdata(byteCount);
-    std::copy_n(bytes, byteCount, glbdata.data());
-
     // The ownership of an allocated `sourceAsset` will be moved to FFilamentAsset::mSourceAsset.
     cgltf_data* sourceAsset;
-    cgltf_result result = cgltf_parse(&options, glbdata.data(), byteCount, &sourceAsset);
+    cgltf_result result = cgltf_parse(&options, bytes, byteCount, &sourceAsset);
     if (result != cgltf_result_success) {
         slog.e << "Unable to parse glTF file." << io::endl;
         return nullptr;
@@ -357,7 +402,6 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         mError = false;
         return nullptr;
     }
-    glbdata.swap(fAsset->mSourceAsset->glbData);
 
     createInstances(numInstances, fAsset);
     if (mError) {
@@ -366,8 +410,6 @@ FFilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_
         mError = false;
         return nullptr;
     }
-
-    std::copy_n(fAsset->mInstances.data(), numInstances, instances);
     return fAsset;
 }
 
@@ -438,6 +480,16 @@ FFilamentAsset* FAssetLoader::createRootAsset(const cgltf_data* srcAsset) {
     mDummyBufferObject = nullptr;
     FFilamentAsset* fAsset = new FFilamentAsset(&mEngine, mNameManager, &mEntityManager,
             &mNodeManager, &mTrsTransformManager, srcAsset);
+    fAsset->mLevelsOfDetail = mLevelsOfDetail;
+    fAsset->mStreaming = mStreaming;
+    if (mStreaming) {
+        for (cgltf_size i = 0; i < srcAsset->animations_count; ++i) {
+            const cgltf_animation& anim = srcAsset->animations[i];
+            for (cgltf_size j = 0; j < anim.channels_count; ++j) {
+                addAnimatedNodes(anim.channels[j].target_node, fAsset);
+            }
+        }
+    }
 
     // It is not an error for a glTF file to have zero scenes.
     fAsset->mScenes.clear();
@@ -509,7 +561,9 @@ void FAssetLoader::recursePrimitives(const cgltf_node* node, FFilamentAsset* fAs
     const char* name = getNodeName(node, mDefaultNodeName);
     name = name ? name : "node";
 
-    if (node->mesh) {
+    if (node->mesh && fAsset->isChunk(*node)) {
+        addChunkBounds(node, fAsset);
+    } else if (node->mesh) {
         createPrimitives(node, name, fAsset);
         fAsset->mRenderableCount++;
     }
@@ -656,35 +710,83 @@ void FAssetLoader::createPrimitives(const cgltf_node* node, const char* name,
     fAsset->mBoundingBox.max = max(fAsset->mBoundingBox.max, transformed.max);
  }
 
-void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const char* name,
-        FFilamentAsset* fAsset) {
+void FAssetLoader::addAnimatedNodes(const cgltf_node* node, FFilamentAsset* fAsset) {
+    if (!node || !fAsset->mAnimatedNodes.insert(node).second) {
+        return;
+    }
+    for (cgltf_size i = 0, len = node->children_count; i < len; ++i) {
+        addAnimatedNodes(node->children[i], fAsset);
+    }
+}
+
+void FAssetLoader::addChunkBounds(const cgltf_node* node, FFilamentAsset* fAsset) {
     const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
     const cgltf_mesh* mesh = node->mesh;
-    const cgltf_size primitiveCount = mesh->primitives_count;
 
-    // If the mesh is already loaded, obtain the list of Filament VertexBuffer / IndexBuffer objects
-    // that were already generated (one for each primitive).
+    // The geometry is created later by AssetStreamer, only the bounding boxes of the primitives
+    // are needed, they come from the min/max properties of the positions.
     FixedCapacityVector<Primitive>& prims = fAsset->mMeshCache[mesh - srcAsset->meshes];
-    assert_invariant(prims.size() == primitiveCount);
-    Primitive* outputPrim = prims.data();
-    const cgltf_primitive* inputPrim = &mesh->primitives[0];
+    if (prims.empty()) {
+        prims.reserve(mesh->primitives_count);
+        prims.resize(mesh->primitives_count);
+        for (cgltf_size index = 0, n = mesh->primitives_count; index < n; ++index) {
+            const cgltf_primitive& inputPrim = mesh->primitives[index];
+            for (cgltf_size aindex = 0; aindex < inputPrim.attributes_count; aindex++) {
+                const cgltf_attribute& attribute = inputPrim.attributes[aindex];
+                if (attribute.type == cgltf_attribute_type_position) {
+                    const float* minp = &attribute.data->min[0];
+                    const float* maxp = &attribute.data->max[0];
+                    prims[index].aabb.min = float3(minp[0], minp[1], minp[2]);
+                    prims[index].aabb.max = float3(maxp[0], maxp[1], maxp[2]);
+                }
+            }
+        }
+    }
 
     Aabb aabb;
+    for (const Primitive& prim : prims) {
+        aabb.min = min(prim.aabb.min, aabb.min);
+        aabb.max = max(prim.aabb.max, aabb.max);
+    }
+
+    mat4f worldTransform;
+    cgltf_node_transform_world(node, &worldTransform[0][0]);
+
+    const Aabb transformed = aabb.transform(worldTransform);
+    fAsset->mBoundingBox.min = min(fAsset->mBoundingBox.min, transformed.min);
+    fAsset->mBoundingBox.max = max(fAsset->mBoundingBox.max, transformed.max);
+}
+
+bool FAssetLoader::createChunkPrimitives(const Chunk& chunk, FFilamentAsset* fAsset) {
+    const char* name = getNodeName(chunk.node, mDefaultNodeName);
+
+    // The dummy buffer of a previous load may belong to another asset.
+    mDummyBufferObject = nullptr;
+    createPrimitives(chunk.node, name ? name : "node", fAsset);
+    const bool success = !mError;
+    mError = false;
+    return success;
+}
+
+void FAssetLoader::createChunkRenderable(const Chunk& chunk, FFilamentAsset* fAsset) {
+    const char* name = getNodeName(chunk.node, mDefaultNodeName);
+    buildRenderable(chunk.node, chunk.entity, name ? name : "node", chunk.materials.data(),
+            fAsset);
+}
+
+void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const char* name,
+        FFilamentAsset* fAsset) {
+    const cgltf_mesh* mesh = node->mesh;
+    const cgltf_size primitiveCount = mesh->primitives_count;
+    const cgltf_primitive* inputPrim = &mesh->primitives[0];
 
     // glTF spec says that all primitives must have the same number of morph targets.
     const cgltf_size numMorphTargets = inputPrim ? inputPrim->targets_count : 0;
-    RenderableManager::Builder builder(primitiveCount);
-    builder.morphing(numMorphTargets);
-
-    // For each prim, create a Filament VertexBuffer, IndexBuffer, and MaterialInstance.
-    // The VertexBuffer and IndexBuffer objects are cached for possible re-use, but MaterialInstance
-    // is not.
-    for (cgltf_size index = 0; index < primitiveCount; ++index, ++outputPrim, ++inputPrim) {
-        RenderableManager::PrimitiveType primType;
-        if (!getPrimitiveType(inputPrim->type, &primType)) {
-            slog.e << "Unsupported primitive type in " << name << io::endl;
-        }
 
+    // Create a material instance for each primitive or fetch one from the cache. MaterialInstance
+    // objects are not shared across instances, unlike VertexBuffer and IndexBuffer objects.
+    FixedCapacityVector<MaterialInstance*> materials(primitiveCount, nullptr);
+    for (cgltf_size index = 0; index < primitiveCount; ++index, ++inputPrim) {
         if (numMorphTargets != inputPrim->targets_count) {
             slog.e << "Sister primitives must all have the same number of morph targets."
                    << io::endl;
@@ -692,7 +794,6 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
             continue;
         }
 
-        // Create a material instance for this primitive or fetch one from the cache.
         UvMap uvmap {};
         bool hasVertexColor = primitiveHasVertexColor(*inputPrim);
         MaterialInstance* mi = createMaterialInstance(inputPrim->material, &uvmap, hasVertexColor,
@@ -704,10 +805,69 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
         }
 
         fAsset->mDependencyGraph.addEdge(entity, mi);
+        materials[index] = mi;
+    }
+
+    // The renderables of chunks are created when they are streamed in.
+    if (fAsset->isChunk(*node)) {
+        fAsset->mChunks.push_back({ node, entity, std::move(materials) });
+        return;
+    }
+
+    buildRenderable(node, entity, name, materials.data(), fAsset);
+}
+
+void FAssetLoader::buildRenderable(const cgltf_node* node, Entity entity, const char* name,
+        MaterialInstance* const* materials, FFilamentAsset* fAsset) {
+    const cgltf_data* srcAsset = fAsset->mSourceAsset->hierarchy;
+    const cgltf_mesh* mesh = node->mesh;
+    const cgltf_size primitiveCount = mesh->primitives_count;
+
+    // If the mesh is already loaded, obtain the list of Filament VertexBuffer / IndexBuffer objects
+    // that were already generated (one for each primitive).
+    FixedCapacityVector<Primitive>& prims = fAsset->mMeshCache[mesh - srcAsset->meshes];
+    assert_invariant(prims.size() == primitiveCount);
+    Primitive* outputPrim = prims.data();
+    const cgltf_primitive* inputPrim = &mesh->primitives[0];
+
+    Aabb aabb;
+
+    // The number of morph targets was checked by createRenderable().
+    const cgltf_size numMorphTargets = inputPrim ? inputPrim->targets_count : 0;
+
+    // Each level of detail gets a copy of the primitives, whose geometry is replaced by
+    // ResourceLoader once the simplified indices are generated.
+    const size_t levelCount = supportsLevelsOfDetail(*mesh) ?
+            fAsset->mLevelsOfDetail.size() + 1 : 1;
+
+    RenderableManager::Builder builder(primitiveCount * levelCount);
+    builder.morphing(numMorphTargets);
+
+    // For each prim, use the cached Filament VertexBuffer and IndexBuffer, and the material
+    // instance created for this renderable.
+    for (cgltf_size index = 0; index < primitiveCount; ++index, ++outputPrim, ++inputPrim) {
+        RenderableManager::PrimitiveType primType;
+        if (!getPrimitiveType(inputPrim->type, &primType)) {
+            slog.e << "Unsupported primitive type in " << name << io::endl;
+        }
+
+        MaterialInstance* mi = materials[index];
+        if (!mi) {
+            continue;
+        }
         builder.material(index, mi);
 
         assert_invariant(outputPrim->vertices);
 
+        // Until the simplified indices are available, levels of detail use the original ones.
+        for (size_t level = 1; level < levelCount; ++level) {
+            IndexBuffer* const indices = level <= outputPrim->lods.size() ?
+                    outputPrim->lods[level - 1] : outputPrim->indices;
+            builder.material(level * primitiveCount + index, mi);
+            builder.geometry(level * primitiveCount + index, primType, outputPrim->vertices,
+                    indices);
+        }
+
         // Expand the object-space bounding box.
         aabb.min = min(outputPrim->aabb.min, aabb.min);
         aabb.max = max(outputPrim->aabb.max, aabb.max);
@@ -735,6 +895,11 @@ void FAssetLoader::createRenderable(const cgltf_node* node, Entity entity, const
        builder.skinning(node->skin->joints_count);
     }
 
+    for (size_t level = 1; level < levelCount; ++level) {
+        builder.levelOfDetail(uint8_t(level), level * primitiveCount,
+                fAsset->mLevelsOfDetail[level - 1].screenSize);
+    }
+
     // Per the spec, glTF models must have valid mix / max annotations for position attributes.
     // If desired, clients can call "recomputeBoundingBoxes()" in FilamentInstance.
     Box box = Box().set(aabb.min, aabb.max);
@@ -1576,6 +1741,10 @@ FilamentAsset* AssetLoader::createAsset(uint8_t const* bytes, uint32_t nbytes) {
     return downcast(this)->createAsset(bytes, nbytes);
 }
 
+FilamentAsset* AssetLoader::createAssetFromFile(const char* path) {
+    return downcast(this)->createAssetFromFile(path);
+}
+
 FilamentAsset* AssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t numBytes,
         FilamentInstance** instances, size_t numInstances) {
     return downcast(this)->createInstancedAsset(bytes, numBytes, instances, numInstances);
@@ -1609,4 +1778,13 @@ MaterialProvider& AssetLoader::getMaterialProvider() noexcept {
     return downcast(this)->mMaterials;
 }
 
+// These are used by FAssetStreamer, which does not see FAssetLoader.
+bool createChunkPrimitives(AssetLoader* loader, const Chunk& chunk, FFilamentAsset* asset) {
+    return downcast(loader)->createChunkPrimitives(chunk, asset);
+}
+
+void createChunkRenderable(AssetLoader* loader, const Chunk& chunk, FFilamentAsset* asset) {
+    downcast(loader)->createChunkRenderable(chunk, asset);
+}
+
 } // namespace filament::gltfio
@@ -0,0 +1,709 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FAssetStreamer.h"
+#include "GltfEnums.h"
+
+#include <filament/BufferObject.h>
+#include <filament/Camera.h>
+#include <filament/IndexBuffer.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+#include <filament/VertexBuffer.h>
+#include <filament/View.h>
+
+#include <utils/Log.h>
+#include <utils/Systrace.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+static const auto FREE_CALLBACK = [](void* mem, size_t, void*) { free(mem); };
+
+namespace filament::gltfio {
+
+size_t simplifyPrimitive(const cgltf_primitive& prim, const FixedCapacityVector<LevelOfDetail>& lods,
+        std::vector<std::vector<uint32_t>>* levels);
+IndexBuffer* createIndexBuffer(Engine& engine, const std::vector<uint32_t>& indices,
+        size_t vertexCount);
+bool createChunkPrimitives(AssetLoader* loader, const Chunk& chunk, FFilamentAsset* asset);
+void createChunkRenderable(AssetLoader* loader, const Chunk& chunk, FFilamentAsset* asset);
+
+// Maximum number of chunks in a leaf of the bounding volume hierarchy.
+static constexpr uint32_t BVH_LEAF_SIZE = 8;
+
+// Keeps the source data alive while it is uploaded without a copy, and counts the uploads in
+// flight so that the source data of the mesh can be discarded once they are done.
+struct SourceUpload {
+    FFilamentAsset::SourceHandle source;
+    std::shared_ptr<std::atomic<uint32_t>> pending;
+};
+
+static void uploadCallback(void*, size_t, void* user) {
+    auto upload = (SourceUpload*) user;
+    upload->pending->fetch_sub(1, std::memory_order_release);
+    delete upload;
+}
+
+static float getDistance(Aabb const& box, float3 const& eye) noexcept {
+    return length(max(max(box.min - eye, eye - box.max), float3(0.0f)));
+}
+
+static bool isEqual(mat4f const& lhs, mat4f const& rhs) noexcept {
+    for (size_t i = 0; i < 4; i++) {
+        if (lhs[i] != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+static void moveTail(std::vector<T>& src, size_t first, std::vector<T>* dst) {
+    dst->insert(dst->end(), src.begin() + first, src.end());
+    src.resize(first);
+}
+
+FAssetStreamer::FAssetStreamer(Engine* engine, AssetLoader* loader,
+        AssetStreamerConfig const& config)
+        : mEngine(*engine), mLoader(loader), mConfig(config) {
+    JobSystem& js = mEngine.getJobSystem();
+    mRootJob = js.createJob();
+    js.setPriority(mRootJob, JobSystem::JobPriority::BACKGROUND);
+}
+
+FAssetStreamer::~FAssetStreamer() {
+    for (auto& [key, asset] : mAssets) {
+        release(*asset);
+    }
+    mEngine.getJobSystem().release(mRootJob);
+}
+
+void FAssetStreamer::addAsset(FilamentAsset* asset) {
+    FFilamentAsset* fasset = downcast(asset);
+    if (!fasset->mStreaming) {
+        slog.w << "The asset was not created with AssetConfiguration::streaming." << io::endl;
+        return;
+    }
+    auto state = std::make_unique<Asset>();
+    state->asset = fasset;
+    state->meshes.resize(fasset->mSourceAsset->hierarchy->meshes_count);
+    addChunks(*state);
+    mAssets[asset] = std::move(state);
+}
+
+void FAssetStreamer::removeAsset(FilamentAsset* asset) {
+    auto const pos = mAssets.find(asset);
+    if (pos != mAssets.end()) {
+        release(*pos->second);
+        mAssets.erase(pos);
+    }
+}
+
+void FAssetStreamer::update(View const* view) {
+    SYSTRACE_CALL();
+
+    float3 const eye{ view->getCamera().getPosition() };
+
+    std::vector<Candidate> candidates;
+    for (auto& [key, asset] : mAssets) {
+        // Instances created since the previous update add chunks.
+        addChunks(*asset);
+        updateBvh(*asset);
+
+        std::vector<Mesh*>& pending = asset->pending;
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [&](Mesh* mesh) {
+            if (mesh->job) {
+                if (!mesh->ready.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                finishLoading(*asset, *mesh);
+            }
+            if (mesh->pendingUploads->load(std::memory_order_acquire)) {
+                return false;
+            }
+            discardSources(*mesh);
+            mesh->queued = false;
+            return true;
+        }), pending.end());
+
+        // Only the loaded chunks are checked for unloading.
+        std::vector<uint32_t>& loaded = asset->loaded;
+        loaded.erase(std::remove_if(loaded.begin(), loaded.end(), [&](uint32_t chunk) {
+            ChunkState const& state = asset->chunks[chunk];
+            if (getDistance(state.worldAabb, eye) > mConfig.unloadDistance) {
+                unloadChunk(*asset, chunk);
+                return true;
+            }
+            if (!state.built && getMesh(*asset, chunk).state == MeshState::RESIDENT) {
+                buildChunk(*asset, chunk);
+            }
+            return false;
+        }), loaded.end());
+
+        // The chunks to load are found with the bounding volume hierarchy, whose depth is
+        // logarithmic in the number of chunks.
+        if (asset->bvh.empty()) {
+            continue;
+        }
+        uint32_t stack[64];
+        size_t depth = 0;
+        stack[depth++] = 0;
+        while (depth) {
+            BvhNode const& node = asset->bvh[stack[--depth]];
+            if (getDistance(node.aabb, eye) >= mConfig.loadDistance) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack[depth++] = node.first;
+                stack[depth++] = node.first + 1;
+                continue;
+            }
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                uint32_t const chunk = asset->order[i];
+                ChunkState const& state = asset->chunks[chunk];
+                float const distance = getDistance(state.worldAabb, eye);
+                if (!state.loaded && distance < mConfig.loadDistance) {
+                    candidates.push_back({ asset.get(), chunk, distance });
+                }
+            }
+        }
+    }
+
+    // Load the closest chunks first, a mesh that does not fit in the budget may let a smaller
+    // one in.
+    std::sort(candidates.begin(), candidates.end(), [](Candidate const& lhs, Candidate const& rhs) {
+        return lhs.distance < rhs.distance;
+    });
+    uint32_t loadCount = 0;
+    for (Candidate const& candidate : candidates) {
+        Mesh& mesh = getMesh(*candidate.asset, candidate.chunk);
+        if (mesh.state == MeshState::UNLOADED) {
+            if (loadCount == mConfig.maxLoadsPerUpdate ||
+                    mResidentBytes + mesh.byteCount > mConfig.budget) {
+                continue;
+            }
+            loadCount++;
+            startLoading(*candidate.asset, mesh,
+                    candidate.asset->asset->mChunks[candidate.chunk]);
+        }
+        if (mesh.state != MeshState::ERROR) {
+            loadChunk(*candidate.asset, candidate.chunk);
+        }
+    }
+}
+
+AssetStreamer::Statistics FAssetStreamer::getStatistics() const noexcept {
+    Statistics stats{ 0, 0, 0, mResidentBytes };
+    for (auto const& [key, asset] : mAssets) {
+        stats.chunkCount += asset->chunks.size();
+        for (uint32_t chunk : asset->loaded) {
+            stats.loadedChunkCount += asset->chunks[chunk].built ? 1 : 0;
+        }
+        for (Mesh const* mesh : asset->pending) {
+            stats.loadingCount += mesh->state == MeshState::LOADING ? 1 : 0;
+        }
+    }
+    return stats;
+}
+
+void FAssetStreamer::prepare(FFilamentAsset const* asset, Mesh* mesh) {
+    SYSTRACE_CALL();
+
+    const cgltf_accessor* kGenerateTangents = &asset->mGenerateTangents;
+    const cgltf_accessor* kGenerateNormals = &asset->mGenerateNormals;
+
+    // The data is converted like in ResourceLoader::loadResources(), the data that does not need
+    // to be converted is uploaded from the source data.
+    tsl::robin_map<VertexBuffer*, uint8_t> baseTangents;
+    for (BufferSlot const& slot : mesh->slots) {
+        const cgltf_accessor* accessor = slot.accessor;
+        if (accessor == kGenerateTangents || accessor == kGenerateNormals) {
+            baseTangents[slot.vertexBuffer] = slot.bufferIndex;
+            continue;
+        }
+        SlotData const content = getSlotData(slot);
+        if (content.data) {
+            mesh->uploads.push_back({ slot, content });
+        }
+    }
+
+    using Params = TangentsJob::Params;
+    for (auto [prim, vb] : mesh->primitives) {
+        if (UTILS_UNLIKELY(prim->type != cgltf_primitive_type_triangles)) {
+            continue;
+        }
+        auto iter = baseTangents.find(vb);
+        if (iter != baseTangents.end()) {
+            mesh->tangents.emplace_back(Params {{ prim }, { vb, nullptr, iter->second }});
+        }
+    }
+    for (Params& params : mesh->tangents) {
+        TangentsJob::run(&params);
+    }
+
+    const FixedCapacityVector<LevelOfDetail>& lods = asset->mLevelsOfDetail;
+    if (!lods.empty() && supportsLevelsOfDetail(*mesh->source)) {
+        const size_t primitiveCount = mesh->source->primitives_count;
+        mesh->vertexCounts.resize(primitiveCount);
+        mesh->levels.resize(primitiveCount);
+        for (size_t index = 0; index < primitiveCount; ++index) {
+            mesh->vertexCounts[index] = simplifyPrimitive(mesh->source->primitives[index], lods,
+                    &mesh->levels[index]);
+        }
+    }
+}
+
+size_t FAssetStreamer::getMeshSize(const cgltf_mesh& mesh) noexcept {
+    size_t size = 0;
+    for (cgltf_size index = 0; index < mesh.primitives_count; ++index) {
+        const cgltf_primitive& prim = mesh.primitives[index];
+        const size_t vertexCount = prim.attributes[0].data->count;
+        for (cgltf_size aindex = 0; aindex < prim.attributes_count; ++aindex) {
+            const cgltf_accessor* accessor = prim.attributes[aindex].data;
+            size += accessor->count * (requiresConversion(accessor) ?
+                    sizeof(float) * cgltf_num_components(accessor->type) : accessor->stride);
+        }
+        // generated or converted tangents
+        size += vertexCount * sizeof(short4);
+        size += prim.indices ? prim.indices->count * std::max(prim.indices->stride, size_t(2)) :
+                vertexCount * sizeof(uint32_t);
+    }
+    return size;
+}
+
+std::vector<FAssetStreamer::SourceRange> FAssetStreamer::getMeshSources(
+        FFilamentAsset const* asset, const cgltf_mesh& mesh) {
+    std::vector<MappedFile> const& files = asset->mSourceAsset->mappedFiles;
+    std::vector<SourceRange> sources;
+    auto addSource = [&](const cgltf_accessor* accessor) {
+        // Meshopt compressed data is decoded in memory that is not mapped.
+        if (!accessor || !accessor->buffer_view || accessor->buffer_view->has_meshopt_compression) {
+            return;
+        }
+        const void* data = (const uint8_t*) accessor->buffer_view->buffer->data +
+                computeBindingOffset(accessor);
+        const size_t size = computeBindingSize(accessor);
+        for (MappedFile const& file : files) {
+            if (file.contains(data, size)) {
+                sources.push_back({ &file, data, size });
+                break;
+            }
+        }
+    };
+    for (cgltf_size index = 0; index < mesh.primitives_count; ++index) {
+        const cgltf_primitive& prim = mesh.primitives[index];
+        for (cgltf_size aindex = 0; aindex < prim.attributes_count; ++aindex) {
+            // Skinning weights may be normalized in place, discarding them would revert them.
+            if (prim.attributes[aindex].type != cgltf_attribute_type_weights) {
+                addSource(prim.attributes[aindex].data);
+            }
+        }
+        addSource(prim.indices);
+    }
+    return sources;
+}
+
+void FAssetStreamer::discardSources(Mesh const& mesh) noexcept {
+    for (SourceRange const& source : mesh.sources) {
+        source.file->discard(source.data, source.size);
+    }
+}
+
+FAssetStreamer::Mesh& FAssetStreamer::getMesh(Asset& asset, size_t chunk) const noexcept {
+    const cgltf_data* gltf = asset.asset->mSourceAsset->hierarchy;
+    return *asset.meshes[asset.asset->mChunks[chunk].node->mesh - gltf->meshes];
+}
+
+void FAssetStreamer::addChunks(Asset& asset) {
+    FFilamentAsset const* fasset = asset.asset;
+    const cgltf_data* gltf = fasset->mSourceAsset->hierarchy;
+    TransformManager const& tm = mEngine.getTransformManager();
+    for (size_t i = asset.chunks.size(), n = fasset->mChunks.size(); i < n; i++) {
+        const cgltf_mesh* source = fasset->mChunks[i].node->mesh;
+        const size_t meshIndex = source - gltf->meshes;
+        FixedCapacityVector<Primitive> const& prims = fasset->mMeshCache[meshIndex];
+        auto& mesh = asset.meshes[meshIndex];
+        if (!mesh) {
+            mesh = std::make_unique<Mesh>();
+            mesh->source = source;
+            if (!prims.empty() && prims[0].vertices) {
+                // The mesh is also used by a node that is not a chunk, e.g. a skinned one, its
+                // geometry was created with the asset.
+                mesh->state = MeshState::RESIDENT;
+            } else {
+                mesh->owned = true;
+                mesh->byteCount = getMeshSize(*source);
+                mesh->sources = getMeshSources(fasset, *source);
+                mesh->pendingUploads = std::make_shared<std::atomic<uint32_t>>(0);
+                // The loaders may have read the source data, e.g. to compute bounding boxes.
+                discardSources(*mesh);
+            }
+        }
+
+        ChunkState& state = asset.chunks.emplace_back();
+        for (Primitive const& prim : prims) {
+            state.aabb.min = min(prim.aabb.min, state.aabb.min);
+            state.aabb.max = max(prim.aabb.max, state.aabb.max);
+        }
+
+        Entity root = fasset->mChunks[i].entity;
+        for (Entity parent = tm.getParent(tm.getInstance(root)); parent;
+                parent = tm.getParent(tm.getInstance(parent))) {
+            root = parent;
+        }
+        auto const pos = std::find_if(asset.roots.begin(), asset.roots.end(),
+                [root](Root const& r) { return r.entity == root; });
+        state.root = uint32_t(pos - asset.roots.begin());
+        if (pos == asset.roots.end()) {
+            asset.roots.push_back({ root, tm.getWorldTransform(tm.getInstance(root)) });
+        }
+        asset.dirty = true;
+    }
+}
+
+void FAssetStreamer::buildBvh(Asset& asset, uint32_t node, uint32_t first, uint32_t count) {
+    Aabb aabb;
+    Aabb centers;
+    for (uint32_t i = first; i < first + count; i++) {
+        Aabb const& box = asset.chunks[asset.order[i]].worldAabb;
+        aabb.min = min(aabb.min, box.min);
+        aabb.max = max(aabb.max, box.max);
+        centers.min = min(centers.min, box.center());
+        centers.max = max(centers.max, box.center());
+    }
+    asset.bvh[node] = { aabb, first, count };
+    if (count <= BVH_LEAF_SIZE) {
+        return;
+    }
+
+    // Split at the median along the largest axis of the centers of the chunks.
+    float3 const extent = centers.extent();
+    size_t const axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) :
+            (extent.y > extent.z ? 1 : 2);
+    auto const begin = asset.order.begin() + first;
+    uint32_t const half = count / 2;
+    std::nth_element(begin, begin + half, begin + count, [&asset, axis](uint32_t a, uint32_t b) {
+        return asset.chunks[a].worldAabb.center()[axis] < asset.chunks[b].worldAabb.center()[axis];
+    });
+
+    uint32_t const child = uint32_t(asset.bvh.size());
+    asset.bvh.resize(child + 2);
+    asset.bvh[node] = { aabb, child, 0 };
+    buildBvh(asset, child, first, half);
+    buildBvh(asset, child + 1, first + half, count - half);
+}
+
+void FAssetStreamer::updateBvh(Asset& asset) {
+    TransformManager const& tm = mEngine.getTransformManager();
+    for (Root& root : asset.roots) {
+        mat4f const& transform = tm.getWorldTransform(tm.getInstance(root.entity));
+        if (!isEqual(transform, root.transform)) {
+            root.transform = transform;
+            asset.dirty = true;
+        }
+    }
+    if (!asset.dirty) {
+        return;
+    }
+    asset.dirty = false;
+
+    // The transforms of chunks relative to their root don't change, the hierarchy is only built
+    // again when chunks are added or when a root moves.
+    SYSTRACE_NAME("AssetStreamer::updateBvh");
+    std::vector<Chunk> const& chunks = asset.asset->mChunks;
+    const uint32_t count = uint32_t(asset.chunks.size());
+    for (uint32_t i = 0; i < count; i++) {
+        ChunkState& state = asset.chunks[i];
+        state.worldAabb = state.aabb.transform(
+                tm.getWorldTransform(tm.getInstance(chunks[i].entity)));
+    }
+    asset.order.resize(count);
+    std::iota(asset.order.begin(), asset.order.end(), 0);
+    asset.bvh.clear();
+    if (count) {
+        asset.bvh.resize(1);
+        buildBvh(asset, 0, 0, count);
+    }
+}
+
+void FAssetStreamer::loadChunk(Asset& asset, size_t chunk) {
+    Mesh& mesh = getMesh(asset, chunk);
+    asset.chunks[chunk].loaded = true;
+    asset.loaded.push_back(uint32_t(chunk));
+    mesh.useCount++;
+    if (mesh.state == MeshState::RESIDENT) {
+        buildChunk(asset, chunk);
+    }
+}
+
+void FAssetStreamer::unloadChunk(Asset& asset, size_t chunk) {
+    ChunkState& state = asset.chunks[chunk];
+    Mesh& mesh = getMesh(asset, chunk);
+    if (state.built) {
+        saveState(asset, chunk);
+        mEngine.getRenderableManager().destroy(asset.asset->mChunks[chunk].entity);
+    }
+    state.loaded = false;
+    state.built = false;
+
+    // A mesh that is still loading is unloaded when its job finishes.
+    if (--mesh.useCount == 0 && mesh.owned && mesh.state == MeshState::RESIDENT) {
+        unloadMesh(asset, mesh);
+    }
+}
+
+void FAssetStreamer::buildChunk(Asset& asset, size_t chunk) {
+    createChunkRenderable(mLoader, asset.asset->mChunks[chunk], asset.asset);
+    asset.chunks[chunk].built = true;
+    restoreState(asset, chunk);
+}
+
+void FAssetStreamer::saveState(Asset& asset, size_t chunk) {
+    RenderableManager const& rm = mEngine.getRenderableManager();
+    auto const ri = rm.getInstance(asset.asset->mChunks[chunk].entity);
+    auto state = std::make_unique<RenderableState>();
+    state->layerMask = rm.getLayerMask(ri);
+    state->priority = rm.getPriority(ri);
+    state->channel = rm.getChannel(ri);
+    state->lightChannels = 0;
+    for (unsigned int channel = 0; channel < 8; channel++) {
+        state->lightChannels |= rm.getLightChannel(ri, channel) ? 1u << channel : 0u;
+    }
+    state->culling = rm.isCullingEnabled(ri);
+    state->castShadows = rm.isShadowCaster(ri);
+    state->receiveShadows = rm.isShadowReceiver(ri);
+    state->staticShadowCaster = rm.isStaticShadowCaster(ri);
+    state->contactShadows = rm.isScreenSpaceContactShadowsEnabled(ri);
+    state->fog = rm.getFogEnabled(ri);
+    state->materials = FixedCapacityVector<MaterialInstance*>(rm.getPrimitiveCount(ri));
+    for (size_t index = 0; index < state->materials.size(); ++index) {
+        state->materials[index] = rm.getMaterialInstanceAt(ri, index);
+    }
+    asset.chunks[chunk].saved = std::move(state);
+}
+
+void FAssetStreamer::restoreState(Asset& asset, size_t chunk) {
+    std::unique_ptr<RenderableState> const state = std::move(asset.chunks[chunk].saved);
+    if (!state) {
+        return;
+    }
+    RenderableManager& rm = mEngine.getRenderableManager();
+    auto const ri = rm.getInstance(asset.asset->mChunks[chunk].entity);
+    rm.setLayerMask(ri, 0xff, state->layerMask);
+    rm.setPriority(ri, state->priority);
+    rm.setChannel(ri, state->channel);
+    for (unsigned int channel = 0; channel < 8; channel++) {
+        rm.setLightChannel(ri, channel, state->lightChannels & (1u << channel));
+    }
+    rm.setCulling(ri, state->culling);
+    rm.setCastShadows(ri, state->castShadows);
+    rm.setReceiveShadows(ri, state->receiveShadows);
+    rm.setStaticShadowCaster(ri, state->staticShadowCaster);
+    rm.setScreenSpaceContactShadows(ri, state->contactShadows);
+    rm.setFogEnabled(ri, state->fog);
+    const size_t primitiveCount = std::min(size_t(state->materials.size()), rm.getPrimitiveCount(ri));
+    for (size_t index = 0; index < primitiveCount; ++index) {
+        rm.setMaterialInstanceAt(ri, index, state->materials[index]);
+    }
+}
+
+void FAssetStreamer::startLoading(Asset& asset, Mesh& mesh, Chunk const& chunk) {
+    FFilamentAsset* fasset = asset.asset;
+    const size_t vertexBufferCount = fasset->mVertexBuffers.size();
+    const size_t indexBufferCount = fasset->mIndexBuffers.size();
+    const size_t bufferObjectCount = fasset->mBufferObjects.size();
+    const size_t slotCount = fasset->mBufferSlots.size();
+    const size_t primitiveCount = fasset->mPrimitives.size();
+
+    // AssetLoader creates the Filament objects in the asset, the streamer owns them instead.
+    const bool success = createChunkPrimitives(mLoader, chunk, fasset);
+    moveTail(fasset->mVertexBuffers, vertexBufferCount, &mesh.vertexBuffers);
+    moveTail(fasset->mIndexBuffers, indexBufferCount, &mesh.indexBuffers);
+    moveTail(fasset->mBufferObjects, bufferObjectCount, &mesh.bufferObjects);
+    moveTail(fasset->mBufferSlots, slotCount, &mesh.slots);
+    moveTail(fasset->mPrimitives, primitiveCount, &mesh.primitives);
+
+    mResidentBytes += mesh.byteCount;
+    mesh.state = MeshState::LOADING;
+    if (!success) {
+        slog.e << "Unable to create the geometry of a chunk." << io::endl;
+        unloadMesh(asset, mesh);
+        mesh.state = MeshState::ERROR;
+        return;
+    }
+
+    JobSystem& js = mEngine.getJobSystem();
+    Mesh* const pmesh = &mesh;
+    mesh.ready.store(false, std::memory_order_relaxed);
+    mesh.job = jobs::createJob(js, mRootJob, [fasset, pmesh] {
+        prepare(fasset, pmesh);
+        pmesh->ready.store(true, std::memory_order_release);
+    });
+    js.runAndRetain(mesh.job);
+    if (!mesh.queued) {
+        mesh.queued = true;
+        asset.pending.push_back(&mesh);
+    }
+}
+
+void FAssetStreamer::finishLoading(Asset& asset, Mesh& mesh) {
+    SYSTRACE_CALL();
+
+    FFilamentAsset* fasset = asset.asset;
+    mEngine.getJobSystem().waitAndRelease(mesh.job);
+    mesh.job = nullptr;
+
+    for (Upload const& upload : mesh.uploads) {
+        SourceUpload* user = nullptr;
+        if (!upload.content.owned) {
+            mesh.pendingUploads->fetch_add(1, std::memory_order_relaxed);
+            user = new SourceUpload{ fasset->mSourceAsset, mesh.pendingUploads };
+        }
+        uploadSlotData(mEngine, upload.slot, upload.content, uploadCallback, user,
+                &mesh.bufferObjects);
+    }
+
+    for (TangentsJob::Params const& params : mesh.tangents) {
+        BufferObject* bo = BufferObject::Builder()
+                .size(params.out.vertexCount * sizeof(short4)).build(mEngine);
+        mesh.bufferObjects.push_back(bo);
+        bo->setBuffer(mEngine, BufferObject::BufferDescriptor(
+                params.out.results, bo->getByteCount(), FREE_CALLBACK));
+        params.context.vb->setBufferObjectAt(mEngine, params.context.slot, bo);
+    }
+
+    const cgltf_data* gltf = fasset->mSourceAsset->hierarchy;
+    FixedCapacityVector<Primitive>& prims = fasset->mMeshCache[mesh.source - gltf->meshes];
+    for (size_t index = 0; index < mesh.levels.size(); ++index) {
+        std::vector<std::vector<uint32_t>> const& levels = mesh.levels[index];
+        if (levels.empty()) {
+            continue;
+        }
+        prims[index].lods = FixedCapacityVector<IndexBuffer*>(levels.size());
+        for (size_t level = 0; level < levels.size(); ++level) {
+            IndexBuffer* ib = createIndexBuffer(mEngine, levels[level],
+                    mesh.vertexCounts[index]);
+            mesh.indexBuffers.push_back(ib);
+            prims[index].lods[level] = ib;
+        }
+    }
+
+    mesh.uploads.clear();
+    mesh.tangents.clear();
+    mesh.vertexCounts.clear();
+    mesh.levels.clear();
+    mesh.slots.clear();
+    mesh.primitives.clear();
+    mesh.state = MeshState::RESIDENT;
+
+    // The renderables are built by update(), unless all the chunks went away in the meantime.
+    if (mesh.useCount == 0) {
+        unloadMesh(asset, mesh);
+    }
+}
+
+void FAssetStreamer::unloadMesh(Asset& asset, Mesh& mesh) {
+    const cgltf_data* gltf = asset.asset->mSourceAsset->hierarchy;
+    for (Primitive& prim : asset.asset->mMeshCache[mesh.source - gltf->meshes]) {
+        prim.vertices = nullptr;
+        prim.indices = nullptr;
+        prim.lods = {};
+    }
+    for (VertexBuffer* vb : mesh.vertexBuffers) {
+        mEngine.destroy(vb);
+    }
+    for (IndexBuffer* ib : mesh.indexBuffers) {
+        if (ib) {
+            mEngine.destroy(ib);
+        }
+    }
+    for (BufferObject* bo : mesh.bufferObjects) {
+        mEngine.destroy(bo);
+    }
+    mesh.vertexBuffers.clear();
+    mesh.indexBuffers.clear();
+    mesh.bufferObjects.clear();
+    mesh.slots.clear();
+    mesh.primitives.clear();
+    mResidentBytes -= mesh.byteCount;
+    mesh.state = MeshState::UNLOADED;
+}
+
+void FAssetStreamer::release(Asset& asset) {
+    for (size_t i = 0, n = asset.chunks.size(); i < n; i++) {
+        if (asset.chunks[i].built) {
+            mEngine.getRenderableManager().destroy(asset.asset->mChunks[i].entity);
+        }
+    }
+    for (auto& mesh : asset.meshes) {
+        if (!mesh || !mesh->owned) {
+            continue;
+        }
+        if (mesh->job) {
+            mEngine.getJobSystem().waitAndRelease(mesh->job);
+            mesh->job = nullptr;
+            for (Upload const& upload : mesh->uploads) {
+                if (upload.content.owned) {
+                    free(const_cast<void*>(upload.content.data));
+                }
+            }
+            for (TangentsJob::Params const& params : mesh->tangents) {
+                free(params.out.results);
+            }
+        }
+        if (mesh->state == MeshState::LOADING || mesh->state == MeshState::RESIDENT) {
+            unloadMesh(asset, *mesh);
+        }
+    }
+}
+
+} // namespace filament::gltfio
+
+using namespace filament::gltfio;
+
+AssetStreamer* AssetStreamer::create(Engine* engine, AssetLoader* loader,
+        AssetStreamerConfig const& config) {
+    return new FAssetStreamer(engine, loader, config);
+}
+
+void AssetStreamer::destroy(AssetStreamer** streamer) {
+    delete downcast(*streamer);
+    *streamer = nullptr;
+}
+
+void AssetStreamer::addAsset(FilamentAsset* asset) {
+    downcast(this)->addAsset(asset);
+}
+
+void AssetStreamer::removeAsset(FilamentAsset* asset) {
+    downcast(this)->removeAsset(asset);
+}
+
+void AssetStreamer::update(View const* view) {
+    downcast(this)->update(view);
+}
+
+AssetStreamer::Statistics AssetStreamer::getStatistics() const noexcept {
+    return downcast(this)->getStatistics();
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BufferUploads.h"
+#include "GltfEnums.h"
+
+#include <filament/BufferObject.h>
+#include <filament/IndexBuffer.h>
+#include <filament/VertexBuffer.h>
+
+#include <algorithm>
+
+#include <stdlib.h>
+
+using namespace filament;
+
+static const auto FREE_CALLBACK = [](void* mem, size_t, void*) { free(mem); };
+
+namespace filament::gltfio {
+
+SlotData getSlotData(const BufferSlot& slot) {
+    const cgltf_accessor* accessor = slot.accessor;
+    if (!accessor->buffer_view) {
+        return {};
+    }
+    const uint8_t* data = nullptr;
+    if (accessor->buffer_view->has_meshopt_compression) {
+        data = (const uint8_t*) accessor->buffer_view->data + accessor->offset;
+    } else {
+        data = (const uint8_t*) accessor->buffer_view->buffer->data +
+                computeBindingOffset(accessor);
+    }
+    assert_invariant(data);
+    const uint32_t size = computeBindingSize(accessor);
+    if (slot.vertexBuffer && requiresConversion(accessor)) {
+        const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
+        const size_t floatsByteCount = sizeof(float) * floatsCount;
+        float* floatsData = (float*) malloc(floatsByteCount);
+        cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
+        return { floatsData, floatsByteCount, true };
+    }
+    if (slot.indexBuffer && accessor->component_type == cgltf_component_type_r_8u) {
+        uint16_t* data16 = (uint16_t*) malloc(size * 2);
+        std::copy_n(data, size, data16);
+        return { data16, size_t(size) * 2, true };
+    }
+    return { data, size, false };
+}
+
+void uploadSlotData(Engine& engine, const BufferSlot& slot, const SlotData& content,
+        backend::BufferDescriptor::Callback callback, void* user,
+        std::vector<BufferObject*>* bufferObjects) {
+    void* const data = const_cast<void*>(content.data);
+    if (content.owned) {
+        callback = FREE_CALLBACK;
+        user = nullptr;
+    }
+    if (slot.vertexBuffer) {
+        BufferObject* bo = BufferObject::Builder().size(content.size).build(engine);
+        bufferObjects->push_back(bo);
+        bo->setBuffer(engine, BufferObject::BufferDescriptor(data, content.size, callback, user));
+        slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+    } else {
+        assert_invariant(slot.indexBuffer);
+        slot.indexBuffer->setBuffer(engine,
+                IndexBuffer::BufferDescriptor(data, content.size, callback, user));
+    }
+}
+
+} // namespace filament::gltfio
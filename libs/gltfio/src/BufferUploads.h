@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_BUFFERUPLOADS_H
+#define GLTFIO_BUFFERUPLOADS_H
+
+#include "FFilamentAsset.h"
+
+#include <backend/BufferDescriptor.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::gltfio {
+
+uint32_t computeBindingSize(const cgltf_accessor* accessor);
+uint32_t computeBindingOffset(const cgltf_accessor* accessor);
+
+// The content of a vertex buffer or index buffer slot, in the layout expected by Filament.
+struct SlotData {
+    const void* data = nullptr; // null if the accessor has no buffer view
+    size_t size = 0;
+    bool owned = false;         // malloc'd, otherwise it points into the source data
+};
+
+// Returns the content of the given vertex buffer or index buffer slot. The accessors that are not
+// supported by the VertexBuffer (e.g. normalized or sparse ones) are unpacked into floats, 8-bit
+// indices are widened to 16 bits, the other ones are returned as is. This does not use the engine
+// and can be called from any thread.
+SlotData getSlotData(const BufferSlot& slot);
+
+// Uploads the given content to its slot. Owned data is freed once uploaded, otherwise the
+// callback is called with the given user data, which must keep the source data alive. The
+// BufferObject created for a vertex buffer slot is added to bufferObjects.
+void uploadSlotData(Engine& engine, const BufferSlot& slot, const SlotData& content,
+        backend::BufferDescriptor::Callback callback, void* user,
+        std::vector<BufferObject*>* bufferObjects);
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_BUFFERUPLOADS_H
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_FASSETSTREAMER_H
+#define GLTFIO_FASSETSTREAMER_H
+
+#include <gltfio/AssetStreamer.h>
+
+#include <filament/Box.h>
+#include <filament/Engine.h>
+
+#include <utils/Entity.h>
+#include <utils/FixedCapacityVector.h>
+#include <utils/JobSystem.h>
+
+#include <math/mat4.h>
+
+#include <tsl/robin_map.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "BufferUploads.h"
+#include "FFilamentAsset.h"
+#include "TangentsJob.h"
+#include "downcast.h"
+
+namespace filament::gltfio {
+
+class FAssetStreamer : public AssetStreamer {
+public:
+    FAssetStreamer(Engine* engine, AssetLoader* loader, AssetStreamerConfig const& config);
+    ~FAssetStreamer();
+
+    void addAsset(FilamentAsset* asset);
+    void removeAsset(FilamentAsset* asset);
+    void update(View const* view);
+    Statistics getStatistics() const noexcept;
+
+private:
+    enum class MeshState : uint8_t {
+        UNLOADED,
+        LOADING,    // the Filament objects exist, the job is preparing their data
+        RESIDENT,
+        ERROR,      // the geometry could not be created, the mesh is never loaded again
+    };
+
+    // Data prepared by a job for a vertex or index buffer slot.
+    struct Upload {
+        BufferSlot slot;
+        SlotData content;
+    };
+
+    // A range of the memory-mapped source data used by a mesh.
+    struct SourceRange {
+        MappedFile const* file;
+        const void* data;
+        size_t size;
+    };
+
+    // The geometry of a glTF mesh, shared by the chunks using it.
+    struct Mesh {
+        const cgltf_mesh* source;
+        MeshState state = MeshState::UNLOADED;
+        bool owned = false;         // false if the asset created it eagerly for another node
+        uint32_t useCount = 0;      // loaded chunks using this mesh
+        size_t byteCount = 0;       // estimated size of the geometry
+        bool queued = false;        // in Asset::pending
+        utils::JobSystem::Job* job = nullptr;
+        std::atomic<bool> ready{ false };
+
+        // Inputs of the job, produced by AssetLoader.
+        std::vector<BufferSlot> slots;
+        std::vector<std::pair<const cgltf_primitive*, VertexBuffer*>> primitives;
+
+        // Outputs of the job, one set of levels of detail per primitive.
+        std::vector<Upload> uploads;
+        std::vector<TangentsJob::Params> tangents;
+        std::vector<size_t> vertexCounts;
+        std::vector<std::vector<std::vector<uint32_t>>> levels;
+
+        std::vector<VertexBuffer*> vertexBuffers;
+        std::vector<IndexBuffer*> indexBuffers;
+        std::vector<BufferObject*> bufferObjects;
+
+        // The source data of an owned mesh is discarded once its uploads are done.
+        std::vector<SourceRange> sources;
+        std::shared_ptr<std::atomic<uint32_t>> pendingUploads;
+    };
+
+    // The state set by the application on the renderable of a chunk, which is restored when the
+    // renderable is created again.
+    struct RenderableState {
+        uint8_t layerMask;
+        uint8_t priority;
+        uint8_t channel;
+        uint8_t lightChannels;
+        bool culling;
+        bool castShadows;
+        bool receiveShadows;
+        bool staticShadowCaster;
+        bool contactShadows;
+        bool fog;
+        utils::FixedCapacityVector<MaterialInstance*> materials;
+    };
+
+    struct ChunkState {
+        Aabb aabb;              // object-space bounding box
+        Aabb worldAabb;         // updated when the spatial index is built
+        uint32_t root;          // index of the root of the chunk in Asset::roots
+        bool loaded = false;    // the chunk uses its mesh, it has a renderable once it is resident
+        bool built = false;     // the chunk has a renderable
+        std::unique_ptr<RenderableState> saved;
+    };
+
+    // The topmost ancestor of chunks, typically the root of an instance. Chunks don't move
+    // relative to it, the spatial index is built again when it moves.
+    struct Root {
+        utils::Entity entity;
+        math::mat4f transform;
+    };
+
+    // A node of the bounding volume hierarchy of the chunks of an asset. Leaves reference count
+    // chunks in Asset::order from first, the children of the other nodes are at first and
+    // first + 1.
+    struct BvhNode {
+        Aabb aabb;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct Asset {
+        FFilamentAsset* asset;
+        std::vector<std::unique_ptr<Mesh>> meshes;  // indexed like the glTF meshes
+        std::vector<ChunkState> chunks;             // indexed like FFilamentAsset::mChunks
+        std::vector<Root> roots;
+        std::vector<BvhNode> bvh;
+        std::vector<uint32_t> order;                // chunk indices, grouped by leaf
+        std::vector<uint32_t> loaded;               // chunks whose state is loaded
+        std::vector<Mesh*> pending;                 // meshes with a job or uploads in flight
+        bool dirty = false;                         // the spatial index must be built again
+    };
+
+    struct Candidate {
+        Asset* asset;
+        size_t chunk;
+        float distance;
+    };
+
+    // Runs in a job, converts the vertex and index data, generates tangents and levels of detail.
+    static void prepare(FFilamentAsset const* asset, Mesh* mesh);
+
+    // estimated size in bytes of the geometry of the given mesh
+    static size_t getMeshSize(const cgltf_mesh& mesh) noexcept;
+
+    // the ranges of the memory-mapped source data read to create the geometry of the given mesh
+    static std::vector<SourceRange> getMeshSources(FFilamentAsset const* asset,
+            const cgltf_mesh& mesh);
+
+    static void discardSources(Mesh const& mesh) noexcept;
+
+    static void buildBvh(Asset& asset, uint32_t node, uint32_t first, uint32_t count);
+    void updateBvh(Asset& asset);
+
+    Mesh& getMesh(Asset& asset, size_t chunk) const noexcept;
+    void addChunks(Asset& asset);
+    void loadChunk(Asset& asset, size_t chunk);
+    void unloadChunk(Asset& asset, size_t chunk);
+    void buildChunk(Asset& asset, size_t chunk);
+    void saveState(Asset& asset, size_t chunk);
+    void restoreState(Asset& asset, size_t chunk);
+    void startLoading(Asset& asset, Mesh& mesh, Chunk const& chunk);
+    void finishLoading(Asset& asset, Mesh& mesh);
+    void unloadMesh(Asset& asset, Mesh& mesh);
+    void release(Asset& asset);
+
+    Engine& mEngine;
+    AssetLoader* const mLoader;
+    AssetStreamerConfig const mConfig;
+    utils::JobSystem::Job* mRootJob;
+    tsl::robin_map<FilamentAsset const*, std::unique_ptr<Asset>> mAssets;
+    size_t mResidentBytes = 0;
+};
+
+FILAMENT_DOWNCAST(AssetStreamer)
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_FASSETSTREAMER_H
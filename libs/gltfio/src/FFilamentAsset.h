@@ -17,6 +17,7 @@
 #ifndef GLTFIO_FFILAMENTASSET_H
 #define GLTFIO_FFILAMENTASSET_H
 
+#include <gltfio/AssetLoader.h>
 #include <gltfio/FilamentAsset.h>
 #include <gltfio/NodeManager.h>
 #include <gltfio/TrsTransformManager.h>
@@ -45,8 +46,10 @@
 #include "DependencyGraph.h"
 #include "DracoCache.h"
 #include "FFilamentInstance.h"
+#include "MappedFile.h"
 
 #include <tsl/htrie_map.h>
+#include <tsl/robin_set.h>
 
 #include <vector>
 
@@ -105,9 +108,51 @@ struct Primitive {
     Aabb aabb; // object-space bounding box
     UvMap uvmap; // mapping from each glTF UV set to either UV0 or UV1 (8 bytes)
     MorphTargetBuffer* targets = nullptr;
+    utils::FixedCapacityVector<IndexBuffer*> lods; // simplified indices, one per level of detail
 };
 using MeshCache = utils::FixedCapacityVector<utils::FixedCapacityVector<Primitive>>;
 
+// Levels of detail are only generated for meshes made of indexed triangles, without morph targets.
+inline bool supportsLevelsOfDetail(const cgltf_mesh& mesh) noexcept {
+    for (cgltf_size i = 0; i < mesh.primitives_count; ++i) {
+        const cgltf_primitive& prim = mesh.primitives[i];
+        if (prim.type != cgltf_primitive_type_triangles || !prim.indices || prim.targets_count) {
+            return false;
+        }
+    }
+    return mesh.primitives_count > 0;
+}
+
+// Streaming
+// ---------
+// In assets created with AssetConfiguration::streaming, the geometry and the renderable component
+// of eligible mesh nodes are not created by the loaders. Each of these nodes is a chunk, whose
+// material instances are created up front, and whose geometry is created and destroyed by
+// AssetStreamer depending on its distance to the camera.
+struct Chunk {
+    const cgltf_node* node;
+    utils::Entity entity;
+    utils::FixedCapacityVector<MaterialInstance*> materials; // one per primitive
+};
+
+// Chunks are made of meshes that are not skinned, morphed, mapped to material variants or Draco
+// compressed, so that their geometry only depends on the mesh. Nodes moved by animations are not
+// chunks either, see FFilamentAsset::isChunk().
+inline bool supportsStreaming(const cgltf_node& node) noexcept {
+    const cgltf_mesh* mesh = node.mesh;
+    if (!mesh || node.skin || node.weights_count || mesh->weights_count) {
+        return false;
+    }
+    for (cgltf_size i = 0; i < mesh->primitives_count; ++i) {
+        const cgltf_primitive& prim = mesh->primitives[i];
+        if (prim.targets_count || prim.mappings_count || prim.has_draco_mesh_compression ||
+                !prim.attributes_count) {
+            return false;
+        }
+    }
+    return mesh->primitives_count > 0;
+}
+
 struct FFilamentAsset : public FilamentAsset {
     FFilamentAsset(Engine* engine, utils::NameComponentManager* names,
             utils::EntityManager* entityManager, NodeManager* nodeManager,
@@ -266,6 +311,18 @@ struct FFilamentAsset : public FilamentAsset {
     // Indicates if resource decoding has started (not necessarily finished)
     bool mResourcesLoaded = false;
 
+    // Set with AssetConfiguration::streaming, the source data is then kept for the chunks.
+    bool mStreaming = false;
+    std::vector<Chunk> mChunks;
+
+    // Nodes targeted by an animation channel, and their descendants. The streamer indexes the
+    // chunks in the space of their instance, so they must not move within it.
+    tsl::robin_set<const cgltf_node*> mAnimatedNodes;
+
+    bool isChunk(const cgltf_node& node) const noexcept {
+        return mStreaming && supportsStreaming(node) && !mAnimatedNodes.count(&node);
+    }
+
     DependencyGraph mDependencyGraph;
     tsl::htrie_map<char, std::vector<utils::Entity>> mNameToEntity;
     utils::CString mAssetExtras;
@@ -282,6 +339,7 @@ struct FFilamentAsset : public FilamentAsset {
         cgltf_data* hierarchy;
         DracoCache dracoCache;
         utils::FixedCapacityVector<uint8_t> glbData;
+        std::vector<MappedFile> mappedFiles; // released after the hierarchy, which points into them
     };
 
     // We used shared ownership for the raw cgltf data in order to permit ResourceLoader to
@@ -313,6 +371,9 @@ struct FFilamentAsset : public FilamentAsset {
     // The mapping from cgltf_mesh to VertexBuffer* (etc) is required when creating new instances.
     MeshCache mMeshCache;
 
+    // Levels of detail requested in AssetConfiguration, generated by ResourceLoader.
+    utils::FixedCapacityVector<LevelOfDetail> mLevelsOfDetail;
+
     // Asset information that is produced by AssetLoader and consumed by ResourceLoader:
     std::vector<BufferSlot> mBufferSlots;
     std::vector<std::pair<const cgltf_primitive*, VertexBuffer*> > mPrimitives;
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_FTEXTURESTREAMER_H
+#define GLTFIO_FTEXTURESTREAMER_H
+
+#include <gltfio/TextureStreamer.h>
+
+#include <filament/Box.h>
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/Texture.h>
+
+#include <ktxreader/Ktx2Reader.h>
+
+#include <utils/Entity.h>
+#include <utils/JobSystem.h>
+
+#include <math/mat4.h>
+
+#include <tsl/robin_map.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "downcast.h"
+
+namespace filament::gltfio {
+
+class FTextureStreamer : public TextureStreamer {
+public:
+    FTextureStreamer(Engine* engine, TextureStreamerConfig const& config);
+    ~FTextureStreamer();
+
+    // Returns the first level of the tail of the given texture, see TextureStreamerConfig.
+    uint32_t getTailLevel(Texture const* texture) const noexcept;
+
+    // Takes ownership of the Async object of a texture whose tail has been uploaded.
+    void adopt(ktxreader::Ktx2Reader::Async* async);
+
+    void addAsset(FilamentAsset* asset);
+    void removeAsset(FilamentAsset* asset);
+    void update(View const* view);
+    Statistics getStatistics() const noexcept;
+
+    // Returns the projected size in pixels of a world-space box, zero if it is outside the
+    // frustum. scale is the height of the viewport times the vertical scale of the projection.
+    static float getCoverage(Frustum const& frustum, math::mat4f const& clipFromWorld,
+            float scale, Box const& box) noexcept;
+
+    // Returns the finest level needed to sample a texture whose largest dimension is size texels
+    // when it covers the given number of pixels, at most tailLevel.
+    static uint8_t getRequiredLevel(size_t size, float coverage, uint8_t tailLevel) noexcept;
+
+private:
+    enum class JobState : uint8_t {
+        IDLE,
+        RUNNING,
+        SUCCESS,
+        ERROR,
+    };
+
+    struct Entry {
+        Texture* texture;
+        ktxreader::Ktx2Reader::Async* async;
+        utils::JobSystem::Job* job = nullptr;
+        std::atomic<JobState> state{ JobState::IDLE };
+        bool failed = false;
+        uint8_t levelCount;
+        uint8_t tailLevel;
+        uint8_t uploadedLevel;      // finest level that was uploaded
+        uint8_t requestedLevel;     // finest level that is being transcoded
+        uint8_t minLevel;           // finest level that can be sampled
+        float coverage = 0.0f;      // projected size in pixels, for the current update
+    };
+
+    struct User {
+        utils::Entity renderable;
+        Texture* texture;
+    };
+
+    // estimated size in bytes of the levels [first, levelCount)
+    static size_t getLevelsSize(Entry const& entry, size_t first) noexcept;
+
+    void startTranscoding(Entry& entry, uint8_t level);
+    void finishTranscoding(Entry& entry);
+    void setMinLevel(Entry& entry, uint8_t level);
+    void release(Entry& entry);
+
+    Engine& mEngine;
+    TextureStreamerConfig const mConfig;
+    ktxreader::Ktx2Reader mReader; // only used to destroy the Async objects we adopt
+    utils::JobSystem::Job* mRootJob;
+    tsl::robin_map<Texture const*, std::unique_ptr<Entry>> mEntries;
+    tsl::robin_map<FilamentAsset const*, std::vector<User>> mUsers;
+    size_t mUploadedBytes = 0;
+};
+
+FILAMENT_DOWNCAST(TextureStreamer)
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_FTEXTURESTREAMER_H
@@ -193,8 +193,14 @@ void FFilamentAsset::releaseSourceData() noexcept {
     for (auto& info : mTextures) {
         info.bindings = {};
     }
-    mMeshCache = {};
     mResourceUris = {};
+
+    // The geometry of chunks is created from the source data at any time, AssetStreamer discards
+    // the memory-mapped data of their meshes once it is uploaded.
+    if (mStreaming) {
+        return;
+    }
+    mMeshCache = {};
     mSourceAsset.reset();
 }
 
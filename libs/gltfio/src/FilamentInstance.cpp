@@ -305,8 +305,10 @@ void FFilamentInstance::recomputeBoundingBoxes() {
                 aabb.min = min(aabb.min, primBounds.min);
                 aabb.max = max(aabb.max, primBounds.max);
             }
-            auto renderable = rm.getInstance(entity);
-            rm.setAxisAlignedBoundingBox(renderable, Box().set(aabb.min, aabb.max));
+            // chunks of streaming assets only have a renderable while they are loaded
+            if (auto renderable = rm.getInstance(entity); renderable) {
+                rm.setAxisAlignedBoundingBox(renderable, Box().set(aabb.min, aabb.max));
+            }
 
             // Transform this bounding box, then update the asset-level bounding box.
             auto transformable = tm.getInstance(entity);
@@ -344,7 +346,12 @@ void FFilamentInstance::applyMaterialVariant(size_t variantIndex) noexcept {
     RenderableManager& rm = mOwner->mEngine->getRenderableManager();
     for (const auto& mapping : mappings) {
         auto renderable = rm.getInstance(mapping.renderable);
-        rm.setMaterialInstanceAt(renderable, mapping.primitiveIndex, mapping.material);
+        // each level of detail has its own copy of the mesh's primitives
+        const size_t primitiveCount = rm.getPrimitiveCount(renderable) / rm.getLevelCount(renderable);
+        for (size_t index = mapping.primitiveIndex, count = rm.getPrimitiveCount(renderable);
+                index < count; index += primitiveCount) {
+            rm.setMaterialInstanceAt(renderable, index, mapping.material);
+        }
     }
 }
 
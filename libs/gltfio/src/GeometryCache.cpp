@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GeometryCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace filament::gltfio {
+
+static constexpr char MAGIC[8] = { 'G', 'L', 'T', 'F', 'I', 'O', 'G', 'C' };
+static constexpr size_t BLOB_ALIGNMENT = 16;
+
+// A simple 64-bit multiplicative hash over 8-byte words, this only needs to tell sources apart.
+static uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t h) noexcept {
+    auto mix = [](uint64_t h, uint64_t w) {
+        h ^= w * 0x9e3779b97f4a7c15u;
+        h = (h << 31u) | (h >> 33u);
+        return h * 0xbf58476d1ce4e5b9u;
+    };
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = mix(h, w);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, size - i);
+    return mix(mix(h, tail), size);
+}
+
+uint64_t GeometryCache::computeKey(const cgltf_data* gltf, const void* options,
+        size_t optionsSize) {
+    uint64_t h = hashBytes((const uint8_t*) options, optionsSize, VERSION);
+    h = hashBytes((const uint8_t*) gltf->json, gltf->json_size, h);
+    for (cgltf_size i = 0, n = gltf->buffers_count; i < n; ++i) {
+        const cgltf_buffer& buffer = gltf->buffers[i];
+        if (!buffer.data) {
+            return 0;
+        }
+        h = hashBytes((const uint8_t*) buffer.data, buffer.size, h);
+    }
+    // zero means that there is no key
+    return h ? h : 1;
+}
+
+bool GeometryCache::open(const char* path, uint64_t key) {
+    MappedFile file(path);
+    if (!file || file.size() < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) || header.version != VERSION ||
+            header.key != key ||
+            file.size() < sizeof(Header) + header.blobCount * sizeof(Entry)) {
+        return false;
+    }
+    const Entry* entries = (const Entry*) (file.data() + sizeof(Header));
+    for (size_t i = 0; i < header.blobCount; ++i) {
+        if (entries[i].offset + entries[i].size > file.size()) {
+            return false;
+        }
+    }
+    mData = file.data();
+    mFile = std::move(file);
+    mEntries = entries;
+    mBlobCount = header.blobCount;
+    mNextBlob = 0;
+    return true;
+}
+
+GeometryCache::Blob GeometryCache::getBlob(size_t index) const noexcept {
+    if (index >= mBlobCount) {
+        return {};
+    }
+    const Entry& entry = mEntries[index];
+    if (entry.size == 0) {
+        return {};
+    }
+    return { mData + entry.offset, size_t(entry.size) };
+}
+
+void GeometryCache::add(const void* data, size_t size) {
+    if (!data || !size) {
+        mWrittenEntries.push_back({ 0, 0 });
+        return;
+    }
+    const size_t offset = (mWrittenData.size() + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    mWrittenData.resize(offset + size);
+    memcpy(mWrittenData.data() + offset, data, size);
+    mWrittenEntries.push_back({ offset, size });
+}
+
+bool GeometryCache::write(const char* path, uint64_t key) const {
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.blobCount = uint32_t(mWrittenEntries.size());
+    header.key = key;
+
+    // The blobs follow the entries, which follow the header.
+    const size_t tableSize = sizeof(Header) + mWrittenEntries.size() * sizeof(Entry);
+    const size_t dataOffset = (tableSize + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    std::vector<Entry> entries(mWrittenEntries);
+    for (Entry& entry : entries) {
+        entry.offset += entry.size ? dataOffset : 0;
+    }
+
+    // Write a temporary file first so that a concurrent or interrupted load never sees a
+    // partial cache.
+    const std::string temporary = std::string(path) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const uint8_t padding[BLOB_ALIGNMENT] = {};
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+    success = success && (entries.empty() ||
+            fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size());
+    success = success && fwrite(padding, 1, dataOffset - tableSize, file) == dataOffset - tableSize;
+    success = success && (mWrittenData.empty() ||
+            fwrite(mWrittenData.data(), 1, mWrittenData.size(), file) == mWrittenData.size());
+    success = fclose(file) == 0 && success;
+    if (!success) {
+        remove(temporary.c_str());
+        return false;
+    }
+    remove(path);
+    return rename(temporary.c_str(), path) == 0;
+}
+
+} // namespace filament::gltfio
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_GEOMETRYCACHE_H
+#define GLTFIO_GEOMETRYCACHE_H
+
+#include "MappedFile.h"
+
+#include <cgltf.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+namespace filament::gltfio {
+
+// Stores the geometry of an asset as ResourceLoader uploads it, i.e. after Draco and meshopt
+// decoding, accessor conversions, normalization of the skinning weights, and generation of the
+// tangents and levels of detail, so that later loads of the same asset can skip that work.
+//
+// The cache is a sequence of blobs in the order in which ResourceLoader produces them, which
+// only depends on the source data and the options used to process it: the file is keyed by a
+// hash of both. When reading, the file is memory-mapped and the blobs point into the mapping.
+//
+// File layout, in native byte order:
+//     Header
+//     Entry[blobCount]
+//     blobs, each aligned to 16 bytes
+class GeometryCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    struct Blob {
+        const void* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Hashes the JSON and the buffers of the given glTF, and the given options. Returns 0 if the
+    // buffers are not all loaded.
+    static uint64_t computeKey(const cgltf_data* gltf, const void* options, size_t optionsSize);
+
+    // Maps the given cache file and returns true if it was written for the given key by this
+    // version of gltfio, in which case the blobs can be read in order with next().
+    bool open(const char* path, uint64_t key);
+
+    bool isReading() const noexcept { return mData != nullptr; }
+
+    // Returns the next blob, which is empty if an empty blob was added or if there are no more.
+    Blob next() noexcept { return getBlob(mNextBlob++); }
+
+    // Random access to the blobs, for validation before they are read in order.
+    size_t getBlobCount() const noexcept { return mBlobCount; }
+    Blob getBlob(size_t index) const noexcept;
+
+    // Transfers the ownership of the mapping, the blobs that were read point into it.
+    MappedFile releaseFile() noexcept { return std::move(mFile); }
+
+    // Copies a blob, a null blob can be added to keep the sequence aligned with the source.
+    void add(const void* data, size_t size);
+
+    // Writes the blobs that were added, returns false on failure.
+    bool write(const char* path, uint64_t key) const;
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t blobCount;
+        uint64_t key;
+    };
+
+    struct Entry {
+        uint64_t offset;    // from the beginning of the file
+        uint64_t size;
+    };
+
+    MappedFile mFile;
+    const uint8_t* mData = nullptr;     // stays valid when the mapping is released
+    const Entry* mEntries = nullptr;
+    size_t mBlobCount = 0;
+    size_t mNextBlob = 0;
+
+    std::vector<Entry> mWrittenEntries;
+    std::vector<uint8_t> mWrittenData;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_GEOMETRYCACHE_H
@@ -22,6 +22,8 @@
 #include <filament/TextureSampler.h>
 #include <filament/VertexBuffer.h>
 
+#include <utils/compiler.h>
+
 #include <cgltf.h>
 
 #define GL_NEAREST                        0x2600
@@ -264,4 +266,17 @@ inline bool getElementType(cgltf_type type, cgltf_component_type ctype,
     return false;
 }
 
+// Returns true if the given accessor must be unpacked to floats before being uploaded.
+inline bool requiresConversion(const cgltf_accessor* accessor) {
+    if (UTILS_UNLIKELY(accessor->is_sparse)) {
+        return true;
+    }
+    const cgltf_type type = accessor->type;
+    const cgltf_component_type ctype = accessor->component_type;
+    filament::VertexBuffer::AttributeType permitted;
+    filament::VertexBuffer::AttributeType actual;
+    bool supported = getElementType(type, ctype, &permitted, &actual);
+    return supported && permitted != actual;
+}
+
 #endif // GLTFIO_GLTFENUMS_H
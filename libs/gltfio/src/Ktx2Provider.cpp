@@ -26,6 +26,8 @@
 
 #include <ktxreader/Ktx2Reader.h>
 
+#include "FTextureStreamer.h"
+
 using namespace filament;
 using namespace utils;
 
@@ -37,7 +39,7 @@ namespace filament::gltfio {
 
 class Ktx2Provider final : public TextureProvider {
 public:
-    Ktx2Provider(Engine* engine);
+    Ktx2Provider(Engine* engine, TextureStreamer* streamer);
     ~Ktx2Provider();
 
     Texture* pushTexture(const uint8_t* data, size_t byteCount,
@@ -68,6 +70,7 @@ private:
 
     struct QueueItem {
         ktxreader::Ktx2Reader::Async* async;
+        Texture* texture;
         QueueItemState state;
         atomic<TranscoderState> transcoderState;
         JobSystem::Job* job;
@@ -84,6 +87,7 @@ private:
     std::string mRecentPopMessage;
     std::unique_ptr<ktxreader::Ktx2Reader> mKtxReader;
     Engine* const mEngine;
+    FTextureStreamer* const mStreamer;
 };
 
 Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
@@ -104,6 +108,7 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
     ++mPushedCount;
 
     item->async = async;
+    item->texture = async->getTexture();
     item->state = QueueItemState::TRANSCODING;
     item->transcoderState.store(TranscoderState::NOT_STARTED);
 
@@ -115,10 +120,14 @@ Texture* Ktx2Provider::pushTexture(const uint8_t* data, size_t byteCount,
         return async->getTexture();
     }
 
+    // when streaming, only the tail of the mip chain is transcoded, see TextureStreamer
+    const uint32_t minLevel = mStreamer ? mStreamer->getTailLevel(item->texture) : 0;
     JobSystem* js = &mEngine->getJobSystem();
-    item->job = jobs::createJob(*js, mDecoderRootJob, [item] {
+    item->job = jobs::createJob(*js, mDecoderRootJob, [item, js, minLevel] {
         using Result = ktxreader::Ktx2Reader::Result;
-        const bool success = Result::SUCCESS == item->async->doTranscoding();
+        // mip levels are transcoded concurrently, with the priority of the decoder jobs
+        const bool success = Result::SUCCESS == item->async->doTranscoding(*js,
+                JobSystem::JobPriority::BACKGROUND, minLevel);
         item->transcoderState.store(success ? TranscoderState::SUCCESS : TranscoderState::ERROR);
     });
 
@@ -140,10 +149,8 @@ Texture* Ktx2Provider::popTexture() {
             } else {
                 mRecentPopMessage.clear();
             }
-            Texture* texture = item->async->getTexture();
             mKtxReader->asyncDestroy(&item->async);
-            item->async = nullptr;
-            return texture;
+            return item->texture;
         }
     }
     return nullptr;
@@ -161,6 +168,8 @@ void Ktx2Provider::updateQueue() {
         item->async->getTexture();
         const TranscoderState state = item->transcoderState.load();
         if (state != TranscoderState::NOT_STARTED) {
+            // without threading, all the levels are transcoded by transcodeSingleTexture()
+            const bool streamed = mStreamer && item->job;
             if (item->job) {
                 js->waitAndRelease(item->job);
             }
@@ -170,6 +179,11 @@ void Ktx2Provider::updateQueue() {
                 continue;
             }
             item->async->uploadImages();
+            if (streamed) {
+                // the streamer transcodes the finer levels later
+                mStreamer->adopt(item->async);
+                item->async = nullptr;
+            }
             item->state = QueueItemState::READY;
             ++mDecodedCount;
         }
@@ -230,8 +244,12 @@ void Ktx2Provider::transcodeSingleTexture() {
     }
 }
 
-Ktx2Provider::Ktx2Provider(Engine* engine) : mEngine(engine) {
-    mDecoderRootJob = mEngine->getJobSystem().createJob();
+Ktx2Provider::Ktx2Provider(Engine* engine, TextureStreamer* streamer)
+        : mEngine(engine), mStreamer(streamer ? downcast(streamer) : nullptr) {
+    JobSystem& js = mEngine->getJobSystem();
+    mDecoderRootJob = js.createJob();
+    // decoder jobs inherit this, they must not compete with the jobs producing a frame
+    js.setPriority(mDecoderRootJob, JobSystem::JobPriority::BACKGROUND);
 #ifdef NDEBUG
     const bool quiet = true;
 #else
@@ -257,7 +275,11 @@ Ktx2Provider::~Ktx2Provider() {
 }
 
 TextureProvider* createKtx2Provider(Engine* engine) {
-    return new Ktx2Provider(engine);
+    return new Ktx2Provider(engine, nullptr);
+}
+
+TextureProvider* createKtx2Provider(Engine* engine, TextureStreamer* streamer) {
+    return new Ktx2Provider(engine, streamer);
 }
 
 } // namespace filament::gltfio
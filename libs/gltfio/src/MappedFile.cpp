@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#if defined(WIN32)
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace filament::gltfio {
+
+#if defined(WIN32)
+
+MappedFile::MappedFile(const char* path) noexcept {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        // The view keeps the mapping object alive, both handles can be closed.
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping) {
+            mData = (const uint8_t*) MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            mSize = mData ? size_t(size.QuadPart) : 0;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+}
+
+void MappedFile::unmap() noexcept {
+    if (mData) {
+        UnmapViewOfFile(mData);
+    }
+}
+
+void MappedFile::discard(const void* data, size_t size) const noexcept {
+    // Unlocking pages that are not locked removes them from the working set.
+    VirtualUnlock(const_cast<void*>(data), size);
+}
+
+#else
+
+MappedFile::MappedFile(const char* path) noexcept {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        // The mapping keeps a reference to the file, the descriptor can be closed. The pages are
+        // writable because cgltf buffers are, e.g. ResourceLoader normalizes skinning weights.
+        void* data = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            mData = (const uint8_t*) data;
+            mSize = size_t(st.st_size);
+        }
+    }
+    close(fd);
+}
+
+void MappedFile::unmap() noexcept {
+    if (mData) {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+}
+
+void MappedFile::discard(const void* data, size_t size) const noexcept {
+    // Only the pages that are entirely within the range are discarded.
+    const uintptr_t pageSize = uintptr_t(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = (uintptr_t(data) + pageSize - 1) & ~(pageSize - 1);
+    const uintptr_t end = (uintptr_t(data) + size) & ~(pageSize - 1);
+    if (begin < end) {
+        madvise((void*) begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+        : mData(std::exchange(rhs.mData, nullptr)), mSize(std::exchange(rhs.mSize, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+    if (this != &rhs) {
+        unmap();
+        mData = std::exchange(rhs.mData, nullptr);
+        mSize = std::exchange(rhs.mSize, 0);
+    }
+    return *this;
+}
+
+} // namespace filament::gltfio
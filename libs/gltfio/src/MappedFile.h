@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_MAPPEDFILE_H
+#define GLTFIO_MAPPEDFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament::gltfio {
+
+// Copy-on-write memory mapping of a whole file, the file itself is never modified.
+//
+// The loaders use this to avoid copying the content of glTF files in memory: the buffers whose
+// layout is supported by the VertexBuffer and IndexBuffer objects are uploaded straight from the
+// mapping, which is owned by the source asset and therefore stays alive until the upload
+// callbacks have been called.
+class MappedFile {
+public:
+    MappedFile() noexcept = default;
+    explicit MappedFile(const char* path) noexcept;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    // False if the file could not be opened or mapped, or if it is empty.
+    explicit operator bool() const noexcept { return mData != nullptr; }
+
+    const uint8_t* data() const noexcept { return mData; }
+    size_t size() const noexcept { return mSize; }
+
+    // True if the given range is within the mapping.
+    bool contains(const void* data, size_t size) const noexcept {
+        return data >= mData && (const uint8_t*) data + size <= mData + mSize;
+    }
+
+    // Lets the system reclaim the memory of the pages within the given range, they are read from
+    // the file again when accessed. Modified pages may revert to the content of the file.
+    void discard(const void* data, size_t size) const noexcept;
+
+private:
+    void unmap() noexcept;
+
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+};
+
+} // namespace filament::gltfio
+
+#endif // GLTFIO_MAPPEDFILE_H
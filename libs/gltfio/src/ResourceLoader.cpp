@@ -17,8 +17,10 @@
 #include <gltfio/ResourceLoader.h>
 #include <gltfio/TextureProvider.h>
 
+#include "BufferUploads.h"
 #include "GltfEnums.h"
 #include "FFilamentAsset.h"
+#include "GeometryCache.h"
 #include "TangentsJob.h"
 #include "downcast.h"
 
@@ -29,6 +31,7 @@
 #include <filament/Texture.h>
 #include <filament/VertexBuffer.h>
 #include <filament/MorphTargetBuffer.h>
+#include <filament/RenderableManager.h>
 
 #include <geometry/Transcoder.h>
 
@@ -47,9 +50,11 @@
 
 #include <tsl/robin_map.h>
 
-#include <fstream>
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -79,11 +84,13 @@ struct ResourceLoader::Impl {
         mEngine(config.engine),
         mNormalizeSkinningWeights(config.normalizeSkinningWeights),
         mGltfPath(config.gltfPath ? config.gltfPath : ""),
+        mCachePath(config.cachePath ? config.cachePath : ""),
         mUriDataCache(std::make_shared<UriDataCache>()) {}
 
     Engine* const mEngine;
     bool mNormalizeSkinningWeights;
     std::string mGltfPath;
+    std::string mCachePath;
 
     // User-provided resource data with URI string keys, populated with addResourceData().
     // This is used on platforms without traditional file systems, such as Android, iOS, and WebGL.
@@ -100,7 +107,9 @@ struct ResourceLoader::Impl {
     size_t mRemainingTextureDownloads = 0;
 
     void addResourceData(const char* uri, BufferDescriptor&& buffer);
-    void computeTangents(FFilamentAsset* asset);
+    void uploadCachedBuffers(FFilamentAsset* asset, GeometryCache* cache);
+    void computeTangents(FFilamentAsset* asset, GeometryCache* cache);
+    void generateLevelsOfDetail(FFilamentAsset* asset, GeometryCache* cache);
     void createTextures(FFilamentAsset* asset, bool async);
     void cancelTextureDecoding();
     std::pair<Texture*, CacheResult> getOrCreateTexture(FFilamentAsset* asset, size_t textureIndex,
@@ -108,8 +117,17 @@ struct ResourceLoader::Impl {
     ~Impl();
 };
 
-uint32_t computeBindingSize(const cgltf_accessor* accessor);
-uint32_t computeBindingOffset(const cgltf_accessor* accessor);
+// Simplifies the triangles of the given primitive for each level of detail, each level starting
+// from the previous one. Returns the primitive's vertex count. Also used by FAssetStreamer.
+size_t simplifyPrimitive(const cgltf_primitive& prim, const FixedCapacityVector<LevelOfDetail>& lods,
+        std::vector<std::vector<uint32_t>>* levels);
+
+// Checks that the blobs of a geometry cache match the asset, before anything is uploaded from it.
+static bool matchesCache(FFilamentAsset* asset, const GeometryCache& cache);
+
+// Creates an IndexBuffer with the smallest index type for the given vertex count.
+IndexBuffer* createIndexBuffer(Engine& engine, const std::vector<uint32_t>& indices,
+        size_t vertexCount);
 
 // This little struct holds a shared_ptr that wraps cgltf_data (and, potentially, glb data) while
 // uploading vertex buffer data to the GPU.
@@ -127,24 +145,6 @@ static void uploadCallback(void* buffer, size_t size, void* user) {
     delete event;
 }
 
-static void convertBytesToShorts(uint16_t* dst, const uint8_t* src, size_t count) {
-    for (size_t i = 0; i < count; ++i) {
-        dst[i] = src[i];
-    }
-}
-
-static bool requiresConversion(const cgltf_accessor* accessor) {
-    if (UTILS_UNLIKELY(accessor->is_sparse)) {
-        return true;
-    }
-    const cgltf_type type = accessor->type;
-    const cgltf_component_type ctype = accessor->component_type;
-    filament::VertexBuffer::AttributeType permitted;
-    filament::VertexBuffer::AttributeType actual;
-    bool supported = getElementType(type, ctype, &permitted, &actual);
-    return supported && permitted != actual;
-}
-
 static bool requiresPacking(const cgltf_accessor* accessor) {
     if (requiresConversion(accessor)) {
         return true;
@@ -324,6 +324,7 @@ ResourceLoader::~ResourceLoader() {
 void ResourceLoader::setConfiguration(const ResourceConfiguration& config) {
     pImpl->mNormalizeSkinningWeights = config.normalizeSkinningWeights;
     pImpl->mGltfPath = config.gltfPath;
+    pImpl->mCachePath = config.cachePath ? config.cachePath : "";
 }
 
 void ResourceLoader::addResourceData(const char* uri, BufferDescriptor&& buffer) {
@@ -446,10 +447,47 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
         return cgltf_result_success;
     };
 
+    #else
+
+    // Memory-map the external buffers rather than reading them into the heap. The buffers that
+    // don't need to be converted are then uploaded straight from the mappings, which are owned
+    // by the source asset.
+    std::vector<MappedFile> mappedFiles;
+    options.file.user_data = &mappedFiles;
+    options.file.read = [](const cgltf_memory_options* memoryOpts,
+            const cgltf_file_options* fileOpts, const char* path, cgltf_size* size, void** data) {
+        auto mappedFiles = (std::vector<MappedFile>*) fileOpts->user_data;
+        MappedFile file(path);
+        if (!file) {
+            return cgltf_result_file_not_found;
+        }
+        if (*size > file.size()) {
+            return cgltf_result_data_too_short;
+        }
+        *size = *size ? *size : file.size();
+        *data = (void*) file.data();
+        mappedFiles->push_back(std::move(file));
+        return cgltf_result_success;
+    };
+
     #endif
 
     // Read data from the file system and base64 URIs.
     cgltf_result result = cgltf_load_buffers(&options, (cgltf_data*) gltf, pImpl->mGltfPath.c_str());
+
+    #if GLTFIO_USE_FILESYSTEM
+    // The mappings are released with the source asset, cgltf must not free the buffers it read.
+    for (cgltf_size i = 0, n = gltf->buffers_count; i < n; ++i) {
+        cgltf_buffer& buffer = gltf->buffers[i];
+        if (buffer.data_free_method == cgltf_data_free_method_file_release) {
+            buffer.data_free_method = cgltf_data_free_method_none;
+        }
+    }
+    for (MappedFile& file : mappedFiles) {
+        asset->mSourceAsset->mappedFiles.push_back(std::move(file));
+    }
+    #endif
+
     if (result != cgltf_result_success) {
         slog.e << "Unable to load resources." << io::endl;
         return false;
@@ -463,14 +501,48 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
         return false;
     }
     #endif
+
+    // Look up the processed geometry in the cache, which is keyed by the source data and the
+    // options that affect the processing. On a miss, the geometry is recorded while processed.
+    GeometryCache cache;
+    uint64_t cacheKey = 0;
+    if (!pImpl->mCachePath.empty()) {
+        struct {
+            uint32_t normalizeSkinningWeights;
+            uint32_t streaming;
+            float errors[RenderableManager::Builder::MAX_LEVEL_COUNT];
+        } options = {};
+        options.normalizeSkinningWeights = pImpl->mNormalizeSkinningWeights;
+        options.streaming = asset->mStreaming;
+        for (size_t i = 0; i < asset->mLevelsOfDetail.size(); ++i) {
+            options.errors[i] = asset->mLevelsOfDetail[i].error;
+        }
+        cacheKey = GeometryCache::computeKey(gltf, &options, sizeof(options));
+        if (cacheKey && cache.open(pImpl->mCachePath.c_str(), cacheKey)) {
+            if (matchesCache(asset, cache)) {
+                // The blobs are uploaded from the mapping, which the source asset keeps alive.
+                asset->mSourceAsset->mappedFiles.push_back(cache.releaseFile());
+            } else {
+                slog.w << "The geometry cache " << pImpl->mCachePath
+                       << " does not match the asset, it is written again." << io::endl;
+                cache = {};
+            }
+        }
+    }
+    const bool cached = cache.isReading();
+    GeometryCache* const recorder = cacheKey && !cached ? &cache : nullptr;
+
     // Decompress Draco meshes early on, which allows us to exploit subsequent processing such as
-    // tangent generation.
-    decodeDracoMeshes(asset);
+    // tangent generation. Meshopt is decoded regardless of the cache, animations and skins may use
+    // it.
+    if (!cached) {
+        decodeDracoMeshes(asset);
+    }
     decodeMeshoptCompression((cgltf_data*) gltf);
 
     // For each skin, optionally normalize skinning weights and store a copy of the bind matrices.
     if (gltf->skins_count > 0) {
-        if (pImpl->mNormalizeSkinningWeights) {
+        if (pImpl->mNormalizeSkinningWeights && !cached) {
             normalizeSkinningWeights(asset);
         }
         asset->mSkins.reserve(gltf->skins_count);
@@ -507,88 +579,92 @@ bool ResourceLoader::loadResources(FFilamentAsset* asset, bool async) {
     Engine& engine = *pImpl->mEngine;
 
     // Upload VertexBuffer and IndexBuffer data to the GPU.
-    for (auto slot : asset->mBufferSlots) {
-        const cgltf_accessor* accessor = slot.accessor;
-        if (!accessor->buffer_view) {
-            continue;
-        }
-        const uint8_t* bufferData = nullptr;
-        const uint8_t* data = nullptr;
-        if (accessor->buffer_view->has_meshopt_compression) {
-            bufferData = (const uint8_t*) accessor->buffer_view->data;
-            data = bufferData + accessor->offset;
-        } else {
-            bufferData = (const uint8_t*) accessor->buffer_view->buffer->data;
-            data = computeBindingOffset(accessor) + bufferData;
-        }
-        assert_invariant(bufferData);
-        const uint32_t size = computeBindingSize(accessor);
-        if (slot.vertexBuffer) {
-            if (requiresConversion(accessor)) {
+    if (cached) {
+        pImpl->uploadCachedBuffers(asset, &cache);
+    } else {
+        for (auto slot : asset->mBufferSlots) {
+            const cgltf_accessor* accessor = slot.accessor;
+            if (!accessor->buffer_view) {
+                if (recorder) {
+                    recorder->add(nullptr, 0);
+                }
+                continue;
+            }
+            if (slot.vertexBuffer || slot.indexBuffer) {
+                const SlotData content = getSlotData(slot);
+                if (recorder) {
+                    recorder->add(content.data, content.size);
+                }
+                uploadSlotData(engine, slot, content, uploadCallback,
+                        content.owned ? nullptr : uploadUserdata(asset, pImpl->mUriDataCache),
+                        &asset->mBufferObjects);
+                continue;
+            }
+            const uint8_t* data = nullptr;
+            if (accessor->buffer_view->has_meshopt_compression) {
+                data = (const uint8_t*) accessor->buffer_view->data + accessor->offset;
+            } else {
+                data = (const uint8_t*) accessor->buffer_view->buffer->data +
+                        computeBindingOffset(accessor);
+            }
+            assert_invariant(data);
+
+            // If the buffer slot does not have an associated VertexBuffer or IndexBuffer, then this
+            // must be a morph target.
+            assert(slot.morphTargetBuffer);
+            const size_t vertexCount = slot.morphTargetBuffer->getVertexCount();
+
+            if (requiresPacking(accessor)) {
                 const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
                 const size_t floatsByteCount = sizeof(float) * floatsCount;
                 float* floatsData = (float*) malloc(floatsByteCount);
                 cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
-                BufferObject* bo = BufferObject::Builder().size(floatsByteCount).build(engine);
-                asset->mBufferObjects.push_back(bo);
-                bo->setBuffer(engine, BufferDescriptor(floatsData, floatsByteCount, FREE_CALLBACK));
-                slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
-                continue;
-            }
-            BufferObject* bo = BufferObject::Builder().size(size).build(engine);
-            asset->mBufferObjects.push_back(bo);
-            bo->setBuffer(engine, BufferDescriptor(data, size,
-                    uploadCallback, uploadUserdata(asset, pImpl->mUriDataCache)));
-            slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
-            continue;
-        } else if (slot.indexBuffer) {
-            if (accessor->component_type == cgltf_component_type_r_8u) {
-                const size_t size16 = size * 2;
-                uint16_t* data16 = (uint16_t*) malloc(size16);
-                convertBytesToShorts(data16, data, size);
-                IndexBuffer::BufferDescriptor bd(data16, size16, FREE_CALLBACK);
-                slot.indexBuffer->setBuffer(engine, std::move(bd));
+                if (accessor->type == cgltf_type_vec3) {
+                    if (recorder) {
+                        recorder->add(floatsData, vertexCount * sizeof(float3));
+                    }
+                    slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                            (const float3*) floatsData, slot.morphTargetBuffer->getVertexCount());
+                } else {
+                    if (recorder) {
+                        recorder->add(data, vertexCount * sizeof(float4));
+                    }
+                    slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                            (const float4*) data, slot.morphTargetBuffer->getVertexCount());
+                }
+                free(floatsData);
                 continue;
             }
-            IndexBuffer::BufferDescriptor bd(data, size, uploadCallback,
-                    uploadUserdata(asset, pImpl->mUriDataCache));
-            slot.indexBuffer->setBuffer(engine, std::move(bd));
-            continue;
-        }
 
-        // If the buffer slot does not have an associated VertexBuffer or IndexBuffer, then this
-        // must be a morph target.
-        assert(slot.morphTargetBuffer);
-
-        if (requiresPacking(accessor)) {
-            const size_t floatsCount = accessor->count * cgltf_num_components(accessor->type);
-            const size_t floatsByteCount = sizeof(float) * floatsCount;
-            float* floatsData = (float*) malloc(floatsByteCount);
-            cgltf_accessor_unpack_floats(accessor, floatsData, floatsCount);
             if (accessor->type == cgltf_type_vec3) {
+                if (recorder) {
+                    recorder->add(data, vertexCount * sizeof(float3));
+                }
                 slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
-                        (const float3*) floatsData, slot.morphTargetBuffer->getVertexCount());
+                        (const float3*) data, slot.morphTargetBuffer->getVertexCount());
             } else {
+                assert_invariant(accessor->type == cgltf_type_vec4);
+                if (recorder) {
+                    recorder->add(data, vertexCount * sizeof(float4));
+                }
                 slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
                         (const float4*) data, slot.morphTargetBuffer->getVertexCount());
             }
-            free(floatsData);
-            continue;
-        }
-
-        if (accessor->type == cgltf_type_vec3) {
-            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
-                    (const float3*) data, slot.morphTargetBuffer->getVertexCount());
-        } else {
-            assert_invariant(accessor->type == cgltf_type_vec4);
-            slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
-                    (const float4*) data, slot.morphTargetBuffer->getVertexCount());
         }
     }
 
     // Compute surface orientation quaternions if necessary. This is similar to sparse data in that
     // we need to generate the contents of a GPU buffer by processing one or more CPU buffer(s).
-    pImpl->computeTangents(asset);
+    pImpl->computeTangents(asset, cacheKey ? &cache : nullptr);
+
+    // Simplify the triangles of each mesh for the levels of detail requested in AssetConfiguration.
+    if (!asset->mLevelsOfDetail.empty()) {
+        pImpl->generateLevelsOfDetail(asset, cacheKey ? &cache : nullptr);
+    }
+
+    if (recorder && !recorder->write(pImpl->mCachePath.c_str(), cacheKey)) {
+        slog.w << "Unable to write the geometry cache " << pImpl->mCachePath << io::endl;
+    }
 
     asset->mBufferSlots = {};
     asset->mPrimitives = {};
@@ -737,14 +813,13 @@ std::pair<Texture*, CacheResult> ResourceLoader::Impl::getOrCreateTexture(FFilam
             slog.e << "Unable to open " << fullpath << io::endl;
             return {};
         }
-        using namespace std;
-        ifstream filest(fullpath, std::ifstream::in | std::ifstream::binary);
-        vector<uint8_t> buffer;
-        filest.seekg(0, ios::end);
-        buffer.reserve((size_t) filest.tellg());
-        filest.seekg(0, ios::beg);
-        buffer.assign((istreambuf_iterator<char>(filest)), istreambuf_iterator<char>());
-        if (Texture* texture = provider->pushTexture(buffer.data(), buffer.size(), mime.c_str(), flags); texture) {
+        // The providers copy what they need, the file is only mapped while the texture is pushed.
+        MappedFile file(fullpath.c_str());
+        if (!file) {
+            slog.e << "Unable to map " << fullpath << io::endl;
+            return {};
+        }
+        if (Texture* texture = provider->pushTexture(file.data(), file.size(), mime.c_str(), flags); texture) {
             mFilepathTextureCache[uri] = texture;
             return {texture, CacheResult::MISS};
         }
@@ -807,9 +882,9 @@ void ResourceLoader::Impl::createTextures(FFilamentAsset* asset, bool async) {
     }
 }
 
-void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
-    SYSTRACE_CALL();
-
+// Collects the tangent jobs of the asset: the vertex buffers whose TANGENT attribute is generated
+// and the morph targets that need normals.
+static std::vector<TangentsJob::Params> getTangentJobs(FFilamentAsset* asset) {
     const cgltf_accessor* kGenerateTangents = &asset->mGenerateTangents;
     const cgltf_accessor* kGenerateNormals = &asset->mGenerateNormals;
 
@@ -867,18 +942,189 @@ void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
             }
         }
     }
+    return jobParams;
+}
+
+// Each job simplifies one primitive, each level starting from the previous one.
+struct LevelsOfDetailJob {
+    const cgltf_primitive* prim;
+    size_t mesh;
+    size_t index;
+    size_t vertexCount;
+    std::vector<std::vector<uint32_t>> levels;
+};
+
+// Each primitive is cached as its vertex and level counts, followed by the index blobs.
+struct LevelsOfDetailCounts {
+    uint32_t vertexCount;
+    uint32_t levelCount;
+};
+
+static std::vector<LevelsOfDetailJob> getLevelsOfDetailJobs(FFilamentAsset* asset) {
+    const cgltf_data* gltf = asset->mSourceAsset->hierarchy;
+    std::vector<LevelsOfDetailJob> jobParams;
+    for (size_t i = 0, n = gltf->meshes_count; i < n; ++i) {
+        const cgltf_mesh& mesh = gltf->meshes[i];
+        // skip the meshes without geometry, i.e. unused or streamed by AssetStreamer
+        const FixedCapacityVector<Primitive>& prims = asset->mMeshCache[i];
+        if (!supportsLevelsOfDetail(mesh) || prims.empty() || !prims[0].vertices) {
+            continue;
+        }
+        for (cgltf_size pindex = 0, pcount = mesh.primitives_count; pindex < pcount; ++pindex) {
+            jobParams.push_back({ &mesh.primitives[pindex], i, pindex });
+        }
+    }
+    return jobParams;
+}
+
+// Checks that the blobs of the cache have the sizes that processing the asset would produce, in
+// the order of uploadCachedBuffers(), computeTangents() and generateLevelsOfDetail(). This guards
+// against stale or corrupted files whose key still matches, e.g. written by a buggy build.
+static bool matchesCache(FFilamentAsset* asset, const GeometryCache& cache) {
+    size_t blobIndex = 0;
+    auto next = [&cache, &blobIndex]() { return cache.getBlob(blobIndex++); };
+
+    for (const BufferSlot& slot : asset->mBufferSlots) {
+        const GeometryCache::Blob blob = next();
+        const cgltf_accessor* accessor = slot.accessor;
+        // Draco accessors don't have a buffer view until decoded, which the cache skips.
+        if (!blob.data) {
+            if (accessor->buffer_view) {
+                return false;
+            }
+            continue;
+        }
+        size_t size = 0;
+        if (slot.vertexBuffer) {
+            size = requiresConversion(accessor) ?
+                    sizeof(float) * accessor->count * cgltf_num_components(accessor->type) :
+                    computeBindingSize(accessor);
+        } else if (slot.indexBuffer) {
+            size = accessor->component_type == cgltf_component_type_r_8u ?
+                    accessor->count * sizeof(uint16_t) : computeBindingSize(accessor);
+        } else {
+            const size_t vertexCount = slot.morphTargetBuffer->getVertexCount();
+            size = vertexCount * (accessor->type == cgltf_type_vec3 ?
+                    sizeof(float3) : sizeof(float4));
+        }
+        if (blob.size != size) {
+            return false;
+        }
+    }
+
+    for (const TangentsJob::Params& params : getTangentJobs(asset)) {
+        const size_t vertexCount = params.in.prim->attributes[0].data->count;
+        if (next().size != vertexCount * sizeof(short4)) {
+            return false;
+        }
+    }
+
+    if (!asset->mLevelsOfDetail.empty()) {
+        for (const LevelsOfDetailJob& params : getLevelsOfDetailJobs(asset)) {
+            const GeometryCache::Blob blob = next();
+            LevelsOfDetailCounts counts = {};
+            if (blob.size != sizeof(counts)) {
+                return false;
+            }
+            memcpy(&counts, blob.data, sizeof(counts));
+            if (counts.levelCount > asset->mLevelsOfDetail.size()) {
+                return false;
+            }
+            if (counts.levelCount && counts.vertexCount != params.prim->attributes[0].data->count) {
+                return false;
+            }
+            for (uint32_t level = 0; level < counts.levelCount; ++level) {
+                const GeometryCache::Blob indices = next();
+                if (indices.size % (3 * sizeof(uint32_t))) {
+                    return false;
+                }
+                const uint32_t* data = (const uint32_t*) indices.data;
+                const size_t count = indices.size / sizeof(uint32_t);
+                if (std::any_of(data, data + count,
+                        [&counts](uint32_t index) { return index >= counts.vertexCount; })) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return blobIndex == cache.getBlobCount();
+}
+
+void ResourceLoader::Impl::uploadCachedBuffers(FFilamentAsset* asset, GeometryCache* cache) {
+    SYSTRACE_CALL();
+
+    // The blobs were recorded in the order of the buffer slots, the converted data included.
+    Engine& engine = *mEngine;
+    for (auto slot : asset->mBufferSlots) {
+        const GeometryCache::Blob blob = cache->next();
+        if (!blob.data) {
+            continue;
+        }
+        if (slot.vertexBuffer) {
+            BufferObject* bo = BufferObject::Builder().size(blob.size).build(engine);
+            asset->mBufferObjects.push_back(bo);
+            bo->setBuffer(engine, BufferDescriptor(blob.data, blob.size,
+                    uploadCallback, uploadUserdata(asset, mUriDataCache)));
+            slot.vertexBuffer->setBufferObjectAt(engine, slot.bufferIndex, bo);
+        } else if (slot.indexBuffer) {
+            IndexBuffer::BufferDescriptor bd(blob.data, blob.size, uploadCallback,
+                    uploadUserdata(asset, mUriDataCache));
+            slot.indexBuffer->setBuffer(engine, std::move(bd));
+        } else {
+            assert_invariant(slot.morphTargetBuffer);
+            const size_t vertexCount = slot.morphTargetBuffer->getVertexCount();
+            if (slot.accessor->type == cgltf_type_vec3) {
+                slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                        (const float3*) blob.data, vertexCount);
+            } else {
+                slot.morphTargetBuffer->setPositionsAt(engine, slot.bufferIndex,
+                        (const float4*) blob.data, vertexCount);
+            }
+        }
+    }
+}
+
+void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset, GeometryCache* cache) {
+    SYSTRACE_CALL();
+
+    using Params = TangentsJob::Params;
+    std::vector<Params> jobParams = getTangentJobs(asset);
+
+    // The quaternions of a cached asset are uploaded straight from the cache.
+    if (cache && cache->isReading()) {
+        for (Params& params : jobParams) {
+            const GeometryCache::Blob blob = cache->next();
+            const size_t vertexCount = blob.size / sizeof(short4);
+            if (params.context.vb) {
+                BufferObject* bo = BufferObject::Builder().size(blob.size).build(*mEngine);
+                asset->mBufferObjects.push_back(bo);
+                bo->setBuffer(*mEngine, BufferDescriptor(blob.data, blob.size,
+                        uploadCallback, uploadUserdata(asset, mUriDataCache)));
+                params.context.vb->setBufferObjectAt(*mEngine, params.context.slot, bo);
+            } else {
+                assert_invariant(params.context.tb);
+                params.context.tb->setTangentsAt(*mEngine, params.in.morphTargetIndex,
+                        (const short4*) blob.data, vertexCount);
+            }
+        }
+        return;
+    }
 
     // Kick off jobs for computing tangent frames.
     JobSystem* js = &mEngine->getJobSystem();
     JobSystem::Job* parent = js->createJob();
     for (Params& params : jobParams) {
         Params* pptr = &params;
-        js->run(jobs::createJob(*js, parent, [pptr] { TangentsJob::run(pptr); }));
+        js->run(jobs::createJob(*js, parent, [pptr, js] { TangentsJob::run(pptr, js); }));
     }
     js->runAndWait(parent);
 
     // Finally, upload quaternions to the GPU from the main thread.
     for (Params& params : jobParams) {
+        if (cache) {
+            cache->add(params.out.results, params.out.vertexCount * sizeof(short4));
+        }
         if (params.context.vb) {
             BufferObject* bo = BufferObject::Builder()
                     .size(params.out.vertexCount * sizeof(short4)).build(*mEngine);
@@ -895,6 +1141,149 @@ void ResourceLoader::Impl::computeTangents(FFilamentAsset* asset) {
     }
 }
 
+void ResourceLoader::Impl::generateLevelsOfDetail(FFilamentAsset* asset, GeometryCache* cache) {
+    SYSTRACE_CALL();
+
+    const cgltf_data* gltf = asset->mSourceAsset->hierarchy;
+    const FixedCapacityVector<LevelOfDetail>& lods = asset->mLevelsOfDetail;
+
+    using Params = LevelsOfDetailJob;
+    using Counts = LevelsOfDetailCounts;
+    std::vector<Params> jobParams = getLevelsOfDetailJobs(asset);
+
+    if (cache && cache->isReading()) {
+        for (Params& params : jobParams) {
+            Counts counts = {};
+            const GeometryCache::Blob blob = cache->next();
+            if (blob.size == sizeof(counts)) {
+                memcpy(&counts, blob.data, sizeof(counts));
+            }
+            params.vertexCount = counts.vertexCount;
+            params.levels.resize(counts.levelCount);
+            for (std::vector<uint32_t>& indices : params.levels) {
+                const GeometryCache::Blob level = cache->next();
+                const uint32_t* data = (const uint32_t*) level.data;
+                indices.assign(data, data + level.size / sizeof(uint32_t));
+            }
+        }
+    } else {
+        JobSystem* js = &mEngine->getJobSystem();
+        JobSystem::Job* parent = js->createJob();
+        for (Params& params : jobParams) {
+            Params* pptr = &params;
+            js->run(jobs::createJob(*js, parent, [pptr, &lods] {
+                pptr->vertexCount = simplifyPrimitive(*pptr->prim, lods, &pptr->levels);
+            }));
+        }
+        js->runAndWait(parent);
+
+        for (Params const& params : jobParams) {
+            if (!cache) {
+                break;
+            }
+            const Counts counts = { uint32_t(params.vertexCount), uint32_t(params.levels.size()) };
+            cache->add(&counts, sizeof(counts));
+            for (std::vector<uint32_t> const& indices : params.levels) {
+                cache->add(indices.data(), indices.size() * sizeof(uint32_t));
+            }
+        }
+    }
+
+    // Create the index buffers from the main thread, and replace the placeholder geometry of the
+    // renderables that were already created.
+    RenderableManager& rm = mEngine->getRenderableManager();
+    std::vector<std::vector<size_t>> meshNodes(gltf->meshes_count);
+    for (size_t node = 0, n = gltf->nodes_count; node < n; ++node) {
+        if (gltf->nodes[node].mesh) {
+            meshNodes[gltf->nodes[node].mesh - gltf->meshes].push_back(node);
+        }
+    }
+    for (Params& params : jobParams) {
+        if (params.levels.empty()) {
+            continue;
+        }
+        Primitive& prim = asset->mMeshCache[params.mesh][params.index];
+        const cgltf_mesh& mesh = gltf->meshes[params.mesh];
+        const size_t primitiveCount = mesh.primitives_count;
+
+        prim.lods = FixedCapacityVector<IndexBuffer*>(params.levels.size());
+        for (size_t level = 0; level < params.levels.size(); ++level) {
+            std::vector<uint32_t> const& indices = params.levels[level];
+            IndexBuffer* ib = createIndexBuffer(*mEngine, indices, params.vertexCount);
+            asset->mIndexBuffers.push_back(ib);
+            prim.lods[level] = ib;
+
+            for (FFilamentInstance* instance : asset->mInstances) {
+                for (size_t node : meshNodes[params.mesh]) {
+                    auto ri = rm.getInstance(instance->mNodeMap[node]);
+                    if (ri && rm.getLevelCount(ri) > level + 1) {
+                        rm.setGeometryAt(ri, (level + 1) * primitiveCount + params.index,
+                                RenderableManager::PrimitiveType::TRIANGLES, prim.vertices, ib,
+                                0, indices.size());
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t simplifyPrimitive(const cgltf_primitive& prim, const FixedCapacityVector<LevelOfDetail>& lods,
+        std::vector<std::vector<uint32_t>>* levels) {
+    const cgltf_accessor* positions = nullptr;
+    for (cgltf_size aindex = 0; aindex < prim.attributes_count; aindex++) {
+        if (prim.attributes[aindex].type == cgltf_attribute_type_position) {
+            positions = prim.attributes[aindex].data;
+        }
+    }
+    if (!positions) {
+        return 0;
+    }
+
+    const size_t vertexCount = positions->count;
+    std::vector<float3> vertices(vertexCount);
+    cgltf_accessor_unpack_floats(positions, &vertices[0].x, vertexCount * 3);
+
+    std::vector<uint32_t> indices(prim.indices->count);
+    for (size_t j = 0, c = indices.size(); j < c; ++j) {
+        indices[j] = cgltf_accessor_read_index(prim.indices, j);
+    }
+
+    levels->resize(lods.size());
+    const std::vector<uint32_t>* src = &indices;
+    for (size_t level = 0; level < lods.size(); ++level) {
+        std::vector<uint32_t>& dst = (*levels)[level];
+        dst.resize(src->size());
+        dst.resize(meshopt_simplify(dst.data(), src->data(), src->size(),
+                &vertices[0].x, vertexCount, sizeof(float3), 0, lods[level].error));
+        if (dst.empty()) {
+            // an empty IndexBuffer is not allowed, keep the previous level instead
+            dst = *src;
+        }
+        meshopt_optimizeVertexCache(dst.data(), dst.data(), dst.size(), vertexCount);
+        src = &dst;
+    }
+    return vertexCount;
+}
+
+IndexBuffer* createIndexBuffer(Engine& engine, const std::vector<uint32_t>& indices,
+        size_t vertexCount) {
+    const bool shortIndices = vertexCount <= std::numeric_limits<uint16_t>::max() + 1;
+    IndexBuffer* ib = IndexBuffer::Builder()
+            .indexCount(indices.size())
+            .bufferType(shortIndices ? IndexBuffer::IndexType::USHORT
+                    : IndexBuffer::IndexType::UINT)
+            .build(engine);
+    const size_t size = indices.size() * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+    void* data = malloc(size);
+    if (shortIndices) {
+        std::copy(indices.begin(), indices.end(), (uint16_t*) data);
+    } else {
+        memcpy(data, indices.data(), size);
+    }
+    ib->setBuffer(engine, IndexBuffer::BufferDescriptor(data, size, FREE_CALLBACK));
+    return ib;
+}
+
 ResourceLoader::Impl::~Impl() {
     for (const auto& iter : mTextureProviders) {
         iter.second->cancelDecoding();
@@ -262,7 +262,10 @@ void StbProvider::decodeSingleTexture() {
 }
 
 StbProvider::StbProvider(Engine* engine) : mEngine(engine) {
-    mDecoderRootJob = mEngine->getJobSystem().createJob();
+    JobSystem& js = mEngine->getJobSystem();
+    mDecoderRootJob = js.createJob();
+    // decoder jobs inherit this, they must not compete with the jobs producing a frame
+    js.setPriority(mDecoderRootJob, JobSystem::JobPriority::BACKGROUND);
 #ifndef NDEBUG
     slog.i << "Texture Decoder has "
             << mEngine->getJobSystem().getThreadCount()
@@ -25,7 +25,7 @@ using namespace filament;
 using namespace filament::math;
 
 // This procedure is designed to run in an isolated job.
-void TangentsJob::run(Params* params) {
+void TangentsJob::run(Params* params, utils::JobSystem* jobSystem) {
     const cgltf_primitive& prim = *params->in.prim;
     const int morphTargetIndex = params->in.morphTargetIndex;
     const bool isMorphTarget = morphTargetIndex != kMorphTargetUnused;
@@ -76,6 +76,7 @@ void TangentsJob::run(Params* params) {
 
     geometry::SurfaceOrientation::Builder sob;
     sob.vertexCount(vertexCount);
+    sob.jobSystem(jobSystem);
 
     // Allocate scratch space to store morph deltas.
     if (isMorphTarget) {
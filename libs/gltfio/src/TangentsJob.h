@@ -18,6 +18,10 @@
 
 #include <math/vec4.h>
 
+namespace utils {
+class JobSystem;
+}
+
 namespace filament {
 
 class VertexBuffer;
@@ -65,8 +69,9 @@ struct TangentsJob {
     };
 
     // Performs tangents generation synchronously. This can be invoked from inside a job if desired.
-    // The parameters structure is owned by the client.
-    static void run(Params* params);
+    // The parameters structure is owned by the client. When a job system is given, the tangent
+    // frames of large primitives are computed in parallel.
+    static void run(Params* params, utils::JobSystem* jobSystem = nullptr);
 };
 
 } // namespace filament::gltfio
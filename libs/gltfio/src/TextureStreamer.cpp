@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FTextureStreamer.h"
+#include "FFilamentAsset.h"
+
+#include <filament/Box.h>
+#include <filament/Camera.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+#include <filament/View.h>
+#include <filament/Viewport.h>
+
+#include <backend/DriverEnums.h>
+
+#include <math/mat4.h>
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace filament;
+using namespace filament::math;
+using namespace utils;
+
+using Async = ktxreader::Ktx2Reader::Async;
+
+namespace filament::gltfio {
+
+FTextureStreamer::FTextureStreamer(Engine* engine, TextureStreamerConfig const& config)
+        : mEngine(*engine), mConfig(config), mReader(*engine, true) {
+    JobSystem& js = mEngine.getJobSystem();
+    mRootJob = js.createJob();
+    js.setPriority(mRootJob, JobSystem::JobPriority::BACKGROUND);
+}
+
+FTextureStreamer::~FTextureStreamer() {
+    for (auto& [texture, entry] : mEntries) {
+        release(*entry);
+    }
+    mEngine.getJobSystem().release(mRootJob);
+}
+
+uint32_t FTextureStreamer::getTailLevel(Texture const* texture) const noexcept {
+    uint32_t const levelCount = texture->getLevels();
+    uint32_t level = 0;
+    while (level + 1 < levelCount &&
+            std::max(texture->getWidth(level), texture->getHeight(level)) > mConfig.tailSize) {
+        level++;
+    }
+    return level;
+}
+
+void FTextureStreamer::adopt(Async* async) {
+    Texture* const texture = async->getTexture();
+    auto entry = std::make_unique<Entry>();
+    entry->texture = texture;
+    entry->async = async;
+    entry->levelCount = uint8_t(texture->getLevels());
+    entry->tailLevel = uint8_t(getTailLevel(texture));
+    entry->uploadedLevel = entry->tailLevel;
+    entry->requestedLevel = entry->tailLevel;
+    entry->minLevel = entry->tailLevel;
+    texture->setMinMaxLevels(mEngine, entry->minLevel, entry->levelCount - 1);
+    mUploadedBytes += getLevelsSize(*entry, entry->uploadedLevel);
+    mEntries[texture] = std::move(entry);
+}
+
+void FTextureStreamer::addAsset(FilamentAsset* asset) {
+    FFilamentAsset const* fasset = downcast(asset);
+
+    // Textures are bound to material instances, which are bound to the primitives of renderables.
+    tsl::robin_map<MaterialInstance const*, std::vector<Texture*>> textures;
+    for (auto const& info : fasset->mTextures) {
+        if (!info.texture) {
+            continue;
+        }
+        for (TextureSlot const& slot : info.bindings) {
+            textures[slot.materialInstance].push_back(info.texture);
+        }
+    }
+
+    RenderableManager& rm = mEngine.getRenderableManager();
+    std::vector<User>& users = mUsers[asset];
+    Entity const* entities = asset->getRenderableEntities();
+    for (size_t i = 0, n = asset->getRenderableEntityCount(); i < n; i++) {
+        auto const ri = rm.getInstance(entities[i]);
+        for (size_t prim = 0, c = rm.getPrimitiveCount(ri); prim < c; prim++) {
+            auto const pos = textures.find(rm.getMaterialInstanceAt(ri, prim));
+            if (pos == textures.end()) {
+                continue;
+            }
+            for (Texture* texture : pos->second) {
+                users.push_back({ entities[i], texture });
+            }
+        }
+    }
+
+    // The renderables of chunks are created and destroyed by AssetStreamer, update() skips the
+    // users that don't have one.
+    for (Chunk const& chunk : fasset->mChunks) {
+        for (MaterialInstance const* mi : chunk.materials) {
+            auto const pos = textures.find(mi);
+            if (pos == textures.end()) {
+                continue;
+            }
+            for (Texture* texture : pos->second) {
+                users.push_back({ chunk.entity, texture });
+            }
+        }
+    }
+}
+
+void FTextureStreamer::removeAsset(FilamentAsset* asset) {
+    mUsers.erase(asset);
+    for (auto const& info : downcast(asset)->mTextures) {
+        auto const pos = mEntries.find(info.texture);
+        if (pos != mEntries.end()) {
+            release(*pos->second);
+            mEntries.erase(pos);
+        }
+    }
+}
+
+void FTextureStreamer::update(View const* view) {
+    // Upload the levels whose transcoding has finished.
+    for (auto& [texture, entry] : mEntries) {
+        if (entry->job && entry->state.load(std::memory_order_acquire) != JobState::RUNNING) {
+            finishTranscoding(*entry);
+        }
+        entry->coverage = 0.0f;
+    }
+
+    // Estimate the size in pixels of each texture from the bounding spheres of its visible users.
+    Camera const& camera = view->getCamera();
+    Frustum const frustum = camera.getFrustum();
+    mat4 const projection = camera.getProjectionMatrix();
+    mat4f const clipFromWorld{ projection * camera.getViewMatrix() };
+    float const scale = float(projection[1][1]) * float(view->getViewport().height);
+
+    RenderableManager const& rm = mEngine.getRenderableManager();
+    TransformManager const& tm = mEngine.getTransformManager();
+    for (auto const& [asset, users] : mUsers) {
+        for (User const& user : users) {
+            auto const pos = mEntries.find(user.texture);
+            auto const ri = rm.getInstance(user.renderable);
+            if (pos == mEntries.end() || !ri) {
+                continue;
+            }
+            Box const box = rigidTransform(rm.getAxisAlignedBoundingBox(ri),
+                    tm.getWorldTransform(tm.getInstance(user.renderable)));
+            Entry& entry = *pos->second;
+            entry.coverage = std::max(entry.coverage,
+                    getCoverage(frustum, clipFromWorld, scale, box));
+        }
+    }
+
+    // Uploaded levels are never released, so the levels that were uploaded or are being
+    // transcoded count towards the limit, the most magnified textures get the rest first.
+    std::vector<Entry*> entries;
+    entries.reserve(mEntries.size());
+    size_t spent = 0;
+    for (auto& [texture, entry] : mEntries) {
+        spent += getLevelsSize(*entry, entry->requestedLevel);
+        entries.push_back(entry.get());
+    }
+    std::sort(entries.begin(), entries.end(), [](Entry const* lhs, Entry const* rhs) {
+        return lhs->coverage * float(rhs->texture->getWidth()) >
+               rhs->coverage * float(lhs->texture->getWidth());
+    });
+
+    size_t remaining = mConfig.maxUploadedBytes > spent ? mConfig.maxUploadedBytes - spent : 0;
+    for (Entry* entry : entries) {
+        if (entry->job) {
+            // the levels being transcoded are applied once they are uploaded
+            continue;
+        }
+        uint8_t level = entry->tailLevel;
+        if (!entry->failed && entry->coverage > 0.0f) {
+            size_t const size = std::max(entry->texture->getWidth(), entry->texture->getHeight());
+            level = getRequiredLevel(size, entry->coverage, entry->tailLevel);
+        }
+
+        // Transcode as many of the missing levels as the limit allows.
+        size_t const uploaded = getLevelsSize(*entry, entry->uploadedLevel);
+        uint8_t first = level;
+        while (first < entry->uploadedLevel &&
+                getLevelsSize(*entry, first) - uploaded > remaining) {
+            first++;
+        }
+        if (first < entry->uploadedLevel) {
+            remaining -= getLevelsSize(*entry, first) - uploaded;
+            startTranscoding(*entry, first);
+        }
+        setMinLevel(*entry, std::max(level, entry->uploadedLevel));
+    }
+}
+
+float FTextureStreamer::getCoverage(Frustum const& frustum, mat4f const& clipFromWorld,
+        float scale, Box const& box) noexcept {
+    if (!frustum.intersects(box)) {
+        return 0.0f;
+    }
+    float const radius = length(box.halfExtent);
+    float const w = (clipFromWorld * float4{ box.center, 1.0f }).w;
+    if (w <= radius) {
+        // the camera is within the bounding sphere
+        return std::numeric_limits<float>::infinity();
+    }
+    return scale * radius / w;
+}
+
+uint8_t FTextureStreamer::getRequiredLevel(size_t size, float coverage,
+        uint8_t tailLevel) noexcept {
+    // Level n is sampled when a pixel covers between 2^n and 2^(n+1) texels.
+    float const ratio = float(size) / coverage;
+    if (ratio < 2.0f) {
+        return 0;
+    }
+    return uint8_t(std::min(std::floor(std::log2(ratio)), float(tailLevel)));
+}
+
+TextureStreamer::Statistics FTextureStreamer::getStatistics() const noexcept {
+    size_t streamingCount = 0;
+    for (auto const& [texture, entry] : mEntries) {
+        streamingCount += entry->job ? 1 : 0;
+    }
+    return { mEntries.size(), mUploadedBytes, streamingCount };
+}
+
+size_t FTextureStreamer::getLevelsSize(Entry const& entry, size_t first) noexcept {
+    using TextureFormat = backend::TextureFormat;
+    TextureFormat const format = entry.texture->getFormat();
+    bool const compressed = backend::isCompressedFormat(format);
+    // Transcoded KTX2 textures use formats of 1 byte per texel (most block-compressed formats),
+    // 2 bytes or 4 bytes; this is only an estimate for the other formats.
+    size_t const bytesPerTexel = compressed ? 1 :
+            (format == TextureFormat::RGB565 || format == TextureFormat::RGBA4) ? 2 : 4;
+    size_t size = 0;
+    for (size_t level = first; level < entry.levelCount; level++) {
+        size_t width = entry.texture->getWidth(level);
+        size_t height = entry.texture->getHeight(level);
+        if (compressed) {
+            width = std::max(width, size_t(4));
+            height = std::max(height, size_t(4));
+        }
+        size += width * height * bytesPerTexel;
+    }
+    return size;
+}
+
+void FTextureStreamer::startTranscoding(Entry& entry, uint8_t level) {
+    JobSystem& js = mEngine.getJobSystem();
+    entry.requestedLevel = level;
+    entry.state.store(JobState::RUNNING, std::memory_order_relaxed);
+    entry.job = js.createJob(mRootJob, [&entry, &js, level](JobSystem&, JobSystem::Job*) {
+        using Result = ktxreader::Ktx2Reader::Result;
+        Result const result = entry.async->doTranscoding(js,
+                JobSystem::JobPriority::BACKGROUND, level);
+        entry.state.store(result == Result::SUCCESS ? JobState::SUCCESS : JobState::ERROR,
+                std::memory_order_release);
+    });
+    js.runAndRetain(entry.job);
+}
+
+void FTextureStreamer::finishTranscoding(Entry& entry) {
+    mEngine.getJobSystem().waitAndRelease(entry.job);
+    entry.job = nullptr;
+    if (entry.state.load(std::memory_order_relaxed) == JobState::SUCCESS) {
+        entry.async->uploadImages();
+        mUploadedBytes += getLevelsSize(entry, entry.requestedLevel) -
+                getLevelsSize(entry, entry.uploadedLevel);
+        entry.uploadedLevel = entry.requestedLevel;
+    } else {
+        entry.failed = true;
+        entry.requestedLevel = entry.uploadedLevel;
+    }
+    entry.state.store(JobState::IDLE, std::memory_order_relaxed);
+
+    // Uploading may extend the range of levels the backend samples from, restore ours.
+    entry.texture->setMinMaxLevels(mEngine, entry.minLevel, entry.levelCount - 1);
+}
+
+void FTextureStreamer::setMinLevel(Entry& entry, uint8_t level) {
+    if (level == entry.minLevel) {
+        return;
+    }
+    entry.minLevel = level;
+    entry.texture->setMinMaxLevels(mEngine, level, entry.levelCount - 1);
+}
+
+void FTextureStreamer::release(Entry& entry) {
+    if (entry.job) {
+        mEngine.getJobSystem().waitAndRelease(entry.job);
+        entry.job = nullptr;
+    }
+    mUploadedBytes -= getLevelsSize(entry, entry.uploadedLevel);
+    mReader.asyncDestroy(&entry.async);
+}
+
+} // namespace filament::gltfio
+
+using namespace filament::gltfio;
+
+TextureStreamer* TextureStreamer::create(Engine* engine, TextureStreamerConfig const& config) {
+    return new FTextureStreamer(engine, config);
+}
+
+void TextureStreamer::destroy(TextureStreamer** streamer) {
+    delete downcast(*streamer);
+    *streamer = nullptr;
+}
+
+void TextureStreamer::addAsset(FilamentAsset* asset) {
+    downcast(this)->addAsset(asset);
+}
+
+void TextureStreamer::removeAsset(FilamentAsset* asset) {
+    downcast(this)->removeAsset(asset);
+}
+
+void TextureStreamer::update(View const* view) {
+    downcast(this)->update(view);
+}
+
+TextureStreamer::Statistics TextureStreamer::getStatistics() const noexcept {
+    return downcast(this)->getStatistics();
+}
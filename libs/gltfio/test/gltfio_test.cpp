@@ -18,13 +18,17 @@
 
 #include <backend/PixelBufferDescriptor.h>
 
+#include <filament/Camera.h>
 #include <filament/Engine.h>
 #include <filament/MaterialEnums.h>
 #include <filament/RenderableManager.h>
 #include <filament/TransformManager.h>
+#include <filament/View.h>
 
 #include <gltfio/AssetLoader.h>
+#include <gltfio/AssetStreamer.h>
 #include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
 #include <gltfio/ResourceLoader.h>
 #include <gltfio/TextureProvider.h>
 #include <gltfio/math.h>
@@ -35,8 +39,17 @@
 
 #include "materials/uberarchive.h"
 
+#include "../src/BufferUploads.h"
+#include "../src/FFilamentAsset.h"
+#include "../src/GeometryCache.h"
+#include "../src/FTextureStreamer.h"
+
+#include <chrono>
 #include <fstream>
+#include <iterator>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 using namespace filament;
 using namespace backend;
@@ -44,12 +57,68 @@ using namespace gltfio;
 using namespace utils;
 
 char const* ANIMATED_MORPH_CUBE_GLB = "AnimatedMorphCube.glb";
+char const* LUCY_GLB = "lucy.glb";
 
 static std::ifstream::pos_type getFileSize(const char* filename) {
     std::ifstream in(filename, std::ifstream::ate | std::ifstream::binary);
     return in.tellg();
 }
 
+static std::vector<uint8_t> readFile(Path const& filename) {
+    std::ifstream in(filename.c_str(), std::ifstream::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), {});
+}
+
+// Binary chunk of the skinned triangle: positions, joints, weights that don't sum to 1, indices.
+struct SkinnedTriangle {
+    math::float3 positions[3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } };
+    math::ubyte4 joints[3] = {};
+    math::float4 weights[3] = { { 0.5f, 0, 0, 0 }, { 0.25f, 0.25f, 0, 0 }, { 2.0f, 0, 0, 0 } };
+    uint16_t indices[4] = { 0, 1, 2, 0 };
+};
+
+static char const* SKINNED_TRIANGLE_JSON = R"({
+  "asset": { "version": "2.0" },
+  "scene": 0,
+  "scenes": [ { "nodes": [ 0, 1 ] } ],
+  "nodes": [ { "mesh": 0, "skin": 0 }, { "name": "joint" } ],
+  "skins": [ { "joints": [ 1 ] } ],
+  "meshes": [ { "primitives": [ {
+    "attributes": { "POSITION": 0, "JOINTS_0": 1, "WEIGHTS_0": 2 }, "indices": 3
+  } ] } ],
+  "buffers": [ { "byteLength": 104 } ],
+  "bufferViews": [
+    { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+    { "buffer": 0, "byteOffset": 36, "byteLength": 12 },
+    { "buffer": 0, "byteOffset": 48, "byteLength": 48 },
+    { "buffer": 0, "byteOffset": 96, "byteLength": 6 }
+  ],
+  "accessors": [
+    { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+      "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ] },
+    { "bufferView": 1, "componentType": 5121, "count": 3, "type": "VEC4" },
+    { "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC4" },
+    { "bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR" }
+  ]
+})";
+
+// Writes a GLB file with a skinned triangle.
+static void writeSkinnedTriangle(Path const& filename) {
+    static_assert(sizeof(SkinnedTriangle) == 104);
+    std::string json = SKINNED_TRIANGLE_JSON;
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+    SkinnedTriangle const bin;
+    uint32_t const header[] = {
+            0x46546C67, 2, uint32_t(12 + 8 + json.size() + 8 + sizeof(bin)),  // "glTF"
+            uint32_t(json.size()), 0x4E4F534A };                               // "JSON"
+    uint32_t const binHeader[] = { uint32_t(sizeof(bin)), 0x004E4942 };        // "BIN"
+    std::ofstream out(filename.c_str(), std::ofstream::binary);
+    out.write((char const*) header, sizeof(header));
+    out.write(json.data(), std::streamsize(json.size()));
+    out.write((char const*) binHeader, sizeof(binHeader));
+    out.write((char const*) &bin, sizeof(bin));
+}
+
 class glTFData {
 public:
     glTFData(Path filename, Engine* engine, MaterialProvider* materialProvider,
@@ -236,6 +305,356 @@ TEST_F(glTFIOTest, AnimatedMorphCubeRenderables) {
     EXPECT_EQ(morphTargetBuffer->getVertexCount(), 24u);
 }
 
+TEST_F(glTFIOTest, CreateAssetFromFile) {
+    Path const filename = Path::getCurrentExecutable().getParent() + Path(ANIMATED_MORPH_CUBE_GLB);
+    AssetLoader* assetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+    ResourceLoader resourceLoader({ mEngine, filename.getAbsolutePath().c_str(), false });
+
+    EXPECT_EQ(assetLoader->createAssetFromFile("missing.glb"), nullptr);
+
+    // The buffers of the mapped GLB file are uploaded without a copy, the result is the same.
+    FilamentAsset* asset = assetLoader->createAssetFromFile(filename.c_str());
+    ASSERT_NE(asset, nullptr);
+    EXPECT_TRUE(resourceLoader.loadResources(asset));
+    asset->releaseSourceData();
+
+    auto const& renderableManager = mEngine->getRenderableManager();
+    EXPECT_EQ(asset->getRenderableEntityCount(), 1u);
+    auto const inst = renderableManager.getInstance(asset->getRenderableEntities()[0]);
+    EXPECT_EQ(renderableManager.getPrimitiveCount(inst), 1u);
+    EXPECT_EQ(renderableManager.getMorphTargetCount(inst), 2u);
+
+    assetLoader->destroyAsset(asset);
+
+    // The skinning weights are normalized in the copy-on-write pages of the mapping, the file is
+    // not modified.
+    Path skinnedPath = Path::getTemporaryDirectory() + Path("gltfio_test_skinned.glb");
+    writeSkinnedTriangle(skinnedPath);
+    std::vector<uint8_t> const skinnedFile = readFile(skinnedPath);
+    ResourceLoader skinnedLoader({ mEngine, skinnedPath.getAbsolutePath().c_str(), true });
+    asset = assetLoader->createAssetFromFile(skinnedPath.c_str());
+    ASSERT_NE(asset, nullptr);
+    EXPECT_TRUE(skinnedLoader.loadResources(asset));
+    EXPECT_EQ(asset->getInstance()->getSkinCount(), 1u);
+    EXPECT_EQ(asset->getRenderableEntityCount(), 1u);
+
+    auto const gltf = (cgltf_data const*) asset->getSourceAsset();
+    cgltf_accessor const* weights = gltf->meshes[0].primitives[0].attributes[2].data;
+    ASSERT_EQ(gltf->meshes[0].primitives[0].attributes[2].type, cgltf_attribute_type_weights);
+    for (cgltf_size i = 0; i < weights->count; i++) {
+        math::float4 weight;
+        cgltf_accessor_read_float(weights, i, &weight[0], 4);
+        EXPECT_FLOAT_EQ(weight.x + weight.y + weight.z + weight.w, 1.0f);
+    }
+    EXPECT_EQ(readFile(skinnedPath), skinnedFile);
+
+    assetLoader->destroyAsset(asset);
+    skinnedPath.unlinkFile();
+    AssetLoader::destroy(&assetLoader);
+}
+
+TEST_F(glTFIOTest, GeometryCache) {
+    Path const filename = Path::getCurrentExecutable().getParent() + Path(ANIMATED_MORPH_CUBE_GLB);
+    Path cachePath = Path::getTemporaryDirectory() + Path("gltfio_test_geometry.cache");
+    cachePath.unlinkFile();
+
+    AssetLoader* assetLoader = AssetLoader::create({ mEngine, mMaterialProvider, mNameManager });
+    ResourceConfiguration config = { mEngine, filename.getAbsolutePath().c_str(), true };
+    config.cachePath = cachePath.c_str();
+    ResourceLoader resourceLoader(config);
+
+    // The first load writes the cache, the second one uploads the geometry from it. On a hit, the
+    // source asset keeps the mapping of the cache file, which is not written again.
+    std::vector<uint8_t> written;
+    for (int i = 0; i < 2; i++) {
+        FilamentAsset* asset = assetLoader->createAssetFromFile(filename.c_str());
+        ASSERT_NE(asset, nullptr);
+        EXPECT_TRUE(resourceLoader.loadResources(asset));
+        EXPECT_TRUE(cachePath.exists());
+        EXPECT_EQ(downcast(asset)->mSourceAsset->mappedFiles.size(), i == 0 ? 1u : 2u);
+        if (i == 0) {
+            written = readFile(cachePath);
+        } else {
+            EXPECT_EQ(readFile(cachePath), written);
+        }
+
+        auto const& renderableManager = mEngine->getRenderableManager();
+        EXPECT_EQ(asset->getRenderableEntityCount(), 1u);
+        auto const inst = renderableManager.getInstance(asset->getRenderableEntities()[0]);
+        EXPECT_EQ(renderableManager.getMorphTargetCount(inst), 2u);
+
+        assetLoader->destroyAsset(asset);
+    }
+
+    // The blobs uploaded on a hit are the vertex and index data that processing the asset
+    // uploads. The key is read from the header: magic, version, blob count, key.
+    ASSERT_GT(written.size(), 24u);
+    uint64_t key;
+    memcpy(&key, written.data() + 16, sizeof(key));
+    FilamentAsset* asset = assetLoader->createAssetFromFile(filename.c_str());
+    ASSERT_NE(asset, nullptr);
+    {
+        GeometryCache cache;
+        ASSERT_TRUE(cache.open(cachePath.c_str(), key));
+        size_t compared = 0;
+        for (BufferSlot const& slot : downcast(asset)->mBufferSlots) {
+            GeometryCache::Blob const blob = cache.next();
+            if (!slot.vertexBuffer && !slot.indexBuffer) {
+                continue;
+            }
+            SlotData const content = getSlotData(slot);
+            ASSERT_EQ(blob.size, content.size);
+            EXPECT_EQ(memcmp(blob.data, content.data, blob.size), 0);
+            if (content.owned) {
+                free(const_cast<void*>(content.data));
+            }
+            compared++;
+        }
+        EXPECT_GT(compared, 0u);
+    }
+    assetLoader->destroyAsset(asset);
+
+    // A cache whose blobs don't match the asset is ignored and written again. The first entry
+    // follows the header, its size follows its offset.
+    std::vector<uint8_t> corrupted = written;
+    uint64_t size;
+    memcpy(&size, corrupted.data() + 24 + 8, sizeof(size));
+    size -= 4;
+    memcpy(corrupted.data() + 24 + 8, &size, sizeof(size));
+    {
+        std::ofstream out(cachePath.c_str(), std::ofstream::binary | std::ofstream::trunc);
+        out.write((char const*) corrupted.data(), std::streamsize(corrupted.size()));
+    }
+    asset = assetLoader->createAssetFromFile(filename.c_str());
+    ASSERT_NE(asset, nullptr);
+    EXPECT_TRUE(resourceLoader.loadResources(asset));
+    EXPECT_EQ(downcast(asset)->mSourceAsset->mappedFiles.size(), 1u);
+    EXPECT_EQ(readFile(cachePath), written);
+    assetLoader->destroyAsset(asset);
+
+    AssetLoader::destroy(&assetLoader);
+    cachePath.unlinkFile();
+}
+
+TEST_F(glTFIOTest, LevelsOfDetail) {
+    const LevelOfDetail lods[] = { { 0.01f, 0.5f }, { 0.05f, 0.25f } };
+    AssetConfiguration config = { mEngine, mMaterialProvider, mNameManager };
+    config.levelsOfDetail = lods;
+    config.levelOfDetailCount = 2;
+    AssetLoader* assetLoader = AssetLoader::create(config);
+    auto const& renderableManager = mEngine->getRenderableManager();
+
+    // Each instance of the mesh gets a copy of its primitive per level, using the simplified
+    // indices once the resources are loaded.
+    Path const lucyPath = Path::getCurrentExecutable().getParent() + Path(LUCY_GLB);
+    std::vector<uint8_t> const lucy = readFile(lucyPath);
+    ASSERT_FALSE(lucy.empty());
+    FilamentInstance* instances[2] = {};
+    FilamentAsset* asset = assetLoader->createInstancedAsset(lucy.data(), lucy.size(),
+            instances, 2);
+    ASSERT_NE(asset, nullptr);
+    ResourceLoader resourceLoader({ mEngine, lucyPath.getAbsolutePath().c_str(), false });
+    EXPECT_TRUE(resourceLoader.loadResources(asset));
+
+    EXPECT_EQ(asset->getRenderableEntityCount(), 2u);
+    for (size_t i = 0; i < asset->getRenderableEntityCount(); i++) {
+        auto const inst = renderableManager.getInstance(asset->getRenderableEntities()[i]);
+        EXPECT_EQ(renderableManager.getLevelCount(inst), 3u);
+        EXPECT_EQ(renderableManager.getPrimitiveCount(inst), 3u);
+    }
+
+    Primitive const& prim = downcast(asset)->mMeshCache[0][0];
+    ASSERT_EQ(prim.lods.size(), 2u);
+    EXPECT_LT(prim.lods[0]->getIndexCount(), prim.indices->getIndexCount());
+    EXPECT_LT(prim.lods[1]->getIndexCount(), prim.lods[0]->getIndexCount());
+    EXPECT_EQ(prim.lods[1]->getIndexCount() % 3, 0u);
+    assetLoader->destroyAsset(asset);
+
+    // Meshes with morph targets keep a single level
+    Path const cubePath = Path::getCurrentExecutable().getParent() + Path(ANIMATED_MORPH_CUBE_GLB);
+    asset = assetLoader->createAssetFromFile(cubePath.c_str());
+    ASSERT_NE(asset, nullptr);
+    EXPECT_TRUE(resourceLoader.loadResources(asset));
+    auto const inst = renderableManager.getInstance(asset->getRenderableEntities()[0]);
+    EXPECT_EQ(renderableManager.getLevelCount(inst), 1u);
+    EXPECT_EQ(renderableManager.getPrimitiveCount(inst), 1u);
+    EXPECT_TRUE(downcast(asset)->mMeshCache[0][0].lods.empty());
+    assetLoader->destroyAsset(asset);
+
+    AssetLoader::destroy(&assetLoader);
+}
+
+TEST_F(glTFIOTest, AssetStreaming) {
+    AssetConfiguration config = { mEngine, mMaterialProvider, mNameManager };
+    config.streaming = true;
+    AssetLoader* assetLoader = AssetLoader::create(config);
+    AssetStreamerConfig streamerConfig;
+    streamerConfig.loadDistance = 100.0f;
+    streamerConfig.unloadDistance = 150.0f;
+    AssetStreamer* streamer = AssetStreamer::create(mEngine, assetLoader, streamerConfig);
+    auto& renderableManager = mEngine->getRenderableManager();
+    auto& transformManager = mEngine->getTransformManager();
+
+    // Three instances of the mesh, each one is a chunk.
+    Path const lucyPath = Path::getCurrentExecutable().getParent() + Path(LUCY_GLB);
+    std::vector<uint8_t> const lucy = readFile(lucyPath);
+    ASSERT_FALSE(lucy.empty());
+    FilamentInstance* instances[3] = {};
+    FilamentAsset* asset = assetLoader->createInstancedAsset(lucy.data(), lucy.size(),
+            instances, 3);
+    ASSERT_NE(asset, nullptr);
+    ResourceLoader resourceLoader({ mEngine, lucyPath.getAbsolutePath().c_str(), false });
+    EXPECT_TRUE(resourceLoader.loadResources(asset));
+    asset->releaseSourceData();
+    EXPECT_EQ(asset->getRenderableEntityCount(), 0u);
+
+    std::vector<Chunk> const& chunks = downcast(asset)->mChunks;
+    ASSERT_EQ(chunks.size(), 3u);
+    float const offsets[3] = { 0.0f, 50.0f, 500.0f };
+    for (size_t i = 0; i < 3; i++) {
+        transformManager.setTransform(transformManager.getInstance(instances[i]->getRoot()),
+                math::mat4f::translation(math::float3{ offsets[i], 0, 0 }));
+    }
+    streamer->addAsset(asset);
+
+    View* view = mEngine->createView();
+    Entity const cameraEntity = EntityManager::get().create();
+    Camera* camera = mEngine->createCamera(cameraEntity);
+    view->setCamera(camera);
+    auto streamAt = [&](float x) {
+        camera->lookAt({ x, 0, 10 }, { x, 0, 0 });
+        // The geometry is prepared by background jobs.
+        streamer->update(view);
+        for (int i = 0; i < 1000 && streamer->getStatistics().loadingCount; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            streamer->update(view);
+        }
+        mEngine->flushAndWait();
+    };
+    auto isBuilt = [&](size_t chunk) {
+        return renderableManager.hasComponent(chunks[chunk].entity);
+    };
+
+    // The chunks within the load distance get a renderable.
+    streamAt(0.0f);
+    AssetStreamer::Statistics stats = streamer->getStatistics();
+    EXPECT_EQ(stats.chunkCount, 3u);
+    EXPECT_EQ(stats.loadedChunkCount, 2u);
+    EXPECT_EQ(stats.loadingCount, 0u);
+    EXPECT_GT(stats.residentBytes, 0u);
+    EXPECT_TRUE(isBuilt(0));
+    EXPECT_TRUE(isBuilt(1));
+    EXPECT_FALSE(isBuilt(2));
+
+    auto ri = renderableManager.getInstance(chunks[1].entity);
+    renderableManager.setLayerMask(ri, 0xff, 0x2);
+    renderableManager.setPriority(ri, 6);
+    renderableManager.setCastShadows(ri, true);
+    MaterialInstance* const material = renderableManager.getMaterialInstanceAt(ri, 0);
+
+    // The chunks beyond the unload distance lose their renderable, the mesh stays resident for
+    // the remaining one.
+    streamAt(500.0f);
+    stats = streamer->getStatistics();
+    EXPECT_EQ(stats.loadedChunkCount, 1u);
+    EXPECT_GT(stats.residentBytes, 0u);
+    EXPECT_FALSE(isBuilt(0));
+    EXPECT_FALSE(isBuilt(1));
+    EXPECT_TRUE(isBuilt(2));
+
+    // The state set on a renderable is restored when it is created again.
+    streamAt(50.0f);
+    EXPECT_TRUE(isBuilt(0));
+    EXPECT_TRUE(isBuilt(1));
+    EXPECT_FALSE(isBuilt(2));
+    ri = renderableManager.getInstance(chunks[1].entity);
+    EXPECT_EQ(renderableManager.getLayerMask(ri), 0x2);
+    EXPECT_EQ(renderableManager.getPriority(ri), 6);
+    EXPECT_TRUE(renderableManager.isShadowCaster(ri));
+    EXPECT_EQ(renderableManager.getMaterialInstanceAt(ri, 0), material);
+    ri = renderableManager.getInstance(chunks[0].entity);
+    EXPECT_EQ(renderableManager.getLayerMask(ri), 0x1);
+
+    // Moving the root of an instance moves its chunk in the spatial index.
+    transformManager.setTransform(transformManager.getInstance(instances[2]->getRoot()),
+            math::mat4f::translation(math::float3{ 60.0f, 0, 0 }));
+    streamAt(50.0f);
+    EXPECT_TRUE(isBuilt(2));
+    EXPECT_EQ(streamer->getStatistics().loadedChunkCount, 3u);
+
+    streamer->removeAsset(asset);
+    EXPECT_FALSE(isBuilt(0));
+    stats = streamer->getStatistics();
+    EXPECT_EQ(stats.chunkCount, 0u);
+    EXPECT_EQ(stats.residentBytes, 0u);
+    AssetStreamer::destroy(&streamer);
+
+    // Nothing is loaded if the mesh does not fit in the budget.
+    streamerConfig.budget = 1024;
+    streamer = AssetStreamer::create(mEngine, assetLoader, streamerConfig);
+    streamer->addAsset(asset);
+    streamAt(0.0f);
+    stats = streamer->getStatistics();
+    EXPECT_EQ(stats.loadedChunkCount, 0u);
+    EXPECT_EQ(stats.residentBytes, 0u);
+    EXPECT_FALSE(isBuilt(0));
+    streamer->removeAsset(asset);
+    AssetStreamer::destroy(&streamer);
+
+    mEngine->destroy(view);
+    mEngine->destroyCameraComponent(cameraEntity);
+    EntityManager::get().destroy(cameraEntity);
+    assetLoader->destroyAsset(asset);
+    AssetLoader::destroy(&assetLoader);
+}
+
+TEST(TextureStreamerTest, RequiredLevel) {
+    // level n is needed when a pixel covers less than 2^(n+1) texels
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 2048.0f, 3), 0);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 1024.0f, 3), 0);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 600.0f, 3), 0);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 512.0f, 3), 1);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 300.0f, 3), 1);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 256.0f, 3), 2);
+
+    // the tail is always used
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 1.0f, 3), 3);
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024, 1.0f, 0), 0);
+
+    EXPECT_EQ(FTextureStreamer::getRequiredLevel(1024,
+            std::numeric_limits<float>::infinity(), 3), 0);
+}
+
+TEST(TextureStreamerTest, Coverage) {
+    // a camera at the origin, looking down -Z, with a 90 degrees fov and a 1000 pixels viewport
+    math::mat4f const clipFromWorld = math::mat4f::perspective(90.0f, 1.0f, 0.1f, 100.0f);
+    Frustum const frustum(clipFromWorld);
+    float const scale = clipFromWorld[1][1] * 1000.0f;
+    EXPECT_NEAR(scale, 1000.0f, 1e-3f);
+
+    // the projected diameter of the bounding sphere
+    Box const box = { { 0, 0, -10 }, { 1, 1, 1 } };
+    EXPECT_NEAR(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, box),
+            1000.0f * std::sqrt(3.0f) / 10.0f, 1e-2f);
+
+    Box const farther = { { 0, 0, -20 }, { 1, 1, 1 } };
+    EXPECT_NEAR(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, farther),
+            1000.0f * std::sqrt(3.0f) / 20.0f, 1e-2f);
+
+    // boxes outside of the frustum are not covered
+    Box const behind = { { 0, 0, 10 }, { 1, 1, 1 } };
+    EXPECT_EQ(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, behind), 0.0f);
+    Box const aside = { { 100, 0, -10 }, { 1, 1, 1 } };
+    EXPECT_EQ(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, aside), 0.0f);
+    Box const beyond = { { 0, 0, -200 }, { 1, 1, 1 } };
+    EXPECT_EQ(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, beyond), 0.0f);
+
+    // the camera is within the bounding sphere
+    Box const around = { { 0, 0, -0.5f }, { 1, 1, 1 } };
+    EXPECT_EQ(FTextureStreamer::getCoverage(frustum, clipFromWorld, scale, around),
+            std::numeric_limits<float>::infinity());
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -23,6 +23,7 @@
 #include <filament/Texture.h>
 
 #include <utils/FixedCapacityVector.h>
+#include <utils/JobSystem.h>
 
 namespace filament {
     class Engine;
@@ -131,15 +132,42 @@ class Ktx2Reader {
              */
             Result doTranscoding();
 
+            /**
+             * Same as doTranscoding(), but transcodes all mipmap levels concurrently, with one job
+             * per level on the given JobSystem, starting with the smallest levels.
+             *
+             * The calling thread must belong to the JobSystem, e.g. it can be called from a job.
+             * The jobs are created with the given priority.
+             *
+             * Only the levels from minLevel to the smallest one are transcoded, levels that were
+             * transcoded by a previous call are skipped. This allows the finest levels to be
+             * streamed in later, by calling this again with a smaller minLevel. Calls must not
+             * overlap.
+             */
+            Result doTranscoding(utils::JobSystem& js,
+                    utils::JobSystem::JobPriority priority = utils::JobSystem::JobPriority::CRITICAL,
+                    uint32_t minLevel = 0);
+
             /**
              * Uploads pending mipmaps to the texture.
              *
              * This can safely be called while doTranscoding() is still working in another thread.
              * Since this calls Texture::setImage(), it should be called from the foreground thread;
              * see "Thread safety" in the documentation for filament::Engine.
+             *
+             * Mipmaps are uploaded from the smallest to the largest, a level is only uploaded once
+             * all the smaller levels have been, so that the texture always has a complete tail of
+             * its mip chain.
              */
             void uploadImages();
 
+            /**
+             * Returns the finest miplevel that was uploaded to the texture so far, or the number
+             * of levels of the texture if none was. All the coarser levels have been uploaded.
+             * This should be called from the foreground thread, like uploadImages().
+             */
+            uint32_t getUploadedLevel() const noexcept;
+
         protected:
             Async() noexcept = default;
             virtual ~Async();
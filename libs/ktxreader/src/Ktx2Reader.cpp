@@ -19,9 +19,11 @@
 #include <filament/Engine.h>
 #include <filament/Texture.h>
 
+#include <utils/JobSystem.h>
 #include <utils/Log.h>
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #pragma clang diagnostic push
@@ -166,11 +168,16 @@ namespace ktxreader {
 class FAsync : public Async {
 public:
     FAsync(Texture* texture, Engine& engine, ktx2_transcoder* transcoder, Buffer&& buf) :
+            mTranscodedLevel(transcoder->get_levels()),
+            mPendingLevelCount(transcoder->get_levels()),
             mTexture(texture), mEngine(engine), mTranscoder(transcoder),
             mSourceBuffer(std::move(buf)) {}
     Texture* getTexture() const noexcept { return mTexture; }
     Result doTranscoding();
+    Result doTranscoding(utils::JobSystem& js, utils::JobSystem::JobPriority priority,
+            uint32_t minLevel);
     void uploadImages();
+    uint32_t getUploadedLevel() const noexcept { return mPendingLevelCount; }
 
 protected:
     ~FAsync();
@@ -183,6 +190,14 @@ private:
     // miplevel in the texture.
     TranscoderResult mTranscoderResults[KTX2_MAX_SUPPORTED_LEVEL_COUNT] = {};
 
+    // Levels are transcoded from the smallest to the largest, this is the largest level that was
+    // transcoded so far, or the level count if none was.
+    uint32_t mTranscodedLevel;
+
+    // Levels are uploaded from the smallest to the largest, this is the number of levels that
+    // remain to be uploaded, i.e. the next one to upload is mPendingLevelCount - 1.
+    uint32_t mPendingLevelCount;
+
     Texture* const mTexture;
     Engine& mEngine;
 
@@ -275,7 +290,8 @@ FAsync::~FAsync() {
 Result FAsync::doTranscoding() {
     ktx2_transcoder_state basisThreadState;
     basisThreadState.clear();
-    for (uint32_t levelIndex = 0, n = mTranscoder->get_levels(); levelIndex < n; levelIndex++) {
+    // Transcode the smallest levels first, they're uploaded first.
+    for (uint32_t levelIndex = mTranscodedLevel; levelIndex-- > 0;) {
         Texture::PixelBufferDescriptor* pbd;
         Result result = transcodeImageLevel(*mTranscoder, basisThreadState, mTexture->getFormat(),
                 levelIndex, &pbd);
@@ -283,21 +299,63 @@ Result FAsync::doTranscoding() {
             return result;
         }
         mTranscoderResults[levelIndex].store(pbd);
+        mTranscodedLevel = levelIndex;
     }
     return Result::SUCCESS;
 }
 
+Result FAsync::doTranscoding(utils::JobSystem& js, utils::JobSystem::JobPriority priority,
+        uint32_t minLevel) {
+    if (minLevel >= mTranscodedLevel) {
+        return Result::SUCCESS;
+    }
+
+    // The transcoder state holds scratch buffers, so we keep one per thread rather than per level.
+    const size_t threadCount = js.getMaxThreadCount();
+    std::unique_ptr<ktx2_transcoder_state[]> states(new ktx2_transcoder_state[threadCount]);
+    for (size_t i = 0; i < threadCount; i++) {
+        states[i].clear();
+    }
+
+    std::atomic<Result> status{ Result::SUCCESS };
+    utils::JobSystem::Job* parent = js.createJob();
+    js.setPriority(parent, priority);
+
+    // The smallest levels are scheduled first, so that they're ready to be uploaded first.
+    for (uint32_t levelIndex = mTranscodedLevel; levelIndex-- > minLevel;) {
+        js.run(utils::jobs::createJob(js, parent, [this, &js, &states, &status, levelIndex]() {
+            Texture::PixelBufferDescriptor* pbd;
+            Result result = transcodeImageLevel(*mTranscoder, states[js.getThreadIndex()],
+                    mTexture->getFormat(), levelIndex, &pbd);
+            if (UTILS_UNLIKELY(result != Result::SUCCESS)) {
+                status.store(result, std::memory_order_relaxed);
+                return;
+            }
+            mTranscoderResults[levelIndex].store(pbd);
+        }));
+    }
+    js.runAndWait(parent);
+
+    const Result result = status.load(std::memory_order_relaxed);
+    if (result == Result::SUCCESS) {
+        mTranscodedLevel = minLevel;
+    }
+    return result;
+}
+
 void FAsync::uploadImages() {
-    size_t levelIndex = 0;
     UTILS_NOUNROLL
-    for (TranscoderResult& level : mTranscoderResults) {
+    while (mPendingLevelCount > 0) {
+        const uint32_t levelIndex = mPendingLevelCount - 1;
+        TranscoderResult& level = mTranscoderResults[levelIndex];
         Texture::PixelBufferDescriptor* pbd = level.load();
-        if (pbd) {
-            level.store(nullptr);
-            mTexture->setImage(mEngine, levelIndex, std::move(*pbd));
-            delete pbd;
+        if (!pbd) {
+            break;
         }
-        ++levelIndex;
+        level.store(nullptr);
+        mTexture->setImage(mEngine, levelIndex, std::move(*pbd));
+        delete pbd;
+        mPendingLevelCount--;
     }
 }
 
@@ -434,8 +492,17 @@ Result Async::doTranscoding() {
     return static_cast<FAsync*>(this)->doTranscoding();
 }
 
+Result Async::doTranscoding(utils::JobSystem& js, utils::JobSystem::JobPriority priority,
+        uint32_t minLevel) {
+    return static_cast<FAsync*>(this)->doTranscoding(js, priority, minLevel);
+}
+
 void Async::uploadImages() {
     return static_cast<FAsync*>(this)->uploadImages();
 }
 
+uint32_t Async::getUploadedLevel() const noexcept {
+    return static_cast<FAsync const*>(this)->getUploadedLevel();
+}
+
 } // namespace ktxreader
@@ -21,6 +21,7 @@
 #include <filament/Texture.h>
 
 #include <gtest/gtest.h>
+#include <utils/JobSystem.h>
 #include <utils/Path.h>
 
 #include <fstream>
@@ -90,6 +91,71 @@ TEST_F(KtxReaderTest, Ktx2) {
     engine->destroy(tex);
 }
 
+TEST_F(KtxReaderTest, Ktx2Async) {
+    const utils::Path parent = Path::getCurrentExecutable().getParent();
+    const auto contents = readFile(parent + "color_grid_uastc_zstd.ktx2");
+
+    ktxreader::Ktx2Reader reader(*engine);
+    reader.requestFormat(Texture::InternalFormat::SRGB8_A8);
+
+    ktxreader::Ktx2Reader::Async* async = reader.asyncCreate(contents.data(), contents.size(),
+            ktxreader::Ktx2Reader::TransferFunction::sRGB);
+    ASSERT_NE(async, nullptr);
+    Texture* tex = async->getTexture();
+    ASSERT_NE(tex, nullptr);
+    EXPECT_GT(tex->getLevels(), 1u);
+
+    // the engine's thread belongs to its JobSystem
+    EXPECT_EQ(async->doTranscoding(engine->getJobSystem()),
+            ktxreader::Ktx2Reader::Result::SUCCESS);
+    async->uploadImages();
+
+    reader.asyncDestroy(&async);
+    EXPECT_EQ(async, nullptr);
+    engine->destroy(tex);
+}
+
+TEST_F(KtxReaderTest, Ktx2AsyncMinLevel) {
+    const utils::Path parent = Path::getCurrentExecutable().getParent();
+    const auto contents = readFile(parent + "color_grid_uastc_zstd.ktx2");
+
+    ktxreader::Ktx2Reader reader(*engine);
+    reader.requestFormat(Texture::InternalFormat::SRGB8_A8);
+
+    using Result = ktxreader::Ktx2Reader::Result;
+    constexpr auto BACKGROUND = utils::JobSystem::JobPriority::BACKGROUND;
+    utils::JobSystem& js = engine->getJobSystem();
+
+    ktxreader::Ktx2Reader::Async* async = reader.asyncCreate(contents.data(), contents.size(),
+            ktxreader::Ktx2Reader::TransferFunction::sRGB);
+    ASSERT_NE(async, nullptr);
+    Texture* tex = async->getTexture();
+    const uint32_t levels = tex->getLevels();
+    ASSERT_GT(levels, 3u);
+    EXPECT_EQ(async->getUploadedLevel(), levels);
+
+    // only the tail of the mip chain is transcoded
+    EXPECT_EQ(async->doTranscoding(js, BACKGROUND, levels - 2), Result::SUCCESS);
+    async->uploadImages();
+    EXPECT_EQ(async->getUploadedLevel(), levels - 2);
+
+    // levels that were already transcoded are skipped, there is nothing new to upload
+    EXPECT_EQ(async->doTranscoding(js, BACKGROUND, levels - 1), Result::SUCCESS);
+    async->uploadImages();
+    EXPECT_EQ(async->getUploadedLevel(), levels - 2);
+
+    // the finer levels are streamed in later
+    EXPECT_EQ(async->doTranscoding(js, BACKGROUND, 1), Result::SUCCESS);
+    async->uploadImages();
+    EXPECT_EQ(async->getUploadedLevel(), 1u);
+    EXPECT_EQ(async->doTranscoding(js, BACKGROUND, 0), Result::SUCCESS);
+    async->uploadImages();
+    EXPECT_EQ(async->getUploadedLevel(), 0u);
+
+    reader.asyncDestroy(&async);
+    engine->destroy(tex);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
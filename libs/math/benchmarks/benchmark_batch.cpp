@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <math/batch.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+using namespace filament::math;
+
+namespace {
+
+struct Data {
+    explicit Data(size_t count)
+            : matrices(count), quats(count), points(count), extents(count),
+              outMatrices(count), outCenters(count), outExtents(count) {
+        for (size_t i = 0; i < count; i++) {
+            float const f = float(i) / float(count);
+            quats[i] = normalize(quatf{ f, 1.0f - f, 0.5f, 0.25f });
+            matrices[i] = mat4f::translation(float3{ f, -f, 2.0f * f }) * mat4f(quats[i]);
+            points[i] = { f, 2.0f * f, -f };
+            extents[i] = { 1.0f, f, 0.5f };
+        }
+    }
+    std::vector<mat4f> matrices;
+    std::vector<quatf> quats;
+    std::vector<float3> points;
+    std::vector<float3> extents;
+    std::vector<mat4f> outMatrices;
+    std::vector<float3> outCenters;
+    std::vector<float3> outExtents;
+};
+
+template<typename F>
+void run(benchmark::State& state, F&& f) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            f();
+            benchmark::ClobberMemory();
+        }
+        pc.stop();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+} // anonymous namespace
+
+static void BM_MultiplyScalar(benchmark::State& state) {
+    Data d(state.range(0));
+    run(state, [&] {
+        for (size_t i = 0, c = d.matrices.size(); i < c; i++) {
+            d.outMatrices[i] = d.matrices[i] * d.matrices[c - i - 1];
+        }
+    });
+}
+
+static void BM_MultiplyBatch(benchmark::State& state) {
+    Data d(state.range(0));
+    // rhs reversed, same as above
+    std::vector<mat4f> rhs(d.matrices.rbegin(), d.matrices.rend());
+    run(state, [&] {
+        batch::multiply(d.outMatrices.data(), d.matrices.data(), rhs.data(), d.matrices.size());
+    });
+}
+
+static void BM_TransformBoxesScalar(benchmark::State& state) {
+    Data d(state.range(0));
+    run(state, [&] {
+        for (size_t i = 0, c = d.matrices.size(); i < c; i++) {
+            mat3f const m = d.matrices[i].upperLeft();
+            d.outCenters[i] = m * d.points[i] + d.matrices[i][3].xyz;
+            d.outExtents[i] = abs(m) * d.extents[i];
+        }
+    });
+}
+
+static void BM_TransformBoxesBatch(benchmark::State& state) {
+    Data d(state.range(0));
+    run(state, [&] {
+        batch::transformBoxes(d.outCenters.data(), d.outExtents.data(),
+                d.matrices.data(), d.points.data(), d.extents.data(), d.matrices.size());
+    });
+}
+
+static void BM_RotationMatricesScalar(benchmark::State& state) {
+    Data d(state.range(0));
+    run(state, [&] {
+        for (size_t i = 0, c = d.quats.size(); i < c; i++) {
+            d.outMatrices[i] = mat4f{ mat3f{ d.quats[i] }};
+        }
+    });
+}
+
+static void BM_RotationMatricesBatch(benchmark::State& state) {
+    Data d(state.range(0));
+    run(state, [&] {
+        batch::rotationMatrices(d.outMatrices.data(), d.quats.data(), d.quats.size());
+    });
+}
+
+BENCHMARK(BM_MultiplyScalar)->Range(64, 16384);
+BENCHMARK(BM_MultiplyBatch)->Range(64, 16384);
+BENCHMARK(BM_TransformBoxesScalar)->Range(64, 16384);
+BENCHMARK(BM_TransformBoxesBatch)->Range(64, 16384);
+BENCHMARK(BM_RotationMatricesScalar)->Range(64, 16384);
+BENCHMARK(BM_RotationMatricesBatch)->Range(64, 16384);
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_MATH_BATCH_H
+#define TNT_MATH_BATCH_H
+
+#include <math/mathfwd.h>
+
+#include <stddef.h>
+
+namespace filament::math::batch {
+
+/*
+ * Kernels processing arrays of transforms, they use SSE (and AVX when enabled at compile time)
+ * or NEON (aarch64) when available, and plain C++ otherwise.
+ *
+ * Output arrays must not overlap input arrays, unless noted otherwise.
+ */
+
+// out[i] = lhs[i] * rhs[i]
+void multiply(mat4f* out, mat4f const* lhs, mat4f const* rhs, size_t count) noexcept;
+
+// out[i] = (m[i] * float4{ points[i], 1 }).xyz, m[i] must be an affine transform
+void transformPoints(float3* out, mat4f const* m, float3 const* points, size_t count) noexcept;
+
+// Computes the bounding boxes of transformed boxes, like Box::transform(). Boxes are given by
+// their centers and half-extents, m[i] must be an affine transform.
+void transformBoxes(float3* outCenters, float3* outHalfExtents, mat4f const* m,
+        float3 const* centers, float3 const* halfExtents, size_t count) noexcept;
+
+// out[i] = mat4f{ mat3f{ q[i] } }, quaternions don't need to be normalized
+void rotationMatrices(mat4f* out, quatf const* q, size_t count) noexcept;
+
+} // namespace filament::math::batch
+
+#endif // TNT_MATH_BATCH_H
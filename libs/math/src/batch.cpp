@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math/batch.h>
+
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#   include <arm_neon.h>
+#   define MATH_BATCH_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <immintrin.h>
+#   define MATH_BATCH_SSE 1
+#endif
+
+namespace filament::math::batch {
+
+#if defined(MATH_BATCH_NEON) || defined(MATH_BATCH_SSE)
+
+namespace {
+
+// A minimal 4-wide float abstraction, just what the kernels below need.
+
+#if defined(MATH_BATCH_NEON)
+
+using vfloat4 = float32x4_t;
+
+inline vfloat4 load(float const* p) noexcept { return vld1q_f32(p); }
+inline void store(float* p, vfloat4 v) noexcept { vst1q_f32(p, v); }
+inline vfloat4 splat(float f) noexcept { return vdupq_n_f32(f); }
+template<int I> inline vfloat4 lane(vfloat4 v) noexcept { return vdupq_laneq_f32(v, I); }
+inline vfloat4 add(vfloat4 a, vfloat4 b) noexcept { return vaddq_f32(a, b); }
+inline vfloat4 sub(vfloat4 a, vfloat4 b) noexcept { return vsubq_f32(a, b); }
+inline vfloat4 mul(vfloat4 a, vfloat4 b) noexcept { return vmulq_f32(a, b); }
+inline vfloat4 div(vfloat4 a, vfloat4 b) noexcept { return vdivq_f32(a, b); }
+// a * b + c
+inline vfloat4 madd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept { return vfmaq_f32(c, a, b); }
+inline vfloat4 abs(vfloat4 v) noexcept { return vabsq_f32(v); }
+// c > 0 ? v : 0
+inline vfloat4 selectPositive(vfloat4 c, vfloat4 v) noexcept {
+    return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(c, vdupq_n_f32(0)), vreinterpretq_u32_f32(v)));
+}
+inline void transpose(vfloat4& a, vfloat4& b, vfloat4& c, vfloat4& d) noexcept {
+    float32x4_t const t0 = vtrn1q_f32(a, b);    // a0 b0 a2 b2
+    float32x4_t const t1 = vtrn2q_f32(a, b);    // a1 b1 a3 b3
+    float32x4_t const t2 = vtrn1q_f32(c, d);    // c0 d0 c2 d2
+    float32x4_t const t3 = vtrn2q_f32(c, d);    // c1 d1 c3 d3
+    a = vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2)));
+    b = vreinterpretq_f32_f64(vtrn1q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3)));
+    c = vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t0), vreinterpretq_f64_f32(t2)));
+    d = vreinterpretq_f32_f64(vtrn2q_f64(vreinterpretq_f64_f32(t1), vreinterpretq_f64_f32(t3)));
+}
+
+#else
+
+using vfloat4 = __m128;
+
+inline vfloat4 load(float const* p) noexcept { return _mm_loadu_ps(p); }
+inline void store(float* p, vfloat4 v) noexcept { _mm_storeu_ps(p, v); }
+inline vfloat4 splat(float f) noexcept { return _mm_set1_ps(f); }
+template<int I> inline vfloat4 lane(vfloat4 v) noexcept {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I));
+}
+inline vfloat4 add(vfloat4 a, vfloat4 b) noexcept { return _mm_add_ps(a, b); }
+inline vfloat4 sub(vfloat4 a, vfloat4 b) noexcept { return _mm_sub_ps(a, b); }
+inline vfloat4 mul(vfloat4 a, vfloat4 b) noexcept { return _mm_mul_ps(a, b); }
+inline vfloat4 div(vfloat4 a, vfloat4 b) noexcept { return _mm_div_ps(a, b); }
+// a * b + c
+inline vfloat4 madd(vfloat4 a, vfloat4 b, vfloat4 c) noexcept {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+inline vfloat4 abs(vfloat4 v) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+// c > 0 ? v : 0
+inline vfloat4 selectPositive(vfloat4 c, vfloat4 v) noexcept {
+    return _mm_and_ps(_mm_cmpgt_ps(c, _mm_setzero_ps()), v);
+}
+inline void transpose(vfloat4& a, vfloat4& b, vfloat4& c, vfloat4& d) noexcept {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+#endif
+
+// Stores the xyz components of v. When more elements follow, a full vector is stored and its
+// w component is overwritten later; this is only allowed when out doesn't alias the inputs.
+inline void store3(float3* out, vfloat4 v, bool last) noexcept {
+    if (!last) {
+        store(&out->x, v);
+    } else {
+        float4 t;
+        store(&t.x, v);
+        *out = t.xyz;
+    }
+}
+
+} // anonymous namespace
+
+void multiply(mat4f* out, mat4f const* lhs, mat4f const* rhs, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        float const* const a = &lhs[i][0][0];
+        float const* const b = &rhs[i][0][0];
+        float* const o = &out[i][0][0];
+#if defined(__AVX__) && defined(MATH_BATCH_SSE)
+        // two result columns at a time
+        __m256 const a0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 0));
+        __m256 const a1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 4));
+        __m256 const a2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 8));
+        __m256 const a3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(a + 12));
+        __m256 const b01 = _mm256_loadu_ps(b + 0);
+        __m256 const b23 = _mm256_loadu_ps(b + 8);
+        auto column = [&](__m256 bb) {
+            __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bb, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(bb, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(bb, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(bb, _MM_SHUFFLE(3, 3, 3, 3))));
+            return r;
+        };
+        _mm256_storeu_ps(o + 0, column(b01));
+        _mm256_storeu_ps(o + 8, column(b23));
+#else
+        vfloat4 const a0 = load(a + 0);
+        vfloat4 const a1 = load(a + 4);
+        vfloat4 const a2 = load(a + 8);
+        vfloat4 const a3 = load(a + 12);
+        for (size_t j = 0; j < 16; j += 4) {
+            vfloat4 const bj = load(b + j);
+            vfloat4 r = mul(a0, lane<0>(bj));
+            r = madd(a1, lane<1>(bj), r);
+            r = madd(a2, lane<2>(bj), r);
+            r = madd(a3, lane<3>(bj), r);
+            store(o + j, r);
+        }
+#endif
+    }
+}
+
+void transformPoints(float3* out, mat4f const* m, float3 const* points, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        float const* const c = &m[i][0][0];
+        float3 const p = points[i];
+        vfloat4 r = madd(load(c + 0), splat(p.x), load(c + 12));
+        r = madd(load(c + 4), splat(p.y), r);
+        r = madd(load(c + 8), splat(p.z), r);
+        store3(out + i, r, i + 1 == count);
+    }
+}
+
+void transformBoxes(float3* outCenters, float3* outHalfExtents,
+        mat4f const* m, float3 const* centers, float3 const* halfExtents, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        float const* const c = &m[i][0][0];
+        vfloat4 const c0 = load(c + 0);
+        vfloat4 const c1 = load(c + 4);
+        vfloat4 const c2 = load(c + 8);
+        float3 const p = centers[i];
+        float3 const h = halfExtents[i];
+        vfloat4 center = madd(c0, splat(p.x), load(c + 12));
+        center = madd(c1, splat(p.y), center);
+        center = madd(c2, splat(p.z), center);
+        vfloat4 extent = mul(abs(c0), splat(h.x));
+        extent = madd(abs(c1), splat(h.y), extent);
+        extent = madd(abs(c2), splat(h.z), extent);
+        bool const last = i + 1 == count;
+        store3(outCenters + i, center, last);
+        store3(outHalfExtents + i, extent, last);
+    }
+}
+
+void rotationMatrices(mat4f* out, quatf const* q, size_t count) noexcept {
+    vfloat4 const zero = splat(0.0f);
+    vfloat4 const one = splat(1.0f);
+    vfloat4 const two = splat(2.0f);
+    float4 const unitW{ 0, 0, 0, 1 };
+    vfloat4 const w1 = load(&unitW.x);
+
+    // four quaternions at a time, in structure-of-arrays form
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vfloat4 x = load(&q[i + 0].x);
+        vfloat4 y = load(&q[i + 1].x);
+        vfloat4 z = load(&q[i + 2].x);
+        vfloat4 w = load(&q[i + 3].x);
+        transpose(x, y, z, w);
+
+        // same as TMat33::rotation(quat)
+        vfloat4 const n = madd(x, x, madd(y, y, madd(z, z, mul(w, w))));
+        vfloat4 const s = selectPositive(n, div(two, n));
+        vfloat4 const xs = mul(x, s);
+        vfloat4 const ys = mul(y, s);
+        vfloat4 const zs = mul(z, s);
+        vfloat4 const xx = mul(xs, x);
+        vfloat4 const xy = mul(xs, y);
+        vfloat4 const xz = mul(xs, z);
+        vfloat4 const xw = mul(xs, w);
+        vfloat4 const yy = mul(ys, y);
+        vfloat4 const yz = mul(ys, z);
+        vfloat4 const yw = mul(ys, w);
+        vfloat4 const zz = mul(zs, z);
+        vfloat4 const zw = mul(zs, w);
+
+        vfloat4 c0x = sub(sub(one, yy), zz), c0y = add(xy, zw), c0z = sub(xz, yw), c0w = zero;
+        vfloat4 c1x = sub(xy, zw), c1y = sub(sub(one, xx), zz), c1z = add(yz, xw), c1w = zero;
+        vfloat4 c2x = add(xz, yw), c2y = sub(yz, xw), c2z = sub(sub(one, xx), yy), c2w = zero;
+        transpose(c0x, c0y, c0z, c0w);
+        transpose(c1x, c1y, c1z, c1w);
+        transpose(c2x, c2y, c2z, c2w);
+
+        vfloat4 const c0[4] = { c0x, c0y, c0z, c0w };
+        vfloat4 const c1[4] = { c1x, c1y, c1z, c1w };
+        vfloat4 const c2[4] = { c2x, c2y, c2z, c2w };
+        for (size_t k = 0; k < 4; k++) {
+            float* const o = &out[i + k][0][0];
+            store(o + 0, c0[k]);
+            store(o + 4, c1[k]);
+            store(o + 8, c2[k]);
+            store(o + 12, w1);
+        }
+    }
+
+    for (; i < count; i++) {
+        out[i] = mat4f{ mat3f{ q[i] }};
+    }
+}
+
+#else
+
+void multiply(mat4f* out, mat4f const* lhs, mat4f const* rhs, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = lhs[i] * rhs[i];
+    }
+}
+
+void transformPoints(float3* out, mat4f const* m, float3 const* points, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (m[i] * float4{ points[i], 1 }).xyz;
+    }
+}
+
+void transformBoxes(float3* outCenters, float3* outHalfExtents,
+        mat4f const* m, float3 const* centers, float3 const* halfExtents, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        mat3f const u = m[i].upperLeft();
+        outCenters[i] = u * centers[i] + m[i][3].xyz;
+        outHalfExtents[i] = abs(u) * halfExtents[i];
+    }
+}
+
+void rotationMatrices(mat4f* out, quatf const* q, size_t count) noexcept {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = mat4f{ mat3f{ q[i] }};
+    }
+}
+
+#endif
+
+} // namespace filament::math::batch
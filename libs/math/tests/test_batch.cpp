@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <math/batch.h>
+#include <math/mat3.h>
+#include <math/mat4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+using namespace filament::math;
+
+class BatchTest : public testing::Test {
+protected:
+    // odd, to exercise the tails
+    static constexpr size_t COUNT = 67;
+
+    void SetUp() override {
+        std::default_random_engine generator(82828);
+        std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+        auto rand = [&]() { return distribution(generator); };
+        for (size_t i = 0; i < COUNT; i++) {
+            quatf const q = normalize(quatf{ rand(), rand(), rand(), rand() });
+            quats.push_back(q * rand());
+            affine.push_back(mat4f::translation(float3{ rand(), rand(), rand() }) *
+                    mat4f(q) * mat4f::scaling(float3{ rand(), rand(), rand() }));
+            mat4f m;
+            for (size_t j = 0; j < 16; j++) {
+                m[j / 4][j % 4] = rand();
+            }
+            matrices.push_back(m);
+            points.push_back({ rand(), rand(), rand() });
+            extents.push_back(abs(float3{ rand(), rand(), rand() }));
+        }
+    }
+
+    std::vector<quatf> quats;
+    std::vector<mat4f> affine;
+    std::vector<mat4f> matrices;
+    std::vector<float3> points;
+    std::vector<float3> extents;
+};
+
+#define EXPECT_VEC_NEAR(expected, actual, size, tolerance)                      \
+    do {                                                                        \
+        for (size_t k_ = 0; k_ < (size); k_++) {                                \
+            EXPECT_NEAR((expected)[k_], (actual)[k_], (tolerance));             \
+        }                                                                       \
+    } while (0)
+
+TEST_F(BatchTest, Multiply) {
+    std::vector<mat4f> out(COUNT);
+    batch::multiply(out.data(), matrices.data(), affine.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        mat4f const expected = matrices[i] * affine[i];
+        for (size_t c = 0; c < 4; c++) {
+            EXPECT_VEC_NEAR(expected[c], out[i][c], 4, 1e-3f * (1.0f + length(expected[c])));
+        }
+    }
+}
+
+TEST_F(BatchTest, TransformPoints) {
+    // guard element, must not be written
+    std::vector<float3> out(COUNT + 1, float3{ 42 });
+    batch::transformPoints(out.data(), affine.data(), points.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        float3 const expected = (affine[i] * float4{ points[i], 1 }).xyz;
+        EXPECT_VEC_NEAR(expected, out[i], 3, 1e-3f * (1.0f + length(expected)));
+    }
+    EXPECT_EQ(out[COUNT], float3{ 42 });
+}
+
+TEST_F(BatchTest, TransformBoxes) {
+    std::vector<float3> centers(COUNT + 1, float3{ 42 });
+    std::vector<float3> halfExtents(COUNT + 1, float3{ 42 });
+    batch::transformBoxes(centers.data(), halfExtents.data(),
+            affine.data(), points.data(), extents.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        mat3f const m = affine[i].upperLeft();
+        float3 const center = m * points[i] + affine[i][3].xyz;
+        float3 const halfExtent = abs(m) * extents[i];
+        EXPECT_VEC_NEAR(center, centers[i], 3, 1e-3f * (1.0f + length(center)));
+        EXPECT_VEC_NEAR(halfExtent, halfExtents[i], 3, 1e-3f * (1.0f + length(halfExtent)));
+    }
+    EXPECT_EQ(centers[COUNT], float3{ 42 });
+    EXPECT_EQ(halfExtents[COUNT], float3{ 42 });
+}
+
+TEST_F(BatchTest, RotationMatrices) {
+    quats[3] = quatf{ 0, 0, 0, 0 };
+    std::vector<mat4f> out(COUNT);
+    batch::rotationMatrices(out.data(), quats.data(), COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        mat4f const expected{ mat3f{ quats[i] }};
+        for (size_t c = 0; c < 4; c++) {
+            EXPECT_VEC_NEAR(expected[c], out[i][c], 4, 1e-5f);
+        }
+    }
+}
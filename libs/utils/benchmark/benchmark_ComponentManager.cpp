@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <utils/EntityManager.h>
+#include <utils/SingleInstanceComponentManager.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace utils;
+
+// Looks-up the instances of entities in random order, like FScene::prepare() does for each
+// renderable's transform. range(0) is the number of entities, range(1) enables direct lookup.
+static void BM_ComponentManagerGetInstance(benchmark::State& state) {
+    using Manager = SingleInstanceComponentManager<float>;
+    EntityManager& em = EntityManager::get();
+    size_t const count = size_t(state.range(0));
+
+    Manager cm;
+    if (state.range(1)) {
+        cm.enableDirectLookup(EntityManager::getMaxEntityCount() * sizeof(Manager::Instance));
+    }
+
+    std::vector<Entity> entities(count);
+    em.create(count, entities.data());
+    for (Entity e : entities) {
+        cm.addComponent(e);
+    }
+    std::shuffle(entities.begin(), entities.end(), std::default_random_engine{ 123 });
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            for (Entity e : entities) {
+                benchmark::DoNotOptimize(cm.getInstance(e));
+            }
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * count));
+
+    for (Entity e : entities) {
+        cm.removeComponent(e);
+    }
+    em.destroy(count, entities.data());
+}
+
+BENCHMARK(BM_ComponentManagerGetInstance)
+        ->RangeMultiplier(8)->Ranges({{ 1024, 65536 }, { 0, 1 }});
@@ -21,6 +21,13 @@
 
 #include <benchmark/benchmark.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <math.h>
+
 using namespace utils;
 
 
@@ -78,7 +85,111 @@ static void BM_JobSystemParallelFor(benchmark::State& state) {
     js.emancipate();
 }
 
+// parallel_for over items doing a small amount of real work, with an increasing number of
+// threads in the pool. This measures how well the JobSystem scales, including the cost of
+// waking-up and putting threads back to sleep at each iteration.
+static void BM_JobSystemParallelForScaling(benchmark::State& state) {
+    JobSystem js(state.range(0));
+    js.adopt();
+
+    constexpr uint32_t COUNT = 65536;
+    std::vector<float> data(COUNT, 1.0f);
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto job = jobs::parallel_for(js, nullptr, data.data(), COUNT,
+                    [](float* p, uint32_t count) {
+                        for (uint32_t i = 0; i < count; i++) {
+                            p[i] = sqrtf(p[i] * p[i] + 1.0f);
+                        }
+                    }, jobs::CountSplitter<1024>());
+            js.runAndWait(job);
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * COUNT);
+    state.counters["threads"] = double(js.getThreadCount() + 1);
+
+    js.emancipate();
+}
+
+// Same as above, with the range processed in chunks handed out by an atomic counter.
+static void BM_JobSystemParallelForChunksScaling(benchmark::State& state) {
+    JobSystem js(state.range(0));
+    js.adopt();
+
+    constexpr uint32_t COUNT = 65536;
+    std::vector<float> data(COUNT, 1.0f);
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            auto job = jobs::parallel_for(js, nullptr, data.data(), COUNT,
+                    [](float* p, uint32_t count) {
+                        for (uint32_t i = 0; i < count; i++) {
+                            p[i] = sqrtf(p[i] * p[i] + 1.0f);
+                        }
+                    }, jobs::ChunkSplitter<1024>());
+            js.runAndWait(job);
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * COUNT);
+    state.counters["threads"] = double(js.getThreadCount() + 1);
+
+    js.emancipate();
+}
+
+// Latency of a frame-like parallel_for while the JobSystem is kept busy with long-running jobs.
+// With arg 0 the load is submitted as CRITICAL jobs (i.e. it competes with the frame), with
+// arg 1 it is submitted as BACKGROUND jobs.
+static void BM_JobSystemFrameLatencyUnderLoad(benchmark::State& state) {
+    JobSystem js;
+    js.adopt();
+
+    auto const priority = state.range(0) ?
+            JobSystem::JobPriority::BACKGROUND : JobSystem::JobPriority::CRITICAL;
+    size_t const maxPendingCount = js.getThreadCount() * 2;
+    std::atomic<size_t> pendingCount = { 0 };
+
+    auto backgroundWork = [&pendingCount](JobSystem&, JobSystem::Job*) {
+        // keep a thread busy for 1ms, e.g. decoding a texture
+        auto const end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        pendingCount.fetch_sub(1, std::memory_order_relaxed);
+    };
+
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            state.PauseTiming();
+            while (pendingCount.load(std::memory_order_relaxed) < maxPendingCount) {
+                pendingCount.fetch_add(1, std::memory_order_relaxed);
+                JobSystem::Job* job = js.createJob(nullptr, backgroundWork);
+                js.setPriority(job, priority);
+                js.run(job);
+            }
+            state.ResumeTiming();
+
+            auto job = jobs::parallel_for(js, nullptr, 0, 4096,
+                    [](uint32_t start, uint32_t count) { }, jobs::CountSplitter<64>());
+            js.runAndWait(job);
+        }
+    }
+
+    while (pendingCount.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+    }
+
+    js.emancipate();
+}
+
 
 BENCHMARK(BM_JobSystem);
 BENCHMARK(BM_JobSystemAsChildren4k);
 BENCHMARK(BM_JobSystemParallelFor);
+BENCHMARK(BM_JobSystemParallelForScaling)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+BENCHMARK(BM_JobSystemParallelForChunksScaling)->RangeMultiplier(2)->Range(1, 32)->UseRealTime();
+BENCHMARK(BM_JobSystemFrameLatencyUnderLoad)->Arg(0)->Arg(1)->UseRealTime();
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_CPUTOPOLOGY_H
+#define TNT_UTILS_CPUTOPOLOGY_H
+
+#include <utils/compiler.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * Describes the CPUs this process can run on, grouped by cache domain (CPUs sharing a last-level
+ * cache) and NUMA node.
+ *
+ * The topology is read from /sys on Linux and Android. On other platforms, or if that information
+ * is not available, all CPUs are reported in a single cache domain on node 0.
+ */
+class UTILS_PUBLIC CpuTopology {
+public:
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+
+    struct CacheDomain {
+        uint32_t node = 0;              // NUMA node of this cache domain
+        std::vector<uint32_t> cpus;     // logical CPUs sharing the last-level cache, ascending
+    };
+
+    // reads the current topology, this is not cheap (it does file I/O on Linux)
+    static CpuTopology query() noexcept;
+
+    // returns the CPU the calling thread is running on, or 0 if unknown
+    static uint32_t getCurrentCpu() noexcept;
+
+    size_t getCpuCount() const noexcept { return mCpuCount; }
+    size_t getNodeCount() const noexcept { return mNodeCount; }
+
+    // number of CPUs of a given NUMA node
+    size_t getNodeCpuCount(uint32_t node) const noexcept;
+
+    // cache domains, sorted by node and first CPU
+    std::vector<CacheDomain> const& getCacheDomains() const noexcept { return mCacheDomains; }
+
+    // returns the index of the cache domain of a CPU, or INVALID
+    uint32_t getCacheDomain(uint32_t cpu) const noexcept;
+
+    // returns the NUMA node of a CPU, or INVALID
+    uint32_t getNode(uint32_t cpu) const noexcept;
+
+private:
+    std::vector<CacheDomain> mCacheDomains;
+    size_t mCpuCount = 0;
+    size_t mNodeCount = 0;
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_CPUTOPOLOGY_H
@@ -34,6 +34,9 @@
 
 namespace utils {
 
+template <typename ... Elements>
+class SingleInstanceComponentManager;
+
 class UTILS_PUBLIC EntityManager {
 public:
     // Get the global EntityManager. It is recommended to cache this value.
@@ -108,11 +111,15 @@ public:
 
 private:
     friend class EntityManagerImpl;
+    template <typename ... Elements>
+    friend class SingleInstanceComponentManager;
     EntityManager();
     ~EntityManager();
 
     // GENERATION_SHIFT determines how many simultaneous Entities are available, the
-    // minimum memory requirement is 2^GENERATION_SHIFT bytes.
+    // minimum memory requirement is 2^GENERATION_SHIFT bytes for the generations. The list of
+    // free indices grows in 32 KiB chunks as entities are destroyed, up to
+    // 2^GENERATION_SHIFT * 8 bytes.
     static constexpr const int GENERATION_SHIFT = 17;
     static constexpr const size_t RAW_INDEX_COUNT = (1 << GENERATION_SHIFT);
     static constexpr const Entity::Type INDEX_MASK = (1 << GENERATION_SHIFT) - 1u;
@@ -19,6 +19,7 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <thread>
@@ -39,8 +40,13 @@
 namespace utils {
 
 class JobSystem {
-    static constexpr size_t MAX_JOB_COUNT = 16384;
-    static_assert(MAX_JOB_COUNT <= 0x7FFE, "MAX_JOB_COUNT must be <= 0x7FFE");
+    // Jobs are allocated in segments of JOB_SEGMENT_SIZE jobs, which are added as needed.
+    // Jobs are referenced by 16-bits indices, which limits their total count.
+    static constexpr size_t MAX_JOB_COUNT = 32768;
+    static constexpr size_t JOB_SEGMENT_SIZE = 4096;
+    static constexpr size_t JOB_SEGMENT_COUNT = MAX_JOB_COUNT / JOB_SEGMENT_SIZE;
+    static_assert(MAX_JOB_COUNT <= 0x8000, "MAX_JOB_COUNT must be <= 0x8000");
+    static_assert(MAX_JOB_COUNT % JOB_SEGMENT_SIZE == 0);
     using WorkQueue = WorkStealingDequeue<uint16_t, MAX_JOB_COUNT>;
 
 public:
@@ -48,6 +54,17 @@ public:
 
     using JobFunc = void(*)(void*, JobSystem&, Job*);
 
+    /*
+     * Jobs are scheduled by priority class, each class has its own queue in each thread.
+     * Threads always prefer CRITICAL jobs; BACKGROUND jobs are only run by idle threads (or by
+     * threads waiting on their own BACKGROUND children), and only a limited number of threads
+     * run them concurrently, so that long-running BACKGROUND jobs can't delay CRITICAL work.
+     */
+    enum class JobPriority : uint8_t {
+        CRITICAL,       // the default, e.g. work needed to produce the current frame
+        BACKGROUND,     // e.g. asset loading or texture decoding
+    };
+
     class alignas(CACHELINE_SIZE) Job {
     public:
         Job() noexcept {} /* = default; */ /* clang bug */ // NOLINT(modernize-use-equals-default,cppcoreguidelines-pro-type-member-init)
@@ -72,11 +89,24 @@ public:
         uint16_t parent;                                        //  2 |  2
         std::atomic<uint16_t> runningJobCount = { 1 };          //  2 |  2
         mutable std::atomic<uint16_t> refCount = { 1 };         //  2 |  2
-                                                                //  6 |  2 (padding)
+        JobPriority priority = JobPriority::CRITICAL;           //  1 |  1
+                                                                //  5 |  1 (padding)
                                                                 // 64 | 64
     };
 
-    explicit JobSystem(size_t threadCount = 0, size_t adoptableThreadsCount = 1) noexcept;
+    /*
+     * How worker threads are pinned to CPUs. In both cases, worker threads are spread across the
+     * cache domains (CPUs sharing a last-level cache, see CpuTopology) of the NUMA node of the
+     * thread creating the JobSystem first, and steal work preferably from threads of their
+     * own cache domain.
+     */
+    enum class ThreadAffinity : uint8_t {
+        CPU,            // each worker thread is pinned to a single CPU (the default)
+        CACHE_DOMAIN,   // worker threads can run on any CPU of their cache domain
+    };
+
+    explicit JobSystem(size_t threadCount = 0, size_t adoptableThreadsCount = 1,
+            ThreadAffinity threadAffinity = ThreadAffinity::CPU) noexcept;
 
     ~JobSystem();
 
@@ -99,8 +129,17 @@ public:
     Job* setMasterJob(Job* job) noexcept { return setRootJob(job); }
 
 
+    // Jobs inherit the priority of their parent, jobs without a parent are CRITICAL.
     Job* create(Job* parent, JobFunc func) noexcept;
 
+    /*
+     * Sets the priority of a job, this must be called before the job is run, and before
+     * its children are created (which inherit it).
+     */
+    void setPriority(Job* job, JobPriority priority) noexcept {
+        job->priority = priority;
+    }
+
     // NOTE: All methods below must be called from the same thread and that thread must be
     // owned by JobSystem's thread pool.
 
@@ -307,6 +346,17 @@ public:
 
     size_t getThreadCount() const { return mThreadCount; }
 
+    // Returns the maximum number of threads that can run jobs, i.e. the thread pool and the
+    // adoptable threads.
+    size_t getMaxThreadCount() const noexcept { return mThreadStates.size(); }
+
+    /*
+     * Returns the index of the calling thread, in [0, getMaxThreadCount()). This can be used to
+     * access per-thread data without synchronization.
+     * Current thread must be owned by JobSystem's thread pool. See adopt().
+     */
+    uint32_t getThreadIndex() noexcept;
+
 private:
     // this is just to avoid using std::default_random_engine, since we're in a public header.
     class default_random_engine {
@@ -321,9 +371,18 @@ private:
         }
     };
 
+    static constexpr size_t PRIORITY_COUNT = 2;
+    static constexpr uint16_t NO_PARENT = 0xFFFF;
+    static constexpr uint16_t NO_CACHE_DOMAIN = 0xFFFF;
+
+    struct CacheDomain {
+        std::vector<uint32_t> cpus;         // CPUs of this cache domain
+        std::vector<uint16_t> threads;      // worker threads running in this cache domain
+    };
+
     struct alignas(CACHELINE_SIZE) ThreadState {    // this causes 40-bytes padding
         // make sure storage is cache-line aligned
-        WorkQueue workQueue;
+        WorkQueue workQueues[PRIORITY_COUNT];       // one queue per JobPriority
 
         // these are not accessed by the worker threads
         alignas(CACHELINE_SIZE)     // this causes 56-bytes padding
@@ -331,43 +390,71 @@ private:
         std::thread thread;
         default_random_engine rndGen;
         uint32_t id;
+        uint32_t backgroundJobDepth = 0;    // # of nested BACKGROUND jobs this thread is running
+        int32_t cpu = -1;                   // CPU this thread is pinned to, -1 if none
+        uint16_t cacheDomain = NO_CACHE_DOMAIN; // index in mCacheDomains
+
+        // each thread sleeps on its own condition, so it can be woken up individually
+        utils::Mutex parkLock;
+        utils::Condition parkCondition;
+        bool wakeup = false;
     };
 
     static_assert(sizeof(ThreadState) % CACHELINE_SIZE == 0,
             "ThreadState doesn't align to a cache line");
 
     ThreadState& getState() noexcept;
+    ThreadState& getStateFromThreadMap() noexcept;
 
     void incRef(Job const* job) noexcept;
     void decRef(Job const* job) noexcept;
 
     Job* allocateJob() noexcept;
+    Job* growJobPool(size_t segmentCount) noexcept;
+    void freeJob(Job const* job) noexcept;
+    uint16_t getJobIndex(Job const* job) const noexcept;
+    Job* getJob(size_t index) const noexcept;
     JobSystem::ThreadState* getStateToStealFrom(JobSystem::ThreadState& state) noexcept;
     bool hasJobCompleted(Job const* job) noexcept;
 
     void requestExit() noexcept;
     bool exitRequested() const noexcept;
-    bool hasActiveJobs() const noexcept;
+    bool hasActiveJobs(JobPriority priority) const noexcept;
+    bool canWaiterRunBackgroundJobs(ThreadState const& state, Job const* job) const noexcept;
+    bool acquireBackgroundSlot(ThreadState& state) noexcept;
+    void releaseBackgroundSlot(ThreadState& state) noexcept;
 
+    void setThreadAffinity(ThreadState const& state) const noexcept;
     void loop(ThreadState* state) noexcept;
-    bool execute(JobSystem::ThreadState& state) noexcept;
-    Job* steal(JobSystem::ThreadState& state) noexcept;
+    bool execute(JobSystem::ThreadState& state, bool allowBackground) noexcept;
+    Job* steal(JobSystem::ThreadState& state, JobPriority priority) noexcept;
     void finish(Job* job) noexcept;
 
-    void put(WorkQueue& workQueue, Job* job) noexcept;
-    Job* pop(WorkQueue& workQueue) noexcept;
-    Job* steal(WorkQueue& workQueue) noexcept;
+    void put(ThreadState& state, Job* job) noexcept;
+    Job* pop(WorkQueue& workQueue, JobPriority priority) noexcept;
+    Job* steal(WorkQueue& workQueue, JobPriority priority) noexcept;
 
-    void wait(std::unique_lock<Mutex>& lock, Job* job = nullptr) noexcept;
+    void park(ThreadState& state, Job const* job = nullptr) noexcept;
+    void wait(std::unique_lock<Mutex>& lock, ThreadState& state, Job const* job) noexcept;
+    static void unpark(ThreadState& state) noexcept;
+    void unparkAll(uint64_t threads) noexcept;
     void wakeAll() noexcept;
-    void wakeOne() noexcept;
+    void wakeOne(JobPriority priority) noexcept;
+    void wakeWaiters() noexcept;
 
     // these have thread contention, keep them together
-    utils::Mutex mWaiterLock;
-    utils::Condition mWaiterCondition;
-
-    std::atomic<uint32_t> mActiveJobs = { 0 };
-    utils::Arena<utils::ThreadSafeObjectPoolAllocator<Job>, LockingPolicy::NoLock> mJobPool;
+    std::atomic<uint64_t> mParkedThreads = { 0 };       // one bit per parked thread
+    std::atomic<uint64_t> mWaitingThreads = { 0 };      // parked threads waiting on a job
+    std::atomic<uint32_t> mActiveJobs[PRIORITY_COUNT] = {};  // per JobPriority
+    std::atomic<uint32_t> mBackgroundThreads = { 0 };   // # of threads running BACKGROUND jobs
+
+    struct JobSegment {
+        explicit JobSegment(Job* storage) noexcept
+                : storage(storage), allocator(storage, storage + JOB_SEGMENT_SIZE) {
+        }
+        Job* const storage;                             // JOB_SEGMENT_SIZE jobs
+        utils::ThreadSafeObjectPoolAllocator<Job> allocator;
+    };
 
     template <typename T>
     using aligned_vector = std::vector<T, utils::STLAlignedAllocator<T>>;
@@ -382,9 +469,15 @@ private:
     aligned_vector<ThreadState> mThreadStates;          // actual data is stored offline
     std::atomic<bool> mExitRequested = { false };       // this one is almost never written
     std::atomic<uint16_t> mAdoptedThreads = { 0 };      // this one is almost never written
-    Job* const mJobStorageBase;                         // Base for conversion to indices
+    std::atomic<uint32_t> mJobSegmentCount = { 0 };    // this one is rarely written
+    JobSegment* mJobSegments[JOB_SEGMENT_COUNT] = {};   // only grows, protected by the above
+    utils::Mutex mJobSegmentLock;                       // held while growing the job pool
+    uint32_t const mId;                                 // unique id, keys the thread_local cache
     uint16_t mThreadCount = 0;                          // total # of threads in the pool
     uint8_t mParallelSplitCount = 0;                    // # of split allowable in parallel_for
+    uint16_t mBackgroundThreadLimit = 1;                // max # of threads running BACKGROUND jobs
+    ThreadAffinity mThreadAffinity = ThreadAffinity::CPU;
+    std::vector<CacheDomain> mCacheDomains;             // only the ones we have threads in
     Job* mRootJob = nullptr;
 
     utils::SpinLock mThreadMapLock; // this should have very little contention
@@ -488,8 +581,74 @@ private:
     SplitterType splitter;      // 1
 };
 
+template<typename F>
+struct ParallelForChunksJobData {
+    using Functor = F;
+    using JobData = ParallelForChunksJobData;
+    using size_type = uint32_t;
+
+    ParallelForChunksJobData(size_type start, size_type count, size_type chunkSize,
+            Functor functor) noexcept
+            : start(start), count(count), chunkSize(chunkSize),
+              chunkCount((count + chunkSize - 1) / chunkSize),
+              functor(std::move(functor)) {
+    }
+
+    ParallelForChunksJobData(ParallelForChunksJobData&& rhs) noexcept
+            : start(rhs.start), count(rhs.count), chunkSize(rhs.chunkSize),
+              chunkCount(rhs.chunkCount),
+              nextChunk(rhs.nextChunk.load(std::memory_order_relaxed)),
+              functor(std::move(rhs.functor)) {
+    }
+
+    void parallelWithChunks(JobSystem& js, JobSystem::Job* parent) noexcept {
+        assert(parent);
+
+        // one job per thread is all we need, they all pick chunks until there are none left
+        size_t const jobCount = std::min(size_t(chunkCount), js.getThreadCount() + 1);
+        JobSystem::Job* helpers = js.createJob(parent);
+        if (UTILS_LIKELY(helpers)) {
+            for (size_t i = 1; i < jobCount; i++) {
+                JobSystem::Job* job = js.createJob<JobData, &JobData::processChunks>(helpers, this);
+                if (UTILS_UNLIKELY(job == nullptr)) {
+                    // couldn't create a job, we'll just process more chunks ourselves
+                    break;
+                }
+                js.run(job);
+            }
+        }
+
+        processChunks(js, parent);
+
+        // the helpers reference us, so we must wait for them; by now they can only be
+        // finishing their last chunk.
+        if (UTILS_LIKELY(helpers)) {
+            js.runAndWait(helpers);
+        }
+    }
+
+    void processChunks(JobSystem&, JobSystem::Job*) noexcept {
+        size_type chunk;
+        while ((chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount) {
+            size_type const offset = chunk * chunkSize;
+            functor(start + offset, std::min(chunkSize, count - offset));
+        }
+    }
+
+private:
+    size_type start;                            // 4
+    size_type count;                            // 4
+    size_type chunkSize;                        // 4
+    size_type chunkCount;                       // 4
+    std::atomic<size_type> nextChunk = { 0 };   // 4
+    Functor functor;                            // ?
+};
+
 } // namespace details
 
+template <size_t CHUNK_SIZE>
+class ChunkSplitter;
+
 
 // parallel jobs with start/count indices
 template<typename S, typename F>
@@ -500,6 +659,16 @@ JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
     return js.createJob<JobData, &JobData::parallelWithJobs>(parent, std::move(jobData));
 }
 
+// parallel jobs with start/count indices, processed in chunks (see ChunkSplitter)
+template<size_t CHUNK_SIZE, typename F>
+JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
+        uint32_t start, uint32_t count, F functor, const ChunkSplitter<CHUNK_SIZE>&) noexcept {
+    static_assert(CHUNK_SIZE > 0, "CHUNK_SIZE must be > 0");
+    using JobData = details::ParallelForChunksJobData<F>;
+    JobData jobData(start, count, uint32_t(CHUNK_SIZE), std::move(functor));
+    return js.createJob<JobData, &JobData::parallelWithChunks>(parent, std::move(jobData));
+}
+
 // parallel jobs with pointer/count
 template<typename T, typename S, typename F>
 JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
@@ -507,9 +676,7 @@ JobSystem::Job* parallel_for(JobSystem& js, JobSystem::Job* parent,
     auto user = [data, f = std::move(functor)](uint32_t s, uint32_t c) {
         f(data + s, c);
     };
-    using JobData = details::ParallelForJobData<S, decltype(user)>;
-    JobData jobData(0, count, 0, std::move(user), splitter);
-    return js.createJob<JobData, &JobData::parallelWithJobs>(parent, std::move(jobData));
+    return parallel_for(js, parent, 0, count, std::move(user), splitter);
 }
 
 // parallel jobs on a Slice<>
@@ -528,6 +695,15 @@ public:
     }
 };
 
+/*
+ * Instead of recursively splitting the range into jobs, ChunkSplitter creates one job per thread,
+ * and these jobs pick chunks of CHUNK_SIZE items from the range using an atomic counter. The
+ * number of jobs doesn't depend on the size of the range, and the load is balanced dynamically.
+ */
+template <size_t CHUNK_SIZE>
+class ChunkSplitter {
+};
+
 } // namespace jobs
 } // namespace utils
 
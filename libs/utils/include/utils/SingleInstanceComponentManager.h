@@ -25,6 +25,10 @@
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -90,12 +94,32 @@ public:
     }
 
     // Get instance of this Entity to be used to retrieve components
-    UTILS_NOINLINE
     Instance getInstance(Entity e) const noexcept {
-        auto const& map = mInstanceMap;
-        // find() generates quite a bit of code
-        auto pos = map.find(e);
-        return pos != map.end() ? pos->second : 0;
+        // the direct lookup is small enough to be inlined
+        if (mDirectLookupPageCount) {
+            uint32_t const* const slot = findSlot(e);
+            if (slot && (*slot & INDEX_MASK) && getGeneration(*slot) == getGeneration(e.getId())) {
+                return *slot & INDEX_MASK;
+            }
+            if (UTILS_LIKELY(mInstanceMap.empty())) {
+                return 0;
+            }
+        }
+        return getInstanceFromMap(e);
+    }
+
+    /*
+     * Enables looking-up instances directly by entity index in pages of PAGE_SIZE instances,
+     * which are allocated as needed, instead of through a hash map. Lookups become an array
+     * read, at the cost of up to maxMemorySize bytes of memory. Entities that don't fit, or
+     * that share their index with a destroyed entity that still has a component, use the hash
+     * map.
+     * This must be called before any component is added.
+     */
+    void enableDirectLookup(size_t maxMemorySize) noexcept {
+        assert(empty());
+        mDirectLookupPageCount = std::min(maxMemorySize / (PAGE_SIZE * sizeof(uint32_t)),
+                (EntityManager::RAW_INDEX_COUNT + PAGE_SIZE - 1) / PAGE_SIZE);
     }
 
     // Returns the number of components (i.e. size of each array)
@@ -210,15 +234,18 @@ protected:
         assert(j);
         if (i && j) {
             // update the index map
-            auto& map = mInstanceMap;
             Entity& ei = elementAt<ENTITY_INDEX>(i);
             Entity& ej = elementAt<ENTITY_INDEX>(j);
+            // find where the instances are before changing anything, ei and ej could share
+            // their slot.
+            uint32_t* const si = ei ? findDirectSlot(ei, i) : nullptr;
+            uint32_t* const sj = ej ? findDirectSlot(ej, j) : nullptr;
             std::swap(ei, ej);
             if (ei) {
-                map[ei] = i;
+                setInstance(ei, i, sj);
             }
             if (ej) {
-                map[ej] = j;
+                setInstance(ej, j, si);
             }
         }
     }
@@ -257,8 +284,77 @@ protected:
     SoA mData;
 
 private:
+    static constexpr size_t PAGE_SIZE = 4096;
+    static constexpr uint32_t INDEX_MASK = EntityManager::INDEX_MASK;
+
+    static uint32_t getGeneration(uint32_t id) noexcept {
+        return id & ~INDEX_MASK;
+    }
+
+    // A slot stores the instance along with the generation of its entity, so lookups don't
+    // need to access the entity array. The entity's index is implied by the slot.
+    static uint32_t makeSlot(Entity e, Instance i) noexcept {
+        assert(i <= INDEX_MASK);
+        return getGeneration(e.getId()) | i;
+    }
+
+    UTILS_NOINLINE
+    Instance getInstanceFromMap(Entity e) const noexcept {
+        auto const& map = mInstanceMap;
+        // find() generates quite a bit of code
+        auto pos = map.find(e);
+        return pos != map.end() ? pos->second : 0;
+    }
+
+    uint32_t* findSlot(Entity e) const noexcept {
+        size_t const index = EntityManager::getIndex(e);
+        size_t const page = index / PAGE_SIZE;
+        return page < mPages.size() && mPages[page] ?
+               &mPages[page][index % PAGE_SIZE] : nullptr;
+    }
+
+    // returns the slot of e if it holds instance i
+    uint32_t* findDirectSlot(Entity e, Instance i) const noexcept {
+        uint32_t* const slot = mDirectLookupPageCount ? findSlot(e) : nullptr;
+        return slot && *slot == makeSlot(e, i) ? slot : nullptr;
+    }
+
+    // sets the instance of an entity, slot is where the entity currently is, if anywhere
+    void setInstance(Entity e, Instance i, uint32_t* slot) noexcept {
+        if (slot) {
+            *slot = makeSlot(e, i);
+        } else {
+            mInstanceMap[e] = i;
+        }
+    }
+
+    // adds a new entity
+    void insertInstance(Entity e, Instance i) {
+        if (mDirectLookupPageCount) {
+            size_t const index = EntityManager::getIndex(e);
+            size_t const page = index / PAGE_SIZE;
+            if (page < mDirectLookupPageCount) {
+                if (page >= mPages.size()) {
+                    mPages.resize(page + 1);
+                }
+                if (!mPages[page]) {
+                    mPages[page].reset(new uint32_t[PAGE_SIZE]());
+                }
+                uint32_t& slot = mPages[page][index % PAGE_SIZE];
+                if (!(slot & INDEX_MASK)) {
+                    slot = makeSlot(e, i);
+                    return;
+                }
+            }
+        }
+        mInstanceMap[e] = i;
+    }
+
     // maps an entity to an instance index
     tsl::robin_map<Entity, Instance, Entity::Hasher> mInstanceMap;
+    // maps an entity index to an instance index, when direct lookup is enabled
+    std::vector<std::unique_ptr<uint32_t[]>> mPages;
+    size_t mDirectLookupPageCount = 0;
     default_random_engine mRng;
 };
 
@@ -273,10 +369,10 @@ SingleInstanceComponentManager<Elements ...>::addComponent(Entity e) {
             mData.push_back(Structure{}).template back<ENTITY_INDEX>() = e;
             // index 0 is used when the component doesn't exist
             ci = Instance(mData.size() - 1);
-            mInstanceMap[e] = ci;
+            insertInstance(e, ci);
         } else {
             // if the entity already has this component, just return its instance
-            ci = mInstanceMap[e];
+            ci = getInstance(e);
         }
     }
     assert(ci != 0);
@@ -288,23 +384,29 @@ template <typename ... Elements>
 typename SingleInstanceComponentManager<Elements ...>::Instance
 SingleInstanceComponentManager<Elements ... >::removeComponent(Entity e) {
     auto& map = mInstanceMap;
-    auto pos = map.find(e);
-    if (UTILS_LIKELY(pos != map.end())) {
-        size_t index = pos->second;
-        assert(index != 0);
+    Instance const index = getInstance(e);
+    if (UTILS_LIKELY(index)) {
+        // find where the entities are before changing anything
+        uint32_t* const slot = findDirectSlot(e, index);
         size_t last = mData.size() - 1;
         if (last != index) {
+            Entity const lastEntity = mData.template elementAt<ENTITY_INDEX>(last);
+            uint32_t* const lastSlot = findDirectSlot(lastEntity, Instance(last));
+
             // move the last item to where we removed this component, as to keep
             // the array tightly packed.
             mData.forEach([index, last](auto* p) {
                 p[index] = std::move(p[last]);
             });
 
-            Entity lastEntity = mData.template elementAt<ENTITY_INDEX>(index);
-            map[lastEntity] = index;
+            setInstance(lastEntity, index, lastSlot);
         }
         mData.pop_back();
-        map.erase(pos);
+        if (slot) {
+            *slot = 0;
+        } else {
+            map.erase(e);
+        }
         return last;
     }
     return 0;
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_UTILS_TRACER_H
+#define TNT_UTILS_TRACER_H
+
+#include <utils/compiler.h>
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace utils {
+
+/*
+ * In-process trace recorder.
+ *
+ * While a capture is running, events are recorded into a ring buffer per thread, without locks.
+ * Each thread keeps its most recent events, dump() writes them as a Chrome / Perfetto JSON trace,
+ * which can be opened with ui.perfetto.dev or chrome://tracing.
+ * When a thread exits, its buffer is kept for its events, a new thread reuses it once none of
+ * them are part of the current capture (after clear() or the next startCapture()).
+ *
+ * On Linux, the SYSTRACE_ macros record into the Tracer (see utils/Systrace.h), on other
+ * platforms events can only be recorded with record().
+ */
+class UTILS_PUBLIC Tracer {
+public:
+    enum class EventType : uint8_t {
+        BEGIN,          // beginning of a section, must be balanced by END on the same thread
+        END,            // end of the current section
+        ASYNC_BEGIN,    // beginning of an asynchronous section, value is the cookie
+        ASYNC_END,      // end of an asynchronous section, value is the cookie
+        COUNTER,        // value of a counter
+        INSTANT,        // instantaneous event, value is reported as its "id"
+    };
+
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 32768;
+
+    // Starts recording events. The size of the per-thread buffers is set when a thread records
+    // its first event, it is rounded up to a power of two.
+    static void startCapture(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD) noexcept;
+
+    // Stops recording events, recorded events are kept until clear() or the next startCapture().
+    static void stopCapture() noexcept;
+
+    static bool isCapturing() noexcept {
+        return sCapturing.load(std::memory_order_relaxed);
+    }
+
+    // Forgets all events recorded so far.
+    static void clear() noexcept;
+
+    // Writes all recorded events to a JSON file. This can be called while capturing.
+    // Returns false if the file couldn't be written.
+    static bool dump(const char* path) noexcept;
+
+    // Records an event on the calling thread. Strings are not copied, they must stay valid until
+    // the events are dumped. This doesn't check isCapturing().
+    static void record(EventType type, const char* name, int64_t value = 0) noexcept;
+
+private:
+    static std::atomic<bool> sCapturing;
+};
+
+} // namespace utils
+
+#endif // TNT_UTILS_TRACER_H
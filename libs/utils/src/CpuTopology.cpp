@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/CpuTopology.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#    include <dirent.h>
+#    include <sched.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+#if defined(__linux__)
+
+// reads a small text file from sysfs, returns an empty string on failure
+std::string readSysFile(const char* path) noexcept {
+    std::string result;
+    FILE* file = fopen(path, "r");
+    if (file) {
+        char buffer[1024];
+        size_t const size = fread(buffer, 1, sizeof(buffer) - 1, file);
+        fclose(file);
+        result.assign(buffer, size);
+    }
+    return result;
+}
+
+// parses a cpu list, e.g. "0-3,8,10-11"
+std::vector<uint32_t> parseCpuList(std::string const& list) noexcept {
+    std::vector<uint32_t> cpus;
+    char const* p = list.c_str();
+    while (*p) {
+        char* end;
+        unsigned long const first = strtoul(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        unsigned long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtoul(p + 1, &end, 10);
+            p = end;
+        }
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(uint32_t(cpu));
+        }
+        if (*p == ',') {
+            p++;
+        } else {
+            break;
+        }
+    }
+    return cpus;
+}
+
+// the CPUs sharing the last-level cache of the given CPU
+std::vector<uint32_t> getLastLevelCacheCpus(uint32_t cpu) noexcept {
+    char path[128];
+    std::vector<uint32_t> cpus;
+    uint32_t maxLevel = 0;
+    for (uint32_t index = 0; ; index++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level",
+                cpu, index);
+        std::string const level = readSysFile(path);
+        if (level.empty()) {
+            break;
+        }
+        uint32_t const l = uint32_t(strtoul(level.c_str(), nullptr, 10));
+        if (l > maxLevel) {
+            snprintf(path, sizeof(path),
+                    "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+            std::vector<uint32_t> shared = parseCpuList(readSysFile(path));
+            if (!shared.empty()) {
+                maxLevel = l;
+                cpus = std::move(shared);
+            }
+        }
+    }
+    if (cpus.empty()) {
+        // cache information is often missing on Android, use the cluster, or the package
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/cluster_cpus_list",
+                cpu);
+        cpus = parseCpuList(readSysFile(path));
+    }
+    if (cpus.empty()) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_siblings_list",
+                cpu);
+        cpus = parseCpuList(readSysFile(path));
+    }
+    return cpus;
+}
+
+#endif
+
+} // anonymous namespace
+
+CpuTopology CpuTopology::query() noexcept {
+    CpuTopology topology;
+    auto& domains = topology.mCacheDomains;
+
+#if defined(__linux__)
+    // the CPUs we're allowed to run on
+    std::vector<uint32_t> cpus = parseCpuList(readSysFile("/sys/devices/system/cpu/online"));
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&allowed](uint32_t cpu) {
+            return cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed);
+        }), cpus.end());
+    }
+
+    // NUMA node of each CPU
+    std::vector<uint32_t> cpuToNode;
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        while (dirent const* entry = readdir(dir)) {
+            unsigned int node;
+            char c;
+            if (sscanf(entry->d_name, "node%u%c", &node, &c) != 1) {
+                continue;
+            }
+            char path[128];
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+            for (uint32_t cpu : parseCpuList(readSysFile(path))) {
+                if (cpu >= cpuToNode.size()) {
+                    cpuToNode.resize(cpu + 1, 0);
+                }
+                cpuToNode[cpu] = node;
+            }
+        }
+        closedir(dir);
+    }
+
+    for (uint32_t cpu : cpus) {
+        auto pos = std::find_if(domains.begin(), domains.end(), [cpu](CacheDomain const& domain) {
+            return std::binary_search(domain.cpus.begin(), domain.cpus.end(), cpu);
+        });
+        if (pos != domains.end()) {
+            continue;
+        }
+        // only keep the CPUs we can run on
+        std::vector<uint32_t> shared = getLastLevelCacheCpus(cpu);
+        shared.erase(std::remove_if(shared.begin(), shared.end(), [&cpus](uint32_t other) {
+            return !std::binary_search(cpus.begin(), cpus.end(), other);
+        }), shared.end());
+        if (shared.empty()) {
+            shared.push_back(cpu);
+        }
+        domains.push_back({ cpu < cpuToNode.size() ? cpuToNode[cpu] : 0, std::move(shared) });
+    }
+#endif
+
+    if (domains.empty()) {
+        CacheDomain domain;
+        domain.cpus.resize(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 0, c = domain.cpus.size(); i < c; i++) {
+            domain.cpus[i] = uint32_t(i);
+        }
+        domains.push_back(std::move(domain));
+    }
+
+    std::sort(domains.begin(), domains.end(), [](CacheDomain const& lhs, CacheDomain const& rhs) {
+        return lhs.node != rhs.node ? lhs.node < rhs.node : lhs.cpus.front() < rhs.cpus.front();
+    });
+
+    std::vector<uint32_t> nodes;
+    for (auto const& domain : domains) {
+        topology.mCpuCount += domain.cpus.size();
+        if (std::find(nodes.begin(), nodes.end(), domain.node) == nodes.end()) {
+            nodes.push_back(domain.node);
+        }
+    }
+    topology.mNodeCount = nodes.size();
+    return topology;
+}
+
+uint32_t CpuTopology::getCurrentCpu() noexcept {
+#if defined(__linux__)
+    int const cpu = sched_getcpu();
+    return cpu < 0 ? 0 : uint32_t(cpu);
+#else
+    return 0;
+#endif
+}
+
+size_t CpuTopology::getNodeCpuCount(uint32_t node) const noexcept {
+    size_t count = 0;
+    for (auto const& domain : mCacheDomains) {
+        if (domain.node == node) {
+            count += domain.cpus.size();
+        }
+    }
+    return count;
+}
+
+uint32_t CpuTopology::getCacheDomain(uint32_t cpu) const noexcept {
+    for (size_t i = 0, c = mCacheDomains.size(); i < c; i++) {
+        auto const& cpus = mCacheDomains[i].cpus;
+        if (std::binary_search(cpus.begin(), cpus.end(), cpu)) {
+            return uint32_t(i);
+        }
+    }
+    return INVALID;
+}
+
+uint32_t CpuTopology::getNode(uint32_t cpu) const noexcept {
+    uint32_t const domain = getCacheDomain(cpu);
+    return domain == INVALID ? INVALID : mCacheDomains[domain].node;
+}
+
+} // namespace utils
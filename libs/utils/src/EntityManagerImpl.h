@@ -19,6 +19,7 @@
 
 #include <utils/EntityManager.h>
 
+#include <utils/architecture.h>
 #include <utils/compiler.h>
 #include <utils/Entity.h>
 #include <utils/Mutex.h>
@@ -31,8 +32,11 @@
 #include <tsl/robin_map.h>
 #endif
 
-#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex> // for std::lock_guard
+#include <thread>
 #include <vector>
 
 
@@ -50,59 +54,66 @@ public:
 
     UTILS_NOINLINE
     size_t getEntityCount() const noexcept {
-        std::lock_guard<Mutex> const lock(mFreeListLock);
-        if (mCurrentIndex < RAW_INDEX_COUNT) {
-            return (mCurrentIndex - 1) - mFreeList.size();
-        } else {
-            return getMaxEntityCount() - mFreeList.size();
-        }
+        // this is only a snapshot if other threads are creating or destroying entities
+        size_t const currentIndex = std::min(size_t(mCurrentIndex.load(std::memory_order_relaxed)),
+                RAW_INDEX_COUNT);
+        return (currentIndex - 1) - mFreeList.size();
     }
 
     UTILS_NOINLINE
     void create(size_t n, Entity* entities) {
-        Entity::Type index{};
         auto& freeList = mFreeList;
-        uint8_t* const gens = mGens;
+        std::atomic<uint8_t>* const gens = getGenerations();
 
-        // this must be thread-safe, acquire the free-list mutex
-        std::lock_guard<Mutex> const lock(mFreeListLock);
-        Entity::Type currentIndex = mCurrentIndex;
-        for (size_t i = 0; i < n; i++) {
+        // This is thread-safe and lock-free.
+        size_t i = 0;
+        while (i < n) {
             // If we have more than a certain number of freed indices, get one from the list.
             // this is a trade-off between how often we recycle indices and how large the free list
-            // can grow.
-            if (UTILS_UNLIKELY(currentIndex >= RAW_INDEX_COUNT || freeList.size() >= MIN_FREE_INDICES)) {
+            // can grow. In the common case, we just grab the next indices. This works only until
+            // all indices have been used once, at which point we're always in the slower case.
+            // The idea is that we have enough indices that it doesn't happen in practice.
+            if (freeList.size() < MIN_FREE_INDICES) {
+                Entity::Type index;
+                size_t const count = allocateIndices(n - i, &index);
+                for (size_t j = 0; j < count; j++, i++, index++) {
+                    entities[i] = Entity{ makeIdentity(
+                            gens[index].load(std::memory_order_relaxed), index) };
+                }
+                if (count) {
+                    continue;
+                }
+            }
 
-                // this could only happen if we had gone through all the indices at least once
-                if (UTILS_UNLIKELY(freeList.empty())) {
+            Entity::Type index;
+            if (UTILS_UNLIKELY(!freeList.pop(&index))) {
+                // another thread could have emptied the free list since we looked
+                if (!allocateIndices(1, &index)) {
+                    // this could only happen if we had gone through all the indices at least once,
                     // return the null entity
-                    entities[i] = {};
+                    entities[i++] = {};
                     continue;
                 }
-
-                index = freeList.front();
-                freeList.pop_front();
-            } else {
-                // In the common case, we just grab the next index.
-                // This works only until all indices have been used once, at which point
-                // we're always in the slower case above. The idea is that we have enough indices
-                // that it doesn't happen in practice.
-                index = currentIndex++;
             }
-            entities[i] = Entity{ makeIdentity(gens[index], index) };
+            entities[i++] = Entity{
+                    makeIdentity(gens[index].load(std::memory_order_relaxed), index) };
+        }
+
 #if FILAMENT_UTILS_TRACK_ENTITIES
-            mDebugActiveEntities.emplace(entities[i], CallStack::unwind(5));
-#endif
+        std::lock_guard<Mutex> const lock(mDebugActiveEntitiesLock);
+        for (size_t j = 0; j < n; j++) {
+            if (entities[j]) {
+                mDebugActiveEntities.emplace(entities[j], CallStack::unwind(5));
+            }
         }
-        mCurrentIndex = currentIndex;
+#endif
     }
 
     UTILS_NOINLINE
     void destroy(size_t n, Entity* entities) noexcept {
         auto& freeList = mFreeList;
-        uint8_t* const gens = mGens;
+        std::atomic<uint8_t>* const gens = getGenerations();
 
-        std::unique_lock<Mutex> lock(mFreeListLock);
         for (size_t i = 0; i < n; i++) {
             if (!entities[i]) {
                 // behave like free(), ok to free null Entity.
@@ -113,44 +124,53 @@ public:
             assert(isAlive(entities[i]));
 
             // ... deleting a dead Entity will corrupt the internal state, so we protect ourselves
-            // against it. We don't guarantee anything about external state -- e.g. the listeners
-            // will be called.
-            if (isAlive(entities[i])) {
-                Entity::Type const index = getIndex(entities[i]);
-                freeList.push_back(index);
-
-                // The generation update doesn't require the lock because it's only used for isAlive()
-                // and entities work as weak references -- it just means that isAlive() could return
-                // true a little longer than expected in some other threads.
-                // We do need a memory fence though, it is provided by the mFreeListLock.unlock() below.
-                gens[index]++;
+            // against it, even if it happens concurrently: only the thread that bumps the
+            // generation recycles the index. We don't guarantee anything about external state
+            // -- e.g. the listeners will be called.
+            // The generation is only used for isAlive() and entities work as weak references --
+            // it just means that isAlive() could return true a little longer than expected in
+            // some other threads. The free list provides the memory fence with create().
+            Entity::Type const index = getIndex(entities[i]);
+            uint8_t generation = uint8_t(getGeneration(entities[i]));
+            if (gens[index].compare_exchange_strong(generation, uint8_t(generation + 1),
+                    std::memory_order_relaxed)) {
+                freeList.push(index);
+            }
+        }
 
 #if FILAMENT_UTILS_TRACK_ENTITIES
-                mDebugActiveEntities.erase(entities[i]);
-#endif
-            }
+        std::unique_lock<Mutex> lock(mDebugActiveEntitiesLock);
+        for (size_t i = 0; i < n; i++) {
+            mDebugActiveEntities.erase(entities[i]);
         }
         lock.unlock();
+#endif
 
-        // notify our listeners that some entities are being destroyed
-        auto listeners = getListeners();
-        for (auto const& l : listeners) {
-            l->onEntitiesDestroyed(n, entities);
+        // notify our listeners that some entities are being destroyed, most of the time there
+        // are none, in which case we don't need the lock.
+        if (mListenerCount.load(std::memory_order_relaxed)) {
+            auto listeners = getListeners();
+            for (auto const& l : listeners) {
+                l->onEntitiesDestroyed(n, entities);
+            }
         }
     }
 
     void registerListener(EntityManager::Listener* l) noexcept {
         std::lock_guard<Mutex> const lock(mListenerLock);
         mListeners.insert(l);
+        mListenerCount.store(uint32_t(mListeners.size()), std::memory_order_relaxed);
     }
 
     void unregisterListener(EntityManager::Listener* l) noexcept {
         std::lock_guard<Mutex> const lock(mListenerLock);
         mListeners.erase(l);
+        mListenerCount.store(uint32_t(mListeners.size()), std::memory_order_relaxed);
     }
 
 #if FILAMENT_UTILS_TRACK_ENTITIES
     std::vector<Entity> getActiveEntities() const {
+        std::lock_guard<Mutex> const lock(mDebugActiveEntitiesLock);
         std::vector<Entity> result(mDebugActiveEntities.size());
         auto p = result.begin();
         for (auto i : mDebugActiveEntities) {
@@ -160,6 +180,7 @@ public:
     }
 
     void dumpActiveEntities(utils::io::ostream& out) const {
+        std::lock_guard<Mutex> const lock(mDebugActiveEntitiesLock);
         for (auto i : mDebugActiveEntities) {
             out << "*** Entity " << i.first.getId() << " was allocated at:\n";
             out << i.second;
@@ -169,6 +190,152 @@ public:
 #endif
 
 private:
+    /*
+     * A lock-free, multi-producer, multi-consumer FIFO of free indices. Recycling indices in FIFO
+     * order maximizes the time before a generation wraps around for a given index.
+     * Each index can only be in the list once, so it can never overflow.
+     * The cells are allocated in chunks, the first time the list reaches them, so that the
+     * memory used grows with the number of destroyed entities rather than being reserved upfront.
+     */
+    class FreeList {
+    public:
+        FreeList() noexcept = default;
+
+        ~FreeList() noexcept {
+            for (auto& chunk : mChunks) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+
+        void push(Entity::Type index) noexcept {
+            Cell* cell;
+            uint32_t pos = mTail.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = getOrCreateCell(pos);
+                uint32_t const sequence = cell->sequence.load(std::memory_order_acquire);
+                int32_t const diff = int32_t(sequence - pos);
+                if (diff == 0) {
+                    if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else {
+                    if (UTILS_UNLIKELY(diff < 0)) {
+                        // The thread that popped this cell a lap ago hasn't released it yet, it
+                        // must have been preempted. The list can't be full, so it can't be
+                        // anything else.
+                        std::this_thread::yield();
+                    }
+                    // or another thread pushed an index in this cell, try the next one
+                    pos = mTail.load(std::memory_order_relaxed);
+                }
+            }
+            cell->index = index;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        bool pop(Entity::Type* index) noexcept {
+            Cell* cell;
+            uint32_t pos = mHead.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = getCell(pos);
+                if (UTILS_UNLIKELY(!cell)) {
+                    // nothing was ever pushed that far, the list is empty
+                    return false;
+                }
+                uint32_t const sequence = cell->sequence.load(std::memory_order_acquire);
+                int32_t const diff = int32_t(sequence - (pos + 1));
+                if (diff == 0) {
+                    if (mHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    // the list is empty
+                    return false;
+                } else {
+                    // another thread popped this cell, try the next one
+                    pos = mHead.load(std::memory_order_relaxed);
+                }
+            }
+            *index = cell->index;
+            cell->sequence.store(pos + RAW_INDEX_COUNT, std::memory_order_release);
+            return true;
+        }
+
+        size_t size() const noexcept {
+            uint32_t const head = mHead.load(std::memory_order_relaxed);
+            uint32_t const tail = mTail.load(std::memory_order_relaxed);
+            int32_t const size = int32_t(tail - head);
+            return size < 0 ? 0 : size_t(size);
+        }
+
+    private:
+        struct Cell {
+            std::atomic<uint32_t> sequence;
+            Entity::Type index;
+        };
+
+        static constexpr size_t CHUNK_SHIFT = 12;   // 4096 cells, 32 KiB
+        static constexpr size_t CHUNK_SIZE = 1u << CHUNK_SHIFT;
+        static constexpr size_t CHUNK_COUNT = RAW_INDEX_COUNT / CHUNK_SIZE;
+        static_assert(RAW_INDEX_COUNT % CHUNK_SIZE == 0);
+
+        Cell* getCell(uint32_t pos) const noexcept {
+            Cell* const chunk = mChunks[(pos & INDEX_MASK) >> CHUNK_SHIFT].load(
+                    std::memory_order_acquire);
+            return chunk ? &chunk[pos & (CHUNK_SIZE - 1)] : nullptr;
+        }
+
+        Cell* getOrCreateCell(uint32_t pos) noexcept {
+            Cell* const cell = getCell(pos);
+            if (UTILS_LIKELY(cell)) {
+                return cell;
+            }
+            // A chunk is reached for the first time during the first lap, so the sequence of
+            // each of its cells is its position.
+            uint32_t const first = (pos & INDEX_MASK) & ~uint32_t(CHUNK_SIZE - 1);
+            Cell* chunk = new Cell[CHUNK_SIZE];
+            for (uint32_t i = 0; i < CHUNK_SIZE; i++) {
+                chunk[i].sequence.store(first + i, std::memory_order_relaxed);
+            }
+            Cell* expected = nullptr;
+            auto& slot = mChunks[first >> CHUNK_SHIFT];
+            if (!slot.compare_exchange_strong(expected, chunk,
+                    std::memory_order_release, std::memory_order_acquire)) {
+                // another thread published this chunk first
+                delete[] chunk;
+                chunk = expected;
+            }
+            return &chunk[pos & (CHUNK_SIZE - 1)];
+        }
+
+        std::atomic<Cell*> mChunks[CHUNK_COUNT] = {};
+        // keep these on separate cache lines, they're written by different threads
+        alignas(CACHELINE_SIZE) std::atomic<uint32_t> mHead = { 0 };
+        alignas(CACHELINE_SIZE) std::atomic<uint32_t> mTail = { 0 };
+    };
+
+    std::atomic<uint8_t>* getGenerations() const noexcept {
+        static_assert(sizeof(std::atomic<uint8_t>) == sizeof(uint8_t));
+        static_assert(std::atomic<uint8_t>::is_always_lock_free);
+        return reinterpret_cast<std::atomic<uint8_t>*>(mGens);
+    }
+
+    // allocates up to count never used indices, returns how many were allocated
+    size_t allocateIndices(size_t count, Entity::Type* first) noexcept {
+        uint32_t currentIndex = mCurrentIndex.load(std::memory_order_relaxed);
+        size_t n;
+        do {
+            n = std::min(count, currentIndex < RAW_INDEX_COUNT ?
+                    RAW_INDEX_COUNT - currentIndex : size_t(0));
+            if (!n) {
+                return 0;
+            }
+        } while (!mCurrentIndex.compare_exchange_weak(currentIndex, uint32_t(currentIndex + n),
+                std::memory_order_relaxed));
+        *first = currentIndex;
+        return n;
+    }
+
     utils::FixedCapacityVector<EntityManager::Listener*> getListeners() const noexcept {
         std::lock_guard<Mutex> const lock(mListenerLock);
         tsl::robin_set<Listener*> const& listeners = mListeners;
@@ -178,16 +345,17 @@ private:
         return result; // the c++ standard guarantees a move
     }
 
-    uint32_t mCurrentIndex = 1;
+    std::atomic<uint32_t> mCurrentIndex = { 1 };
 
     // stores indices that got freed
-    mutable Mutex mFreeListLock;
-    std::deque<Entity::Type> mFreeList;
+    FreeList mFreeList;
 
     mutable Mutex mListenerLock;
     tsl::robin_set<Listener*> mListeners;
+    std::atomic<uint32_t> mListenerCount = { 0 };
 
 #if FILAMENT_UTILS_TRACK_ENTITIES
+    mutable Mutex mDebugActiveEntitiesLock;
     tsl::robin_map<Entity, CallStack, Entity::Hasher> mDebugActiveEntities;
 #endif
 };
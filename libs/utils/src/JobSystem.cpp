@@ -28,7 +28,9 @@ static constexpr bool DEBUG_FINISH_HANGS = false;
 
 #include <utils/JobSystem.h>
 
+#include <utils/algorithm.h>
 #include <utils/compiler.h>
+#include <utils/CpuTopology.h>
 #include <utils/Log.h>
 #include <utils/memalign.h>
 #include <utils/Panic.h>
@@ -37,6 +39,7 @@ static constexpr bool DEBUG_FINISH_HANGS = false;
 #include <random>
 
 #include <math.h>
+#include <stdint.h>
 
 #if defined(WIN32)
 #    define NOMINMAX
@@ -81,6 +84,22 @@ static constexpr bool DEBUG_FINISH_HANGS = false;
 
 namespace utils {
 
+namespace {
+
+// Cache of the calling thread's ThreadState, which saves us a locked lookup in mThreadMap for
+// each run()/waitAndRelease(). It's keyed by the JobSystem's unique id rather than its address,
+// so a stale entry can never match a JobSystem allocated later at the same address.
+struct ThreadLocalState {
+    uint32_t jobSystemId = 0;   // 0 is never a valid id
+    void* state = nullptr;
+};
+
+thread_local ThreadLocalState sThreadLocalState;
+
+std::atomic<uint32_t> sJobSystemId = { 0 };
+
+} // anonymous namespace
+
 void JobSystem::setThreadName(const char* name) noexcept {
 #if defined(__linux__)
     pthread_setname_np(pthread_self(), name);
@@ -135,9 +154,29 @@ void JobSystem::setThreadAffinityById(size_t id) noexcept {
 #endif
 }
 
-JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount) noexcept
-    : mJobPool("JobSystem Job pool", MAX_JOB_COUNT * sizeof(Job)),
-      mJobStorageBase(static_cast<Job *>(mJobPool.getAllocator().getCurrent()))
+void JobSystem::setThreadAffinity(ThreadState const& state) const noexcept {
+    if (state.cacheDomain == NO_CACHE_DOMAIN) {
+        return;
+    }
+    if (mThreadAffinity == ThreadAffinity::CPU) {
+        setThreadAffinityById(state.cpu);
+        return;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : mCacheDomains[state.cacheDomain].cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    sched_setaffinity(gettid(), sizeof(set), &set);
+#endif
+}
+
+JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreadsCount,
+        ThreadAffinity threadAffinity) noexcept
+    : mId(sJobSystemId.fetch_add(1, std::memory_order_relaxed) + 1)
 {
     SYSTRACE_ENABLE();
 
@@ -159,13 +198,59 @@ JobSystem::JobSystem(const size_t userThreadCount, const size_t adoptableThreads
     // and also limit the pool to 32 threads
     threadPoolCount = std::min(UTILS_HAS_THREADING ? 32 : 0, threadPoolCount);
 
+    // each thread owns a bit in mParkedThreads and mWaitingThreads
+    ASSERT_PRECONDITION(threadPoolCount + adoptableThreadsCount <= 64,
+            "JobSystem supports at most 64 threads (%d requested)",
+            int(threadPoolCount + adoptableThreadsCount));
+
     mThreadStates = aligned_vector<ThreadState>(threadPoolCount + adoptableThreadsCount);
     mThreadCount = uint16_t(threadPoolCount);
     mParallelSplitCount = (uint8_t)std::ceil((std::log2f(threadPoolCount + adoptableThreadsCount)));
 
+    // at most half of the threads (rounded-up) run BACKGROUND jobs at any given time, so that
+    // CRITICAL jobs always find a thread available.
+    mBackgroundThreadLimit = uint16_t(std::max(1, (threadPoolCount + 1) / 2));
+
     static_assert(std::atomic<bool>::is_always_lock_free);
     static_assert(std::atomic<uint16_t>::is_always_lock_free);
 
+    // Assign a CPU to each worker thread. We use the NUMA node we're running on first, then the
+    // other ones. Within a node, threads are spread across its cache domains (to maximize the
+    // total amount of cache available), and CPUs are used in ascending order, which on most
+    // systems lists all physical cores before their hyper-threads.
+    mThreadAffinity = threadAffinity;
+    CpuTopology const topology = CpuTopology::query();
+    auto const& domains = topology.getCacheDomains();
+    uint32_t const currentNode = topology.getNode(CpuTopology::getCurrentCpu());
+
+    std::vector<std::pair<uint32_t, uint32_t>> cpus; // {cpu, domain} in assignment order
+    cpus.reserve(topology.getCpuCount());
+    auto addNodeCpus = [&](auto predicate) {
+        for (size_t k = 0, added = 1; added; k++) {
+            added = 0;
+            for (size_t d = 0, c = domains.size(); d < c; d++) {
+                if (predicate(domains[d].node) && k < domains[d].cpus.size()) {
+                    cpus.emplace_back(domains[d].cpus[k], uint32_t(d));
+                    added++;
+                }
+            }
+        }
+    };
+    addNodeCpus([currentNode](uint32_t node) { return node == currentNode; });
+    addNodeCpus([currentNode](uint32_t node) { return node != currentNode; });
+
+    std::vector<uint16_t> domainIndices(domains.size(), NO_CACHE_DOMAIN);
+    for (size_t i = 0, c = cpus.size(); i < mThreadCount && c; i++) {
+        auto [cpu, domain] = cpus[i % c];
+        if (domainIndices[domain] == NO_CACHE_DOMAIN) {
+            domainIndices[domain] = uint16_t(mCacheDomains.size());
+            mCacheDomains.push_back({ domains[domain].cpus, {}});
+        }
+        mThreadStates[i].cpu = int32_t(cpu);
+        mThreadStates[i].cacheDomain = domainIndices[domain];
+        mCacheDomains[domainIndices[domain]].threads.push_back(uint16_t(i));
+    }
+
     std::random_device rd;
     const size_t hardwareThreadCount = mThreadCount;
     auto& states = mThreadStates;
@@ -193,6 +278,11 @@ JobSystem::~JobSystem() {
             state.thread.join();
         }
     }
+
+    for (size_t i = 0, c = mJobSegmentCount.load(std::memory_order_relaxed); i < c; i++) {
+        aligned_free(mJobSegments[i]->storage);
+        delete mJobSegments[i];
+    }
 }
 
 inline void JobSystem::incRef(Job const* job) noexcept {
@@ -216,14 +306,13 @@ void JobSystem::decRef(Job const* job) noexcept {
     assert(c > 0);
     if (c == 1) {
         // This was the last reference, it's safe to destroy the job.
-        mJobPool.destroy(job);
+        freeJob(job);
     }
 }
 
 void JobSystem::requestExit() noexcept {
     mExitRequested.store(true);
-    std::lock_guard<Mutex> lock(mWaiterLock);
-    mWaiterCondition.notify_all();
+    wakeAll();
 }
 
 inline bool JobSystem::exitRequested() const noexcept {
@@ -231,25 +320,95 @@ inline bool JobSystem::exitRequested() const noexcept {
     return mExitRequested.load(std::memory_order_relaxed);
 }
 
-inline bool JobSystem::hasActiveJobs() const noexcept {
-    return mActiveJobs.load(std::memory_order_relaxed) > 0;
+inline bool JobSystem::hasActiveJobs(JobPriority priority) const noexcept {
+    return mActiveJobs[size_t(priority)].load(std::memory_order_relaxed) > 0;
+}
+
+inline bool JobSystem::canWaiterRunBackgroundJobs(
+        ThreadState const& state, Job const* job) const noexcept {
+    // A thread waiting on a job doesn't pick-up BACKGROUND jobs, which could take an arbitrary
+    // long time to run, unless it's itself running a BACKGROUND job (i.e. it's waiting on its
+    // children). Without worker threads however, there is no-one else to run them.
+    return !job || state.backgroundJobDepth > 0 || mThreadCount == 0;
+}
+
+bool JobSystem::acquireBackgroundSlot(ThreadState& state) noexcept {
+    // a thread already running a BACKGROUND job (e.g. waiting on its children) can always run
+    // more of them, otherwise we could deadlock.
+    if (state.backgroundJobDepth == 0) {
+        uint32_t count = mBackgroundThreads.load(std::memory_order_relaxed);
+        do {
+            if (count >= mBackgroundThreadLimit) {
+                return false;
+            }
+        } while (!mBackgroundThreads.compare_exchange_weak(count, count + 1,
+                std::memory_order_relaxed, std::memory_order_relaxed));
+    }
+    state.backgroundJobDepth++;
+    return true;
+}
+
+void JobSystem::releaseBackgroundSlot(ThreadState& state) noexcept {
+    assert(state.backgroundJobDepth > 0);
+    if (--state.backgroundJobDepth == 0) {
+        mBackgroundThreads.fetch_sub(1, std::memory_order_relaxed);
+        // another thread could have parked because it wasn't allowed to run a BACKGROUND job
+        if (hasActiveJobs(JobPriority::BACKGROUND)) {
+            wakeOne(JobPriority::BACKGROUND);
+        }
+    }
 }
 
 inline bool JobSystem::hasJobCompleted(JobSystem::Job const* job) noexcept {
     return job->runningJobCount.load(std::memory_order_acquire) <= 0;
 }
 
-void JobSystem::wait(std::unique_lock<Mutex>& lock, Job* job) noexcept {
+void JobSystem::park(ThreadState& state, Job const* job) noexcept {
+    HEAVY_SYSTRACE_CALL();
+    uint64_t const bit = uint64_t(1) << state.id;
+
+    std::unique_lock<Mutex> lock(state.parkLock);
+    state.wakeup = false;
+
+    // Advertise that we're about to sleep, then check again whether we actually need to.
+    // Whoever makes our condition true (put(), finish(), requestExit()) does the opposite, i.e.
+    // first updates the condition, then looks for parked threads. The seq_cst fences on both
+    // sides guarantee at least one of us sees the other's write, so a wake-up can't be lost.
+    mParkedThreads.fetch_or(bit, std::memory_order_relaxed);
+    if (job) {
+        mWaitingThreads.fetch_or(bit, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool const canRunBackgroundJobs = canWaiterRunBackgroundJobs(state, job) &&
+            hasActiveJobs(JobPriority::BACKGROUND) &&
+            (state.backgroundJobDepth > 0 ||
+                    mBackgroundThreads.load(std::memory_order_relaxed) < mBackgroundThreadLimit);
+
+    if (!hasActiveJobs(JobPriority::CRITICAL) && !canRunBackgroundJobs &&
+            !exitRequested() && !(job && hasJobCompleted(job))) {
+        wait(lock, state, job);
+    }
+
+    mParkedThreads.fetch_and(~bit, std::memory_order_relaxed);
+    if (job) {
+        mWaitingThreads.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::wait(std::unique_lock<Mutex>& lock, ThreadState& state, Job const* job) noexcept {
     if constexpr (!DEBUG_FINISH_HANGS) {
-        mWaiterCondition.wait(lock);
+        while (!state.wakeup) {
+            state.parkCondition.wait(lock);
+        }
     } else {
-        do {
+        while (!state.wakeup) {
             // we use a pretty long timeout (4s) so we're very confident that the system is hung
             // and nothing else is happening.
-            std::cv_status status = mWaiterCondition.wait_for(lock,
+            std::cv_status status = state.parkCondition.wait_for(lock,
                     std::chrono::milliseconds(4000));
             if (status == std::cv_status::no_timeout) {
-                break;
+                continue;
             }
 
             // hang debugging...
@@ -258,8 +417,8 @@ void JobSystem::wait(std::unique_lock<Mutex>& lock, Job* job) noexcept {
             // there is the possibility of a race condition, but our long timeout gives us some
             // confidence that we're in an incorrect state.
 
-            auto id = getState().id;
-            auto activeJobs = mActiveJobs.load();
+            auto id = state.id;
+            auto activeJobs = mActiveJobs[size_t(JobPriority::CRITICAL)].load();
 
             if (job) {
                 auto runningJobCount = job->runningJobCount.load();
@@ -271,92 +430,217 @@ void JobSystem::wait(std::unique_lock<Mutex>& lock, Job* job) noexcept {
             ASSERT_POSTCONDITION(activeJobs <= 0,
                     "JobSystem(%p, %d): waiting while %d jobs are active!",
                     this, id, activeJobs);
+        }
+    }
+}
 
-        } while (true);
+void JobSystem::unpark(ThreadState& state) noexcept {
+    std::lock_guard<Mutex> lock(state.parkLock);
+    // wakeup must be set under the lock, to guarantee that notify_one() happens after the
+    // parked thread has started to wait, or that it sees wakeup before it does.
+    state.wakeup = true;
+    state.parkCondition.notify_one();
+}
+
+void JobSystem::unparkAll(uint64_t threads) noexcept {
+    while (threads) {
+        size_t const index = utils::ctz(threads);
+        threads &= threads - 1;
+        unpark(mThreadStates[index]);
     }
 }
 
 void JobSystem::wakeAll() noexcept {
     HEAVY_SYSTRACE_CALL();
-    std::lock_guard<Mutex> lock(mWaiterLock);
-    // this empty critical section is needed -- it guarantees that notify_all() happens
-    // after the condition's variables are set.
-    mWaiterCondition.notify_all();
+    // pairs with the fence in park()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    unparkAll(mParkedThreads.exchange(0, std::memory_order_relaxed));
+}
+
+void JobSystem::wakeOne(JobPriority priority) noexcept {
+    HEAVY_SYSTRACE_CALL();
+    // pairs with the fence in park()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // threads waiting on a job generally won't run a BACKGROUND job, don't waste the wake-up
+    // on any of them.
+    uint64_t const candidates = priority == JobPriority::BACKGROUND ?
+            ~mWaitingThreads.load(std::memory_order_relaxed) : ~uint64_t(0);
+    // claim a single parked thread, so that concurrent calls wake-up different threads
+    uint64_t parked = mParkedThreads.load(std::memory_order_relaxed);
+    while (parked & candidates) {
+        size_t const index = utils::ctz(parked & candidates);
+        if (mParkedThreads.compare_exchange_weak(parked, parked & ~(uint64_t(1) << index),
+                std::memory_order_relaxed, std::memory_order_relaxed)) {
+            unpark(mThreadStates[index]);
+            break;
+        }
+    }
 }
 
-void JobSystem::wakeOne() noexcept {
+void JobSystem::wakeWaiters() noexcept {
     HEAVY_SYSTRACE_CALL();
-    std::lock_guard<Mutex> lock(mWaiterLock);
-    // this empty critical section is needed -- it guarantees that notify_one() happens
-    // after the condition's variables are set.
-    mWaiterCondition.notify_one();
+    // pairs with the fence in park()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mWaitingThreads.load(std::memory_order_relaxed)) {
+        // only threads blocked in waitAndRelease() can care about a job finishing; idle
+        // threads are left alone.
+        uint64_t const waiting = mWaitingThreads.exchange(0, std::memory_order_relaxed);
+        // make sure wakeOne() doesn't pick a thread we're already waking up
+        mParkedThreads.fetch_and(~waiting, std::memory_order_relaxed);
+        unparkAll(waiting);
+    }
 }
 
 inline JobSystem::ThreadState& JobSystem::getState() noexcept {
-    std::lock_guard<utils::SpinLock> lock(mThreadMapLock);
+    ThreadLocalState const& tls = sThreadLocalState;
+    if (UTILS_LIKELY(tls.jobSystemId == mId)) {
+        return *static_cast<ThreadState*>(tls.state);
+    }
+    return getStateFromThreadMap();
+}
+
+uint32_t JobSystem::getThreadIndex() noexcept {
+    return getState().id;
+}
+
+UTILS_NOINLINE
+JobSystem::ThreadState& JobSystem::getStateFromThreadMap() noexcept {
+    std::unique_lock<utils::SpinLock> lock(mThreadMapLock);
     auto iter = mThreadMap.find(std::this_thread::get_id());
     ASSERT_PRECONDITION(iter != mThreadMap.end(), "This thread has not been adopted.");
-    return *iter->second;
+    ThreadState* const state = iter->second;
+    lock.unlock();
+    sThreadLocalState = { mId, state };
+    return *state;
 }
 
 JobSystem::Job* JobSystem::allocateJob() noexcept {
-    return mJobPool.make<Job>();
+    // memory_order_acquire pairs with the release in growJobPool(), so we see the new segments
+    size_t const segmentCount = mJobSegmentCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < segmentCount; i++) {
+        void* const p = mJobSegments[i]->allocator.alloc();
+        if (UTILS_LIKELY(p)) {
+            return new(p) Job;
+        }
+    }
+    return growJobPool(segmentCount);
+}
+
+UTILS_NOINLINE
+JobSystem::Job* JobSystem::growJobPool(size_t segmentCount) noexcept {
+    std::lock_guard<Mutex> const lock(mJobSegmentLock);
+
+    // another thread might have grown the pool while we were waiting for the lock, or freed
+    // some jobs since we looked.
+    size_t const currentCount = mJobSegmentCount.load(std::memory_order_relaxed);
+    for (size_t i = currentCount == segmentCount ? 0 : segmentCount; i < currentCount; i++) {
+        void* const p = mJobSegments[i]->allocator.alloc();
+        if (p) {
+            return new(p) Job;
+        }
+    }
+
+    if (UTILS_UNLIKELY(currentCount == JOB_SEGMENT_COUNT)) {
+        // we're out of jobs
+        return nullptr;
+    }
+
+    Job* const storage = static_cast<Job*>(
+            aligned_alloc(JOB_SEGMENT_SIZE * sizeof(Job), alignof(Job)));
+    if (UTILS_UNLIKELY(!storage)) {
+        return nullptr;
+    }
+    JobSegment* const segment = new JobSegment(storage);
+    void* const p = segment->allocator.alloc();
+    mJobSegments[currentCount] = segment;
+    // publish the new segment, mJobSegments[] entries are never modified once published.
+    mJobSegmentCount.store(uint32_t(currentCount + 1), std::memory_order_release);
+    return new(p) Job;
+}
+
+void JobSystem::freeJob(Job const* job) noexcept {
+    JobSegment* const segment = mJobSegments[getJobIndex(job) / JOB_SEGMENT_SIZE];
+    job->~Job();
+    segment->allocator.free(const_cast<Job*>(job));
+}
+
+uint16_t JobSystem::getJobIndex(Job const* job) const noexcept {
+    // there are only a handful of segments, and the first one is where most jobs live
+    size_t const segmentCount = mJobSegmentCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < segmentCount; i++) {
+        Job const* const storage = mJobSegments[i]->storage;
+        if (job >= storage && job < storage + JOB_SEGMENT_SIZE) {
+            return uint16_t(i * JOB_SEGMENT_SIZE + (job - storage));
+        }
+    }
+    assert(false);
+    return 0;
+}
+
+inline JobSystem::Job* JobSystem::getJob(size_t index) const noexcept {
+    assert(index < MAX_JOB_COUNT);
+    return &mJobSegments[index / JOB_SEGMENT_SIZE]->storage[index % JOB_SEGMENT_SIZE];
 }
 
-void JobSystem::put(WorkQueue& workQueue, Job* job) noexcept {
+void JobSystem::put(ThreadState& state, Job* job) noexcept {
     assert(job);
-    size_t index = job - mJobStorageBase;
-    assert(index >= 0 && index < MAX_JOB_COUNT);
+    size_t const index = getJobIndex(job);
+
+    JobPriority const priority = job->priority;
 
     // put the job into the queue first
-    workQueue.push(uint16_t(index + 1));
+    state.workQueues[size_t(priority)].push(uint16_t(index + 1));
     // then increase our active job count
-    uint32_t oldActiveJobs = mActiveJobs.fetch_add(1, std::memory_order_relaxed);
+    uint32_t oldActiveJobs = mActiveJobs[size_t(priority)].fetch_add(1, std::memory_order_relaxed);
     // but it's possible that the job has already been picked-up, so oldActiveJobs could be
     // negative for instance. We signal only if that's not the case.
     if (oldActiveJobs >= 0) {
-        wakeOne(); // wake-up a thread if needed...
+        wakeOne(priority); // wake-up a thread if needed...
     }
 }
 
-JobSystem::Job* JobSystem::pop(WorkQueue& workQueue) noexcept {
+JobSystem::Job* JobSystem::pop(WorkQueue& workQueue, JobPriority priority) noexcept {
+    auto& activeJobs = mActiveJobs[size_t(priority)];
+
     // decrement mActiveJobs first, this is to ensure that if there is only a single job left
     // (and we're about to pick it up), other threads don't loop trying to do the same.
-    mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
+    activeJobs.fetch_sub(1, std::memory_order_relaxed);
 
     size_t index = workQueue.pop();
     assert(index <= MAX_JOB_COUNT);
-    Job* job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* job = !index ? nullptr : getJob(index - 1);
 
     // if our guess was wrong, i.e. we couldn't pick-up a job (b/c our queue was empty), we
     // need to correct mActiveJobs.
     if (!job) {
-        if (mActiveJobs.fetch_add(1, std::memory_order_relaxed) >= 0) {
+        if (activeJobs.fetch_add(1, std::memory_order_relaxed) >= 0) {
             // and if there are some active jobs, then we need to wake someone up. We know it
             // can't be us, because we failed taking a job and we know another thread can't
             // have added one in our queue.
-            wakeOne();
+            wakeOne(priority);
         }
     }
     return job;
 }
 
-JobSystem::Job* JobSystem::steal(WorkQueue& workQueue) noexcept {
+JobSystem::Job* JobSystem::steal(WorkQueue& workQueue, JobPriority priority) noexcept {
+    auto& activeJobs = mActiveJobs[size_t(priority)];
+
     // decrement mActiveJobs first, this is to ensure that if there is only a single job left
     // (and we're about to pick it up), other threads don't loop trying to do the same.
-    mActiveJobs.fetch_sub(1, std::memory_order_relaxed);
+    activeJobs.fetch_sub(1, std::memory_order_relaxed);
 
     size_t index = workQueue.steal();
     assert(index <= MAX_JOB_COUNT);
-    Job* job = !index ? nullptr : &mJobStorageBase[index - 1];
+    Job* job = !index ? nullptr : getJob(index - 1);
 
     // if we failed taking a job, we need to correct mActiveJobs
     if (!job) {
-        if (mActiveJobs.fetch_add(1, std::memory_order_relaxed) >= 0) {
+        if (activeJobs.fetch_add(1, std::memory_order_relaxed) >= 0) {
             // and if there are some active jobs, then we need to wake someone up. We know it
             // can't be us, because we failed taking a job and we know another thread can't
             // have added one in our queue.
-            wakeOne();
+            wakeOne(priority);
         }
     }
     return job;
@@ -373,6 +657,24 @@ inline JobSystem::ThreadState* JobSystem::getStateToStealFrom(JobSystem::ThreadS
 
     // don't try to steal from someone else if we're the only thread (infinite loop)
     if (threadCount >= 2) {
+        // most of the time, steal from a thread sharing our last-level cache, the job's data is
+        // more likely to be there. Adopted threads (e.g. the main thread) are not pinned, so we
+        // don't know their cache domain; they're always considered, since they're typically
+        // the ones pushing most of the jobs.
+        if (mCacheDomains.size() > 1 && state.cacheDomain != NO_CACHE_DOMAIN) {
+            auto const& threads = mCacheDomains[state.cacheDomain].threads;
+            size_t const candidateCount = threads.size() + adopted;
+            if (candidateCount >= 2 && (state.rndGen() & 3u)) {
+                do {
+                    size_t const i = state.rndGen() % candidateCount;
+                    uint16_t const index = i < threads.size() ?
+                            threads[i] : uint16_t(mThreadCount + (i - threads.size()));
+                    assert(index < threadStates.size());
+                    stateToStealFrom = &threadStates[index];
+                } while (stateToStealFrom == &state);
+                return stateToStealFrom;
+            }
+        }
         do {
             // this is biased, but frankly, we don't care. it's fast.
             uint16_t index = uint16_t(state.rndGen() % threadCount);
@@ -384,27 +686,43 @@ inline JobSystem::ThreadState* JobSystem::getStateToStealFrom(JobSystem::ThreadS
     return stateToStealFrom;
 }
 
-JobSystem::Job* JobSystem::steal(JobSystem::ThreadState& state) noexcept {
+JobSystem::Job* JobSystem::steal(JobSystem::ThreadState& state, JobPriority priority) noexcept {
     HEAVY_SYSTRACE_CALL();
     Job* job = nullptr;
     do {
         ThreadState* const stateToStealFrom = getStateToStealFrom(state);
         if (UTILS_LIKELY(stateToStealFrom)) {
-            job = steal(stateToStealFrom->workQueue);
+            job = steal(stateToStealFrom->workQueues[size_t(priority)], priority);
         }
         // nullptr -> nothing to steal in that queue either, if there are active jobs,
-        // continue to try stealing one.
-    } while (!job && hasActiveJobs());
+        // continue to try stealing one -- unless we're looking for a BACKGROUND job and
+        // CRITICAL jobs have been added in the meantime.
+    } while (!job && hasActiveJobs(priority) &&
+            (priority == JobPriority::CRITICAL || !hasActiveJobs(JobPriority::CRITICAL)));
     return job;
 }
 
-bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
+bool JobSystem::execute(JobSystem::ThreadState& state, bool allowBackground) noexcept {
     HEAVY_SYSTRACE_CALL();
 
-    Job* job = pop(state.workQueue);
+    Job* job = pop(state.workQueues[size_t(JobPriority::CRITICAL)], JobPriority::CRITICAL);
     if (UTILS_UNLIKELY(job == nullptr)) {
         // our queue is empty, try to steal a job
-        job = steal(state);
+        job = steal(state, JobPriority::CRITICAL);
+    }
+
+    // only look for BACKGROUND jobs when there are no CRITICAL ones
+    bool background = false;
+    if (!job && allowBackground && hasActiveJobs(JobPriority::BACKGROUND) &&
+            acquireBackgroundSlot(state)) {
+        job = pop(state.workQueues[size_t(JobPriority::BACKGROUND)], JobPriority::BACKGROUND);
+        if (!job) {
+            job = steal(state, JobPriority::BACKGROUND);
+        }
+        background = job != nullptr;
+        if (!background) {
+            releaseBackgroundSlot(state);
+        }
     }
 
     if (job) {
@@ -415,6 +733,10 @@ bool JobSystem::execute(JobSystem::ThreadState& state) noexcept {
             job->function(job->storage, *this, job);
         }
         finish(job);
+
+        if (background) {
+            releaseBackgroundSlot(state);
+        }
     }
     return job != nullptr;
 }
@@ -425,7 +747,7 @@ void JobSystem::loop(ThreadState* state) noexcept {
 
     // set a CPU affinity on each of our JobSystem thread to prevent them from jumping from core
     // to core. On Android, it looks like the affinity needs to be reset from time to time.
-    setThreadAffinityById(state->id);
+    setThreadAffinity(*state);
 
     // record our work queue
     mThreadMapLock.lock();
@@ -433,14 +755,13 @@ void JobSystem::loop(ThreadState* state) noexcept {
     mThreadMapLock.unlock();
     ASSERT_PRECONDITION(inserted, "This thread is already in a loop.");
 
+    sThreadLocalState = { mId, state };
+
     // run our main loop...
     do {
-        if (!execute(*state)) {
-            std::unique_lock<Mutex> lock(mWaiterLock);
-            while (!exitRequested() && !hasActiveJobs()) {
-                wait(lock);
-                setThreadAffinityById(state->id);
-            }
+        if (!execute(*state, true)) {
+            park(*state);
+            setThreadAffinity(*state);
         }
     } while (!exitRequested());
 }
@@ -452,7 +773,6 @@ void JobSystem::finish(Job* job) noexcept {
     bool notify = false;
 
     // terminate this job and notify its parent
-    Job* const storage = mJobStorageBase;
     do {
         // std::memory_order_release here is needed to synchronize with JobSystem::wait()
         // which needs to "see" all changes that happened before the job terminated.
@@ -461,7 +781,7 @@ void JobSystem::finish(Job* job) noexcept {
         if (runningJobCount == 1) {
             // no more work, destroy this job and notify its parent
             notify = true;
-            Job* const parent = job->parent == 0x7FFF ? nullptr : &storage[job->parent];
+            Job* const parent = job->parent == NO_PARENT ? nullptr : getJob(job->parent);
             decRef(job);
             job = parent;
         } else {
@@ -470,9 +790,9 @@ void JobSystem::finish(Job* job) noexcept {
         }
     } while (job);
 
-    // wake-up all threads that could potentially be waiting on this job finishing
+    // wake-up the threads that could potentially be waiting on this job finishing
     if (notify) {
-        wakeAll();
+        wakeWaiters();
     }
 }
 
@@ -484,7 +804,7 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
     parent = (parent == nullptr) ? mRootJob : parent;
     Job* const job = allocateJob();
     if (UTILS_LIKELY(job)) {
-        size_t index = 0x7FFF;
+        uint16_t index = NO_PARENT;
         if (parent) {
             // add a reference to the parent to make sure it can't be terminated.
             // memory_order_relaxed is safe because no action is taken at this point
@@ -494,11 +814,11 @@ JobSystem::Job* JobSystem::create(JobSystem::Job* parent, JobFunc func) noexcept
             // can't create a child job of a terminated parent
             assert(parentJobCount > 0);
 
-            index = parent - mJobStorageBase;
-            assert(index < MAX_JOB_COUNT);
+            index = getJobIndex(parent);
         }
         job->function = func;
-        job->parent = uint16_t(index);
+        job->parent = index;
+        job->priority = parent ? parent->priority : JobPriority::CRITICAL;
     }
     return job;
 }
@@ -528,7 +848,7 @@ void JobSystem::run(Job*& job) noexcept {
 
     ThreadState& state(getState());
 
-    put(state.workQueue, job);
+    put(state, job);
 
     // after run() returns, the job is virtually invalid (it'll die on its own)
     job = nullptr;
@@ -548,7 +868,7 @@ void JobSystem::waitAndRelease(Job*& job) noexcept {
 
     ThreadState& state(getState());
     do {
-        if (!execute(state)) {
+        if (!execute(state, canWaiterRunBackgroundJobs(state, job))) {
             // test if job has completed first, to possibly avoid taking the lock
             if (hasJobCompleted(job)) {
                 break;
@@ -560,13 +880,10 @@ void JobSystem::waitAndRelease(Job*& job) noexcept {
             //    - yet our job hasn't completed yet
             //    ergo, it's being run in another thread
             //
-            // this could take time however, so we will wait with a condition, and
-            // continue to handle more jobs, as they get added.
+            // this could take time however, so we will park until either the job completes,
+            // or more jobs get added, which we'll handle.
 
-            std::unique_lock<Mutex> lock(mWaiterLock);
-            if (!hasJobCompleted(job) && !hasActiveJobs() && !exitRequested()) {
-                wait(lock, job);
-            }
+            park(state, job);
         }
     } while (!hasJobCompleted(job) && !exitRequested());
 
@@ -614,6 +931,9 @@ void JobSystem::adopt() {
 
     lock.lock();
     mThreadMap[tid] = &mThreadStates[index];
+    lock.unlock();
+
+    sThreadLocalState = { mId, &mThreadStates[index] };
 }
 
 void JobSystem::emancipate() {
@@ -624,11 +944,16 @@ void JobSystem::emancipate() {
     ASSERT_PRECONDITION(state, "this thread is not an adopted thread");
     ASSERT_PRECONDITION(state->js == this, "this thread is not adopted by us");
     mThreadMap.erase(iter);
+    if (sThreadLocalState.jobSystemId == mId) {
+        sThreadLocalState = {};
+    }
 }
 
 io::ostream& operator<<(io::ostream& out, JobSystem const& js) {
     for (auto const& item : js.mThreadStates) {
-        out << size_t(item.id) << ": " << item.workQueue.getCount() << io::endl;
+        out << size_t(item.id) << ": "
+            << item.workQueues[size_t(JobSystem::JobPriority::CRITICAL)].getCount() << ", "
+            << item.workQueues[size_t(JobSystem::JobPriority::BACKGROUND)].getCount() << io::endl;
     }
     return out;
 }
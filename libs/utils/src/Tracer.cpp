@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/Tracer.h>
+
+#include <utils/Mutex.h>
+#include <utils/compiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#   include <pthread.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+constexpr uint64_t TIME_MASK = (uint64_t(1) << 56) - 1;
+
+uint64_t now() noexcept {
+    using namespace std::chrono;
+    static const steady_clock::time_point origin = steady_clock::now();
+    return uint64_t(duration_cast<nanoseconds>(steady_clock::now() - origin).count());
+}
+
+// Single producer (the owning thread) ring buffer, read concurrently by dump(). Events are stored
+// as relaxed atomics, which are plain loads and stores, so that torn reads are well defined;
+// dump() discards the events that may have been overwritten while it was reading them.
+struct ThreadBuffer {
+    struct Event {
+        std::atomic<uint64_t> timeAndType;  // time in ns in the low 56 bits, type in the high 8
+        std::atomic<const char*> name;
+        std::atomic<int64_t> value;
+    };
+
+    explicit ThreadBuffer(size_t capacity)
+            : events(new Event[capacity]), mask(capacity - 1) {
+    }
+
+    std::unique_ptr<Event[]> const events;
+    size_t const mask;
+    std::atomic<uint64_t> head{ 0 };    // number of events written so far
+    uint64_t start = 0;                 // events before this one were written by a previous thread
+    uint64_t tid = 0;
+    char name[32] = {};
+};
+
+struct State {
+    Mutex lock;
+    std::vector<ThreadBuffer*> buffers;         // events outlive their thread, until it's reused
+    std::vector<ThreadBuffer*> freeBuffers;     // buffers of the threads that exited
+    std::atomic<size_t> capacity{ Tracer::DEFAULT_EVENTS_PER_THREAD };
+    std::atomic<uint64_t> captureStart{ 0 };    // events older than this are ignored
+};
+
+// intentionally leaked, threads may record events during static destruction
+State& getState() noexcept {
+    static State* const state = new State;
+    return *state;
+}
+
+// tBuffer is trivially destructible so that record() doesn't pay for the thread_local guard,
+// tThreadExit returns the buffer to the free list when the thread exits.
+thread_local ThreadBuffer* tBuffer = nullptr;
+thread_local bool tExited = false;
+
+struct ThreadExit {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadExit() noexcept {
+        if (buffer) {
+            State& state = getState();
+            std::lock_guard<Mutex> const guard(state.lock);
+            state.freeBuffers.push_back(buffer);
+        }
+        // events recorded by the destructors of other thread_locals are dropped
+        tBuffer = nullptr;
+        tExited = true;
+    }
+};
+
+thread_local ThreadExit tThreadExit;
+
+UTILS_NOINLINE
+ThreadBuffer* registerThread() noexcept {
+    if (UTILS_UNLIKELY(tExited)) {
+        return nullptr;
+    }
+    State& state = getState();
+    size_t capacity = 1;
+    while (capacity < state.capacity.load(std::memory_order_relaxed)) {
+        capacity *= 2;
+    }
+#if defined(__linux__)
+    uint64_t const tid = uint64_t(syscall(SYS_gettid));
+#else
+    uint64_t const tid = uint64_t(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    char name[sizeof(ThreadBuffer::name)] = {};
+#if defined(__linux__) || defined(__APPLE__)
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+#endif
+
+    std::lock_guard<Mutex> const guard(state.lock);
+    ThreadBuffer* buffer = nullptr;
+    auto& freeBuffers = state.freeBuffers;
+    uint64_t const captureStart = state.captureStart.load(std::memory_order_relaxed);
+    for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+        // reuse the buffer of a thread that exited, unless it has events in the current capture
+        ThreadBuffer* const candidate = *it;
+        uint64_t const head = candidate->head.load(std::memory_order_relaxed);
+        if (head != candidate->start && (candidate->events[(head - 1) & candidate->mask]
+                .timeAndType.load(std::memory_order_relaxed) & TIME_MASK) >= captureStart) {
+            continue;
+        }
+        freeBuffers.erase(it);
+        if (candidate->mask + 1 == capacity) {
+            buffer = candidate;
+            buffer->start = head;
+        } else {
+            state.buffers.erase(
+                    std::find(state.buffers.begin(), state.buffers.end(), candidate));
+            delete candidate;
+        }
+        break;
+    }
+    if (!buffer) {
+        buffer = new ThreadBuffer(capacity);
+        state.buffers.push_back(buffer);
+    }
+    buffer->tid = tid;
+    std::copy(std::begin(name), std::end(name), buffer->name);
+    tBuffer = buffer;
+    tThreadExit.buffer = buffer;
+    return buffer;
+}
+
+void writeString(FILE* file, const char* s) noexcept {
+    fputc('"', file);
+    for (; s && *s; s++) {
+        unsigned char const c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+} // anonymous namespace
+
+std::atomic<bool> Tracer::sCapturing{ false };
+
+void Tracer::startCapture(size_t eventsPerThread) noexcept {
+    State& state = getState();
+    state.capacity.store(std::max(size_t(1), eventsPerThread), std::memory_order_relaxed);
+    state.captureStart.store(now(), std::memory_order_relaxed);
+    sCapturing.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stopCapture() noexcept {
+    sCapturing.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::clear() noexcept {
+    getState().captureStart.store(now(), std::memory_order_relaxed);
+}
+
+void Tracer::record(EventType type, const char* name, int64_t value) noexcept {
+    ThreadBuffer* buffer = tBuffer;
+    if (UTILS_UNLIKELY(!buffer)) {
+        buffer = registerThread();
+        if (UTILS_UNLIKELY(!buffer)) {
+            return;
+        }
+    }
+    uint64_t const h = buffer->head.load(std::memory_order_relaxed);
+    ThreadBuffer::Event& e = buffer->events[h & buffer->mask];
+    // dump() must see the new head if it reads any of the stores below
+    std::atomic_thread_fence(std::memory_order_release);
+    e.timeAndType.store((now() & TIME_MASK) | (uint64_t(type) << 56), std::memory_order_relaxed);
+    e.name.store(name, std::memory_order_relaxed);
+    e.value.store(value, std::memory_order_relaxed);
+    buffer->head.store(h + 1, std::memory_order_release);
+}
+
+bool Tracer::dump(const char* path) noexcept {
+    State& state = getState();
+
+    // threads can't be registered while we dump, a buffer could otherwise be reused under us
+    std::lock_guard<Mutex> const guard(state.lock);
+    std::vector<ThreadBuffer*> const& buffers = state.buffers;
+
+    FILE* const file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+
+#if defined(__linux__)
+    unsigned long long const pid = (unsigned long long)getpid();
+#else
+    unsigned long long const pid = 0;
+#endif
+    uint64_t const captureStart = state.captureStart.load(std::memory_order_relaxed);
+
+    struct Event {
+        uint64_t time;
+        EventType type;
+        const char* name;
+        int64_t value;
+    };
+    std::vector<Event> events;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&]() {
+        fputs(first ? "" : ",\n", file);
+        first = false;
+    };
+
+    for (ThreadBuffer const* buffer : buffers) {
+        size_t const capacity = buffer->mask + 1;
+        uint64_t const end = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = std::max(end > capacity ? end - capacity : 0, buffer->start);
+
+        events.clear();
+        for (uint64_t i = begin; i < end; i++) {
+            ThreadBuffer::Event const& e = buffer->events[i & buffer->mask];
+            uint64_t const timeAndType = e.timeAndType.load(std::memory_order_relaxed);
+            events.push_back({ timeAndType & TIME_MASK, EventType(timeAndType >> 56),
+                    e.name.load(std::memory_order_relaxed),
+                    e.value.load(std::memory_order_relaxed) });
+        }
+
+        // the owning thread may have overwritten the oldest events while we were reading them,
+        // including the one it's writing right now.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t const after = buffer->head.load(std::memory_order_relaxed);
+        if (after + 1 > begin + capacity) {
+            size_t const overwritten = std::min(size_t(after + 1 - capacity - begin), events.size());
+            events.erase(events.begin(), events.begin() + overwritten);
+        }
+
+        separator();
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%llu,\"tid\":%llu,"
+                      "\"args\":{\"name\":", pid, (unsigned long long)buffer->tid);
+        writeString(file, buffer->name);
+        fputs("}}", file);
+
+        size_t depth = 0;
+        for (Event const& e : events) {
+            if (e.time < captureStart) {
+                continue;
+            }
+            // drop the ends of sections whose beginning was overwritten or not captured
+            if (e.type == EventType::END) {
+                if (!depth) {
+                    continue;
+                }
+                depth--;
+            } else if (e.type == EventType::BEGIN) {
+                depth++;
+            }
+
+            static constexpr const char* phases[] = { "B", "E", "b", "e", "C", "i" };
+            separator();
+            fprintf(file, "{\"ph\":\"%s\",\"pid\":%llu,\"tid\":%llu,\"ts\":%.3f",
+                    phases[size_t(e.type)], pid, (unsigned long long)buffer->tid,
+                    double(e.time) * 1e-3);
+            if (e.type != EventType::END) {
+                fputs(",\"name\":", file);
+                writeString(file, e.name);
+            }
+            switch (e.type) {
+                case EventType::ASYNC_BEGIN:
+                case EventType::ASYNC_END:
+                    fprintf(file, ",\"cat\":\"filament\",\"id\":%lld", (long long)e.value);
+                    break;
+                case EventType::COUNTER:
+                    fprintf(file, ",\"args\":{\"value\":%lld}", (long long)e.value);
+                    break;
+                case EventType::INSTANT:
+                    fprintf(file, ",\"s\":\"t\",\"args\":{\"id\":%lld}", (long long)e.value);
+                    break;
+                default:
+                    break;
+            }
+            fputc('}', file);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    bool const success = !ferror(file);
+    return (fclose(file) == 0) && success;
+}
+
+} // namespace utils
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/Systrace.h>
+
+#if FILAMENT_LINUX_SYSTRACE
+
+namespace utils {
+namespace details {
+
+std::atomic<uint32_t> Systrace::sIsTracingEnabled{ 0 };
+
+void Systrace::enable(uint32_t tags) noexcept {
+    sIsTracingEnabled.fetch_or(tags, std::memory_order_relaxed);
+}
+
+void Systrace::disable(uint32_t tags) noexcept {
+    sIsTracingEnabled.fetch_and(~tags, std::memory_order_relaxed);
+}
+
+// not inlined, so that the cost of a disabled trace point stays small in code size
+bool Systrace::isTracingEnabled(uint32_t tag) noexcept {
+    if (tag && UTILS_UNLIKELY(Tracer::isCapturing())) {
+        return bool((sIsTracingEnabled.load(std::memory_order_relaxed) | SYSTRACE_TAG_ALWAYS) & tag);
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Systrace::init(uint32_t tag) noexcept {
+    // must be called first
+    mIsTracingEnabled = isTracingEnabled(tag);
+}
+
+} // namespace details
+} // namespace utils
+
+#endif // FILAMENT_LINUX_SYSTRACE
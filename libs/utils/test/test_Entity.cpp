@@ -16,10 +16,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "../src/EntityManagerImpl.h"
 #include <utils/NameComponentManager.h>
+#include <utils/SingleInstanceComponentManager.h>
 
 using namespace utils;
 
@@ -128,6 +132,48 @@ TEST(EntityTest, Lots) {
     // at this point, we should be getting indices from the free-list exclusively
 }
 
+TEST(EntityTest, Threads) {
+    EntityManagerImpl em;
+    constexpr size_t THREAD_COUNT = 4;
+    constexpr size_t ENTITY_COUNT = 1024;
+
+    // several threads creating and destroying entities concurrently, each thread keeps the
+    // entities it creates in the first round alive. We never use more than
+    // THREAD_COUNT * ENTITY_COUNT * 16 indices, so we can't run out of them.
+    std::vector<std::vector<Entity>> alive(THREAD_COUNT);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; t++) {
+        threads.emplace_back([&em, &entities = alive[t]]() {
+            std::vector<Entity> temp(ENTITY_COUNT);
+            for (size_t round = 0; round < 16; round++) {
+                em.create(temp.size(), temp.data());
+                for (Entity e : temp) {
+                    EXPECT_TRUE(em.isAlive(e));
+                }
+                if (round == 0) {
+                    entities = temp;
+                } else {
+                    em.destroy(temp.size(), temp.data());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // all the entities still alive must be unique
+    std::vector<uint32_t> ids;
+    for (auto const& entities : alive) {
+        for (Entity e : entities) {
+            EXPECT_TRUE(em.isAlive(e));
+            ids.push_back(e.getId());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids.end(), std::adjacent_find(ids.begin(), ids.end()));
+    EXPECT_EQ(THREAD_COUNT * ENTITY_COUNT, em.getEntityCount());
+}
 
 TEST(EntityTest, NameComponent) {
 
@@ -176,3 +222,59 @@ TEST(EntityTest, NameComponent) {
 
     cm.gc(em);
 }
+
+TEST(EntityTest, DirectLookup) {
+    struct Manager : public SingleInstanceComponentManager<int> {
+        using SingleInstanceComponentManager::swap;
+    };
+
+    EntityManagerImpl em;
+    Manager cm;
+    // only enough memory for the first page
+    cm.enableDirectLookup(4096 * sizeof(Manager::Instance));
+
+    // entities past the first page use the hash map
+    std::unique_ptr<Entity[]> entities(new Entity[8192]);
+    em.create(8192, entities.get());
+    for (size_t i = 0; i < 8192; i++) {
+        auto ci = cm.addComponent(entities[i]);
+        cm.elementAt<0>(ci) = int(i);
+    }
+    for (size_t i = 0; i < 8192; i++) {
+        EXPECT_EQ(int(i), cm.elementAt<0>(cm.getInstance(entities[i])));
+    }
+
+    // destroy an entity without removing its component, and recycle its index
+    em.destroy(entities[0]);
+    for (size_t i = 0; i < MIN_FREE_INDICES; i++) {
+        em.destroy(entities[i + 1]);
+        cm.removeComponent(entities[i + 1]);
+    }
+    Entity const recycled = em.create();
+    ASSERT_EQ(EntityManagerImpl::getIndex(entities[0]), EntityManagerImpl::getIndex(recycled));
+
+    // both entities share a slot, one of them uses the hash map
+    auto ci = cm.addComponent(recycled);
+    cm.elementAt<0>(ci) = -1;
+    EXPECT_EQ(0, cm.elementAt<0>(cm.getInstance(entities[0])));
+    EXPECT_EQ(-1, cm.elementAt<0>(cm.getInstance(recycled)));
+
+    // swap() only swaps the entities, not their components
+    auto const i0 = cm.getInstance(entities[0]);
+    cm.swap(i0, ci);
+    EXPECT_EQ(ci, cm.getInstance(entities[0]));
+    EXPECT_EQ(i0, cm.getInstance(recycled));
+
+    cm.removeComponent(entities[0]);
+    EXPECT_FALSE(cm.hasComponent(entities[0]));
+    EXPECT_EQ(0, cm.elementAt<0>(cm.getInstance(recycled)));
+    for (size_t i = MIN_FREE_INDICES + 1; i < 8192; i++) {
+        EXPECT_EQ(int(i), cm.elementAt<0>(cm.getInstance(entities[i])));
+    }
+
+    // and the slot can be reused
+    cm.removeComponent(recycled);
+    EXPECT_FALSE(cm.hasComponent(recycled));
+    cm.addComponent(recycled);
+    EXPECT_TRUE(cm.hasComponent(recycled));
+}
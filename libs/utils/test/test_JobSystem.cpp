@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <utils/CpuTopology.h>
 #include <utils/JobSystem.h>
 #include <utils/WorkStealingDequeue.h>
 
@@ -23,6 +24,7 @@
 #include <math/mat3.h>
 
 #include <array>
+#include <vector>
 #include <thread>
 #include <utils/Allocator.h>
 
@@ -284,6 +286,131 @@ TEST(JobSystem, JobSystemParallelFor) {
     js.emancipate();
 }
 
+TEST(JobSystem, JobSystemParallelForChunks) {
+    JobSystem js;
+    js.adopt();
+
+    // many more items than MAX_JOB_COUNT, with a small chunk size
+    std::vector<uint32_t> data(1u << 20u, 0);
+    auto job = jobs::parallel_for(js, nullptr, data.data(), uint32_t(data.size()),
+            [base = data.data()](uint32_t* p, uint32_t count) {
+                for (uint32_t i = 0; i < count; i++) {
+                    p[i] += uint32_t(p + i - base);
+                }
+            }, jobs::ChunkSplitter<16>());
+    js.runAndWait(job);
+
+    for (uint32_t i = 0; i < data.size(); i++) {
+        EXPECT_EQ(i, data[i]);
+    }
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemGrowJobPool) {
+    JobSystem js;
+    js.adopt();
+
+    // keep more jobs alive than a single job pool segment can hold
+    std::atomic_int calls = { 0 };
+    JobSystem::Job* root = js.createJob();
+    std::vector<JobSystem::Job*> jobs(20000);
+    for (auto& job : jobs) {
+        job = js.createJob(root, [&calls](JobSystem&, JobSystem::Job*) {
+            calls++;
+        });
+        ASSERT_NE(nullptr, job);
+    }
+    for (auto& job : jobs) {
+        js.run(job);
+    }
+    js.runAndWait(root);
+    EXPECT_EQ(20000, calls.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, JobSystemBackgroundPriority) {
+    JobSystem js(2);
+    js.adopt();
+
+    // BACKGROUND jobs (children inherit their parent's priority) that won't complete until
+    // we let them.
+    std::atomic_bool done = { false };
+    std::atomic_int backgroundCalls = { 0 };
+    JobSystem::Job* background = js.createJob();
+    js.setPriority(background, JobSystem::JobPriority::BACKGROUND);
+    for (int i = 0; i < 4; i++) {
+        js.run(js.createJob(background, [&done, &backgroundCalls](JobSystem&, JobSystem::Job*) {
+            while (!done.load()) {
+                std::this_thread::yield();
+            }
+            backgroundCalls++;
+        }));
+    }
+    background = js.runAndRetain(background);
+
+    // CRITICAL jobs must be able to complete while the BACKGROUND jobs are blocked, i.e. neither
+    // this thread nor all the worker threads can be stuck running them.
+    std::atomic_int criticalCalls = { 0 };
+    JobSystem::Job* root = js.createJob();
+    for (int i = 0; i < 256; i++) {
+        js.run(js.createJob(root, [&criticalCalls](JobSystem&, JobSystem::Job*) {
+            criticalCalls++;
+        }));
+    }
+    js.runAndWait(root);
+
+    EXPECT_EQ(256, criticalCalls.load());
+    EXPECT_EQ(0, backgroundCalls.load());
+
+    done = true;
+    js.waitAndRelease(background);
+    EXPECT_EQ(4, backgroundCalls.load());
+
+    js.emancipate();
+}
+
+TEST(JobSystem, CpuTopology) {
+    CpuTopology const topology = CpuTopology::query();
+    ASSERT_GE(topology.getCacheDomains().size(), 1u);
+    EXPECT_GE(topology.getCpuCount(), 1u);
+    EXPECT_GE(topology.getNodeCount(), 1u);
+
+    // every CPU belongs to exactly one cache domain
+    size_t cpuCount = 0;
+    for (size_t i = 0, c = topology.getCacheDomains().size(); i < c; i++) {
+        auto const& domain = topology.getCacheDomains()[i];
+        EXPECT_FALSE(domain.cpus.empty());
+        for (uint32_t cpu : domain.cpus) {
+            EXPECT_EQ(i, topology.getCacheDomain(cpu));
+            EXPECT_EQ(domain.node, topology.getNode(cpu));
+        }
+        cpuCount += domain.cpus.size();
+    }
+    EXPECT_EQ(cpuCount, topology.getCpuCount());
+}
+
+TEST(JobSystem, JobSystemCacheDomainAffinity) {
+    JobSystem js(4, 1, JobSystem::ThreadAffinity::CACHE_DOMAIN);
+    js.adopt();
+
+    std::array<int, 1024> data{};
+    auto job = jobs::parallel_for(js, nullptr, 0, uint32_t(data.size()),
+            [&data](uint32_t start, uint32_t count) {
+                for (uint32_t i = start; i < start + count; i++) {
+                    data[i] = int(i);
+                }
+            }, jobs::CountSplitter<16>());
+    js.runAndWait(job);
+
+    for (int i = 0; i < int(data.size()); i++) {
+        EXPECT_EQ(i, data[i]);
+    }
+
+    js.emancipate();
+}
+
 TEST(JobSystem, JobSystemDelegates) {
     JobSystem js;
     js.adopt();
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utils/Path.h>
+#include <utils/Tracer.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace utils;
+
+namespace {
+
+std::string dumpToString() {
+    Path path = Path::getTemporaryDirectory() + "test_Tracer.json";
+    EXPECT_TRUE(Tracer::dump(path.c_str()));
+    std::ifstream in(path.c_str());
+    std::stringstream ss;
+    ss << in.rdbuf();
+    in.close();
+    path.unlinkFile();
+    return ss.str();
+}
+
+size_t count(std::string const& s, std::string const& what) {
+    size_t n = 0;
+    for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+} // anonymous namespace
+
+TEST(TracerTest, Dump) {
+    Tracer::startCapture();
+    EXPECT_TRUE(Tracer::isCapturing());
+
+    std::thread t([]() {
+        Tracer::record(Tracer::EventType::BEGIN, "thread \"work\"");
+        Tracer::record(Tracer::EventType::COUNTER, "counter", 42);
+        Tracer::record(Tracer::EventType::END, nullptr);
+    });
+    t.join();
+    Tracer::record(Tracer::EventType::ASYNC_BEGIN, "async", 7);
+    Tracer::record(Tracer::EventType::ASYNC_END, "async", 7);
+    Tracer::record(Tracer::EventType::INSTANT, "frame", 3);
+
+    Tracer::stopCapture();
+    EXPECT_FALSE(Tracer::isCapturing());
+
+    std::string const json = dumpToString();
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"name\":\"thread \\\"work\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"value\":42}"), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"b\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"e\""), std::string::npos);
+    EXPECT_NE(json.find("\"id\":7"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"id\":3}"), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), 1u);
+    EXPECT_EQ(count(json, "\"ph\":\"E\""), 1u);
+
+    // events recorded before clear() are not dumped
+    Tracer::clear();
+    std::string const cleared = dumpToString();
+    EXPECT_EQ(count(cleared, "\"ph\":\"B\""), 0u);
+    EXPECT_EQ(count(cleared, "\"ph\":\"C\""), 0u);
+}
+
+TEST(TracerTest, WrapAround) {
+    Tracer::startCapture(16);
+
+    // a new thread, so that its buffer is created with the size above
+    std::thread t([]() {
+        Tracer::record(Tracer::EventType::BEGIN, "outer");
+        for (size_t i = 0; i < 100; i++) {
+            Tracer::record(Tracer::EventType::BEGIN, "inner");
+            Tracer::record(Tracer::EventType::END, nullptr);
+        }
+        Tracer::record(Tracer::EventType::END, nullptr);
+    });
+    t.join();
+    Tracer::stopCapture();
+
+    std::string const json = dumpToString();
+    EXPECT_EQ(count(json, "\"name\":\"outer\""), 0u);
+    size_t const begins = count(json, "\"ph\":\"B\"");
+    size_t const ends = count(json, "\"ph\":\"E\"");
+    EXPECT_GT(begins, 0u);
+    EXPECT_LE(begins + ends, 16u);
+    // the end of "outer" is dropped, its beginning was overwritten
+    EXPECT_EQ(begins, ends);
+}
+
+TEST(TracerTest, ReuseExitedThreadBuffers) {
+    Tracer::startCapture(64);
+
+    auto record = [](const char* name) {
+        std::thread t([name]() {
+            Tracer::record(Tracer::EventType::INSTANT, name);
+        });
+        t.join();
+    };
+
+    // the events of a thread that exited are kept for the current capture, so its buffer is not
+    // reused by the next thread
+    record("first thread");
+    size_t const threadCount = count(dumpToString(), "thread_name");
+    record("second thread");
+    std::string const json = dumpToString();
+    EXPECT_NE(json.find("\"name\":\"first thread\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"second thread\""), std::string::npos);
+    EXPECT_EQ(count(json, "thread_name"), threadCount + 1);
+
+    // once they're cleared, the buffers are reused
+    Tracer::clear();
+    record("third thread");
+    record("fourth thread");
+    Tracer::stopCapture();
+    std::string const cleared = dumpToString();
+    EXPECT_NE(cleared.find("\"name\":\"third thread\""), std::string::npos);
+    EXPECT_NE(cleared.find("\"name\":\"fourth thread\""), std::string::npos);
+    EXPECT_EQ(count(cleared, "thread_name"), threadCount + 1);
+}
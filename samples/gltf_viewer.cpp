@@ -576,25 +576,10 @@ int main(int argc, char** argv) {
     }
 
     auto loadAsset = [&app](const utils::Path& filename) {
-        // Peek at the file size to allow pre-allocation.
-        long const contentSize = static_cast<long>(getFileSize(filename.c_str()));
-        if (contentSize <= 0) {
-            std::cerr << "Unable to open " << filename << std::endl;
-            exit(1);
-        }
-
-        // Consume the glTF file.
-        std::ifstream in(filename.c_str(), std::ifstream::binary | std::ifstream::in);
-        std::vector<uint8_t> buffer(static_cast<unsigned long>(contentSize));
-        if (!in.read((char*) buffer.data(), contentSize)) {
-            std::cerr << "Unable to read " << filename << std::endl;
-            exit(1);
-        }
-
-        // Parse the glTF file and create Filament entities.
-        app.asset = app.assetLoader->createAsset(buffer.data(), buffer.size());
+        // Map and parse the glTF file, and create Filament entities.
+        app.asset = app.assetLoader->createAssetFromFile(filename.c_str());
         if (!app.asset) {
-            std::cerr << "Unable to parse " << filename << std::endl;
+            std::cerr << "Unable to load " << filename << std::endl;
             exit(1);
         }
 
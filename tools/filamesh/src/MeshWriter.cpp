@@ -20,6 +20,14 @@
 
 #include <meshoptimizer.h>
 
+#include <math/norm.h>
+
+#include <utils/algorithm.h>
+#include <utils/JobSystem.h>
+
+#include <algorithm>
+#include <limits>
+
 using namespace filamesh;
 using namespace filament::math;
 using namespace std;
@@ -95,6 +103,134 @@ void MeshWriter::optimize(Mesh& mesh) {
     // e.g. we already (potentially) use snorm16 for uvs, half-floats for tangents, etc.
 }
 
+// Appends the parts of each level of detail after the existing parts, and returns the screen size
+// of each level. The triangles of each part are simplified in a job, starting from the previous
+// level, so that levels are nested.
+vector<float> MeshWriter::generateLevelsOfDetail(Mesh& mesh) {
+    const size_t partCount = mesh.parts.size();
+    const size_t levelCount = mLodErrors.size() + 1;
+
+    vector<float3> positions(mesh.vertexCount);
+    for (size_t i = 0; i < mesh.vertexCount; i++) {
+        const half4 p = (mFlags & INTERLEAVED) ? mesh.vertices[i].position : mesh.positions[i];
+        positions[i] = float3{ float(p.x), float(p.y), float(p.z) };
+    }
+
+    // simplified[level - 1][part]
+    vector<vector<vector<uint32_t>>> simplified(levelCount - 1, vector<vector<uint32_t>>(partCount));
+
+    utils::JobSystem js;
+    js.adopt();
+    utils::JobSystem::Job* root = js.createJob();
+    for (size_t part = 0; part < partCount; part++) {
+        js.run(utils::jobs::createJob(js, root, [&, part]() {
+            const Part& src = mesh.parts[part];
+            const uint32_t* indices = mesh.indices.data() + src.offset;
+            size_t indexCount = src.indexCount;
+            for (size_t level = 1; level < levelCount; level++) {
+                vector<uint32_t>& dst = simplified[level - 1][part];
+                dst.resize(indexCount);
+                dst.resize(meshopt_simplify(dst.data(), indices, indexCount,
+                        &positions[0].x, mesh.vertexCount, sizeof(float3),
+                        0, mLodErrors[level - 1]));
+                if (dst.empty()) {
+                    // an empty part can't be drawn, keep the previous level instead
+                    dst.assign(indices, indices + indexCount);
+                }
+                meshopt_optimizeVertexCache(dst.data(), dst.data(), dst.size(), mesh.vertexCount);
+                indices = dst.data();
+                indexCount = dst.size();
+            }
+        }));
+    }
+    js.runAndWait(root);
+    js.emancipate();
+
+    // A level is used while its error stays below about one pixel at 1080p, i.e. while the
+    // error, relative to the mesh, times the mesh's projected size is less than 1 / 1000.
+    vector<float> screenSizes(levelCount, 0.0f);
+    for (size_t level = 1; level < levelCount; level++) {
+        screenSizes[level] = 1.0f / (1000.0f * mLodErrors[level - 1]);
+        for (size_t part = 0; part < partCount; part++) {
+            const vector<uint32_t>& indices = simplified[level - 1][part];
+            Part lod = mesh.parts[part];
+            lod.offset = uint32_t(mesh.indices.size());
+            lod.indexCount = uint32_t(indices.size());
+            if (!indices.empty()) {
+                lod.minIndex = *std::min_element(indices.begin(), indices.end());
+                lod.maxIndex = *std::max_element(indices.begin(), indices.end());
+            }
+            mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+            mesh.parts.push_back(lod);
+        }
+    }
+    return screenSizes;
+}
+
+// Replaces the positions and UVs of the mesh with unsigned integers of the configured number of
+// bits, relative to the bounding box of the mesh and to the range of the UVs.
+Quantization MeshWriter::quantize(Mesh& mesh, const Box& aabb) {
+    const bool interleaved = mFlags & INTERLEAVED;
+    Quantization quantization{ mPositionBits, mUvBits, float2(0.0f), float2(0.0f) };
+
+    if (mPositionBits) {
+        const float3 min = aabb.getMin();
+        const float3 extent = aabb.halfExtent * 2.0f;
+        for (size_t i = 0; i < mesh.vertexCount; i++) {
+            half4& position = interleaved ? mesh.vertices[i].position : mesh.positions[i];
+            ushort4 q(0);
+            for (size_t c = 0; c < 3; c++) {
+                const float t = extent[c] > 0.0f ? (float(position[c]) - min[c]) / extent[c] : 0.0f;
+                q[c] = uint16_t(meshopt_quantizeUnorm(t, int(mPositionBits)));
+            }
+            position = utils::bit_cast<half4>(q);
+        }
+    }
+
+    if (mUvBits) {
+        vector<ushort2*> uvs;
+        if (interleaved) {
+            for (Vertex& vertex : mesh.vertices) {
+                uvs.push_back(&vertex.uv0);
+            }
+        } else {
+            for (ushort2& uv : mesh.uv0) {
+                uvs.push_back(&uv);
+            }
+            for (ushort2& uv : mesh.uv1) {
+                uvs.push_back(&uv);
+            }
+        }
+
+        const bool snorm = mFlags & TEXCOORD_SNORM16;
+        auto decode = [snorm](ushort2 uv) {
+            const short2 s = utils::bit_cast<short2>(uv);
+            return snorm ? float2{ unpackSnorm16(s.x), unpackSnorm16(s.y) } :
+                    float2(utils::bit_cast<half2>(uv));
+        };
+
+        float2 uvMin(numeric_limits<float>::max());
+        float2 uvMax(numeric_limits<float>::lowest());
+        for (const ushort2* uv : uvs) {
+            uvMin = min(uvMin, decode(*uv));
+            uvMax = max(uvMax, decode(*uv));
+        }
+
+        const float2 extent = uvMax - uvMin;
+        for (ushort2* uv : uvs) {
+            const float2 value = decode(*uv);
+            for (size_t c = 0; c < 2; c++) {
+                const float t = extent[c] > 0.0f ? (value[c] - uvMin[c]) / extent[c] : 0.0f;
+                (*uv)[c] = uint16_t(meshopt_quantizeUnorm(t, int(mUvBits)));
+            }
+        }
+        quantization.uvMin = uvMin;
+        quantization.uvMax = uvMax;
+    }
+
+    return quantization;
+}
+
 bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
     const bool hasIndex16 = mesh.vertexCount <= numeric_limits<uint16_t>::max();
     const bool hasUV1 = !mesh.uv1.empty();
@@ -113,6 +249,20 @@ bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
     // It's safe to optimize the mesh regardless of the compression setting.
     optimize(mesh);
 
+    // Levels of detail only add parts and indices, they share the vertices of the mesh.
+    vector<float> screenSizes;
+    if (!mLodErrors.empty()) {
+        screenSizes = generateLevelsOfDetail(mesh);
+        mFlags |= LEVELS_OF_DETAIL;
+    }
+
+    // Quantized attributes have the size of the original ones, but compress much better.
+    Quantization quantization{};
+    if (mPositionBits || mUvBits) {
+        quantization = quantize(mesh, aabb);
+        mFlags |= QUANTIZATION;
+    }
+
     // Perform compression of vertex data if it has been requested.
     CompressionHeader cheader {};
     vector<unsigned char> compressedVertices;
@@ -220,6 +370,10 @@ bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
 
     write(out, header);
 
+    if (mFlags & QUANTIZATION) {
+        write(out, quantization);
+    }
+
     if (mFlags & COMPRESSION) {
         write(out, &cheader, 1);
         write(out, compressedVertices.data(), compressedVertices.size());
@@ -257,5 +411,10 @@ bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
         write(out, char(0));
     }
 
+    if (mFlags & LEVELS_OF_DETAIL) {
+        write(out, LevelsOfDetail{ uint32_t(screenSizes.size()) });
+        write(out, screenSizes.data(), uint32_t(screenSizes.size()));
+    }
+
     return true;
 }
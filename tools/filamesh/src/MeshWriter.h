@@ -57,9 +57,26 @@ struct Mesh {
 
 class MeshWriter {
     uint32_t mFlags;
+    std::vector<float> mLodErrors;
+    uint32_t mPositionBits = 0;
+    uint32_t mUvBits = 0;
     void optimize(Mesh& mesh);
+    std::vector<float> generateLevelsOfDetail(Mesh& mesh);
+    Quantization quantize(Mesh& mesh, const Box& aabb);
 public:
     MeshWriter(uint32_t flags) : mFlags(flags) {}
+
+    // Generates one simplified level of detail per error, each error being relative to the extent
+    // of the mesh. Errors must be positive and in increasing order.
+    void setLevelsOfDetail(std::vector<float> errors) { mLodErrors = std::move(errors); }
+
+    // Quantizes the positions and UVs to the given number of bits, from 1 to 16, 0 leaving the
+    // attribute unchanged. See filamesh::Quantization.
+    void setQuantization(uint32_t positionBits, uint32_t uvBits) {
+        mPositionBits = positionBits;
+        mUvBits = uvBits;
+    }
+
     bool serialize(std::ostream&, Mesh& mesh);
 };
 
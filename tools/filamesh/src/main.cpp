@@ -16,8 +16,13 @@
 
 #include "MeshWriter.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
 
 #include <math/half.h>
 #include <math/mat3.h>
@@ -28,6 +33,8 @@
 #include <utils/algorithm.h>
 #include <utils/Path.h>
 
+#include <filament/RenderableManager.h>
+
 #include <filameshio/filamesh.h>
 
 #include <getopt/getopt.h>
@@ -48,6 +55,9 @@ bool g_interleaved = false;
 bool g_snormUVs = false;
 bool g_compression = false;
 bool g_ignore_uv1 = false;
+std::vector<float> g_lodErrors;
+uint32_t g_positionBits = 0;
+uint32_t g_uvBits = 0;
 
 Mesh g_mesh;
 float2 g_minUV = float2(std::numeric_limits<float>::max());
@@ -273,6 +283,14 @@ static void printUsage(const char* name) {
                     "       enable compression\n\n"
                     "   --ignore-uv1, -g\n"
                     "       Ignore the second set of UV coordinates\n\n"
+                    "   --lod=<error>[,<error>...], -L <error>[,<error>...]\n"
+                    "       Generate one simplified level of detail per error, each error being\n"
+                    "       relative to the size of the mesh, in increasing order (e.g. 0.01,0.05)\n\n"
+                    "   --quantize=<bits>[,<UV bits>], -q <bits>[,<UV bits>]\n"
+                    "       Quantize positions, relative to the bounding box of the mesh, and UVs to\n"
+                    "       the given number of bits (1 to 16) so that they compress better with\n"
+                    "       --compress. They are loaded as half floats, more than 12 bits only\n"
+                    "       makes the file larger (e.g. 11,12)\n\n"
 
     );
 
@@ -295,13 +313,15 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hilcg";
+    static constexpr const char* OPTSTR = "hilcgL:q:";
     static const struct option OPTIONS[] = {
             { "help",        no_argument, 0, 'h' },
             { "license",     no_argument, 0, 'l' },
             { "interleaved", no_argument, 0, 'i' },
             { "compress",    no_argument, 0, 'c' },
             { "ignore-uv1",  no_argument, 0, 'g' },
+            { "lod",         required_argument, 0, 'L' },
+            { "quantize",    required_argument, 0, 'q' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -329,6 +349,40 @@ static int handleArguments(int argc, char* argv[]) {
             case 'g':
                 g_ignore_uv1 = true;
                 break;
+            case 'L': {
+                std::string arg(optarg);
+                for (size_t pos = 0; pos < arg.size();) {
+                    size_t const end = std::min(arg.find(',', pos), arg.size());
+                    float const error = strtof(arg.substr(pos, end - pos).c_str(), nullptr);
+                    if (!(error > 0.0f) || (!g_lodErrors.empty() && error <= g_lodErrors.back())) {
+                        std::cerr << "LOD errors must be positive and increasing." << std::endl;
+                        exit(1);
+                    }
+                    g_lodErrors.push_back(error);
+                    pos = end + 1;
+                }
+                // MAX_LEVEL_COUNT includes the original mesh
+                constexpr size_t maxLevelCount =
+                        filament::RenderableManager::Builder::MAX_LEVEL_COUNT - 1;
+                if (g_lodErrors.size() > maxLevelCount) {
+                    std::cerr << "At most " << maxLevelCount
+                              << " levels of detail can be generated." << std::endl;
+                    exit(1);
+                }
+                break;
+            }
+            case 'q': {
+                std::string arg(optarg);
+                size_t const comma = arg.find(',');
+                g_positionBits = uint32_t(strtoul(arg.substr(0, comma).c_str(), nullptr, 10));
+                g_uvBits = comma == std::string::npos ? g_positionBits :
+                        uint32_t(strtoul(arg.substr(comma + 1).c_str(), nullptr, 10));
+                if (g_positionBits < 1 || g_positionBits > 16 || g_uvBits < 1 || g_uvBits > 16) {
+                    std::cerr << "Quantization must use 1 to 16 bits." << std::endl;
+                    exit(1);
+                }
+                break;
+            }
         }
     }
 
@@ -441,7 +495,10 @@ int main(int argc, char* argv[]) {
     if (g_compression) {
         flags |= filamesh::COMPRESSION;
     }
-    MeshWriter(flags).serialize(out, g_mesh);
+    MeshWriter writer(flags);
+    writer.setLevelsOfDetail(g_lodErrors);
+    writer.setQuantization(g_positionBits, g_uvBits);
+    writer.serialize(out, g_mesh);
 
     out.flush();
     out.close();
@@ -132,6 +132,7 @@ export class Texture {
     public getDepth(engine: Engine, level?: number) : number;
     public getLevels(engine: Engine) : number;
     public generateMipmaps(engine: Engine) : void;
+    public setMinMaxLevels(engine: Engine, minLevel: number, maxLevel: number) : void;
 }
 
 // TODO: Remove the entity type and just use integers for parity with Filament's Java bindings.
@@ -1425,6 +1425,7 @@ class_<TextureSampler>("TextureSampler")
 class_<Texture>("Texture")
     .class_function("Builder", (TexBuilder (*)()) [] { return TexBuilder(); })
     .function("generateMipmaps", &Texture::generateMipmaps)
+    .function("setMinMaxLevels", &Texture::setMinMaxLevels)
     .function("_setImage", EMBIND_LAMBDA(void, (Texture* self,
             Engine* engine, uint8_t level, PixelBufferDescriptor pbd), {
         self->setImage(*engine, level, std::move(*pbd.pbd));